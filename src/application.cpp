@@ -59,10 +59,12 @@
 #include "dabtables.h"
 #include "epgbackend.h"
 #include "epgtime.h"
+#include "imagecache.h"
 #include "navigationmodel.h"
 #include "radiocontrol.h"
 #include "scannerbackend.h"
 #include "settingsbackend.h"
+#include "threadplacement.h"
 #include "tiibackend.h"
 #include "updatechecker.h"
 #if HAVE_PORTAUDIO
@@ -253,6 +255,7 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     connect(m_navigationModel, &NavigationModel::isActiveChanged, this, &Application::pageActive);
 
     m_inputDeviceRecorder = new InputDeviceRecorder(m_settings);
+    m_serviceStreamRecorder = new ServiceStreamRecorder(this);
 
     m_settingsBackend = new SettingsBackend(m_qmlEngine, this);
     connect(m_settingsBackend, &SettingsBackend::inputDeviceChanged, this, &Application::changeInputDevice);
@@ -281,6 +284,11 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     connect(m_inputDeviceRecorder, &InputDeviceRecorder::recording, m_ensembleInfoBackend, &EnsembleInfoBackend::onRecording);
     connect(m_inputDeviceRecorder, &InputDeviceRecorder::bytesRecorded, m_ensembleInfoBackend, &EnsembleInfoBackend::updateRecordingStatus,
             Qt::QueuedConnection);
+    connect(m_ensembleInfoBackend, &EnsembleInfoBackend::serviceStreamRecordingStart, this,
+            [this]() { m_serviceStreamRecorder->start(m_settings->dataStoragePath); });
+    connect(m_ensembleInfoBackend, &EnsembleInfoBackend::serviceStreamRecordingStop, m_serviceStreamRecorder, &ServiceStreamRecorder::stop);
+    connect(m_serviceStreamRecorder, &ServiceStreamRecorder::recording, m_ensembleInfoBackend, &EnsembleInfoBackend::onServiceStreamRecording,
+            Qt::QueuedConnection);
 
 #if HAVE_FMLIST_INTERFACE
     m_fmlistInterface = new FMListInterface(PROJECT_VER, TxDataLoader::dbfile());
@@ -333,7 +341,27 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     // load audio setting from ini file
     Settings::AudioFramework audioFramework;
     Settings::AudioDecoder audioDecoder;
-    getAudioSettings(audioFramework, audioDecoder);
+    Settings::AudioLatencyProfile audioLatencyProfile;
+    getAudioSettings(audioFramework, audioDecoder, audioLatencyProfile);
+
+    // audio FIFOs are allocated according to latency profile, this cannot be changed in runtime
+    uint32_t audioChunkMs = AUDIO_FIFO_CHUNK_MS;
+    switch (audioLatencyProfile)
+    {
+        case Settings::AudioLatencyProfile::LowLatency:
+            audioChunkMs = AUDIO_FIFO_CHUNK_MS_LOW_LATENCY;
+            break;
+        case Settings::AudioLatencyProfile::Robust:
+            audioChunkMs = AUDIO_FIFO_CHUNK_MS_ROBUST;
+            break;
+        default:
+            break;
+    }
+    for (int n = 0; n < 2; ++n)
+    {
+        audioFifo[n].allocate(audioChunkMs);
+    }
+    qCInfo(application, "Audio latency profile %d: chunk %u ms, FIFO %u ms", audioLatencyProfile, audioChunkMs, audioFifo[0].sizeMs());
 
 #ifdef Q_OS_LINUX
     if (Settings::AudioFramework::Qt == audioFramework)
@@ -430,6 +458,7 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     m_radioControlThread->setObjectName("radioControlThr");
     m_radioControl->moveToThread(m_radioControlThread);
     connect(m_radioControlThread, &QThread::finished, m_radioControl, &QObject::deleteLater);
+    ThreadPlacement::getInstance()->registerThread(m_radioControlThread, ThreadPlacement::RadioControl);
     m_radioControlThread->start();
 
     // initialize radio control
@@ -441,28 +470,41 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
 
     AudioRecorder *audioRecorder = new AudioRecorder();
 
+    // standby decoder is used for announcements on other service
+    AudioDecoder *standbyAudioDecoder;
 #if (!HAVE_FAAD)
     m_audioDecoder = new AudioDecoderFDKAAC(audioRecorder);
+    standbyAudioDecoder = new AudioDecoderFDKAAC(audioRecorder);
 #elif (!HAVE_FDKAAC)
     m_audioDecoder = new AudioDecoderFAAD(audioRecorder);
+    standbyAudioDecoder = new AudioDecoderFAAD(audioRecorder);
 #else
     if (Settings::AudioDecoder::FDKAAC == audioDecoder)
     {
         m_audioDecoder = new AudioDecoderFDKAAC(audioRecorder);
+        standbyAudioDecoder = new AudioDecoderFDKAAC(audioRecorder);
         qCInfo(application) << "AAC audio decoder: FDK-AAC";
     }
     else
     {
         m_audioDecoder = new AudioDecoderFAAD(audioRecorder);
+        standbyAudioDecoder = new AudioDecoderFAAD(audioRecorder);
         qCInfo(application) << "AAC audio decoder: FAAD";
     }
 #endif
+    m_audioDecoder->setStandbyDecoder(standbyAudioDecoder);
     m_audioDecoderThread = new QThread(this);
     m_audioDecoderThread->setObjectName("audioDecoderThr");
     m_audioDecoder->moveToThread(m_audioDecoderThread);
     audioRecorder->moveToThread(m_audioDecoderThread);
     connect(m_audioDecoderThread, &QThread::finished, m_audioDecoder, &QObject::deleteLater);
     connect(m_audioDecoderThread, &QThread::finished, audioRecorder, &QObject::deleteLater);
+
+    // time shift buffer is placed between radio control and audio decoder
+    m_timeShiftBuffer = new TimeShiftBuffer();
+    m_timeShiftBuffer->moveToThread(m_audioDecoderThread);
+    connect(m_audioDecoderThread, &QThread::finished, m_timeShiftBuffer, &QObject::deleteLater);
+    ThreadPlacement::getInstance()->registerThread(m_audioDecoderThread, ThreadPlacement::AudioDecoder);
     m_audioDecoderThread->start();
 
     m_audioRecScheduleModel = new AudioRecScheduleModel(this);
@@ -471,12 +513,33 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     connect(m_audioRecManager, &AudioRecManager::audioRecordingStarted, this, &Application::onAudioRecordingStarted);
     connect(m_audioRecManager, &AudioRecManager::audioRecordingStopped, this, &Application::onAudioRecordingStopped);
     connect(m_audioRecManager, &AudioRecManager::audioRecordingProgress, this, &Application::onAudioRecordingProgress);
+    connect(m_audioRecManager, &AudioRecManager::audioRecordingStatistics, this, &Application::onAudioRecordingStatistics);
     connect(m_audioRecManager, &AudioRecManager::audioRecordingCountdown, this, &Application::onAudioRecordingCountdown, Qt::QueuedConnection);
     connect(m_audioRecManager, &AudioRecManager::requestServiceSelection, this, &Application::selectService);
     connect(m_radioControl, &RadioControl::audioServiceSelection, m_audioRecManager, &AudioRecManager::onAudioServiceSelection, Qt::QueuedConnection);
     connect(m_settingsBackend, &SettingsBackend::noiseConcealmentLevelChanged, m_audioDecoder, &AudioDecoder::setNoiseConcealment,
             Qt::QueuedConnection);
+    connect(m_settingsBackend, &SettingsBackend::noiseConcealmentLevelChanged, standbyAudioDecoder, &AudioDecoder::setNoiseConcealment,
+            Qt::QueuedConnection);
     connect(this, &Application::audioStop, m_audioDecoder, &AudioDecoder::stop, Qt::QueuedConnection);
+
+    connect(m_settingsBackend, &SettingsBackend::timeShiftSettingsChanged, m_timeShiftBuffer, &TimeShiftBuffer::setup, Qt::QueuedConnection);
+    connect(m_settingsBackend, &SettingsBackend::timeShiftSettingsChanged, this,
+            [this](int lengthMin, int ramBudgetMB)
+            {
+                m_ui->isTimeShiftEnabled(lengthMin > 0);
+                m_timeShiftLengthMs = qint64(lengthMin) * 60 * 1000;
+                m_timeShiftEventBudget = TimeShiftBuffer::metadataBudgetBytes(ramBudgetMB);
+                resetTimeShiftEvents();
+            });
+    connect(this, &Application::timeShiftPause, m_timeShiftBuffer, &TimeShiftBuffer::pause, Qt::QueuedConnection);
+    connect(this, &Application::timeShiftResume, m_timeShiftBuffer, &TimeShiftBuffer::resume, Qt::QueuedConnection);
+    connect(this, &Application::timeShiftSkipRequest, m_timeShiftBuffer, &TimeShiftBuffer::skip, Qt::QueuedConnection);
+    connect(this, &Application::timeShiftLiveRequest, m_timeShiftBuffer, &TimeShiftBuffer::jumpToLive, Qt::QueuedConnection);
+    connect(m_timeShiftBuffer, &TimeShiftBuffer::stateChanged, this, &Application::onTimeShiftState, Qt::QueuedConnection);
+    m_timeShiftTimer = new QTimer(this);
+    m_timeShiftTimer->setInterval(200);
+    connect(m_timeShiftTimer, &QTimer::timeout, this, &Application::onTimeShiftTimer);
     connect(m_settingsBackend, &SettingsBackend::audioRecordingSettings, audioRecorder, &AudioRecorder::setup, Qt::QueuedConnection);
 
     onAudioRecordingStopped();
@@ -507,6 +570,7 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
         m_audioOutputThread->setObjectName("audioOutThr");
         m_audioOutput->moveToThread(m_audioOutputThread);
         connect(m_audioOutputThread, &QThread::finished, m_audioOutput, &QObject::deleteLater);
+        ThreadPlacement::getInstance()->registerThread(m_audioOutputThread, ThreadPlacement::AudioOutput);
         m_audioOutputThread->start();
 
         qCInfo(application) << "Audio output: Qt";
@@ -555,7 +619,25 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     connect(m_radioControl, &RadioControl::audioServiceSelection, this, &Application::onAudioServiceSelection, Qt::QueuedConnection);
     connect(m_radioControl, &RadioControl::audioServiceSelection, m_dlDecoder[Instance::Service], &DLDecoder::reset, Qt::QueuedConnection);
     connect(m_radioControl, &RadioControl::audioServiceSelection, m_dlDecoder[Instance::Announcement], &DLDecoder::reset, Qt::QueuedConnection);
-    connect(m_radioControl, &RadioControl::audioData, m_audioDecoder, &AudioDecoder::decodeData, Qt::QueuedConnection);
+    // service stream recorder copies data in emitting thread, audio data has to be connected before
+    // queued connection to time shift buffer that takes the ownership
+    connect(m_radioControl, &RadioControl::audioData, m_serviceStreamRecorder, &ServiceStreamRecorder::onAudioData, Qt::DirectConnection);
+    connect(m_radioControl, &RadioControl::dlDataGroup_Service, m_serviceStreamRecorder, &ServiceStreamRecorder::onDLDataGroup_Service,
+            Qt::DirectConnection);
+    connect(m_radioControl, &RadioControl::dlDataGroup_Announcement, m_serviceStreamRecorder,
+            &ServiceStreamRecorder::onDLDataGroup_Announcement, Qt::DirectConnection);
+    connect(m_radioControl, &RadioControl::userAppData_Service, m_serviceStreamRecorder, &ServiceStreamRecorder::onUserAppData_Service,
+            Qt::DirectConnection);
+    connect(m_radioControl, &RadioControl::userAppData_Announcement, m_serviceStreamRecorder,
+            &ServiceStreamRecorder::onUserAppData_Announcement, Qt::DirectConnection);
+    connect(m_radioControl, &RadioControl::ensembleInformation, m_serviceStreamRecorder, &ServiceStreamRecorder::onEnsembleInformation,
+            Qt::DirectConnection);
+    connect(m_radioControl, &RadioControl::audioServiceSelection, m_serviceStreamRecorder, &ServiceStreamRecorder::onAudioServiceSelection,
+            Qt::DirectConnection);
+    connect(m_radioControl, &RadioControl::audioData, m_timeShiftBuffer, &TimeShiftBuffer::onAudioData, Qt::QueuedConnection);
+    connect(m_timeShiftBuffer, &TimeShiftBuffer::audioData, m_audioDecoder, &AudioDecoder::decodeData, Qt::DirectConnection);
+    connect(m_radioControl, &RadioControl::audioServiceSelection, m_timeShiftBuffer, &TimeShiftBuffer::reset, Qt::QueuedConnection);
+    connect(m_radioControl, &RadioControl::audioServiceSelection, this, &Application::resetTimeShiftEvents, Qt::QueuedConnection);
     connect(m_settingsBackend, &SettingsBackend::tiiModeChanged, m_radioControl, &RadioControl::setTii, Qt::QueuedConnection);
 
     // service stopped
@@ -565,26 +647,35 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     connect(m_radioControl, &RadioControl::audioServiceReconfiguration, this, &Application::onAudioServiceReconfiguration, Qt::QueuedConnection);
     connect(this, &Application::getAudioInfo, m_audioDecoder, &AudioDecoder::getAudioParameters, Qt::QueuedConnection);
 
-    // DL(+)
+    // DL(+) is delayed by time shift to stay in sync with audio
     // normal service
-    connect(m_dlDecoder[Instance::Service], &DLDecoder::dlComplete, this, &Application::onDLComplete_Service);
+    connect(m_dlDecoder[Instance::Service], &DLDecoder::dlComplete, this,
+            [this](const QString &dl) { timeShifted([this, dl]() { onDLComplete_Service(dl); }); });
     connect(m_dlDecoder[Instance::Service], &DLDecoder::dlComplete, m_audioRecManager, &AudioRecManager::onDLComplete);
-    connect(m_dlDecoder[Instance::Service], &DLDecoder::dlPlusObject, this, &Application::onDLPlusObjReceived_Service);
-    connect(m_dlDecoder[Instance::Service], &DLDecoder::dlItemToggle, this, &Application::onDLPlusItemToggle_Service);
-    connect(m_dlDecoder[Instance::Service], &DLDecoder::dlItemRunning, this, &Application::onDLPlusItemRunning_Service);
-    connect(m_dlDecoder[Instance::Service], &DLDecoder::resetTerminal, this, &Application::onDLReset_Service);
+    connect(m_dlDecoder[Instance::Service], &DLDecoder::dlPlusObject, this,
+            [this](const DLPlusObject &object) { timeShifted([this, object]() { onDLPlusObjReceived_Service(object); }); });
+    connect(m_dlDecoder[Instance::Service], &DLDecoder::dlItemToggle, this, [this]() { timeShifted([this]() { onDLPlusItemToggle_Service(); }); });
+    connect(m_dlDecoder[Instance::Service], &DLDecoder::dlItemRunning, this,
+            [this](bool isRunning) { timeShifted([this, isRunning]() { onDLPlusItemRunning_Service(isRunning); }); });
+    connect(m_dlDecoder[Instance::Service], &DLDecoder::resetTerminal, this, [this]() { timeShifted([this]() { onDLReset_Service(); }); });
     connect(m_dlDecoder[Instance::Service], &DLDecoder::resetTerminal, m_audioRecManager, &AudioRecManager::onDLReset);
     // announcement
-    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::dlComplete, this, &Application::onDLComplete_Announcement);
-    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::dlPlusObject, this, &Application::onDLPlusObjReceived_Announcement);
-    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::dlItemToggle, this, &Application::onDLPlusItemToggle_Announcement);
-    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::dlItemRunning, this, &Application::onDLPlusItemRunning_Announcement);
-    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::resetTerminal, this, &Application::onDLReset_Announcement);
+    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::dlComplete, this,
+            [this](const QString &dl) { timeShifted([this, dl]() { onDLComplete_Announcement(dl); }); });
+    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::dlPlusObject, this,
+            [this](const DLPlusObject &object) { timeShifted([this, object]() { onDLPlusObjReceived_Announcement(object); }); });
+    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::dlItemToggle, this,
+            [this]() { timeShifted([this]() { onDLPlusItemToggle_Announcement(); }); });
+    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::dlItemRunning, this,
+            [this](bool isRunning) { timeShifted([this, isRunning]() { onDLPlusItemRunning_Announcement(isRunning); }); });
+    connect(m_dlDecoder[Instance::Announcement], &DLDecoder::resetTerminal, this, [this]() { timeShifted([this]() { onDLReset_Announcement(); }); });
 
     connect(m_audioDecoder, &AudioDecoder::audioParametersInfo, this, &Application::onAudioParametersInfo, Qt::QueuedConnection);
     connect(m_radioControl, &RadioControl::audioServiceSelection, m_audioDecoder, &AudioDecoder::start, Qt::QueuedConnection);
 
     // audio output is controlled by signals from decoder
+    connect(m_radioControl, &RadioControl::stopAudio, m_timeShiftBuffer, &TimeShiftBuffer::reset, Qt::QueuedConnection);
+    connect(m_radioControl, &RadioControl::stopAudio, this, &Application::resetTimeShiftEvents, Qt::QueuedConnection);
     connect(m_radioControl, &RadioControl::stopAudio, m_audioDecoder, &AudioDecoder::stop, Qt::QueuedConnection);
     connect(m_audioDecoder, &AudioDecoder::startAudio, m_audioOutput, &AudioOutput::start, Qt::QueuedConnection);
     connect(m_audioDecoder, &AudioDecoder::switchAudio, m_audioOutput, &AudioOutput::restart, Qt::QueuedConnection);
@@ -621,10 +712,17 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     connect(m_radioControl, &RadioControl::audioServiceSelection, m_slideShowApp[Instance::Service], &UserApplication::setAudioServiceId);
 
     // connect(this, &MainWindow::serviceRequest, m_metadataManager, &MetadataManager::onServiceRequest);
-    connect(m_slideShowApp[Instance::Service], &SlideShowApp::currentSlide, m_slsBackend[Instance::Service], &SLSBackend::showSlide,
-            Qt::QueuedConnection);
-    connect(m_slideShowApp[Instance::Service], &SlideShowApp::resetTerminal, m_slsBackend[Instance::Service], &SLSBackend::reset,
-            Qt::QueuedConnection);
+    connect(
+        m_slideShowApp[Instance::Service], &SlideShowApp::currentSlide, this,
+        [this](const Slide &slide)
+        {
+            qint64 bytes = slide.getRawData().size() + slide.getImage().sizeInBytes();
+            timeShifted([this, slide]() { m_slsBackend[Instance::Service]->showSlide(slide); }, bytes);
+        },
+        Qt::QueuedConnection);
+    connect(
+        m_slideShowApp[Instance::Service], &SlideShowApp::resetTerminal, this,
+        [this]() { timeShifted([this]() { m_slsBackend[Instance::Service]->reset(); }); }, Qt::QueuedConnection);
     connect(
         m_slideShowApp[Instance::Service], &SlideShowApp::catSlsAvailable, this,
         [this]() { m_navigationModel->setEnabled(NavigationModel::CatSls, true); }, Qt::QueuedConnection);
@@ -634,10 +732,17 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     connect(m_radioControlThread, &QThread::finished, m_slideShowApp[Instance::Announcement], &QObject::deleteLater);
     connect(m_radioControl, &RadioControl::audioServiceSelection, m_slideShowApp[Instance::Announcement], &SlideShowApp::start);
     connect(m_radioControl, &RadioControl::userAppData_Announcement, m_slideShowApp[Instance::Announcement], &SlideShowApp::onUserAppData);
-    connect(m_slideShowApp[Instance::Announcement], &SlideShowApp::currentSlide, m_slsBackend[Instance::Announcement], &SLSBackend::showSlide,
-            Qt::QueuedConnection);
-    connect(m_slideShowApp[Instance::Announcement], &SlideShowApp::resetTerminal, m_slsBackend[Instance::Announcement], &SLSBackend::reset,
-            Qt::QueuedConnection);
+    connect(
+        m_slideShowApp[Instance::Announcement], &SlideShowApp::currentSlide, this,
+        [this](const Slide &slide)
+        {
+            qint64 bytes = slide.getRawData().size() + slide.getImage().sizeInBytes();
+            timeShifted([this, slide]() { m_slsBackend[Instance::Announcement]->showSlide(slide); }, bytes);
+        },
+        Qt::QueuedConnection);
+    connect(
+        m_slideShowApp[Instance::Announcement], &SlideShowApp::resetTerminal, this,
+        [this]() { timeShifted([this]() { m_slsBackend[Instance::Announcement]->reset(); }); }, Qt::QueuedConnection);
 
     connect(m_radioControl, &RadioControl::announcement, m_slsBackend[Instance::Announcement], &SLSBackend::showAnnouncement, Qt::QueuedConnection);
     connect(this, &Application::stopUserApps, m_slideShowApp[Instance::Announcement], &SlideShowApp::stop, Qt::QueuedConnection);
@@ -646,19 +751,31 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
             Qt::QueuedConnection);
     connect(m_settingsBackend, &SettingsBackend::uaDumpSettings, m_slideShowApp[Instance::Announcement], &SlideShowApp::setDataDumping,
             Qt::QueuedConnection);
+    connect(m_settingsBackend, &SettingsBackend::slsPrescaleHeightChanged, m_slideShowApp[Instance::Service], &SlideShowApp::setPrescaleHeight,
+            Qt::QueuedConnection);
+    connect(m_settingsBackend, &SettingsBackend::slsPrescaleHeightChanged, m_slideShowApp[Instance::Announcement],
+            &SlideShowApp::setPrescaleHeight, Qt::QueuedConnection);
 
+    // whole SPI decoding chain (MOT directory, binary decoding, SPI metadata) runs in its own thread
+    // only finished metadata batches are passed to MetadataManager
     m_spiApp = new SPIApp();
-    m_spiApp->moveToThread(m_radioControlThread);
-    connect(m_radioControlThread, &QThread::finished, m_spiApp, &QObject::deleteLater);
-    connect(m_radioControl, &RadioControl::userAppData_Service, m_spiApp, &SPIApp::onUserAppData);
-    connect(m_radioControl, &RadioControl::audioServiceSelection, m_spiApp, &SPIApp::start);
+    m_spiThread = new QThread(this);
+    m_spiThread->setObjectName("spiThr");
+    m_spiApp->moveToThread(m_spiThread);
+    connect(m_spiThread, &QThread::finished, m_spiApp, &QObject::deleteLater);
+    ThreadPlacement::getInstance()->registerThread(m_spiThread, ThreadPlacement::SpiDecoder);
+    m_spiThread->start();
+    connect(m_radioControl, &RadioControl::userAppData_Service, m_spiApp, &SPIApp::onUserAppData, Qt::QueuedConnection);
+    connect(m_radioControl, &RadioControl::audioServiceSelection, m_spiApp, &SPIApp::start, Qt::QueuedConnection);
     connect(this, &Application::stopUserApps, m_spiApp, &SPIApp::stop, Qt::QueuedConnection);
     connect(this, &Application::resetUserApps, m_spiApp, &SPIApp::reset, Qt::QueuedConnection);
     connect(m_spiApp, &SPIApp::decodingStart, this, [this](bool isEns) { onSpiProgress(isEns, 0, 0); }, Qt::QueuedConnection);
     connect(m_spiApp, &SPIApp::decodingProgress, this, &Application::onSpiProgress, Qt::QueuedConnection);
     connect(m_settingsBackend, &SettingsBackend::uaDumpSettings, m_spiApp, &SPIApp::setDataDumping, Qt::QueuedConnection);
+    connect(m_settingsBackend, &SettingsBackend::spiCacheBudgetChanged, m_spiApp, &SPIApp::setCacheBudget, Qt::QueuedConnection);
 
     connect(m_spiApp, &SPIApp::xmlDocument, m_metadataManager, &MetadataManager::processXML, Qt::QueuedConnection);
+    connect(m_spiApp, &SPIApp::metadata, m_metadataManager, &MetadataManager::processMetadata, Qt::QueuedConnection);
     connect(m_metadataManager, &MetadataManager::getSI, m_spiApp, &SPIApp::getSI, Qt::QueuedConnection);
     connect(m_metadataManager, &MetadataManager::getPI, m_spiApp, &SPIApp::getPI, Qt::QueuedConnection);
     connect(m_metadataManager, &MetadataManager::getFile, m_spiApp, &SPIApp::onFileRequest, Qt::QueuedConnection);
@@ -670,8 +787,8 @@ Application::Application(const QString &iniFilename, const QString &iniSlFilenam
     connect(m_settingsBackend, &SettingsBackend::spiApplicationSettingsChanged, m_spiApp, &SPIApp::onSettingsChanged, Qt::QueuedConnection);
     connect(m_radioControl, &RadioControl::ensembleInformation, m_metadataManager, &MetadataManager::onEnsembleInformation, Qt::QueuedConnection);
     connect(m_radioControl, &RadioControl::audioServiceSelection, m_metadataManager, &MetadataManager::onAudioServiceSelection, Qt::QueuedConnection);
-    connect(m_radioControl, &RadioControl::ensembleInformation, m_spiApp, &UserApplication::setEnsId);
-    connect(m_radioControl, &RadioControl::audioServiceSelection, m_spiApp, &UserApplication::setAudioServiceId);
+    connect(m_radioControl, &RadioControl::ensembleInformation, m_spiApp, &UserApplication::setEnsId, Qt::QueuedConnection);
+    connect(m_radioControl, &RadioControl::audioServiceSelection, m_spiApp, &UserApplication::setAudioServiceId, Qt::QueuedConnection);
 
     // connect(m_setupDialog, &SetupDialog::slsBgChanged, ui->slsView_Service, &SLSView::setBgColor);
     // connect(m_setupDialog, &SetupDialog::slsBgChanged, ui->slsView_Announcement, &SLSView::setBgColor);
@@ -729,6 +846,10 @@ Application::~Application()
     // Stop all worker threads FIRST, before deleting the QML engine
     // This ensures no threads are running when we destroy objects
 
+    m_spiThread->quit();  // this deletes SPI application
+    m_spiThread->wait();
+    delete m_spiThread;
+
     m_radioControlThread->quit();  // this deletes radioControl
     m_radioControlThread->wait();
     delete m_radioControlThread;
@@ -1903,10 +2024,130 @@ void Application::audioRecordingToggle()
     m_audioRecManager->doAudioRecording(!m_audioRecManager->isAudioRecordingActive());
 }
 
+void Application::timeShiftPauseToggle()
+{
+    if (m_ui->isTimeShiftPaused())
+    {
+        emit timeShiftResume();
+    }
+    else
+    {
+        if (m_timeShiftLengthMs > 0)
+        {  // output is muted before FIFO runs out, otherwise pause would be handled as underrun and jitter buffer target increased
+            emit audioMute(true);
+        }
+        emit timeShiftPause();
+    }
+}
+
+void Application::timeShiftSkip(bool forward)
+{
+    emit timeShiftSkipRequest(forward ? TIMESHIFT_SKIP_SEC : -TIMESHIFT_SKIP_SEC);
+}
+
+void Application::timeShiftJumpToLive()
+{
+    emit timeShiftLiveRequest();
+}
+
+void Application::onTimeShiftState(bool isPaused, qint64 delayMs, qint64 availableMs)
+{
+    Q_UNUSED(availableMs)
+
+    if (isPaused != m_timeShiftPaused)
+    {  // output is muted while paused
+        emit audioMute(isPaused || m_ui->isMuted());
+    }
+    m_timeShiftPaused = isPaused;
+    m_timeShiftDelayMs = delayMs;
+    m_timeShiftStateMs = TimeShiftBuffer::timestamp();
+
+    m_ui->isTimeShiftPaused(isPaused);
+    m_ui->isTimeShiftLive(!isPaused && (0 == delayMs));
+    if (m_ui->isTimeShiftLive())
+    {
+        m_timeShiftTimer->stop();
+        m_ui->timeShiftLabel("");
+    }
+    else
+    {
+        m_timeShiftTimer->start();
+    }
+    onTimeShiftTimer();
+}
+
+void Application::onTimeShiftTimer()
+{
+    qint64 now = TimeShiftBuffer::timestamp();
+    qint64 position = m_ui->isTimeShiftLive() ? now : (m_timeShiftPaused ? m_timeShiftStateMs : now) - m_timeShiftDelayMs;
+
+    if (position + 1000 < m_timeShiftReleasedMs)
+    {  // rewind (small steps back are caused by state signalling delay) -> metadata is rebuilt from the oldest event kept
+        onDLReset_Service();
+        onDLReset_Announcement();
+        m_slsBackend[Instance::Service]->reset();
+        m_slsBackend[Instance::Announcement]->reset();
+        m_timeShiftEventIdx = 0;
+    }
+    m_timeShiftReleasedMs = position;
+
+    // release metadata received before current playback position
+    while ((m_timeShiftEventIdx < m_timeShiftEvents.size()) && (m_timeShiftEvents[m_timeShiftEventIdx].timestampMs <= position))
+    {
+        m_timeShiftEvents[m_timeShiftEventIdx++].event();
+    }
+
+    if (!m_ui->isTimeShiftLive())
+    {
+        int delaySec = (now - position) / 1000;
+        m_ui->timeShiftLabel(QString("-%1:%2").arg(delaySec / 60, 2, 10, QChar('0')).arg(delaySec % 60, 2, 10, QChar('0')));
+    }
+}
+
+void Application::timeShifted(std::function<void()> event, qint64 bytes)
+{
+    if (0 == m_timeShiftLengthMs)
+    {  // time shift disabled
+        event();
+        return;
+    }
+
+    qint64 now = TimeShiftBuffer::timestamp();
+    m_timeShiftEvents.push_back({now, bytes, event});
+    m_timeShiftEventBytes += bytes;
+    if (m_ui->isTimeShiftLive() && (m_timeShiftEventIdx + 1 == m_timeShiftEvents.size()))
+    {
+        m_timeShiftReleasedMs = now;
+        m_timeShiftEventIdx += 1;
+        event();
+    }
+
+    // events are dropped together with audio older than buffer length or when metadata budget is exceeded
+    while ((m_timeShiftEvents.size() > 1) &&
+           ((m_timeShiftEvents.front().timestampMs < now - m_timeShiftLengthMs) || (m_timeShiftEventBytes > m_timeShiftEventBudget)))
+    {
+        m_timeShiftEventBytes -= m_timeShiftEvents.front().bytes;
+        m_timeShiftEvents.pop_front();
+        if (m_timeShiftEventIdx > 0)
+        {
+            m_timeShiftEventIdx -= 1;
+        }
+    }
+}
+
+void Application::resetTimeShiftEvents()
+{
+    m_timeShiftEvents.clear();
+    m_timeShiftEventIdx = 0;
+    m_timeShiftEventBytes = 0;
+    m_timeShiftReleasedMs = 0;
+}
+
 void Application::onAudioRecordingStarted()
 {
     m_navigationModel->setEnabled(NavigationModel::AudioRecording, true);
     emit announcementMask(0x0001);  // disable announcements during recording (only alarm is enabled)
+    m_audioRecordingWriterInfo.clear();
     onAudioRecordingProgress(0, 0);
     m_navigationModel->setLabel(NavigationModel::AudioRecording, tr("Stop audio recording"));
 }
@@ -1927,15 +2168,22 @@ void Application::onAudioRecordingProgress(size_t bytes, qint64 timeSec)
         m_ui->audioRecordingProgressLabelToolTip(QString(tr("Audio recording ongoing (%2 kBytes recorded)\n"
                                                             "File: %1"))
                                                      .arg(m_audioRecManager->audioRecordingFile())
-                                                     .arg(bytes >> 10));
+                                                     .arg(bytes >> 10) +
+                                                 m_audioRecordingWriterInfo);
     }
     else
     {  // scheduled recording will start
+        m_audioRecordingWriterInfo.clear();
         m_ui->audioRecordingProgressLabel("0:00");
         m_ui->audioRecordingProgressLabelToolTip(tr("Scheduled audio recording is getting ready"));
     }
 }
 
+void Application::onAudioRecordingStatistics(int queueDepth, int queueCapacity, int maxWriteLatencyMs)
+{
+    m_audioRecordingWriterInfo = QString(tr("\nWrite queue: %1/%2 blocks, max write time: %3 ms")).arg(queueDepth).arg(queueCapacity).arg(maxWriteLatencyMs);
+}
+
 void Application::onAudioRecordingCountdown(int numSec)
 {
     m_navigationModel->setEnabled(NavigationModel::AudioRecording, false);
@@ -2130,7 +2378,7 @@ void Application::onSpiProgressSettingsChanged()
     }
 }
 
-void Application::onSpiProgress(bool isEns, int decoded, int total)
+void Application::onSpiProgress(bool isEns, int decoded, int total, const MOTObjectCache::Statistics &cacheStats)
 {
     int progress = (total > 0) ? static_cast<int>(100.0 * decoded / total) : 0;
 
@@ -2145,6 +2393,12 @@ void Application::onSpiProgress(bool isEns, int decoded, int total)
         {
             tooltip = QString(tr("SPI MOT directory complete\n%1 MOT objects decoded")).arg(total);
         }
+        quint64 lookups = cacheStats.hits + cacheStats.misses;
+        tooltip += QString(tr("\nMOT cache: %1 objects, %2 kB, hit rate %3 %, %4 evictions"))
+                       .arg(cacheStats.objects)
+                       .arg(cacheStats.bytes / 1024)
+                       .arg((lookups > 0) ? (100 * cacheStats.hits / lookups) : 0)
+                       .arg(cacheStats.evictions);
     }
     else
     {  // this happens on decoding start
@@ -2855,7 +3109,8 @@ void Application::configureForInputDevice()
     }
 }
 
-void Application::getAudioSettings(Settings::AudioFramework &framework, Settings::AudioDecoder &decoder)
+void Application::getAudioSettings(Settings::AudioFramework &framework, Settings::AudioDecoder &decoder,
+                                   Settings::AudioLatencyProfile &latencyProfile)
 {
     QSettings *settings;
     if (m_iniFilename.isEmpty())
@@ -2878,6 +3133,9 @@ void Application::getAudioSettings(Settings::AudioFramework &framework, Settings
     val = settings->value("audioDecoderAAC", Settings::AudioDecoder::FAAD).toInt();
     decoder = static_cast<Settings::AudioDecoder>(val);
 
+    val = settings->value("audioLatencyProfile", Settings::AudioLatencyProfile::Balanced).toInt();
+    latencyProfile = static_cast<Settings::AudioLatencyProfile>(qBound(0, val, int(Settings::AudioLatencyProfile::Robust)));
+
     delete settings;
 }
 
@@ -2985,9 +3243,11 @@ void Application::loadSettings()
     m_settings->spiAppEna = settings->value("spiAppEna", true).toBool();
     m_settings->spiProgressEna = settings->value("spiProgressEna", true).toBool();
     m_settings->spiProgressHideComplete = settings->value("spiProgressHideComplete", true).toBool();
+    m_settings->spiCacheBudget = settings->value("spiCacheBudget", 16).toInt();
     m_settings->useInternet = settings->value("useInternet", true).toBool();
     m_settings->radioDnsEna = settings->value("radioDNS", true).toBool();
     m_settings->slsBackground = QColor::fromString(settings->value("slsBg", QString("#000000")).toString());
+    m_settings->slsPrescaleHeight = settings->value("slsPrescaleHeight", 0).toInt();
     m_settings->updateCheckEna = settings->value("updateCheckEna", true).toBool();
     m_settings->updateCheckTime = settings->value("updateCheckTime", QDateTime::currentDateTime().addDays(-1)).value<QDateTime>();
     m_settings->uploadEnsembleInfo = settings->value("uploadEnsembleInfoEna", true).toBool();
@@ -3015,12 +3275,43 @@ void Application::loadSettings()
 #else
     m_settings->audioDecoder = static_cast<Settings::AudioDecoder>(settings->value("audioDecoderAAC", Settings::AudioDecoder::FAAD).toInt());
 #endif
+    m_settings->audioLatencyProfile = static_cast<Settings::AudioLatencyProfile>(
+        qBound(0, settings->value("audioLatencyProfile", Settings::AudioLatencyProfile::Balanced).toInt(), int(Settings::AudioLatencyProfile::Robust)));
 
     m_settings->audioRec.captureOutput = settings->value("AudioRecording/captureOutput", false).toBool();
+    m_settings->audioRec.flacLevel = settings->value("AudioRecording/flacLevel", -1).toInt();
     m_settings->audioRec.autoStopEna = settings->value("AudioRecording/autoStop", false).toBool();
     m_settings->audioRec.dl = settings->value("AudioRecording/DL", false).toBool();
     m_settings->audioRec.dlAbsTime = settings->value("AudioRecording/DLAbsTime", false).toBool();
 
+    m_settings->timeShift.length = settings->value("TimeShift/length", 30).toInt();
+    m_settings->timeShift.ramBudget = settings->value("TimeShift/ramBudget", 32).toInt();
+
+    m_settings->imageCache.memoryBudget = settings->value("ImageCache/memoryBudget", IMAGECACHE_MEMORY_BUDGET).toInt();
+    m_settings->imageCache.diskBudget = settings->value("ImageCache/diskBudget", 0).toInt();
+    ImageCache::getInstance()->setMemoryBudget(m_settings->imageCache.memoryBudget);
+    ImageCache::getInstance()->setDiskBudget(m_settings->imageCache.diskBudget);
+
+    m_settings->metadataCache.maxAge = settings->value("MetadataCache/maxAge", METADATACACHEINDEX_MAX_AGE).toInt();
+    m_settings->metadataCache.diskBudget = settings->value("MetadataCache/diskBudget", METADATACACHEINDEX_DISK_BUDGET).toInt();
+    m_metadataManager->setCacheLimits(m_settings->metadataCache.maxAge, m_settings->metadataCache.diskBudget);
+
+    for (int r = 0; r < ThreadPlacement::NumRoles; ++r)
+    {
+        ThreadPlacement::Role role = ThreadPlacement::Role(r);
+        QString key = QString("Threads/%1").arg(ThreadPlacement::roleName(role));
+        ThreadPlacement::Config &threadConfig = m_settings->threads.config[r];
+        bool ok = true;
+        threadConfig.cpus = ThreadPlacement::parseCpuList(settings->value(key + "Cpus", "").toString(), &ok);
+        if (!ok)
+        {
+            qCWarning(application) << "Invalid CPU list:" << key + "Cpus";
+        }
+        threadConfig.nice = qBound(-20, settings->value(key + "Nice", 0).toInt(), 19);
+        threadConfig.rtPriority = qBound(0, settings->value(key + "RtPriority", 0).toInt(), 99);
+        ThreadPlacement::getInstance()->setConfig(role, threadConfig);
+    }
+
 #ifdef Q_OS_MAC
     m_settings->trayIconEna = settings->value("showTrayIcon", false).toBool();
 #else
@@ -3326,6 +3617,7 @@ void Application::saveSettings()
     }
     settings->setValue("audioFramework", m_settings->audioFramework);
     settings->setValue("audioDecoderAAC", m_settings->audioDecoder);
+    settings->setValue("audioLatencyProfile", m_settings->audioLatencyProfile);
     settings->setValue("volume", m_ui->audioVolume());
     settings->setValue("mute", m_ui->isMuted());
     settings->setValue("keepServiceListOnScan", m_settings->keepServiceListOnScan);
@@ -3339,9 +3631,11 @@ void Application::saveSettings()
     settings->setValue("spiAppEna", m_settings->spiAppEna);
     settings->setValue("spiProgressEna", m_settings->spiProgressEna);
     settings->setValue("spiProgressHideComplete", m_settings->spiProgressHideComplete);
+    settings->setValue("spiCacheBudget", m_settings->spiCacheBudget);
     settings->setValue("useInternet", m_settings->useInternet);
     settings->setValue("radioDNS", m_settings->radioDnsEna);
     settings->setValue("slsBg", m_settings->slsBackground.name(QColor::HexArgb));
+    settings->setValue("slsPrescaleHeight", m_settings->slsPrescaleHeight);
     settings->setValue("updateCheckEna", m_settings->updateCheckEna);
     settings->setValue("updateCheckTime", m_settings->updateCheckTime);
     settings->setValue("uploadEnsembleInfoEna", m_settings->uploadEnsembleInfo);
@@ -3364,10 +3658,29 @@ void Application::saveSettings()
     settings->setValue("AppWindow/fullscreen", m_settings->appWindow.fullscreen);
 
     settings->setValue("AudioRecording/captureOutput", m_settings->audioRec.captureOutput);
+    settings->setValue("AudioRecording/flacLevel", m_settings->audioRec.flacLevel);
     settings->setValue("AudioRecording/autoStop", m_settings->audioRec.autoStopEna);
     settings->setValue("AudioRecording/DL", m_settings->audioRec.dl);
     settings->setValue("AudioRecording/DLAbsTime", m_settings->audioRec.dlAbsTime);
 
+    settings->setValue("TimeShift/length", m_settings->timeShift.length);
+    settings->setValue("TimeShift/ramBudget", m_settings->timeShift.ramBudget);
+
+    settings->setValue("ImageCache/memoryBudget", m_settings->imageCache.memoryBudget);
+    settings->setValue("ImageCache/diskBudget", m_settings->imageCache.diskBudget);
+
+    settings->setValue("MetadataCache/maxAge", m_settings->metadataCache.maxAge);
+    settings->setValue("MetadataCache/diskBudget", m_settings->metadataCache.diskBudget);
+
+    for (int r = 0; r < ThreadPlacement::NumRoles; ++r)
+    {
+        QString key = QString("Threads/%1").arg(ThreadPlacement::roleName(ThreadPlacement::Role(r)));
+        const ThreadPlacement::Config &threadConfig = m_settings->threads.config[r];
+        settings->setValue(key + "Cpus", ThreadPlacement::cpuListToString(threadConfig.cpus));
+        settings->setValue(key + "Nice", threadConfig.nice);
+        settings->setValue(key + "RtPriority", threadConfig.rtPriority);
+    }
+
     settings->setValue("EPG/filterEmpty", m_settings->epg.filterEmptyEpg);
     settings->setValue("EPG/filterOtherEnsembles", m_settings->epg.filterEnsemble);
     settings->setValue("EPG/layout", m_settings->epg.splitterState);
@@ -3641,7 +3954,7 @@ void Application::onAudioVolumeChanged()
 void Application::onMuteButtonToggled(bool doMute)
 {
     m_ui->isMuted(doMute);
-    emit audioMute(doMute);
+    emit audioMute(doMute || m_timeShiftPaused);
 }
 
 void Application::copyDlToClipboard()
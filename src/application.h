@@ -58,6 +58,7 @@
 #include "radiocontrol.h"
 #include "scannerbackend.h"
 #include "servicelist.h"
+#include "servicestreamrecorder.h"
 #include "settingsbackend.h"
 #include "signalbackend.h"
 #include "slideshowapp.h"
@@ -65,6 +66,7 @@
 #include "sltreemodel.h"
 #include "spiapp.h"
 #include "tiibackend.h"
+#include "timeshiftbuffer.h"
 #include "uicontrolprovider.h"
 
 class ApplicationUI : public UIControlProvider
@@ -199,6 +201,11 @@ public:
     UI_PROPERTY_DEFAULT(bool, isMuted, false);
     UI_PROPERTY_DEFAULT(int, audioVolume, 100);
 
+    UI_PROPERTY_DEFAULT(bool, isTimeShiftEnabled, false);
+    UI_PROPERTY_DEFAULT(bool, isTimeShiftPaused, false);
+    UI_PROPERTY_DEFAULT(bool, isTimeShiftLive, true);
+    UI_PROPERTY(QString, timeShiftLabel)
+
     UI_PROPERTY_DEFAULT(bool, isSpiProgressServiceVisible, false);
     UI_PROPERTY_DEFAULT(bool, isSpiProgressEnsVisible, false);
     UI_PROPERTY_DEFAULT(int, spiProgressService, -1);
@@ -280,6 +287,9 @@ public:
     Q_INVOKABLE void copyDlToClipboard();
     Q_INVOKABLE void copyDlPlusToClipboard();
     Q_INVOKABLE void audioRecordingToggle();
+    Q_INVOKABLE void timeShiftPauseToggle();
+    Q_INVOKABLE void timeShiftSkip(bool forward);
+    Q_INVOKABLE void timeShiftJumpToLive();
     Q_INVOKABLE void exportServiceList();
     Q_INVOKABLE void clearServiceList();
     Q_INVOKABLE QObject *createBackend(int id);
@@ -314,6 +324,10 @@ signals:
     void audioVolume(int volume);
     void audioOutput(const QByteArray &deviceId);
     void audioStop();
+    void timeShiftPause();
+    void timeShiftResume();
+    void timeShiftSkipRequest(int seconds);
+    void timeShiftLiveRequest();
     void announcementMask(uint16_t mask);
     void exit();
     void startBandScan();
@@ -389,13 +403,35 @@ private:
     InputDevice::Id m_inputDeviceRequest = InputDevice::Id::UNDEFINED;
     QVariant m_inputDeviceIdRequest;
     InputDeviceRecorder *m_inputDeviceRecorder = nullptr;
+    ServiceStreamRecorder *m_serviceStreamRecorder = nullptr;
 
     // audio decoder
     QThread *m_audioDecoderThread;
     AudioDecoder *m_audioDecoder;
 
+    // time shift, metadata (DL, slides) is delayed together with audio
+    TimeShiftBuffer *m_timeShiftBuffer;
+    bool m_timeShiftPaused = false;
+    qint64 m_timeShiftDelayMs = 0;
+    qint64 m_timeShiftStateMs = 0;
+    qint64 m_timeShiftLengthMs = 0;
+    struct TimeShiftEvent
+    {
+        qint64 timestampMs;
+        qint64 bytes;
+        std::function<void()> event;
+    };
+    // events within time shift buffer length are kept to be replayed after rewind
+    std::deque<TimeShiftEvent> m_timeShiftEvents;
+    size_t m_timeShiftEventIdx = 0;  // first event not released yet
+    qint64 m_timeShiftEventBytes = 0;
+    qint64 m_timeShiftEventBudget = 0;
+    qint64 m_timeShiftReleasedMs = 0;  // playback position of last release
+    QTimer *m_timeShiftTimer = nullptr;
+
     // Audio recording
     AudioRecManager *m_audioRecManager;
+    QString m_audioRecordingWriterInfo;
     AudioRecScheduleModel *m_audioRecScheduleModel;
 
     // audio output
@@ -437,13 +473,14 @@ private:
     // user applications
     DLDecoder *m_dlDecoder[Instance::NumInstances];
     SlideShowApp *m_slideShowApp[Instance::NumInstances];
+    QThread *m_spiThread;
     SPIApp *m_spiApp;
     MetadataManager *m_metadataManager;
 
     // methods
     void loadSettings();
     void saveSettings();
-    void getAudioSettings(Settings::AudioFramework &framework, Settings::AudioDecoder &decoder);
+    void getAudioSettings(Settings::AudioFramework &framework, Settings::AudioDecoder &decoder, Settings::AudioLatencyProfile &latencyProfile);
     void restoreWindows();
 
     QObject *createTiiBackend();
@@ -513,11 +550,16 @@ private:
     void onAudioRecordingStarted();
     void onAudioRecordingStopped();
     void onAudioRecordingProgress(size_t bytes, qint64 timeSec);
+    void onAudioRecordingStatistics(int queueDepth, int queueCapacity, int maxWriteLatencyMs);
     void onAudioRecordingCountdown(int numSec);
+    void onTimeShiftState(bool isPaused, qint64 delayMs, qint64 availableMs);
+    void onTimeShiftTimer();
+    void timeShifted(std::function<void()> event, qint64 bytes = 0);
+    void resetTimeShiftEvents();
     void onMetadataUpdated(const ServiceListId &id, MetadataManager::MetadataRole role);
     void onEpgEmpty();
     void onSpiProgressSettingsChanged();
-    void onSpiProgress(bool isEns, int decoded, int total);
+    void onSpiProgress(bool isEns, int decoded, int total, const MOTObjectCache::Statistics &cacheStats = MOTObjectCache::Statistics());
     void setProxy();
     void checkForUpdate();
     void pageUndocked(int id, bool isUndocked);
@@ -0,0 +1,262 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "audioconcealment.h"
+
+#include <algorithm>
+#include <cmath>
+
+// noise table size, must be power of 2
+#define AUDIO_CONCEALMENT_NOISE_TABLE_SIZE (1 << 16)
+// bandwidth expansion of LPC synthesis filter, makes spectral envelope smoother and filter stable
+#define AUDIO_CONCEALMENT_LPC_GAMMA (0.94)
+// autocorrelation smoothing across frames
+#define AUDIO_CONCEALMENT_ANALYSIS_ALPHA (0.3)
+// initial buffer size in samples, enough for HE-AAC and MP2 stereo frames
+#define AUDIO_CONCEALMENT_BUFFER_SIZE (4096)
+// LPC model works in int16 scale independently of pipeline sample type
+#define AUDIO_CONCEALMENT_INPUT_SCALE (32768.0f / AUDIO_SAMPLE_FULL_SCALE)
+
+AudioConcealment::AudioConcealment()
+{
+    init(48000, 2);
+}
+
+void AudioConcealment::init(uint32_t sampleRate, int numChannels)
+{
+    m_numChannels = numChannels;
+    m_isConcealing = false;
+
+    // default envelope is low pass 1st order (similar to pink noise)
+    std::fill(m_autoCorr, m_autoCorr + AUDIO_CONCEALMENT_LPC_ORDER + 1, 0.0);
+    std::fill(m_lpc, m_lpc + AUDIO_CONCEALMENT_LPC_ORDER, 0.0f);
+    m_lpc[0] = -0.8;
+    m_isLpcValid = true;
+    m_filterState.assign(numChannels * AUDIO_CONCEALMENT_LPC_ORDER, 0.0f);
+
+    m_shaped.resize(AUDIO_CONCEALMENT_BUFFER_SIZE);
+    m_noise.resize(AUDIO_CONCEALMENT_BUFFER_SIZE);
+
+    // ramps are sin^2 (0 -> 1) and cos^2 (1 -> 0)
+    size_t numFrames = AUDIO_CONCEALMENT_FADE_MS * sampleRate / 1000;
+    m_rampUp.resize(numFrames);
+    m_rampDown.resize(numFrames);
+    float coe = M_PI / (2.0 * numFrames);
+    for (size_t n = 0; n < numFrames; ++n)
+    {
+        float g = sinf(n * coe);
+        m_rampUp[n] = g * g;
+        m_rampDown[n] = 1.0f - g * g;
+    }
+}
+
+const std::vector<float> &AudioConcealment::noiseTable()
+{
+    // unit variance, approximately gaussian noise generated once (sum of 4 uniform random numbers)
+    static const std::vector<float> table = []()
+    {
+        std::vector<float> t(AUDIO_CONCEALMENT_NOISE_TABLE_SIZE);
+        uint32_t x = 0x12345678;
+        for (auto &v : t)
+        {
+            float sum = 0.0;
+            for (int k = 0; k < 4; ++k)
+            {  // xorshift32
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                sum += x * (1.0f / 4294967296.0f) - 0.5f;
+            }
+            v = sum * std::sqrt(3.0f);  // variance of uniform(-0.5, 0.5) is 1/12
+        }
+        return t;
+    }();
+    return table;
+}
+
+void AudioConcealment::analyze(const audioSample_t *data, size_t numSamples)
+{
+    size_t numFrames = numSamples / m_numChannels;
+    if (numFrames <= AUDIO_CONCEALMENT_LPC_ORDER)
+    {
+        return;
+    }
+    if (m_shaped.size() < numFrames)
+    {
+        m_shaped.resize(numFrames);
+    }
+
+    // envelope is estimated from mono downmix
+    float *x = m_shaped.data();
+    for (size_t n = 0; n < numFrames; ++n)
+    {
+        float sum = 0.0;
+        for (int c = 0; c < m_numChannels; ++c)
+        {
+            sum += data[n * m_numChannels + c];
+        }
+        x[n] = sum * AUDIO_CONCEALMENT_INPUT_SCALE / m_numChannels;
+    }
+
+    for (int k = 0; k <= AUDIO_CONCEALMENT_LPC_ORDER; ++k)
+    {
+        double r = 0.0;
+        for (size_t n = k; n < numFrames; ++n)
+        {
+            r += x[n] * x[n - k];
+        }
+        m_autoCorr[k] += AUDIO_CONCEALMENT_ANALYSIS_ALPHA * (r / numFrames - m_autoCorr[k]);
+    }
+    m_isLpcValid = false;
+}
+
+void AudioConcealment::updateLpc()
+{
+    m_isLpcValid = true;
+    if (m_autoCorr[0] < 1.0)
+    {  // silence -> keep previous envelope
+        return;
+    }
+
+    // Levinson-Durbin recursion, small white noise correction improves conditioning
+    double r[AUDIO_CONCEALMENT_LPC_ORDER + 1];
+    std::copy(m_autoCorr, m_autoCorr + AUDIO_CONCEALMENT_LPC_ORDER + 1, r);
+    r[0] *= 1.0001;
+
+    double a[AUDIO_CONCEALMENT_LPC_ORDER + 1] = {1.0};
+    double tmp[AUDIO_CONCEALMENT_LPC_ORDER + 1];
+    double err = r[0];
+    for (int i = 1; i <= AUDIO_CONCEALMENT_LPC_ORDER; ++i)
+    {
+        double acc = r[i];
+        for (int j = 1; j < i; ++j)
+        {
+            acc += a[j] * r[i - j];
+        }
+        double k = -acc / err;
+        std::copy(a, a + i, tmp);
+        for (int j = 1; j < i; ++j)
+        {
+            a[j] = tmp[j] + k * tmp[i - j];
+        }
+        a[i] = k;
+        err *= (1.0 - k * k);
+        if (err <= 0.0)
+        {  // numerical problem -> keep previous envelope
+            return;
+        }
+    }
+
+    double g = AUDIO_CONCEALMENT_LPC_GAMMA;
+    for (int i = 0; i < AUDIO_CONCEALMENT_LPC_ORDER; ++i)
+    {
+        m_lpc[i] = a[i + 1] * g;
+        g *= AUDIO_CONCEALMENT_LPC_GAMMA;
+    }
+}
+
+void AudioConcealment::generate(audioSample_t *out, size_t numSamples)
+{
+    if (!m_isLpcValid)
+    {
+        updateLpc();
+    }
+    if (m_shaped.size() < numSamples)
+    {
+        m_shaped.resize(numSamples);
+    }
+
+    const std::vector<float> &table = noiseTable();
+    const uint32_t mask = AUDIO_CONCEALMENT_NOISE_TABLE_SIZE - 1;
+    const uint32_t channelOffset = AUDIO_CONCEALMENT_NOISE_TABLE_SIZE / m_numChannels;  // decorrelated channels
+
+    size_t numFrames = numSamples / m_numChannels;
+    double energy = 0.0;
+    float *y = m_shaped.data();
+    for (size_t n = 0; n < numFrames; ++n)
+    {
+        for (int c = 0; c < m_numChannels; ++c)
+        {  // all-pole synthesis filter 1/A(z), state holds past outputs, newest first
+            float *state = &m_filterState[c * AUDIO_CONCEALMENT_LPC_ORDER];
+            float v = table[(m_noiseIdx + c * channelOffset) & mask];
+            for (int i = 0; i < AUDIO_CONCEALMENT_LPC_ORDER; ++i)
+            {
+                v -= m_lpc[i] * state[i];
+            }
+            for (int i = AUDIO_CONCEALMENT_LPC_ORDER - 1; i > 0; --i)
+            {
+                state[i] = state[i - 1];
+            }
+            state[0] = v;
+            *y++ = v;
+            energy += v * v;
+        }
+        m_noiseIdx = (m_noiseIdx + 1) & mask;
+    }
+
+    // normalize output to constant RMS, envelope defines only spectral shape
+    size_t num = numFrames * m_numChannels;
+    float scale = (energy > 0.0) ? AUDIO_CONCEALMENT_NOISE_RMS / AUDIO_CONCEALMENT_INPUT_SCALE / std::sqrt(energy / num) : 0.0;
+    for (size_t n = 0; n < num; ++n)
+    {
+        out[n] = AudioDsp::toSample(scale * m_shaped[n]);
+    }
+}
+
+void AudioConcealment::process(audioSample_t *data, size_t numSamples, bool isValid)
+{
+    if (isValid && !m_isConcealing)
+    {  // nothing to conceal
+        analyze(data, numSamples);
+        return;
+    }
+
+    if (m_noise.size() < numSamples)
+    {
+        m_noise.resize(numSamples);
+    }
+    generate(m_noise.data(), numSamples);
+
+    size_t numFrames = numSamples / m_numChannels;
+    size_t fadeFrames = std::min(numFrames, m_rampUp.size());
+    if (isValid)
+    {  // recovery: audio is faded in, noise is faded out
+        analyze(data, numSamples);
+        AudioDsp::tableRampNoiseMix(data, m_rampUp.data(), m_noise.data(), m_level, fadeFrames, m_numChannels, false);
+        m_isConcealing = false;
+    }
+    else if (!m_isConcealing)
+    {  // first frame with error: decoder output is faded out, noise is faded in
+        AudioDsp::tableRampNoiseMix(data, m_rampDown.data(), m_noise.data(), m_level, fadeFrames, m_numChannels, false);
+        AudioDsp::gain(data + fadeFrames * m_numChannels, m_noise.data() + fadeFrames * m_numChannels, (numFrames - fadeFrames) * m_numChannels,
+                       m_level);
+        m_isConcealing = true;
+    }
+    else
+    {  // error continues
+        AudioDsp::gain(data, m_noise.data(), numSamples, m_level);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AUDIOCONCEALMENT_H
+#define AUDIOCONCEALMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "audiodsp.h"
+
+#define AUDIO_CONCEALMENT_FADE_MS 20     // crossfade between audio and concealment noise
+#define AUDIO_CONCEALMENT_LPC_ORDER 8    // order of spectral envelope model
+#define AUDIO_CONCEALMENT_NOISE_RMS 3560 // RMS of concealment noise at level 1.0 (0 dB) in int16 scale
+
+// Concealment of audio frames with decoding errors by spectrally shaped noise
+// Spectral envelope of the programme is estimated by linear prediction from good frames,
+// concealment noise is white noise from precomputed table filtered by LPC synthesis filter.
+// No memory is allocated and no I/O is done during processing, all methods are called from decoder thread.
+class AudioConcealment
+{
+public:
+    AudioConcealment();
+
+    // resets state and sets stream parameters
+    void init(uint32_t sampleRate, int numChannels);
+
+    // linear level of concealment noise, 0 means that errors are concealed by silence
+    void setLevel(float level) { m_level = level; }
+    float level() const { return m_level; }
+
+    // updates spectral envelope estimate from good (interleaved) samples
+    void analyze(const audioSample_t *data, size_t numSamples);
+
+    // generates shaped noise at level 1.0 (caller applies level)
+    void generate(audioSample_t *out, size_t numSamples);
+
+    // complete concealment stage for decoders without own error handling:
+    // frame with error is replaced by noise, transitions between audio and noise are crossfaded
+    void process(audioSample_t *data, size_t numSamples, bool isValid);
+
+    bool isConcealing() const { return m_isConcealing; }
+
+private:
+    int m_numChannels = 0;
+    float m_level = 0.0;
+    bool m_isConcealing = false;
+
+    // LPC model
+    double m_autoCorr[AUDIO_CONCEALMENT_LPC_ORDER + 1];
+    float m_lpc[AUDIO_CONCEALMENT_LPC_ORDER];
+    bool m_isLpcValid = false;
+    std::vector<float> m_filterState;  // numChannels * AUDIO_CONCEALMENT_LPC_ORDER past outputs
+
+    uint32_t m_noiseIdx = 0;
+    std::vector<float> m_shaped;  // working buffer
+    std::vector<audioSample_t> m_noise;
+    std::vector<float> m_rampUp;
+    std::vector<float> m_rampDown;
+
+    void updateLpc();
+    static const std::vector<float> &noiseTable();
+};
+
+#endif  // AUDIOCONCEALMENT_H
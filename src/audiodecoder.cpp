@@ -33,8 +33,17 @@
 #include <QLoggingCategory>
 #include <QStandardPaths>
 
+#include "audiodsp.h"
+
 Q_LOGGING_CATEGORY(audioDecoder, "AudioDecoder", QtDebugMsg)
 
+// mpg123 output encoding matching audioSample_t, float output is normalized to [-1.0, 1.0)
+#if USE_FLOAT_AUDIO
+#define AUDIO_DECODER_MPG123_ENC MPG123_ENC_FLOAT_32
+#else
+#define AUDIO_DECODER_MPG123_ENC MPG123_ENC_SIGNED_16
+#endif
+
 audioFifo_t audioFifo[2];
 
 AudioDecoder::AudioDecoder(AudioRecorder *recorder, QObject *parent) : QObject(parent)
@@ -42,7 +51,7 @@ AudioDecoder::AudioDecoder(AudioRecorder *recorder, QObject *parent) : QObject(p
     m_outFifoIdx = 0;
     m_outFifoPtr = &audioFifo[m_outFifoIdx];
 
-    m_outBufferPtr = new int16_t[AUDIO_DECODER_BUFFER_SIZE];
+    m_outBufferPtr = new audioSample_t[AUDIO_DECODER_BUFFER_SIZE];
 
     m_mp2DecoderHandle = nullptr;
     m_playbackState = PlaybackState::Stopped;
@@ -105,20 +114,53 @@ void AudioDecoder::start(const RadioControlServiceComponent &s)
 
 void AudioDecoder::stop()
 {
+    if (PlaybackState::Running == m_playbackState)
+    {  // delayed output is played before stop
+        flushDelayLine(m_delayCount);
+    }
     m_playbackState = PlaybackState::Stopped;
     m_recorder->stop();
 
     deinitAACDecoder();
     deinitMPG123();
 
+    if (nullptr != m_standby)
+    {
+        m_standby->deinitAACDecoder();
+        m_standby->deinitMPG123();
+    }
+    m_onAir = this;
+    m_onAirRequest = nullptr;
+    m_delayStart = 0;
+    m_delayCount = 0;
+    m_offAirIdleSamples = SIZE_MAX;
+    m_fadeOutSamples.clear();
+
     emit stopAudio();
 }
 
+void AudioDecoder::setStandbyDecoder(AudioDecoder *decoder)
+{
+    Q_ASSERT(nullptr == m_standby);
+
+    decoder->setParent(this);
+    decoder->m_controller = this;
+    m_standby = decoder;
+}
+
+void AudioDecoder::setNoiseConcealment(int level)
+{  // level is in dB below reference noise level, 0 means concealment by silence
+    m_concealment.setLevel((level > 0) ? pow(10, -1.0 * level / 20) : 0.0);
+}
+
 void AudioDecoder::initMPG123()
 {
     deinitMPG123();
     deinitAACDecoder();
 
+    // format is known after first frame is decoded
+    m_mp2HasOutput = false;
+
     int res = mpg123_init();
     if (MPG123_OK != res)
     {
@@ -138,13 +180,13 @@ void AudioDecoder::initMPG123()
         throw std::runtime_error(std::string(Q_FUNC_INFO) + ": error while mpg123_format_none: " + std::string(mpg123_plain_strerror(res)));
     }
 
-    res = mpg123_format(m_mp2DecoderHandle, 48000, MPG123_STEREO, MPG123_ENC_SIGNED_16);
+    res = mpg123_format(m_mp2DecoderHandle, 48000, MPG123_STEREO, AUDIO_DECODER_MPG123_ENC);
     if (MPG123_OK != res)
     {
         throw std::runtime_error(std::string(Q_FUNC_INFO) + ": error while mpg123_format for 48KHz: " + std::string(mpg123_plain_strerror(res)));
     }
 
-    res = mpg123_format(m_mp2DecoderHandle, 24000, MPG123_STEREO, MPG123_ENC_SIGNED_16);
+    res = mpg123_format(m_mp2DecoderHandle, 24000, MPG123_STEREO, AUDIO_DECODER_MPG123_ENC);
     if (MPG123_OK != res)
     {
         throw std::runtime_error(std::string(Q_FUNC_INFO) + ": error while mpg123_format for 24KHz: " + std::string(mpg123_plain_strerror(res)));
@@ -182,12 +224,37 @@ void AudioDecoder::deinitMPG123()
 
 void AudioDecoder::decodeData(RadioControlAudioData *inData)
 {
-    if (PlaybackState::Stopped == m_playbackState)
-    {                   // do nothing if not running
+    if ((PlaybackState::Stopped == m_playbackState) || ((nullptr == m_standby) && !inData->onAir))
+    {                   // do nothing if not running or if there is no decoder to keep the stream ready
         delete inData;  // free input buffer
         return;
     }
 
+    AudioDecoder *decoder = this;
+    if ((nullptr != m_standby) && (DABSDR_ID_AUDIO_SECONDARY == inData->id))
+    {  // announcement stream is decoded by standby decoder
+        decoder = m_standby;
+    }
+    if (inData->onAir)
+    {  // switch is done when decoder delivers output, until then current stream continues
+        m_onAirRequest = (decoder != m_onAir) ? decoder : nullptr;
+    }
+
+    decoder->decodeFrame(inData);
+
+    if (decoder == m_onAir)
+    {
+        m_recorder->recordData(inData, decoder->m_outBufferPtr, decoder->m_outputBufferSamples);
+    }
+
+    LatencyTracer::getInstance()->record(LatencyTracer::AudioDecoder, inData->timestampNs);
+
+    // free input data
+    delete inData;
+}
+
+void AudioDecoder::decodeFrame(RadioControlAudioData *inData)
+{
     switch (inData->ASCTy)
     {
         case DabAudioDataSCty::DAB_AUDIO:
@@ -200,14 +267,14 @@ void AudioDecoder::decodeData(RadioControlAudioData *inData)
 
         default:;  // do nothing
     }
-
-    m_recorder->recordData(inData, m_outBufferPtr, m_outputBufferSamples);
-
-    // free input data
-    delete inData;
 }
 
 void AudioDecoder::getAudioParameters()
+{
+    m_onAir->updateAudioParameters();
+}
+
+void AudioDecoder::updateAudioParameters()
 {
     if (isAACHandleValid())
     {
@@ -231,6 +298,7 @@ void AudioDecoder::processMP2(RadioControlAudioData *inData)
         initMPG123();
     }
 
+    bool isValid = false;
     if (inData->data.size() > 0)
     {
         // [ETSI TS 103 466 V1.2.1 (2019-09)]
@@ -242,7 +310,7 @@ void AudioDecoder::processMP2(RadioControlAudioData *inData)
         /* Feed input chunk and get first chunk of decoded audio. */
         size_t size;
         int ret = mpg123_decode(m_mp2DecoderHandle, &inData->data[0], inData->data.size(), m_outBufferPtr,
-                                AUDIO_DECODER_BUFFER_SIZE * sizeof(int16_t), &size);
+                                AUDIO_DECODER_BUFFER_SIZE * sizeof(audioSample_t), &size);
         if ((MPG123_NEW_FORMAT == ret) || (inData->id != m_inputDataDecoderId))
         {  // this is stream reconfiguration or announcement (different instance)
             long sampleRate;
@@ -262,17 +330,18 @@ void AudioDecoder::processMP2(RadioControlAudioData *inData)
 
             m_inputDataDecoderId = inData->id;
             m_mp2DRC = 0;
+            m_mp2HasOutput = false;
         }
 
-        m_outputBufferSamples = size / sizeof(int16_t);
+        m_outputBufferSamples = size / sizeof(audioSample_t);
 
         // there should be nothing more to decode, but try to be sure
         while (ret != MPG123_ERR && ret != MPG123_NEED_MORE)
         {  // Get all decoded audio that is available now before feeding more input
             ret = mpg123_decode(m_mp2DecoderHandle, NULL, 0, m_outBufferPtr + m_outputBufferSamples,
-                                (AUDIO_DECODER_BUFFER_SIZE - m_outputBufferSamples) * sizeof(int16_t), &size);
+                                (AUDIO_DECODER_BUFFER_SIZE - m_outputBufferSamples) * sizeof(audioSample_t), &size);
 
-            m_outputBufferSamples += size / sizeof(int16_t);
+            m_outputBufferSamples += size / sizeof(audioSample_t);
 
             if ((0 == size) || (m_outputBufferSamples >= AUDIO_DECODER_BUFFER_SIZE))
             {
@@ -284,46 +353,33 @@ void AudioDecoder::processMP2(RadioControlAudioData *inData)
 
 #if MP2_DRC_ENABLE
         if (m_mp2DRC != 0)
-        {                                                    // multiply buffer by gain
-            float gain = pow(10, m_mp2DRC * 0.0125);         // 0.0125 = 1/(4*20)
-            for (int n = 0; n < m_outputBufferSamples; ++n)  // considering int16_t data => 2 bytes
-            {                                                // multiply all samples by gain
-                m_outBufferPtr[n] = int16_t(qRound(m_outBufferPtr[n] * gain));
-            }
+        {  // multiply all samples by gain
+            float gain = powf(10, m_mp2DRC * 0.0125);  // 0.0125 = 1/(4*20)
+            AudioDsp::gain(m_outBufferPtr, m_outputBufferSamples, gain);
         }
 #endif  // MP2_DRC_ENABLE
 
-        int64_t bytesToWrite = m_outputBufferSamples * sizeof(int16_t);
-
-        // wait for space in ouput buffer
-        m_outFifoPtr->mutex.lock();
-        uint64_t count = m_outFifoPtr->count;
-        while (int64_t(AUDIO_FIFO_SIZE - count) < bytesToWrite)
-        {
-            m_outFifoPtr->countChanged.wait(&m_outFifoPtr->mutex);
-            count = m_outFifoPtr->count;
-        }
-        m_outFifoPtr->mutex.unlock();
-
-        int64_t bytesToEnd = AUDIO_FIFO_SIZE - m_outFifoPtr->head;
-        if (bytesToEnd < bytesToWrite)
-        {
-            memcpy(m_outFifoPtr->buffer + m_outFifoPtr->head, m_outBufferPtr, bytesToEnd);
-            memcpy(m_outFifoPtr->buffer, reinterpret_cast<uint8_t *>(m_outBufferPtr) + bytesToEnd, bytesToWrite - bytesToEnd);
-            m_outFifoPtr->head = bytesToWrite - bytesToEnd;
-        }
-        else
-        {
-            memcpy(m_outFifoPtr->buffer + m_outFifoPtr->head, m_outBufferPtr, bytesToWrite);
-            m_outFifoPtr->head += bytesToWrite;
-        }
-
-        m_outFifoPtr->mutex.lock();
-        m_outFifoPtr->count += bytesToWrite;
-        m_outFifoPtr->mutex.unlock();
+        isValid = (m_outputBufferSamples > 0);
     }
     // store DRC for next frame
     m_mp2DRC = inData->header.mp2DRC;
+
+    if (isValid)
+    {
+        m_mp2HasOutput = true;
+    }
+    else if (m_mp2HasOutput)
+    {  // frame was lost or could not be decoded => replaced by concealment frame
+        m_outputBufferSamples = MP2_FRAME_PCM_SAMPLES / 2 * m_streamNumChannels;
+        memset(m_outBufferPtr, 0, m_outputBufferSamples * sizeof(audioSample_t));
+    }
+    else
+    {  // nothing to output
+        return;
+    }
+
+    m_concealment.process(m_outBufferPtr, m_outputBufferSamples, isValid);
+    writeOutput(m_outBufferPtr, m_outputBufferSamples);
 }
 
 void AudioDecoder::getFormatMP2()
@@ -363,12 +419,214 @@ void AudioDecoder::getFormatMP2()
     }
 
     m_audioParameters.sampleRateKHz = info.rate / 1000;
-    m_recorder->setDataFormat(m_audioParameters.sampleRateKHz, false);
-    emit audioParametersInfo(m_audioParameters);
+    if (isOnAir())
+    {
+        m_recorder->setDataFormat(m_audioParameters.sampleRateKHz, false);
+    }
+    publishAudioParameters(m_audioParameters);
 }
 
 void AudioDecoder::setOutput(int sampleRate, int numChannels)
 {
+    m_streamSampleRate = sampleRate;
+    m_streamNumChannels = numChannels;
+    m_concealment.init(sampleRate, numChannels);
+
+    if (isOnAir())
+    {
+        m_controller->switchFifo(sampleRate, numChannels);
+    }
+    else
+    { /* standby stream format is applied when it goes on air */
+    }
+}
+
+void AudioDecoder::writeOutput(audioSample_t *samples, size_t numSamples)
+{
+    m_controller->routeOutput(this, samples, numSamples);
+}
+
+void AudioDecoder::publishAudioParameters(const AudioParameters &params)
+{  // only stream on air is signalled to HMI
+    if (isOnAir())
+    {
+        emit m_controller->audioParametersInfo(params);
+    }
+}
+
+void AudioDecoder::switchOnAir(AudioDecoder *decoder)
+{
+    m_onAir = decoder;
+    m_onAirRequest = nullptr;
+
+    // recording does not continue across announcement switching
+    m_recorder->stop();
+
+    qCInfo(audioDecoder) << "Switching audio to" << ((decoder == this) ? "primary" : "announcement") << "stream";
+
+    if ((PlaybackState::Running == m_playbackState) && (uint32_t(decoder->m_streamSampleRate) == m_outFifoPtr->sampleRate) &&
+        (decoder->m_streamNumChannels == m_outFifoPtr->numChannels))
+    {  // same format => delayed tail of previous stream is crossfaded with new stream in current output FIFO
+        size_t numFrames = m_delayCount / m_outFifoPtr->numChannels;
+        if (numFrames > 0)
+        {
+            if (m_crossfadeRamp.size() != numFrames)
+            {  // ramp is sin^2 that changes from 0 to 1, previous stream is faded out with 1 - ramp
+                m_crossfadeRamp.clear();
+                float coe = M_PI / (2.0 * numFrames);
+                for (size_t n = 0; n < numFrames; ++n)
+                {
+                    float g = sinf(n * coe);
+                    m_crossfadeRamp.push_back(g * g);
+                }
+            }
+            // delay line is unwrapped, capacity is reserved so no allocation is done here
+            size_t numSamples = numFrames * m_outFifoPtr->numChannels;
+            size_t toEnd = qMin(numSamples, m_delayLine.size() - m_delayStart);
+            m_fadeOutSamples.assign(m_delayLine.cbegin() + m_delayStart, m_delayLine.cbegin() + m_delayStart + toEnd);
+            m_fadeOutSamples.insert(m_fadeOutSamples.end(), m_delayLine.cbegin(), m_delayLine.cbegin() + (numSamples - toEnd));
+            m_delayStart = 0;
+            m_delayCount = 0;
+            m_crossfadePos = 0;
+        }
+    }
+    else
+    {  // different format => output is restarted with new FIFO
+        switchFifo(decoder->m_streamSampleRate, decoder->m_streamNumChannels);
+    }
+
+    decoder->updateAudioParameters();
+}
+
+void AudioDecoder::routeOutput(AudioDecoder *decoder, audioSample_t *samples, size_t numSamples)
+{
+    if (decoder == m_onAirRequest)
+    {
+        switchOnAir(decoder);
+    }
+
+    if (decoder == m_onAir)
+    {
+        if (m_offAirIdleSamples < SIZE_MAX - numSamples)
+        {
+            m_offAirIdleSamples += numSamples;
+        }
+        if (!m_fadeOutSamples.empty())
+        {  // mix with delayed tail of previous stream
+            int numChannels = m_outFifoPtr->numChannels;
+            size_t numFrames = qMin(numSamples / numChannels, m_crossfadeRamp.size() - m_crossfadePos);
+            AudioDsp::tableRampNoiseMix(samples, m_crossfadeRamp.data() + m_crossfadePos, m_fadeOutSamples.data() + m_crossfadePos * numChannels,
+                                        1.0, numFrames, numChannels, false);
+            m_crossfadePos += numFrames;
+            if (m_crossfadePos >= m_crossfadeRamp.size())
+            {  // done
+                m_fadeOutSamples.clear();
+            }
+        }
+        if (isSwitchPossible())
+        {
+            writeDelayed(samples, numSamples);
+        }
+        else
+        {  // no switch expected => no delay
+            flushDelayLine(m_delayCount);
+            writeFifo(samples, numSamples);
+        }
+    }
+    else
+    {  // standby decoder output is not used, decoder only keeps running to be ready for switching
+        m_offAirIdleSamples = 0;
+    }
+}
+
+bool AudioDecoder::isSwitchPossible() const
+{
+    size_t idleSamples = size_t(AUDIO_DECODER_STANDBY_IDLE_MS) * m_outFifoPtr->sampleRate / 1000 * m_outFifoPtr->numChannels;
+    return (m_onAir != this) || (nullptr != m_onAirRequest) || (m_offAirIdleSamples < idleSamples);
+}
+
+void AudioDecoder::writeDelayed(const audioSample_t *samples, size_t numSamples)
+{
+    size_t capacity = m_delayLine.size();
+    if (m_delayCount + numSamples > capacity)
+    {  // oldest samples are written to FIFO, new samples that do not fit to delay line go directly to FIFO
+        size_t overflow = m_delayCount + numSamples - capacity;
+        size_t fromDelayLine = qMin(overflow, m_delayCount);
+        flushDelayLine(fromDelayLine);
+        overflow -= fromDelayLine;
+        if (overflow > 0)
+        {
+            writeFifo(samples, overflow);
+            samples += overflow;
+            numSamples -= overflow;
+        }
+    }
+    while (numSamples > 0)
+    {
+        size_t pos = (m_delayStart + m_delayCount) % capacity;
+        size_t count = qMin(numSamples, capacity - pos);
+        memcpy(m_delayLine.data() + pos, samples, count * sizeof(audioSample_t));
+        m_delayCount += count;
+        samples += count;
+        numSamples -= count;
+    }
+}
+
+void AudioDecoder::flushDelayLine(size_t numSamples)
+{  // writes oldest numSamples from delay line to FIFO
+    if (0 == numSamples)
+    {
+        return;
+    }
+    size_t toEnd = qMin(numSamples, m_delayLine.size() - m_delayStart);
+    writeFifo(m_delayLine.data() + m_delayStart, toEnd);
+    if (numSamples > toEnd)
+    {
+        writeFifo(m_delayLine.data(), numSamples - toEnd);
+    }
+    m_delayStart = (m_delayStart + numSamples) % m_delayLine.size();
+    m_delayCount -= numSamples;
+}
+
+void AudioDecoder::writeFifo(const audioSample_t *samples, size_t numSamples)
+{
+    int64_t bytesToWrite = numSamples * sizeof(audioSample_t);
+
+    // wait for space in ouput buffer
+    m_outFifoPtr->waitForSpace(bytesToWrite);
+
+    int64_t bytesToEnd = m_outFifoPtr->size - m_outFifoPtr->head;
+    if (bytesToEnd < bytesToWrite)
+    {
+        memcpy(m_outFifoPtr->buffer + m_outFifoPtr->head, samples, bytesToEnd);
+        memcpy(m_outFifoPtr->buffer, reinterpret_cast<const uint8_t *>(samples) + bytesToEnd, bytesToWrite - bytesToEnd);
+        m_outFifoPtr->head = bytesToWrite - bytesToEnd;
+    }
+    else
+    {
+        memcpy(m_outFifoPtr->buffer + m_outFifoPtr->head, samples, bytesToWrite);
+        m_outFifoPtr->head += bytesToWrite;
+    }
+
+    m_outFifoPtr->commitWrite(bytesToWrite);
+
+    m_outFifoPtr->latencyStamps.push(bytesToWrite, LatencyTracer::timestamp());
+
+#ifdef AUDIO_DEBUG_STATS
+    m_byteCounter += bytesToWrite;
+#endif
+}
+
+void AudioDecoder::switchFifo(int sampleRate, int numChannels)
+{
+    if (PlaybackState::Running == m_playbackState)
+    {  // delayed output belongs to current FIFO
+        flushDelayLine(m_delayCount);
+    }
+    m_delayStart = 0;
+    m_delayCount = 0;
+    m_fadeOutSamples.clear();
+
     // toggle index 0->1 or 1->0
     m_outFifoIdx = (m_outFifoIdx + 1) & 0x1;
     m_outFifoPtr = &audioFifo[m_outFifoIdx];
@@ -377,6 +635,14 @@ void AudioDecoder::setOutput(int sampleRate, int numChannels)
     m_outFifoPtr->numChannels = numChannels;
     m_outFifoPtr->reset();
 
+    // buffers are allocated only when format changes, not per frame
+    size_t delaySamples = size_t(AUDIO_DECODER_CROSSFADE_MS) * sampleRate / 1000 * numChannels;
+    if (m_delayLine.size() != delaySamples)
+    {
+        m_delayLine.assign(delaySamples, 0);
+        m_fadeOutSamples.reserve(delaySamples);
+    }
+
     if (PlaybackState::Running == m_playbackState)
     {  // switch audio source
         emit switchAudio(m_outFifoPtr);
@@ -418,9 +684,12 @@ void AudioDecoder::readAACHeader()
     m_audioParameters.parametricStereo = m_aacHeader.bits.ps_flag;
     m_audioParameters.sbr = m_aacHeader.bits.sbr_flag;
 
-    m_recorder->setDataFormat(m_audioParameters.sampleRateKHz, true);
+    if (isOnAir())
+    {
+        m_recorder->setDataFormat(m_audioParameters.sampleRateKHz, true);
+    }
     m_streamDropout = false;
-    emit audioParametersInfo(m_audioParameters);
+    publishAudioParameters(m_audioParameters);
 
     qCInfo(audioDecoder, "%s %d kHz %s", (m_aacHeader.bits.sbr_flag ? (m_aacHeader.bits.ps_flag ? "HE-AAC v2" : "HE-AAC") : "AAC-LC"),
            (m_aacHeader.bits.dac_rate ? 48 : 32), (m_aacHeader.bits.aac_channel_mode || m_aacHeader.bits.ps_flag ? "stereo" : "mono"));
@@ -29,16 +29,22 @@
 
 #include <mpg123.h>
 
+#include <cstdint>
+
 #include <QByteArray>
 #include <QDataStream>
 #include <QFile>
 #include <QObject>
 
+#include "audioconcealment.h"
 #include "audiofifo.h"
 #include "audiorecorder.h"
 #include "radiocontrol.h"
 
 #define AUDIO_DECODER_BUFFER_SIZE 3840  // this is maximum buffer size for HE-AAC
+#define AUDIO_DECODER_CROSSFADE_MS 100  // crossfade duration when switching between primary and announcement stream
+// output is delayed for crossfade until off air stream delivers no output for this time [ms]
+#define AUDIO_DECODER_STANDBY_IDLE_MS 1000
 
 enum class AudioCoding
 {
@@ -70,7 +76,11 @@ public:
     void stop();
     void decodeData(RadioControlAudioData *inData);
     void getAudioParameters();
-    virtual void setNoiseConcealment(int level) = 0;
+    void setNoiseConcealment(int level);
+
+    // decoder of the same type used for secondary (announcement) stream, it becomes child of this decoder
+    // both decoders are kept initialized while announcement is ongoing and output is crossfaded when switching
+    void setStandbyDecoder(AudioDecoder *decoder);
 
 signals:
     void startAudio(audioFifo_t *buffer);
@@ -93,8 +103,9 @@ protected:
 
     AudioRecorder *m_recorder;
     AudioParameters m_audioParameters;
+    AudioConcealment m_concealment;
 
-    int16_t *m_outBufferPtr;
+    audioSample_t *m_outBufferPtr;
     size_t m_outputBufferSamples;
 
     dabsdrDecoderId_t m_inputDataDecoderId;
@@ -102,6 +113,9 @@ protected:
     audioFifo_t *m_outFifoPtr;
 
     void setOutput(int sampleRate, int numChannels);
+    void writeOutput(audioSample_t *samples, size_t numSamples);
+    bool isOnAir() const { return m_controller->m_onAir == this; }
+    void publishAudioParameters(const AudioParameters &params);
 
     virtual bool isAACHandleValid() const = 0;
     void readAACHeader();
@@ -120,9 +134,37 @@ protected:
 private:
     float m_mp2DRC = 0;
     mpg123_handle *m_mp2DecoderHandle;
+    bool m_mp2HasOutput = false;  // concealment starts after first decoded frame
+
+    // primary decoder controls output FIFO, standby decoder only delivers samples to it
+    AudioDecoder *m_controller = this;
+    AudioDecoder *m_standby = nullptr;
+    AudioDecoder *m_onAir = this;            // decoder writing to output FIFO
+    AudioDecoder *m_onAirRequest = nullptr;  // decoder that goes on air when it has output
+    // while switching is possible (announcement or standby stream decoded), last AUDIO_DECODER_CROSSFADE_MS of output
+    // is written to FIFO with delay, when stream on air is switched this tail of previous stream is crossfaded with the new stream
+    // otherwise output is written to FIFO directly without additional latency
+    std::vector<audioSample_t> m_delayLine;  // ring buffer allocated when FIFO is switched
+    size_t m_delayStart = 0;                 // [samples] oldest sample in delay line
+    size_t m_delayCount = 0;                 // [samples]
+    size_t m_offAirIdleSamples = SIZE_MAX;   // on air samples since last output of off air decoder
+    std::vector<audioSample_t> m_fadeOutSamples;
+    std::vector<float> m_crossfadeRamp;
+    size_t m_crossfadePos = 0;  // [frames]
+    int m_streamSampleRate = 0;
+    int m_streamNumChannels = 0;
 
     void processMP2(RadioControlAudioData *inData);
     void getFormatMP2();
+    void updateAudioParameters();
+    void decodeFrame(RadioControlAudioData *inData);
+    void switchFifo(int sampleRate, int numChannels);
+    void switchOnAir(AudioDecoder *decoder);
+    void routeOutput(AudioDecoder *decoder, audioSample_t *samples, size_t numSamples);
+    bool isSwitchPossible() const;
+    void writeDelayed(const audioSample_t *samples, size_t numSamples);
+    void flushDelayLine(size_t numSamples);
+    void writeFifo(const audioSample_t *samples, size_t numSamples);
 };
 
 #endif  // AUDIODECODER_H
@@ -33,6 +33,8 @@
 #include <QLoggingCategory>
 #include <QStandardPaths>
 
+#include "audiodsp.h"
+
 Q_DECLARE_LOGGING_CATEGORY(audioDecoder)
 
 AudioDecoderFAAD::AudioDecoderFAAD(AudioRecorder *recorder, QObject *parent) : AudioDecoder(recorder, parent)
@@ -40,9 +42,8 @@ AudioDecoderFAAD::AudioDecoderFAAD(AudioRecorder *recorder, QObject *parent) : A
     m_aacDecoderHandle = nullptr;
 
 #if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-    m_noiseBufferPtr = new int16_t[AUDIO_DECODER_BUFFER_SIZE];
-    m_noiseFile = nullptr;
-    memset(m_noiseBufferPtr, 0, AUDIO_DECODER_BUFFER_SIZE * sizeof(int16_t));
+    m_noiseBufferPtr = new audioSample_t[AUDIO_DECODER_BUFFER_SIZE];
+    memset(m_noiseBufferPtr, 0, AUDIO_DECODER_BUFFER_SIZE * sizeof(audioSample_t));
 #endif
 }
 
@@ -54,11 +55,6 @@ AudioDecoderFAAD::~AudioDecoderFAAD()
     }
 
 #if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-    if (nullptr != m_noiseFile)
-    {
-        m_noiseFile->close();
-        delete m_noiseFile;
-    }
     delete[] m_noiseBufferPtr;
 #endif
 }
@@ -88,7 +84,11 @@ void AudioDecoderFAAD::initAACDecoder()
         throw std::runtime_error(std::string(Q_FUNC_INFO) + ": error while NeAACDecGetCurrentConfiguration");
     }
 
+#if USE_FLOAT_AUDIO
+    config->outputFormat = FAAD_FMT_FLOAT;  // normalized to [-1.0, 1.0)
+#else
     config->outputFormat = FAAD_FMT_16BIT;
+#endif
     config->dontUpSampleImplicitSBR = 0;
     config->downMatrix = 1;
 
@@ -134,39 +134,6 @@ void AudioDecoderFAAD::deinitAACDecoder()
     }
 }
 
-void AudioDecoderFAAD::setNoiseConcealment(int level)
-{
-#if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-    if (nullptr != m_noiseFile)
-    {
-        m_noiseFile->close();
-        delete m_noiseFile;
-        m_noiseFile = nullptr;
-    }
-
-    if (level > 0)
-    {
-        m_noiseFile = new QFile(":/resources/noise.bin");
-        if (!m_noiseFile->open(QIODevice::ReadOnly))
-        {
-            qCWarning(audioDecoder) << "Unable to open noise file";
-            delete m_noiseFile;
-            m_noiseFile = nullptr;
-            memset(m_noiseBufferPtr, 0, AUDIO_DECODER_BUFFER_SIZE * sizeof(int16_t));
-        }
-        else
-        {  // OK
-            m_noiseLevel = pow(10, -1.0 * level / 20);
-        }
-    }
-    else
-    {  // set buffer to zero
-        memset(m_noiseBufferPtr, 0, AUDIO_DECODER_BUFFER_SIZE * sizeof(int16_t));
-        m_noiseLevel = 0.0;
-    }
-#endif
-}
-
 void AudioDecoderFAAD::processAAC(RadioControlAudioData *inData)
 {
     dabsdrAudioFrameHeader_t header;
@@ -176,7 +143,7 @@ void AudioDecoderFAAD::processAAC(RadioControlAudioData *inData)
     if (nullptr == m_aacDecoderHandle)
     {  // this can happen when format changes from MP2 to AAC or during init
        // not necessary -> will be set in init state
-        // memset(m_outBufferPtr, 0, AUDIO_DECODER_BUFFER_SIZE * sizeof(int16_t));
+        // memset(m_outBufferPtr, 0, AUDIO_DECODER_BUFFER_SIZE * sizeof(audioSample_t));
         m_state = OutputState::Init;
         m_aacHeader.raw = header.raw;
         m_inputDataDecoderId = inData->id;
@@ -200,7 +167,7 @@ void AudioDecoderFAAD::processAAC(RadioControlAudioData *inData)
             m_streamDropout = true;
             auto audioParams = m_audioParameters;
             audioParams.coding = AudioCoding::None;
-            emit audioParametersInfo(audioParams);
+            publishAudioParameters(audioParams);
         }
 
         // concealment not supported
@@ -211,13 +178,13 @@ void AudioDecoderFAAD::processAAC(RadioControlAudioData *inData)
     else if (m_streamDropout)
     {
         m_streamDropout = false;
-        emit audioParametersInfo(m_audioParameters);
+        publishAudioParameters(m_audioParameters);
     }
 
     if ((header.raw != m_aacHeader.raw && inData->data.size() > 10) || (inData->id != m_inputDataDecoderId))
     {  // this is stream reconfiguration or announcement (different instance)
        // not necessary -> will be set in init state
-        // memset(m_outBufferPtr, 0, AUDIO_DECODER_BUFFER_SIZE * sizeof(int16_t));
+        // memset(m_outBufferPtr, 0, AUDIO_DECODER_BUFFER_SIZE * sizeof(audioSample_t));
         m_state = OutputState::Init;
 
         if (inData->id != m_inputDataDecoderId)
@@ -244,37 +211,21 @@ void AudioDecoderFAAD::handleAudioOutput(const NeAACDecFrameInfo &frameInfo, con
         if (OutputState::Unmuted == m_state)
         {  // do mute
 #if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-           // read noise samples
+           // generate noise samples
             qCInfo(audioDecoder) << "Muting audio (decoding errors)";
-            int valuesToRead = m_muteRamp.size() * m_numChannels;
-            if (nullptr != m_noiseFile)
-            {
-                if (m_noiseFile->bytesAvailable() < valuesToRead * sizeof(int16_t))
-                {
-                    m_noiseFile->seek(0);
-                }
-                m_noiseFile->read((char *)m_noiseBufferPtr, valuesToRead * sizeof(int16_t));
-            }
-            int16_t *noisePtr = m_noiseBufferPtr;
+            m_concealment.generate(m_noiseBufferPtr, m_muteRamp.size() * m_numChannels);
+            audioSample_t *noisePtr = m_noiseBufferPtr;
 #else
 
 #endif
 
-            int16_t *dataPtr = &m_outBufferPtr[m_outputBufferSamples - 1];  // last sample
-            std::vector<float>::const_iterator it = m_muteRamp.cbegin();
-            while (it != m_muteRamp.end())
-            {
-                float gain = *it++;
-                for (uint_fast32_t ch = 0; ch < m_numChannels; ++ch)
-                {
+            // apply mute ramp backwards from last sample
+            audioSample_t *dataPtr = &m_outBufferPtr[m_outputBufferSamples - m_muteRamp.size() * m_numChannels];
 #if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-                    *dataPtr = int16_t(qRound(gain * *dataPtr)) + (1 - gain) * m_noiseLevel * *noisePtr++;
+            AudioDsp::tableRampNoiseMix(dataPtr, m_muteRamp.data(), noisePtr, m_concealment.level(), m_muteRamp.size(), m_numChannels, true);
 #else
-                    *dataPtr = int16_t(qRound(gain * *dataPtr));
+            AudioDsp::tableRamp(dataPtr, m_muteRamp.data(), m_muteRamp.size(), m_numChannels, true);
 #endif
-                    --dataPtr;
-                }
-            }
         }
         else if (OutputState::Init == m_state)
         {  // do nothing and return -> decoder is initializing
@@ -287,126 +238,56 @@ void AudioDecoderFAAD::handleAudioOutput(const NeAACDecFrameInfo &frameInfo, con
 
     if (OutputState::Init == m_state)
     {  // only copy to internal buffer -> this is the first buffer
-        memcpy(m_outBufferPtr, inFramePtr, m_outputBufferSamples * sizeof(int16_t));
+        memcpy(m_outBufferPtr, inFramePtr, m_outputBufferSamples * sizeof(audioSample_t));
 
         // apply unmute ramp
-        int16_t *dataPtr = &m_outBufferPtr[0];  // first sample
-        std::vector<float>::const_iterator it = m_muteRamp.cbegin();
-        while (it != m_muteRamp.end())
-        {
-            float gain = *it++;
-            for (uint_fast32_t ch = 0; ch < m_numChannels; ++ch)
-            {
-                *dataPtr = int16_t(qRound(gain * *dataPtr));
-                dataPtr += 1;
-            }
-        }
+        AudioDsp::tableRamp(m_outBufferPtr, m_muteRamp.data(), m_muteRamp.size(), m_numChannels, false);
 
         m_state = OutputState::Unmuted;
         return;
     }
 
     // copy data to output FIFO
-    int64_t bytesToWrite = m_outputBufferSamples * sizeof(int16_t);
-
-    // wait for space in ouput buffer
-    m_outFifoPtr->mutex.lock();
-    uint64_t count = m_outFifoPtr->count;
-    while (int64_t(AUDIO_FIFO_SIZE - count) < bytesToWrite)
-    {
-        m_outFifoPtr->countChanged.wait(&m_outFifoPtr->mutex);
-        count = m_outFifoPtr->count;
-    }
-    m_outFifoPtr->mutex.unlock();
-
-    int64_t bytesToEnd = AUDIO_FIFO_SIZE - m_outFifoPtr->head;
-    if (bytesToEnd < bytesToWrite)
-    {
-        memcpy(m_outFifoPtr->buffer + m_outFifoPtr->head, m_outBufferPtr, bytesToEnd);
-        memcpy(m_outFifoPtr->buffer, reinterpret_cast<uint8_t *>(m_outBufferPtr) + bytesToEnd, bytesToWrite - bytesToEnd);
-        m_outFifoPtr->head = bytesToWrite - bytesToEnd;
-    }
-    else
-    {
-        memcpy(m_outFifoPtr->buffer + m_outFifoPtr->head, m_outBufferPtr, bytesToWrite);
-        m_outFifoPtr->head += bytesToWrite;
-    }
-
-    m_outFifoPtr->mutex.lock();
-    m_outFifoPtr->count += bytesToWrite;
-    m_outFifoPtr->mutex.unlock();
-
-#ifdef AUDIO_DEBUG_STATS
-    m_byteCounter += bytesToWrite;
-#endif
+    writeOutput(m_outBufferPtr, m_outputBufferSamples);
 
     // copy new data to buffer
     if (frameInfo.samples != m_outputBufferSamples)
     {  // error
 #if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-       // read noise
-        int valuesToRead = m_outputBufferSamples;
-        if (nullptr != m_noiseFile)
-        {
-            if (m_noiseFile->bytesAvailable() < valuesToRead * sizeof(int16_t))
-            {
-                m_noiseFile->seek(0);
-            }
-            m_noiseFile->read((char *)m_noiseBufferPtr, valuesToRead * sizeof(int16_t));
-        }
-        // copy noise
-        int16_t *dataPtr = m_outBufferPtr;
-        int16_t *noisePtr = m_noiseBufferPtr;
-        for (int n = 0; n < m_outputBufferSamples; ++n)
-        {
-            *dataPtr++ = m_noiseLevel * *noisePtr++;
-        }
+       // spectrally shaped noise
+        m_concealment.generate(m_noiseBufferPtr, m_outputBufferSamples);
+        AudioDsp::gain(m_outBufferPtr, m_noiseBufferPtr, m_outputBufferSamples, m_concealment.level());
         m_state = OutputState::Muted;
 #else
         if (OutputState::Unmuted == m_state)
         {  // copy 0
-            memset(m_outBufferPtr, 0, m_outputBufferSamples * sizeof(int16_t));
+            memset(m_outBufferPtr, 0, m_outputBufferSamples * sizeof(audioSample_t));
             m_state = OutputState::Muted;
         }
 #endif
     }
     else
     {  // OK
-        memcpy(m_outBufferPtr, inFramePtr, m_outputBufferSamples * sizeof(int16_t));
+        memcpy(m_outBufferPtr, inFramePtr, m_outputBufferSamples * sizeof(audioSample_t));
+#if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
+        m_concealment.analyze(m_outBufferPtr, m_outputBufferSamples);
+#endif
 
         if (OutputState::Muted == m_state)
         {  // do unmute
             qCInfo(audioDecoder) << "Unmuting audio";
 #if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-            // read noise
-            int valuesToRead = m_muteRamp.size() * m_numChannels;
-            if (nullptr != m_noiseFile)
-            {
-                if (m_noiseFile->bytesAvailable() < valuesToRead * sizeof(int16_t))
-                {
-                    m_noiseFile->seek(0);
-                }
-                m_noiseFile->read((char *)m_noiseBufferPtr, valuesToRead * sizeof(int16_t));
-            }
-            int16_t *noisePtr = m_noiseBufferPtr;
+            // generate noise
+            m_concealment.generate(m_noiseBufferPtr, m_muteRamp.size() * m_numChannels);
+            audioSample_t *noisePtr = m_noiseBufferPtr;
 #endif
 
             // apply unmute ramp
-            int16_t *dataPtr = &m_outBufferPtr[0];  // first sample
-            std::vector<float>::const_iterator it = m_muteRamp.cbegin();
-            while (it != m_muteRamp.end())
-            {
-                float gain = *it++;
-                for (uint_fast32_t ch = 0; ch < m_numChannels; ++ch)
-                {
 #if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-                    *dataPtr = int16_t(qRound(gain * *dataPtr)) + (1 - gain) * m_noiseLevel * *noisePtr++;
+            AudioDsp::tableRampNoiseMix(m_outBufferPtr, m_muteRamp.data(), noisePtr, m_concealment.level(), m_muteRamp.size(), m_numChannels, false);
 #else
-                    *dataPtr = int16_t(qRound(gain * *dataPtr));
+            AudioDsp::tableRamp(m_outBufferPtr, m_muteRamp.data(), m_muteRamp.size(), m_numChannels, false);
 #endif
-                    dataPtr += 1;
-                }
-            }
             m_state = OutputState::Unmuted;
         }
     }
@@ -47,7 +47,6 @@ class AudioDecoderFAAD : public AudioDecoder
 public:
     explicit AudioDecoderFAAD(AudioRecorder *recorder, QObject *parent = nullptr);
     ~AudioDecoderFAAD();
-    void setNoiseConcealment(int level) override;
 
 private:
     NeAACDecHandle m_aacDecoderHandle;
@@ -62,9 +61,7 @@ private:
         Unmuted
     } m_state;
 #if AUDIO_DECODER_FAAD_NOISE_CONCEALMENT
-    QFile *m_noiseFile = nullptr;
-    int16_t *m_noiseBufferPtr;
-    float m_noiseLevel;
+    audioSample_t *m_noiseBufferPtr;
 #endif
 
     bool isAACHandleValid() const override { return m_aacDecoderHandle != nullptr; }
@@ -33,6 +33,8 @@
 #include <QLoggingCategory>
 #include <QStandardPaths>
 
+#include "audiodsp.h"
+
 Q_DECLARE_LOGGING_CATEGORY(audioDecoder)
 
 AudioDecoderFDKAAC::AudioDecoderFDKAAC(AudioRecorder *recorder, QObject *parent) : AudioDecoder(recorder, parent)
@@ -40,6 +42,9 @@ AudioDecoderFDKAAC::AudioDecoderFDKAAC(AudioRecorder *recorder, QObject *parent)
     m_aacDecoderHandle = nullptr;
 
     Q_ASSERT(sizeof(int16_t) == sizeof(INT_PCM));
+#if USE_FLOAT_AUDIO
+    m_pcmBuffer.resize(AUDIO_DECODER_BUFFER_SIZE);
+#endif
 }
 
 AudioDecoderFDKAAC::~AudioDecoderFDKAAC()
@@ -123,9 +128,6 @@ void AudioDecoderFDKAAC::deinitAACDecoder()
     }
 }
 
-void AudioDecoderFDKAAC::setNoiseConcealment(int level)
-{}
-
 void AudioDecoderFDKAAC::processAAC(RadioControlAudioData *inData)
 {
     dabsdrAudioFrameHeader_t header;
@@ -156,7 +158,7 @@ void AudioDecoderFDKAAC::processAAC(RadioControlAudioData *inData)
             m_streamDropout = true;
             auto audioParams = m_audioParameters;
             audioParams.coding = AudioCoding::None;
-            emit audioParametersInfo(audioParams);
+            publishAudioParameters(audioParams);
         }
 
         // clear concealment bit
@@ -171,7 +173,7 @@ void AudioDecoderFDKAAC::processAAC(RadioControlAudioData *inData)
     else if (m_streamDropout)
     {
         m_streamDropout = false;
-        emit audioParametersInfo(m_audioParameters);
+        publishAudioParameters(m_audioParameters);
     }
 
     if ((header.raw != m_aacHeader.raw && inData->data.size() > 10) || (inData->id != m_inputDataDecoderId))
@@ -207,46 +209,32 @@ void AudioDecoderFDKAAC::processAAC(RadioControlAudioData *inData)
     }
 
     // decode audio
-    result = aacDecoder_DecodeFrame(m_aacDecoderHandle, (INT_PCM *)m_outBufferPtr, m_outputBufferSamples, AACDEC_CONCEAL * conceal);
+#if USE_FLOAT_AUDIO
+    // FDK-AAC provides only fixed point output
+    INT_PCM *pcmPtr = m_pcmBuffer.data();
+#else
+    INT_PCM *pcmPtr = (INT_PCM *)m_outBufferPtr;
+#endif
+    result = aacDecoder_DecodeFrame(m_aacDecoderHandle, pcmPtr, m_outputBufferSamples, AACDEC_CONCEAL * conceal);
     if (AAC_DEC_OK != result)
     {
         qCWarning(audioDecoder) << "Error decoding AAC frame:" << result;
     }
 
-    if (!IS_OUTPUT_VALID(result))
+    bool isValid = IS_OUTPUT_VALID(result);
+    if (!isValid)
     {  // no output - fill with zeros
-        memset(m_outBufferPtr, 0, m_outputBufferSamples * sizeof(int16_t));
-    }
-
-    int64_t bytesToWrite = m_outputBufferSamples * sizeof(int16_t);
-
-    // wait for space in ouput buffer
-    m_outFifoPtr->mutex.lock();
-    uint64_t count = m_outFifoPtr->count;
-    while (int64_t(AUDIO_FIFO_SIZE - count) < bytesToWrite)
-    {
-        m_outFifoPtr->countChanged.wait(&m_outFifoPtr->mutex);
-        count = m_outFifoPtr->count;
-    }
-    m_outFifoPtr->mutex.unlock();
-
-    int64_t bytesToEnd = AUDIO_FIFO_SIZE - m_outFifoPtr->head;
-    if (bytesToEnd < bytesToWrite)
-    {
-        memcpy(m_outFifoPtr->buffer + m_outFifoPtr->head, m_outBufferPtr, bytesToEnd);
-        memcpy(m_outFifoPtr->buffer, reinterpret_cast<uint8_t *>(m_outBufferPtr) + bytesToEnd, bytesToWrite - bytesToEnd);
-        m_outFifoPtr->head = bytesToWrite - bytesToEnd;
+        memset(m_outBufferPtr, 0, m_outputBufferSamples * sizeof(audioSample_t));
     }
+#if USE_FLOAT_AUDIO
     else
     {
-        memcpy(m_outFifoPtr->buffer + m_outFifoPtr->head, m_outBufferPtr, bytesToWrite);
-        m_outFifoPtr->head += bytesToWrite;
+        AudioDsp::toFloat(m_outBufferPtr, pcmPtr, m_outputBufferSamples);
     }
-
-    m_outFifoPtr->mutex.lock();
-    m_outFifoPtr->count += bytesToWrite;
-    m_outFifoPtr->mutex.unlock();
-#ifdef AUDIO_DEBUG_STATS
-    m_byteCounter += bytesToWrite;
 #endif
+
+    // concealed frame is crossfaded from decoder output to shaped noise
+    m_concealment.process(m_outBufferPtr, m_outputBufferSamples, isValid && !conceal);
+
+    writeOutput(m_outBufferPtr, m_outputBufferSamples);
 }
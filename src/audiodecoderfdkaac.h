@@ -48,10 +48,12 @@ class AudioDecoderFDKAAC : public AudioDecoder
 public:
     explicit AudioDecoderFDKAAC(AudioRecorder *recorder, QObject *parent = nullptr);
     ~AudioDecoderFDKAAC();
-    void setNoiseConcealment(int level) override;
 
 private:
     HANDLE_AACDECODER m_aacDecoderHandle;
+#if USE_FLOAT_AUDIO
+    std::vector<INT_PCM> m_pcmBuffer;  // fixed point decoder output converted to float samples
+#endif
 
     void setOutput(int sampleRate, int numChannels);
 
@@ -0,0 +1,248 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "audiodsp.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIODSP_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define AUDIODSP_NEON 1
+#include <arm_neon.h>
+#endif
+
+int16_t AudioDsp::saturate(float x)
+{  // lrintf rounds half to even in default rounding mode, the same as SSE2 and NEON conversions
+    if (x >= float(INT16_MAX))
+    {
+        return INT16_MAX;
+    }
+    if (x <= float(INT16_MIN))
+    {
+        return INT16_MIN;
+    }
+    return int16_t(std::lrintf(x));
+}
+
+void AudioDsp::gain(int16_t *out, const int16_t *in, size_t numSamples, float gain)
+{
+    size_t n = 0;
+#if AUDIODSP_SSE2
+    const __m128 g = _mm_set1_ps(gain);
+    for (; n + 8 <= numSamples; n += 8)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + n));
+        // sign extension of int16 to int32
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo), g));
+        hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi), g));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n), _mm_packs_epi32(lo, hi));
+    }
+#elif AUDIODSP_NEON
+    const float32x4_t g = vdupq_n_f32(gain);
+    for (; n + 8 <= numSamples; n += 8)
+    {
+        int16x8_t x = vld1q_s16(in + n);
+        int32x4_t lo = vmovl_s16(vget_low_s16(x));
+        int32x4_t hi = vmovl_s16(vget_high_s16(x));
+        lo = vcvtnq_s32_f32(vmulq_f32(vcvtq_f32_s32(lo), g));
+        hi = vcvtnq_s32_f32(vmulq_f32(vcvtq_f32_s32(hi), g));
+        vst1q_s16(out + n, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#endif
+    for (; n < numSamples; ++n)
+    {
+        out[n] = saturate(gain * in[n]);
+    }
+}
+
+void AudioDsp::gain(float *out, const float *in, size_t numSamples, float gain)
+{
+    size_t n = 0;
+#if AUDIODSP_SSE2
+    const __m128 g = _mm_set1_ps(gain);
+    for (; n + 4 <= numSamples; n += 4)
+    {
+        _mm_storeu_ps(out + n, _mm_mul_ps(_mm_loadu_ps(in + n), g));
+    }
+#elif AUDIODSP_NEON
+    for (; n + 4 <= numSamples; n += 4)
+    {
+        vst1q_f32(out + n, vmulq_n_f32(vld1q_f32(in + n), gain));
+    }
+#endif
+    for (; n < numSamples; ++n)
+    {
+        out[n] = gain * in[n];
+    }
+}
+
+void AudioDsp::toInt16(int16_t *out, const float *in, size_t numSamples)
+{
+    size_t n = 0;
+#if AUDIODSP_SSE2
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    for (; n + 8 <= numSamples; n += 8)
+    {  // conversion to int32 rounds to nearest, pack saturates
+        __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + n), scale));
+        __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + n + 4), scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n), _mm_packs_epi32(lo, hi));
+    }
+#elif AUDIODSP_NEON
+    for (; n + 8 <= numSamples; n += 8)
+    {
+        int32x4_t lo = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in + n), 32768.0f));
+        int32x4_t hi = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in + n + 4), 32768.0f));
+        vst1q_s16(out + n, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+#endif
+    for (; n < numSamples; ++n)
+    {
+        out[n] = saturate(32768.0f * in[n]);
+    }
+}
+
+void AudioDsp::toFloat(float *out, const int16_t *in, size_t numSamples)
+{
+    const float scale = 1.0f / 32768.0f;
+    for (size_t n = 0; n < numSamples; ++n)
+    {
+        out[n] = scale * in[n];
+    }
+}
+
+namespace
+{
+// stores processed value to int16 (saturated) or float sample
+inline void store(int16_t &out, float x)
+{
+    out = AudioDsp::saturate(x);
+}
+inline void store(float &out, float x)
+{
+    out = x;
+}
+
+template <typename T>
+float expRampImpl(T *data, size_t numFrames, int numChannels, float startGain, float coe)
+{
+    float g = startGain;
+    for (size_t n = 0; n < numFrames; ++n)
+    {
+        for (int c = 0; c < numChannels; ++c)
+        {
+            store(*data, g * *data);
+            data++;
+        }
+        g = g * coe;
+    }
+    return g;
+}
+
+template <typename T>
+void tableRampImpl(T *data, const float *ramp, size_t numFrames, int numChannels, bool reverse)
+{
+    if (0 == numFrames)
+    {  // nothing to do, last frame would be before data
+        return;
+    }
+    int step = numChannels;
+    if (reverse)
+    {  // last frame
+        data += (numFrames - 1) * numChannels;
+        step = -numChannels;
+    }
+    for (size_t n = 0; n < numFrames; ++n)
+    {
+        float g = ramp[n];
+        for (int c = 0; c < numChannels; ++c)
+        {
+            store(data[c], g * data[c]);
+        }
+        data += step;
+    }
+}
+
+template <typename T>
+void tableRampNoiseMixImpl(T *data, const float *ramp, const T *noise, float noiseLevel, size_t numFrames, int numChannels, bool reverse)
+{
+    if (0 == numFrames)
+    {  // nothing to do, last frame would be before data
+        return;
+    }
+    int step = numChannels;
+    if (reverse)
+    {  // last frame
+        data += (numFrames - 1) * numChannels;
+        step = -numChannels;
+    }
+    for (size_t n = 0; n < numFrames; ++n)
+    {
+        float g = ramp[n];
+        float noiseGain = (1 - g) * noiseLevel;
+        for (int c = 0; c < numChannels; ++c)
+        {
+            store(data[c], g * data[c] + noiseGain * *noise++);
+        }
+        data += step;
+    }
+}
+}  // namespace
+
+float AudioDsp::expRamp(int16_t *data, size_t numFrames, int numChannels, float startGain, float coe)
+{
+    return expRampImpl(data, numFrames, numChannels, startGain, coe);
+}
+
+float AudioDsp::expRamp(float *data, size_t numFrames, int numChannels, float startGain, float coe)
+{
+    return expRampImpl(data, numFrames, numChannels, startGain, coe);
+}
+
+void AudioDsp::tableRamp(int16_t *data, const float *ramp, size_t numFrames, int numChannels, bool reverse)
+{
+    tableRampImpl(data, ramp, numFrames, numChannels, reverse);
+}
+
+void AudioDsp::tableRamp(float *data, const float *ramp, size_t numFrames, int numChannels, bool reverse)
+{
+    tableRampImpl(data, ramp, numFrames, numChannels, reverse);
+}
+
+void AudioDsp::tableRampNoiseMix(int16_t *data, const float *ramp, const int16_t *noise, float noiseLevel, size_t numFrames, int numChannels,
+                                 bool reverse)
+{
+    tableRampNoiseMixImpl(data, ramp, noise, noiseLevel, numFrames, numChannels, reverse);
+}
+
+void AudioDsp::tableRampNoiseMix(float *data, const float *ramp, const float *noise, float noiseLevel, size_t numFrames, int numChannels,
+                                 bool reverse)
+{
+    tableRampNoiseMixImpl(data, ramp, noise, noiseLevel, numFrames, numChannels, reverse);
+}
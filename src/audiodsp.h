@@ -0,0 +1,91 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AUDIODSP_H
+#define AUDIODSP_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "config.h"
+
+// Sample type of audio pipeline from decoders to audio output
+// Float samples are normalized to [-1.0, 1.0), they are not saturated before audio output
+// so that gain applied during processing (MP2 DRC, volume) does not clip intermediate results.
+#if USE_FLOAT_AUDIO
+typedef float audioSample_t;
+#define AUDIO_SAMPLE_FULL_SCALE (1.0f)
+#else
+typedef int16_t audioSample_t;
+#define AUDIO_SAMPLE_FULL_SCALE (32768.0f)
+#endif
+
+// Sample processing kernels shared by audio decoders and audio outputs
+// All kernels work with interleaved samples, int16 results are rounded to nearest (half to even) and saturated.
+// Constant gain kernels are vectorized (SSE2 / NEON) since they run in every audio output callback,
+// ramps are applied only on mute/unmute and use plain loops.
+class AudioDsp
+{
+public:
+    // out[n] = in[n] * gain, in and out can be the same buffer
+    static void gain(int16_t *out, const int16_t *in, size_t numSamples, float gain);
+    static void gain(int16_t *data, size_t numSamples, float g) { gain(data, data, numSamples, g); }
+    static void gain(float *out, const float *in, size_t numSamples, float gain);
+    static void gain(float *data, size_t numSamples, float g) { gain(data, data, numSamples, g); }
+
+    // exponential ramp: frame n is multiplied by startGain * coe^n
+    // returns gain of the frame following the last one
+    static float expRamp(int16_t *data, size_t numFrames, int numChannels, float startGain, float coe);
+    static float expRamp(float *data, size_t numFrames, int numChannels, float startGain, float coe);
+
+    // ramp from table: frame n is multiplied by ramp[n]
+    // if reverse is true then ramp is applied backwards from the last frame, ramp[0] applies to last frame
+    static void tableRamp(int16_t *data, const float *ramp, size_t numFrames, int numChannels, bool reverse);
+    static void tableRamp(float *data, const float *ramp, size_t numFrames, int numChannels, bool reverse);
+
+    // like tableRamp and noise is mixed in with complementary gain: x * ramp[n] + noise * noiseLevel * (1 - ramp[n])
+    // noise samples are used in processing order
+    static void tableRampNoiseMix(int16_t *data, const float *ramp, const int16_t *noise, float noiseLevel, size_t numFrames, int numChannels,
+                                  bool reverse);
+    static void tableRampNoiseMix(float *data, const float *ramp, const float *noise, float noiseLevel, size_t numFrames, int numChannels,
+                                  bool reverse);
+
+    // conversion between int16 and normalized float samples, int16 output is saturated
+    static void toInt16(int16_t *out, const float *in, size_t numSamples);
+    static void toFloat(float *out, const int16_t *in, size_t numSamples);
+
+    // rounds to nearest (half to even) and saturates to int16 range
+    static int16_t saturate(float x);
+
+    // converts value in pipeline sample scale to pipeline sample type
+#if USE_FLOAT_AUDIO
+    static audioSample_t toSample(float x) { return x; }
+#else
+    static audioSample_t toSample(float x) { return saturate(x); }
+#endif
+};
+
+#endif  // AUDIODSP_H
@@ -26,11 +26,50 @@
 
 #include "audiofifo.h"
 
+void AudioFifo::allocate(uint32_t chunkMs)
+{
+    delete[] buffer;
+    this->chunkMs = chunkMs;
+    size = int64_t(chunkMs) * AUDIO_FIFO_CHUNKS * AUDIO_FIFO_BYTES_PER_MS;
+    buffer = new uint8_t[size];
+    reset();
+}
+
 void AudioFifo::reset()
 {
-    mutex.lock();
     count = 0;
     head = 0;
     tail = 0;
-    mutex.unlock();
-};
+    latencyStamps.reset();
+}
+
+void AudioFifo::waitForSpace(int64_t bytes)
+{
+    while ((size - count.load(std::memory_order_seq_cst)) < bytes)
+    {
+        m_producerWaiting.store(true, std::memory_order_seq_cst);
+
+        // consumer could read data before it saw the flag
+        if ((size - count.load(std::memory_order_seq_cst)) >= bytes)
+        {
+            if (!m_producerWaiting.exchange(false))
+            {  // consumer has seen the flag and released semaphore -> consume it
+                m_spaceAvailable.acquire();
+            }
+            break;
+        }
+
+        m_spaceAvailable.acquire();
+    }
+}
+
+void AudioFifo::commitRead(int64_t bytes)
+{
+    count.fetch_sub(bytes, std::memory_order_seq_cst);
+
+    // wake up producer only if it waits, semaphore release does not block
+    if (m_producerWaiting.load(std::memory_order_seq_cst) && m_producerWaiting.exchange(false))
+    {
+        m_spaceAvailable.release();
+    }
+}
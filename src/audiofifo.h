@@ -27,18 +27,30 @@
 #ifndef AUDIOFIFO_H
 #define AUDIOFIFO_H
 
-#include <QMutex>
-#include <QWaitCondition>
+#include <QSemaphore>
+#include <atomic>
 
+#include "audiodsp.h"
+#include "latencytracer.h"
+
+// chunk size per latency profile, FIFO is allocated at startup according to selected profile
 #ifdef Q_OS_ANDROID
 // #define AUDIO_DEBUG_STATS
+#define AUDIO_FIFO_CHUNK_MS_LOW_LATENCY (100)
 #define AUDIO_FIFO_CHUNK_MS (200)
+#define AUDIO_FIFO_CHUNK_MS_ROBUST (400)
 #else
+#define AUDIO_FIFO_CHUNK_MS_LOW_LATENCY (20)
 #define AUDIO_FIFO_CHUNK_MS (60)
+#define AUDIO_FIFO_CHUNK_MS_ROBUST (120)
 #endif
-#define AUDIO_FIFO_MS (32 * AUDIO_FIFO_CHUNK_MS)
-#define AUDIO_FIFO_SIZE (48 * AUDIO_FIFO_MS * 2 * sizeof(int16_t))  // FS - 48kHz, stereo, int16_t samples
+#define AUDIO_FIFO_CHUNKS (32)
+#define AUDIO_FIFO_BYTES_PER_MS (48 * 2 * sizeof(audioSample_t))  // FS - 48kHz, stereo, audioSample_t samples
 
+// Single producer (audio decoder) / single consumer (audio output) ring buffer
+// head is modified by producer only, tail by consumer only, count is shared.
+// Consumer never blocks, it is called from realtime audio callback.
+// Producer blocks on semaphore only when there is not enough space in buffer.
 struct AudioFifo
 {
     uint32_t sampleRate;
@@ -46,14 +58,35 @@ struct AudioFifo
     std::atomic<int64_t> count;
     int64_t head;
     int64_t tail;
-    uint8_t buffer[AUDIO_FIFO_SIZE];
-    QWaitCondition countChanged;
-    QMutex mutex;
+    uint8_t *buffer = nullptr;
+    int64_t size = 0;      // buffer size in bytes
+    uint32_t chunkMs = 0;  // output chunk (period) duration
+    LatencyStampRing latencyStamps;
+
+    ~AudioFifo() { delete[] buffer; }
+
+    // allocates buffer for AUDIO_FIFO_CHUNKS chunks of chunkMs duration
+    // must be called before decoder and output are started
+    void allocate(uint32_t chunkMs);
+    uint32_t sizeMs() const { return chunkMs * AUDIO_FIFO_CHUNKS; }
+
+    // producer: wait until there is space for bytes in buffer
+    void waitForSpace(int64_t bytes);
+    // producer: bytes were written to buffer at head
+    void commitWrite(int64_t bytes) { count.fetch_add(bytes, std::memory_order_seq_cst); }
+    // consumer: bytes were read from buffer at tail
+    void commitRead(int64_t bytes);
+
+    // must not be called while consumer is reading from this FIFO
     void reset();
+
+private:
+    std::atomic<bool> m_producerWaiting = false;
+    QSemaphore m_spaceAvailable;
 };
 
 typedef struct AudioFifo audioFifo_t;
 
-// extern audioFifo_t audioBuffer[2];
+extern audioFifo_t audioFifo[2];
 
 #endif  // AUDIOFIFO_H
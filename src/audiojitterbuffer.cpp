@@ -0,0 +1,185 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "audiojitterbuffer.h"
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// time constant of FIFO fill low pass filter [ms]
+#define AUDIO_JITTER_BUFFER_FILL_TC_MS (10000)
+// proportional gain of drift controller: ratio deviation per relative fill error
+#define AUDIO_JITTER_BUFFER_DRIFT_GAIN (0.002)
+
+AudioJitterBuffer::AudioJitterBuffer(uint32_t initialTargetChunks) : m_initialTargetChunks(initialTargetChunks)
+{}
+
+void AudioJitterBuffer::init(uint32_t sampleRate_kHz, uint8_t numChannels, uint32_t chunkMs, uint32_t fifoMs)
+{
+    if (chunkMs != m_chunkMs)
+    {  // first init or FIFO profile change => start from initial target
+        m_chunkMs = chunkMs;
+        m_targetMs = m_initialTargetChunks * chunkMs;
+    }
+    m_minMs = AUDIO_JITTER_BUFFER_MIN_CHUNKS * chunkMs;
+    m_maxMs = qMax(m_minMs, fifoMs / 2);
+    m_sampleRate_kHz = sampleRate_kHz;
+    m_numChannels = numChannels;
+    m_bytesPerFrame = numChannels * sizeof(audioSample_t);
+
+    // one more frame is needed for interpolation and one for ratio > 1
+    m_inputBuffer.assign((BlockFrames * (1 + AUDIO_JITTER_BUFFER_MAX_DRIFT) + 3) * numChannels, 0);
+    m_prevFrame.assign(numChannels, 0);
+
+    setTarget(m_targetMs);
+    m_isFillValid = false;
+    m_ratio = 1.0;
+    reset();
+}
+
+void AudioJitterBuffer::reset()
+{
+    m_phase = 0.0;
+    std::fill(m_prevFrame.begin(), m_prevFrame.end(), 0);
+}
+
+uint64_t AudioJitterBuffer::inputBytesNeeded(uint32_t numFrames) const
+{
+    return uint64_t(std::floor(m_phase + numFrames * (1.0 + AUDIO_JITTER_BUFFER_MAX_DRIFT)) + 1) * m_bytesPerFrame;
+}
+
+bool AudioJitterBuffer::underrun()
+{  // called from audio callback, caller logs the new target
+    m_framesWithoutUnderrun = 0;
+    m_isFillValid = false;
+    if (m_targetMs < m_maxMs)
+    {
+        setTarget(m_targetMs + 2 * m_chunkMs);
+        return true;
+    }
+    return false;
+}
+
+void AudioJitterBuffer::setTarget(uint32_t targetMs)
+{
+    m_targetMs = qBound(m_minMs, targetMs, m_maxMs);
+    m_targetBytes = uint64_t(m_targetMs) * m_sampleRate_kHz * m_bytesPerFrame;
+}
+
+void AudioJitterBuffer::peek(const audioFifo_t *fifo, uint64_t offset, audioSample_t *dest, uint32_t numFrames) const
+{
+    uint64_t bytes = uint64_t(numFrames) * m_bytesPerFrame;
+    uint64_t pos = (fifo->tail + offset) % fifo->size;
+    uint64_t bytesToEnd = fifo->size - pos;
+    if (bytesToEnd < bytes)
+    {
+        memcpy(dest, fifo->buffer + pos, bytesToEnd);
+        memcpy(reinterpret_cast<uint8_t *>(dest) + bytesToEnd, fifo->buffer, bytes - bytesToEnd);
+    }
+    else
+    {
+        memcpy(dest, fifo->buffer + pos, bytes);
+    }
+}
+
+uint64_t AudioJitterBuffer::read(audioFifo_t *fifo, audioSample_t *out, uint32_t numFrames, uint64_t fifoBytes)
+{
+    // low pass filtered FIFO fill
+    if (m_isFillValid)
+    {
+        float alpha = qMin(1.0f, float(numFrames) / (AUDIO_JITTER_BUFFER_FILL_TC_MS * m_sampleRate_kHz));
+        m_fillBytes += alpha * (float(fifoBytes) - m_fillBytes);
+    }
+    else
+    {
+        m_fillBytes = fifoBytes;
+        m_isFillValid = true;
+    }
+
+    // FIFO fill above target means that sound card clock is slower than DAB => consume faster (ratio > 1)
+    float error = (m_fillBytes - m_targetBytes) / m_targetBytes;
+    m_ratio = 1.0 + qBound(-AUDIO_JITTER_BUFFER_MAX_DRIFT, AUDIO_JITTER_BUFFER_DRIFT_GAIN * error, AUDIO_JITTER_BUFFER_MAX_DRIFT);
+
+    // stable playback => try to decrease latency
+    m_framesWithoutUnderrun += numFrames;
+    if (m_framesWithoutUnderrun > uint64_t(AUDIO_JITTER_BUFFER_DECREASE_MS) * m_sampleRate_kHz)
+    {
+        m_framesWithoutUnderrun = 0;
+        if (m_targetMs > m_minMs)
+        {
+            setTarget(m_targetMs - m_chunkMs);
+        }
+    }
+
+    uint64_t consumedBytes = 0;
+    uint64_t availableFrames = fifoBytes / m_bytesPerFrame;
+    while (numFrames > 0)
+    {
+        uint32_t frames = qMin(numFrames, uint32_t(BlockFrames));
+
+        // input frame index 0 is last frame of previous block, new frames start at index 1
+        double phaseEnd = m_phase + frames * m_ratio;
+        uint32_t framesConsumed = uint32_t(phaseEnd);
+        uint32_t framesNeeded = qMax(uint32_t(m_phase + (frames - 1) * m_ratio) + 1, framesConsumed);
+        uint32_t framesRead = qMin(uint64_t(framesNeeded), availableFrames);
+
+        memcpy(m_inputBuffer.data(), m_prevFrame.data(), m_bytesPerFrame);
+        peek(fifo, consumedBytes, m_inputBuffer.data() + m_numChannels, framesRead);
+        for (uint32_t n = framesRead; n < framesNeeded; ++n)
+        {  // this should not happen if caller checks inputBytesNeeded() => repeat last frame
+            memcpy(&m_inputBuffer[(n + 1) * m_numChannels], &m_inputBuffer[n * m_numChannels], m_bytesPerFrame);
+        }
+
+        // linear interpolation
+        double phase = m_phase;
+        for (uint32_t n = 0; n < frames; ++n)
+        {
+            uint32_t idx = uint32_t(phase);
+            float frac = phase - idx;
+            const audioSample_t *x0 = &m_inputBuffer[idx * m_numChannels];
+            const audioSample_t *x1 = x0 + m_numChannels;
+            for (uint_fast8_t c = 0; c < m_numChannels; ++c)
+            {
+                *out++ = AudioDsp::toSample(x0[c] + frac * (x1[c] - x0[c]));
+            }
+            phase += m_ratio;
+        }
+
+        framesConsumed = qMin(framesConsumed, framesRead);
+        memcpy(m_prevFrame.data(), &m_inputBuffer[framesConsumed * m_numChannels], m_bytesPerFrame);
+        m_phase = phaseEnd - uint32_t(phaseEnd);
+
+        consumedBytes += uint64_t(framesConsumed) * m_bytesPerFrame;
+        availableFrames -= framesConsumed;
+        numFrames -= frames;
+    }
+
+    fifo->tail = (fifo->tail + consumedBytes) % fifo->size;
+
+    return consumedBytes;
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AUDIOJITTERBUFFER_H
+#define AUDIOJITTERBUFFER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "audiofifo.h"
+
+// minimum target FIFO fill [chunks], maximum is half of FIFO size
+#define AUDIO_JITTER_BUFFER_MIN_CHUNKS (3)
+// target is decreased by one chunk after this time without underrun [ms]
+#define AUDIO_JITTER_BUFFER_DECREASE_MS (5 * 60 * 1000)
+// maximum resampling ratio deviation from 1.0 used for drift compensation (1000 ppm is not audible)
+#define AUDIO_JITTER_BUFFER_MAX_DRIFT (0.001)
+
+// Adaptive jitter buffer used by audio output backends to read from AudioFifo
+// Target FIFO fill is increased on each underrun and slowly decreased when playback is stable.
+// Clock drift between DAB transmitter and sound card is compensated by a small-ratio linear resampler
+// that is controlled by (low pass filtered) FIFO fill error, samples are never dropped or inserted.
+// All methods except init() are realtime safe, they are called from audio output callback.
+class AudioJitterBuffer
+{
+public:
+    explicit AudioJitterBuffer(uint32_t initialTargetChunks);
+
+    // sets stream and FIFO parameters, allocates working buffer
+    void init(uint32_t sampleRate_kHz, uint8_t numChannels, uint32_t chunkMs, uint32_t fifoMs);
+
+    // resets resampler state, to be called before playback starts (unmute)
+    void reset();
+
+    // returns true if FIFO is filled to target level
+    bool isFilled(uint64_t fifoBytes) const { return fifoBytes >= m_targetBytes; }
+
+    // returns number of bytes that must be available in FIFO to produce numFrames
+    uint64_t inputBytesNeeded(uint32_t numFrames) const;
+
+    // reads numFrames resampled frames from fifo to out, fifoBytes is FIFO fill before reading
+    // FIFO tail is updated, returns number of bytes consumed that caller has to commit
+    uint64_t read(audioFifo_t *fifo, audioSample_t *out, uint32_t numFrames, uint64_t fifoBytes);
+
+    // to be called when playback was muted because FIFO ran out of samples, returns true if target was increased
+    bool underrun();
+
+    uint32_t targetMs() const { return m_targetMs; }
+    float ratio() const { return m_ratio; }
+
+private:
+    enum
+    {
+        BlockFrames = 1024,  // resampler works in blocks of this size
+    };
+
+    uint32_t m_initialTargetChunks;
+    uint32_t m_chunkMs = 0;
+    uint32_t m_minMs = 0;
+    uint32_t m_maxMs = 0;
+    uint32_t m_targetMs = 0;
+    uint64_t m_targetBytes = 0;
+    uint32_t m_sampleRate_kHz = 0;
+    uint8_t m_numChannels = 0;
+    uint8_t m_bytesPerFrame = 0;
+
+    // drift compensation
+    float m_fillBytes = 0.0;
+    bool m_isFillValid = false;
+    float m_ratio = 1.0;
+    uint64_t m_framesWithoutUnderrun = 0;
+
+    // resampler state
+    double m_phase = 0.0;
+    std::vector<audioSample_t> m_prevFrame;
+    std::vector<audioSample_t> m_inputBuffer;
+
+    void setTarget(uint32_t targetMs);
+    void peek(const audioFifo_t *fifo, uint64_t offset, audioSample_t *dest, uint32_t numFrames) const;
+};
+
+#endif  // AUDIOJITTERBUFFER_H
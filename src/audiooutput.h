@@ -36,22 +36,11 @@
 #include <QWaitCondition>
 
 #include "audiofifo.h"
-
-// muting
-#define AUDIOOUTPUT_FADE_TIME_MS 60
-// these 2 values must be aligned
-#define AUDIOOUTPUT_FADE_MIN_DB -80.0
-#define AUDIOOUTPUT_FADE_MIN_LIN 0.0001
+#include "audiorenderer.h"
 
 // debug switch
 // #define AUDIOOUTPUT_RAW_FILE_OUT
 
-enum class AudioOutputPlaybackState
-{
-    Muted = 0,
-    Playing = 1,
-};
-
 class AudioOutput : public QObject
 {
     Q_OBJECT
@@ -159,12 +148,10 @@ protected:
     {   // this method is used when no audio device is available
         if (m_currentFifoPtr) {
             // read samples from input buffer
-            m_currentFifoPtr->mutex.lock();
+            uint64_t count = m_currentFifoPtr->count;
             // shifting buffer pointers
-            m_currentFifoPtr->tail = (m_currentFifoPtr->tail + m_currentFifoPtr->count) % AUDIO_FIFO_SIZE;
-            m_currentFifoPtr->count = 0;
-            m_currentFifoPtr->countChanged.wakeAll();
-            m_currentFifoPtr->mutex.unlock();
+            m_currentFifoPtr->tail = (m_currentFifoPtr->tail + count) % m_currentFifoPtr->size;
+            m_currentFifoPtr->commitRead(count);
         }
     }
 };
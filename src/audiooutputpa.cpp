@@ -32,14 +32,26 @@
 #include <QLoggingCategory>
 #include <QThread>
 
+#include "threadplacement.h"
+
 Q_DECLARE_LOGGING_CATEGORY(audioOutput)
 
+// stream sample format matching audioSample_t
+#if USE_FLOAT_AUDIO
+#define AUDIOOUTPUTPA_SAMPLE_FORMAT paFloat32
+#else
+#define AUDIOOUTPUTPA_SAMPLE_FORMAT paInt16
+#endif
+
 AudioOutputPa::AudioOutputPa(QObject *parent) : AudioOutput(parent)
 {
     m_currentFifoPtr = nullptr;
     m_outStream = nullptr;
     m_numChannels = m_sampleRate_kHz = 0;
-    m_linearVolume = 1.0;
+
+    m_cbTimer = new QTimer(this);
+    m_cbTimer->setInterval(100);
+    connect(m_cbTimer, &QTimer::timeout, this, &AudioOutputPa::onCbTimer);
 
     PaError err = Pa_Initialize();
     if (paNoError != err)
@@ -97,7 +109,8 @@ void AudioOutputPa::start(audioFifo_t *buffer)
     uint32_t sRate = buffer->sampleRate;
     uint8_t numCh = buffer->numChannels;
 
-    bool isNewStreamParams = (m_sampleRate_kHz != sRate / 1000) || (m_numChannels != numCh);
+    // port audio callback is called for one FIFO chunk, chunk size depends on latency profile
+    bool isNewStreamParams = (m_sampleRate_kHz != sRate / 1000) || (m_numChannels != numCh) || (m_bufferFrames != buffer->chunkMs * (sRate / 1000));
     if (isNewStreamParams || m_reloadDevice)
     {
         m_reloadDevice = false;
@@ -115,20 +128,15 @@ void AudioOutputPa::start(audioFifo_t *buffer)
         m_sampleRate_kHz = sRate / 1000;
         m_numChannels = numCh;
 
-        m_bytesPerFrame = numCh * sizeof(int16_t);
-        m_bufferFrames = AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz;  // 120 ms (FIFO size should be integer multiple of this)
+        m_bufferFrames = buffer->chunkMs * m_sampleRate_kHz;  // FIFO size is integer multiple of this
 
-        // mute ramp is exponential
-        // value are precalculated to save MIPS in runtime
-        // unmute ramp is then calculated as 2.0 - m_muteFactor in runtime
-        // m_muteFactor is calculated for change from 0dB to AUDIOOUTPUT_FADE_MIN_DB in AUDIOOUTPUT_FADE_TIME_MS
-        m_muteFactor = powf(10, AUDIOOUTPUT_FADE_MIN_DB / (20.0 * AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz));
+        m_renderer.init(m_sampleRate_kHz, m_numChannels, buffer->chunkMs, buffer->sizeMs());
 
 #ifdef Q_OS_LINUX
         /* Open an audio I/O stream. */
         PaError err = Pa_OpenDefaultStream(&m_outStream, 0,       /* no input channels */
                                            numCh,                 /* stereo output */
-                                           paInt16,               /* 16 bit floating point output */
+                                           AUDIOOUTPUTPA_SAMPLE_FORMAT, /* 16 bit integer or 32 bit float output */
                                            sRate, m_bufferFrames, /* frames per buffer, i.e. the number
                                                                   of sample frames that PortAudio will
                                                                   request from the callback. Many apps
@@ -142,7 +150,7 @@ void AudioOutputPa::start(audioFifo_t *buffer)
         PaStreamParameters outputParameters;
         outputParameters.device = deviceIdx;
         outputParameters.channelCount = numCh;
-        outputParameters.sampleFormat = paInt16;
+        outputParameters.sampleFormat = AUDIOOUTPUTPA_SAMPLE_FORMAT;
         outputParameters.suggestedLatency = Pa_GetDeviceInfo(outputParameters.device)->defaultLowOutputLatency;
         outputParameters.hostApiSpecificStreamInfo = nullptr;
 
@@ -181,14 +189,27 @@ void AudioOutputPa::start(audioFifo_t *buffer)
     }
 
     m_currentFifoPtr = buffer;
-    m_playbackState = AudioOutputPlaybackState::Muted;
+    m_renderer.start(buffer);
     m_cbRequest &= ~(Request::Stop | Request::Restart);  // reset stop and restart bits
+    m_cbThreadId = 0;
+    m_isCbThreadRegistered = false;
+    m_cbStatusFlags = 0;
 
     PaError err = Pa_StartStream(m_outStream);
     if (paNoError != err)
     {
         qCCritical(audioOutput) << "Pa_StartStream error:" << Pa_GetErrorText(err);
     }
+    else
+    {
+        m_cbTimer->start();
+        const PaStreamInfo *info = Pa_GetStreamInfo(m_outStream);
+        if (nullptr != info)
+        {
+            LatencyTracer::getInstance()->setOutputDeviceLatency(info->outputLatency * 1000.0);
+            qCInfo(audioOutput, "Output latency: %.1f ms (buffer %u ms)", info->outputLatency * 1000.0, buffer->chunkMs);
+        }
+    }
 }
 
 void AudioOutputPa::restart(audioFifo_t *buffer)
@@ -228,7 +249,7 @@ void AudioOutputPa::mute(bool on)
 
 void AudioOutputPa::setVolume(int value)
 {
-    m_linearVolume = QAudio::convertVolume(value / qreal(100), QAudio::LogarithmicVolumeScale, QAudio::LinearVolumeScale);
+    m_renderer.setVolume(QAudio::convertVolume(value / qreal(100), QAudio::LogarithmicVolumeScale, QAudio::LinearVolumeScale));
 }
 
 int AudioOutputPa::portAudioCb(const void *inputBuffer, void *outputBuffer, unsigned long nBufferFrames, const PaStreamCallbackTimeInfo *timeInfo,
@@ -237,429 +258,40 @@ int AudioOutputPa::portAudioCb(const void *inputBuffer, void *outputBuffer, unsi
     Q_UNUSED(inputBuffer);
     Q_UNUSED(timeInfo);
 
+    if (statusFlags)
+    {  // logged by timer
+        static_cast<AudioOutputPa *>(ctx)->m_cbStatusFlags.fetch_or(statusFlags, std::memory_order_relaxed);
+    }
+
 #ifdef AUDIOOUTPUT_RAW_FILE_OUT
     int ret = static_cast<AudioOutputPa *>(ctx)->portAudioCbPrivate(outputBuffer, nBufferFrames);
     if (static_cast<AudioOutputPa *>(ctx)->m_rawOut)
     {
-        fwrite(outputBuffer, sizeof(int16_t), nBufferFrames * static_cast<AudioOutputPa *>(ctx)->m_numChannels,
+        fwrite(outputBuffer, sizeof(audioSample_t), nBufferFrames * static_cast<AudioOutputPa *>(ctx)->m_numChannels,
                static_cast<AudioOutputPa *>(ctx)->m_rawOut);
     }
     return ret;
 #else
-    if (statusFlags)
-    {
-        qCWarning(audioOutput) << "Port Audio statusFlags =" << statusFlags;
-    }
-
     return static_cast<AudioOutputPa *>(ctx)->portAudioCbPrivate(outputBuffer, nBufferFrames);
 #endif
 }
 
 int AudioOutputPa::portAudioCbPrivate(void *outputBuffer, unsigned long nBufferFrames)
 {
-    // qDebug() << Q_FUNC_INFO << QThread::currentThreadId();
-
-    // read samples from input buffer
-    m_currentFifoPtr->mutex.lock();
-    uint64_t count = m_currentFifoPtr->count;
-    m_currentFifoPtr->mutex.unlock();
-
-    uint64_t bytesToRead = m_bytesPerFrame * nBufferFrames;
-    uint32_t availableSamples = nBufferFrames;
-
     // is any bit is set then mute is requested (mute | stop | restart)
     unsigned int request = m_cbRequest;
 
-    if (AudioOutputPlaybackState::Muted == m_playbackState)
-    {  // muted
-        // condition to unmute is enough samples && !muteFlag
-        if (count > 7 * bytesToRead)
-        {  // enough samples => reading data from input fifo
-            if (Request::None != request)
-            {  // staying muted -> setting output buffer to 0
-                memset(outputBuffer, 0, bytesToRead);
-
-                // shifting buffer pointers
-                m_currentFifoPtr->tail = (m_currentFifoPtr->tail + bytesToRead) % AUDIO_FIFO_SIZE;
-                m_currentFifoPtr->mutex.lock();
-                m_currentFifoPtr->count -= bytesToRead;
-                m_currentFifoPtr->countChanged.wakeAll();
-                m_currentFifoPtr->mutex.unlock();
-
-                if (request & (Request::Stop | Request::Restart))
-                {  // stop or restart requested ==> finish playback
-                    return paComplete;
-                }
-
-                // done
-                return paContinue;
-            }
-            else
-            { /* no request */
-            }
-
-            // at this point we have enough sample to unmute and there is no request => preparing data
-            uint64_t bytesToEnd = AUDIO_FIFO_SIZE - m_currentFifoPtr->tail;
-            if (bytesToEnd < bytesToRead)
-            {
-                float volume = m_linearVolume;
-                if (volume > 0.9)
-                {  // only copy here
-                    memcpy((uint8_t *)outputBuffer, m_currentFifoPtr->buffer + m_currentFifoPtr->tail, bytesToEnd);
-                    memcpy((uint8_t *)outputBuffer + bytesToEnd, m_currentFifoPtr->buffer, (bytesToRead - bytesToEnd));
-                    m_currentFifoPtr->tail = bytesToRead - bytesToEnd;
-                }
-                else
-                {
-                    // memcpy((uint8_t*)outputBuffer, m_currentFifoPtr->buffer+m_currentFifoPtr->tail, bytesToEnd);
-                    int16_t *inDataPtr = (int16_t *)(m_currentFifoPtr->buffer + m_currentFifoPtr->tail);
-                    int16_t *outDataPtr = (int16_t *)outputBuffer;
-                    // each sample is int16 => 2 bytes per samples
-                    uint_fast32_t numSamples = (bytesToEnd >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == bytesToEnd);
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-
-                    // memcpy((uint8_t*)outputBuffer + bytesToEnd, m_inFifoPtr->buffer, (bytesToRead - bytesToEnd));
-                    inDataPtr = (int16_t *)m_currentFifoPtr->buffer;
-                    outDataPtr = (int16_t *)((uint8_t *)outputBuffer + bytesToEnd);
-                    // each sample is int16 => 2 bytes per samples
-                    numSamples = ((bytesToRead - bytesToEnd) >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == (bytesToRead - bytesToEnd));
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-                    m_currentFifoPtr->tail = bytesToRead - bytesToEnd;
-                }
-            }
-            else
-            {
-                float volume = m_linearVolume;
-                if (volume > 0.9)
-                {  // only copy here
-                    memcpy((uint8_t *)outputBuffer, m_currentFifoPtr->buffer + m_currentFifoPtr->tail, bytesToRead);
-                    m_currentFifoPtr->tail += bytesToRead;
-                }
-                else
-                {
-                    // memcpy((uint8_t*) outputBuffer, m_currentFifoPtr->buffer+m_currentFifoPtr->tail, bytesToRead);
-                    int16_t *inDataPtr = (int16_t *)(m_currentFifoPtr->buffer + m_currentFifoPtr->tail);
-                    int16_t *outDataPtr = (int16_t *)outputBuffer;
-                    // each sample is int16 => 2 bytes per samples
-                    uint_fast32_t numSamples = (bytesToRead >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == bytesToRead);
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-
-                    m_currentFifoPtr->tail += bytesToRead;
-                }
-            }
-            m_currentFifoPtr->mutex.lock();
-            m_currentFifoPtr->count -= bytesToRead;
-            m_currentFifoPtr->countChanged.wakeAll();
-            m_currentFifoPtr->mutex.unlock();
-
-            // unmute request
-            request = Request::None;
-        }
-        else
-        {  // not enough samples ==> inserting silence
-            qCDebug(audioOutput, "Muted: Inserting silence [%lu ms]", nBufferFrames / m_sampleRate_kHz);
-            memset(outputBuffer, 0, bytesToRead);
-
-            if (request & (Request::Stop | Request::Restart))
-            {  // stop or restart requested ==> finish playback
-                return paComplete;
-            }
-
-            // done
-            return paContinue;
-        }
+    if (0 == m_cbThreadId.load(std::memory_order_relaxed))
+    {  // first callback of the stream
+        m_cbThreadId.store(ThreadPlacement::currentThreadId(), std::memory_order_relaxed);
     }
-    else
-    {  // (AudioOutputPlaybackState::Muted != m_playbackState)
-        // cannot be anything else than Muted or Playing ==> playing
-
-        // condition to mute is not enough samples || muteFlag
-        if (count < bytesToRead)
-        {  // not enough samples -> reading what we have and filling rest with zeros
-            // minimum mute time is 1ms (m_sampleRate_kHz samples) , if less then hard mute
-            if (m_sampleRate_kHz * m_bytesPerFrame > count)
-            {  // nothing to play (cannot apply mute ramp)
-                qCInfo(audioOutput, "Hard mute [no samples available]");
-                memset(outputBuffer, 0, bytesToRead);
-                m_playbackState = AudioOutputPlaybackState::Muted;
-                return paContinue;
-            }
 
-            // there are some samples available
-            availableSamples = count / m_bytesPerFrame;
+    m_renderer.render(reinterpret_cast<audioSample_t *>(outputBuffer), nBufferFrames, Request::None != request);
 
-            Q_ASSERT(count == availableSamples * m_bytesPerFrame);
-
-            // copy all available samples to output buffer
-            uint64_t bytesToEnd = AUDIO_FIFO_SIZE - m_currentFifoPtr->tail;
-            if (bytesToEnd < count)
-            {
-                float volume = m_linearVolume;
-                if (volume > 0.9)
-                {  // only copy here
-                    memcpy((uint8_t *)outputBuffer, m_currentFifoPtr->buffer + m_currentFifoPtr->tail, bytesToEnd);
-                    memcpy((uint8_t *)outputBuffer + bytesToEnd, m_currentFifoPtr->buffer, (count - bytesToEnd));
-                    m_currentFifoPtr->tail = count - bytesToEnd;
-                }
-                else
-                {
-                    // memcpy((uint8_t*)outputBuffer, m_currentFifoPtr->buffer+m_currentFifoPtr->tail, bytesToEnd);
-                    int16_t *inDataPtr = (int16_t *)(m_currentFifoPtr->buffer + m_currentFifoPtr->tail);
-                    int16_t *outDataPtr = (int16_t *)outputBuffer;
-                    // each sample is int16 => 2 bytes per samples
-                    uint_fast32_t numSamples = (bytesToEnd >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == bytesToEnd);
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-                    // memcpy((uint8_t*)outputBuffer + bytesToEnd, m_inFifoPtr->buffer, (count - bytesToEnd));
-                    inDataPtr = (int16_t *)m_currentFifoPtr->buffer;
-                    // each sample is int16 => 2 bytes per samples
-                    numSamples = ((count - bytesToEnd) >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == (count - bytesToEnd));
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-                    m_currentFifoPtr->tail = count - bytesToEnd;
-                }
-            }
-            else
-            {
-                float volume = m_linearVolume;
-                if (volume > 0.9)
-                {  // only copy here
-                    memcpy((uint8_t *)outputBuffer, m_currentFifoPtr->buffer + m_currentFifoPtr->tail, count);
-                    m_currentFifoPtr->tail += count;
-                }
-                else
-                {
-                    // memcpy((uint8_t*) outputBuffer, m_currentFifoPtr->buffer+m_currentFifoPtr->tail, count);
-                    int16_t *inDataPtr = (int16_t *)(m_currentFifoPtr->buffer + m_currentFifoPtr->tail);
-                    int16_t *outDataPtr = (int16_t *)outputBuffer;
-                    // each sample is int16 => 2 bytes per samples
-                    uint_fast32_t numSamples = (count >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == count);
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-                    m_currentFifoPtr->tail += count;
-                }
-            }
-            // set rest of the samples to be 0
-            memset((uint8_t *)outputBuffer + count, 0, bytesToRead - count);
-
-            m_currentFifoPtr->mutex.lock();
-            m_currentFifoPtr->count -= count;
-            m_currentFifoPtr->countChanged.wakeAll();
-            m_currentFifoPtr->mutex.unlock();
-
-            // request to apply mute ramp
-            request = Request::Mute;
-        }
-        else
-        {  // enough sample available -> reading samples
-            uint64_t bytesToEnd = AUDIO_FIFO_SIZE - m_currentFifoPtr->tail;
-            if (bytesToEnd < bytesToRead)
-            {
-                float volume = m_linearVolume;
-                if (volume > 0.9)
-                {  // only copy here
-                    memcpy((uint8_t *)outputBuffer, m_currentFifoPtr->buffer + m_currentFifoPtr->tail, bytesToEnd);
-                    memcpy((uint8_t *)outputBuffer + bytesToEnd, m_currentFifoPtr->buffer, (bytesToRead - bytesToEnd));
-                    m_currentFifoPtr->tail = bytesToRead - bytesToEnd;
-                }
-                else
-                {
-                    // memcpy((uint8_t*)outputBuffer, m_currentFifoPtr->buffer+m_currentFifoPtr->tail, bytesToEnd);
-                    int16_t *inDataPtr = (int16_t *)(m_currentFifoPtr->buffer + m_currentFifoPtr->tail);
-                    int16_t *outDataPtr = (int16_t *)outputBuffer;
-                    // each sample is int16 => 2 bytes per samples
-                    uint_fast32_t numSamples = (bytesToEnd >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == bytesToEnd);
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-
-                    // memcpy((uint8_t*)outputBuffer + bytesToEnd, m_inFifoPtr->buffer, (bytesToRead - bytesToEnd));
-                    inDataPtr = (int16_t *)m_currentFifoPtr->buffer;
-                    outDataPtr = (int16_t *)((uint8_t *)outputBuffer + bytesToEnd);
-                    // each sample is int16 => 2 bytes per samples
-                    numSamples = ((bytesToRead - bytesToEnd) >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == (bytesToRead - bytesToEnd));
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-                    m_currentFifoPtr->tail = bytesToRead - bytesToEnd;
-                }
-            }
-            else
-            {
-                float volume = m_linearVolume;
-                if (volume > 0.9)
-                {
-                    memcpy((uint8_t *)outputBuffer, m_currentFifoPtr->buffer + m_currentFifoPtr->tail, bytesToRead);
-                    m_currentFifoPtr->tail += bytesToRead;
-                }
-                else
-                {
-                    // memcpy((uint8_t*) outputBuffer, m_currentFifoPtr->buffer+m_currentFifoPtr->tail, bytesToRead);
-                    int16_t *inDataPtr = (int16_t *)(m_currentFifoPtr->buffer + m_currentFifoPtr->tail);
-                    int16_t *outDataPtr = (int16_t *)outputBuffer;
-                    // each sample is int16 => 2 bytes per samples
-                    uint_fast32_t numSamples = (bytesToRead >> 1);
-
-                    Q_ASSERT(numSamples * sizeof(int16_t) == bytesToRead);
-
-                    for (uint_fast32_t n = 0; n < numSamples; ++n)
-                    {
-#if AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND
-                        *outDataPtr++ = int16_t(std::lroundf(volume * *inDataPtr++));
-#else
-                        *outDataPtr++ = int16_t(volume * *inDataPtr++);
-#endif
-                    }
-                    m_currentFifoPtr->tail += bytesToRead;
-                }
-            }
-            m_currentFifoPtr->mutex.lock();
-            m_currentFifoPtr->count -= bytesToRead;
-            m_currentFifoPtr->countChanged.wakeAll();
-            m_currentFifoPtr->mutex.unlock();
-
-            //            if ((Request::Restart & request) && (count >= 4*bytesToRead))
-            //            {   // removing restart flag ==> play all samples we have
-            //                request &= ~Request::Restart;
-            //            }
-
-            if (Request::None == request)
-            {  // done
-                return paContinue;
-            }
-        }
+    if ((request & (Request::Stop | Request::Restart)) && m_renderer.isMuted())
+    {  // stop or restart requested and output is muted ==> finish playback
+        return paComplete;
     }
-
-    // at this point we have buffer that needs to be muted or unmuted
-    // it is indicated by request variable
-
-    // unmute
-    if (Request::None == request)
-    {  // unmute can be requested only when there is enough samples
-        qCInfo(audioOutput) << "Unmuting audio";
-
-        float coe = 2.0 - m_muteFactor;
-        float gain = AUDIOOUTPUT_FADE_MIN_LIN;
-        int16_t *dataPtr = (int16_t *)outputBuffer;
-        for (uint_fast32_t n = 0; n < availableSamples; ++n)
-        {
-            for (uint_fast8_t c = 0; c < m_numChannels; ++c)
-            {
-                *dataPtr = int16_t(std::lroundf(gain * *dataPtr));
-                dataPtr++;
-            }
-            gain = gain * coe;  // after by purpose
-        }
-
-        m_playbackState = AudioOutputPlaybackState::Playing;  // playing
-
-        // done
-        return paContinue;
-    }
-    else
-    {  // there is so request => muting
-        // mute can be requested when there is not enough samples or from HMI
-        qCInfo(audioOutput, "Muting... [available %u samples]", availableSamples);
-        float coe = m_muteFactor;
-        if (availableSamples < AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz)
-        {  // less samples than expected available => need to calculate new coef
-            coe = powf(10, AUDIOOUTPUT_FADE_MIN_DB / (20.0 * availableSamples));
-        }
-
-        float gain = 1.0;
-
-        int16_t *dataPtr = (int16_t *)outputBuffer;
-        for (uint_fast32_t n = 0; n < availableSamples; ++n)
-        {
-            gain = gain * coe;  // before by purpose
-            for (uint_fast8_t c = 0; c < m_numChannels; ++c)
-            {
-                *dataPtr = int16_t(std::lroundf(gain * *dataPtr));
-                dataPtr++;
-            }
-        }
-
-        m_playbackState = AudioOutputPlaybackState::Muted;  // muted
-
-        if (request & (Request::Stop | Request::Restart))
-        {  // stop or restart requested ==> finish playback
-            return paComplete;
-        }
-    }
-
     return paContinue;
 }
 
@@ -669,8 +301,34 @@ void AudioOutputPa::portAudioStreamFinishedCb(void *ctx)
     static_cast<AudioOutputPa *>(ctx)->portAudioStreamFinishedPrivateCb();
 }
 
+void AudioOutputPa::onCbTimer()
+{
+    int64_t tid = m_cbThreadId.load(std::memory_order_relaxed);
+    if (!m_isCbThreadRegistered && (0 != tid))
+    {
+        m_isCbThreadRegistered = true;
+        ThreadPlacement::getInstance()->registerThreadId(tid, ThreadPlacement::AudioOutput);
+    }
+    logCbEvents();
+}
+
+void AudioOutputPa::logCbEvents()
+{
+    PaStreamCallbackFlags statusFlags = m_cbStatusFlags.exchange(0, std::memory_order_relaxed);
+    if (statusFlags)
+    {
+        qCWarning(audioOutput) << "Port Audio statusFlags =" << statusFlags;
+    }
+    m_renderer.logEvents();
+}
+
 void AudioOutputPa::onStreamFinished()
 {
+    m_cbTimer->stop();
+    logCbEvents();
+    m_renderer.logStatistics();
+    ThreadPlacement::getInstance()->unregisterThread(ThreadPlacement::AudioOutput);
+
     if (m_cbRequest & Request::Restart)
     {  // restart was requested (flag is cleared in start routine)
         emit audioOutputRestart();
@@ -37,16 +37,9 @@
 
 #include "audiofifo.h"
 #include "audiooutput.h"
+#include "audiorenderer.h"
 #include "portaudio.h"
 
-#define AUDIOOUTPUT_PORTAUDIO_VOLUME_ROUND 1
-
-// port audio allows to set number of samples in callback
-// this number must be aligned between AUDIOOUTPUT_FADE_TIME_MS and AUDIO_FIFO_CHUNK_MS
-#if (AUDIOOUTPUT_FADE_TIME_MS != AUDIO_FIFO_CHUNK_MS)
-#error "(AUDIOOUTPUT_FADE_TIME_MS != AUDIO_FIFO_CHUNK_MS)"
-#endif
-
 class AudioOutputPa : public AudioOutput
 {
     Q_OBJECT
@@ -75,11 +68,14 @@ private:
     uint8_t m_numChannels;
     uint32_t m_sampleRate_kHz;
     unsigned int m_bufferFrames;
-    uint8_t m_bytesPerFrame;
-    float m_muteFactor;
-    std::atomic<float> m_linearVolume;
-    AudioOutputPlaybackState m_playbackState;
+    AudioRenderer m_renderer{7};  // initial jitter buffer target in FIFO chunks
     bool m_reloadDevice = false;
+    // callback must not block: it stores its thread id and status flags, timer registers the thread for placement
+    // and logs flags and renderer events from GUI thread
+    std::atomic<int64_t> m_cbThreadId = 0;
+    bool m_isCbThreadRegistered = false;
+    std::atomic<PaStreamCallbackFlags> m_cbStatusFlags = 0;
+    QTimer *m_cbTimer = nullptr;
 
     int portAudioCbPrivate(void *outputBuffer, unsigned long nBufferFrames);
     void portAudioStreamFinishedPrivateCb() { emit streamFinished(); }
@@ -93,6 +89,8 @@ private:
 #endif
 
     void onStreamFinished();
+    void onCbTimer();
+    void logCbEvents();
     PaDeviceIndex getCurrentDeviceIdx();
 
 signals:
@@ -40,6 +40,13 @@
 
 Q_LOGGING_CATEGORY(audioOutput, "AudioOutput", QtInfoMsg)
 
+// sink sample format matching audioSample_t
+#if USE_FLOAT_AUDIO
+#define AUDIOOUTPUTQT_SAMPLE_FORMAT QAudioFormat::Float
+#else
+#define AUDIOOUTPUTQT_SAMPLE_FORMAT QAudioFormat::Int16
+#endif
+
 AudioOutputQt::AudioOutputQt(QObject *parent) : AudioOutput(parent)
 {
     m_audioSink = nullptr;
@@ -76,7 +83,7 @@ void AudioOutputQt::start(audioFifo_t *buffer)
 
     QAudioFormat format;
     format.setSampleRate(sRate);
-    format.setSampleFormat(QAudioFormat::Int16);
+    format.setSampleFormat(AUDIOOUTPUTQT_SAMPLE_FORMAT);
     format.setChannelCount(numCh);
     if (numCh > 1)
     {
@@ -118,6 +125,14 @@ void AudioOutputQt::start(audioFifo_t *buffer)
     m_ioDevice->start();
     m_audioSink->start(m_ioDevice);
 
+    // sink buffer size is known after start
+    if (format.bytesPerFrame() > 0)
+    {
+        float latencyMs = m_audioSink->bufferSize() * 1000.0 / (format.bytesPerFrame() * format.sampleRate());
+        LatencyTracer::getInstance()->setOutputDeviceLatency(latencyMs);
+        qCInfo(audioOutput, "Output latency: %.1f ms (FIFO chunk %u ms)", latencyMs, buffer->chunkMs);
+    }
+
     // Reset restart counter on successful start
     resetRestartCounter();
 }
@@ -231,6 +246,7 @@ void AudioOutputQt::stop()
 
 void AudioOutputQt::doStop()
 {
+    m_ioDevice->logStatistics();
     m_audioSink->stop();
     m_ioDevice->close();
 
@@ -243,6 +259,7 @@ void AudioOutputQt::doStop()
 void AudioOutputQt::doRestart(audioFifo_t *buffer)
 {
     m_restartFifoPtr = nullptr;
+    m_ioDevice->logStatistics();
     m_audioSink->stop();
     emit audioOutputRestart();
     start(buffer);
@@ -355,29 +372,31 @@ void AudioOutputQt::handleStateChanged(QAudio::State newState)
 }
 
 AudioIODevice::AudioIODevice(QObject *parent) : QIODevice(parent)
-{}
+{
+    m_eventTimer = new QTimer(this);
+    m_eventTimer->setInterval(100);
+    connect(m_eventTimer, &QTimer::timeout, this, [this]() { m_renderer.logEvents(); });
+
+#ifdef Q_OS_ANDROID
+    // some Android audio implementations request large buffers, playback starts only with enough margin
+    m_renderer.setUnmuteMargin(10);
+#endif
+}
 
 void AudioIODevice::setBuffer(audioFifo_t *buffer)
 {
     m_inFifoPtr = buffer;
-
-    m_sampleRate_kHz = buffer->sampleRate / 1000;
-    m_numChannels = buffer->numChannels;
-    m_bytesPerFrame = m_numChannels * sizeof(int16_t);
-
-    // mute ramp is exponential
-    // value are precalculated to save MIPS in runtime
-    // unmute ramp is then calculated as 2.0 - m_muteFactor in runtime
-    // m_muteFactor is calculated for change from 0dB to AUDIOOUTPUT_FADE_MIN_DB in AUDIOOUTPUT_FADE_TIME_MS
-    m_muteFactor = powf(10, AUDIOOUTPUT_FADE_MIN_DB / (20.0 * AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz));
+    m_bytesPerFrame = buffer->numChannels * sizeof(audioSample_t);
+    m_renderer.init(buffer->sampleRate / 1000, buffer->numChannels, buffer->chunkMs, buffer->sizeMs());
 }
 
 void AudioIODevice::start()
 {
     m_stopFlag = false;
     m_doStop = false;
-    m_playbackState = AudioOutputPlaybackState::Muted;
+    m_renderer.start(m_inFifoPtr);
     open(QIODevice::ReadOnly);
+    m_eventTimer->start();
 
     // for testing of error
     // QTimer::singleShot(10000, this, [this](){ m_doStop = true; } );
@@ -391,7 +410,7 @@ void AudioIODevice::start()
     connect(m_statsTimer, &QTimer::timeout, this,
             [this]()
             {
-                qDebug() << "Output    " << m_byteCounter * 0.1 << m_bufferFullnessAvrg * 1.0 / (AUDIO_FIFO_SIZE * m_avrgCntr);
+                qDebug() << "Output    " << m_byteCounter * 0.1 << m_bufferFullnessAvrg * 1.0 / (m_inFifoPtr->size * m_avrgCntr);
                 m_bufferFullnessAvrg = 0;
                 m_avrgCntr = 0;
                 m_byteCounter = 0;
@@ -407,6 +426,13 @@ void AudioIODevice::stop()
     m_stopFlag = true;  // set stop bit
 }
 
+void AudioIODevice::logStatistics()
+{  // playback is finished
+    m_eventTimer->stop();
+    m_renderer.logEvents();
+    m_renderer.logStatistics();
+}
+
 qint64 AudioIODevice::readData(char *data, qint64 len)
 {
     if (m_doStop || (0 == len))
@@ -414,192 +440,26 @@ qint64 AudioIODevice::readData(char *data, qint64 len)
         return 0;
     }
 
-    // read samples from input buffer
-    m_inFifoPtr->mutex.lock();
-    uint64_t count = m_inFifoPtr->count;
-    m_inFifoPtr->mutex.unlock();
-
     bool muteRequest = m_muteFlag || m_stopFlag;
     m_doStop = m_stopFlag;
 
-    uint64_t bytesToRead = len;
-
-    uint64_t numSamples = len / m_bytesPerFrame;
+    uint32_t numFrames = len / m_bytesPerFrame;
 
 #ifdef AUDIO_DEBUG_STATS
     m_byteCounter += len;
-    m_bufferFullnessAvrg += count;
+    m_bufferFullnessAvrg += m_inFifoPtr->count;
     m_avrgCntr++;
 #endif
-    // qDebug() << "Audio:" << len << count << count * 1.0 / AUDIO_FIFO_SIZE << m_muteFlag << m_stopFlag;
 
-    if (AudioOutputPlaybackState::Muted == m_playbackState)
-    {  // muted
-       // condition to unmute is enough samples
 #ifdef Q_OS_ANDROID
-       // if (count > 1000 * m_sampleRate_kHz * m_bytesPerFrame)  // 1000ms of signal
-        if (count > 10 * len)  // dynamic condition. depends how much is requested
-#else
-        if (count > 500 * m_sampleRate_kHz * m_bytesPerFrame)  // 500ms of signal
+    bool wasMuted = m_renderer.isMuted();
 #endif
-        {  // enough samples => reading data from input fifo
-            if (muteRequest)
-            {  // staying muted -> setting output buffer to 0
-                memset(data, 0, bytesToRead);
-
-                // shifting buffer pointers
-                m_inFifoPtr->tail = (m_inFifoPtr->tail + bytesToRead) % AUDIO_FIFO_SIZE;
-                m_inFifoPtr->mutex.lock();
-                m_inFifoPtr->count -= bytesToRead;
-                m_inFifoPtr->countChanged.wakeAll();
-                m_inFifoPtr->mutex.unlock();
-
-                // done
-                return bytesToRead;
-            }
-            else
-            { /* no request */
-            }
-
-            // at this point we have enough sample to unmute and there is no request => preparing data
-            uint64_t bytesToEnd = AUDIO_FIFO_SIZE - m_inFifoPtr->tail;
-            if (bytesToEnd < bytesToRead)
-            {
-                memcpy((uint8_t *)data, m_inFifoPtr->buffer + m_inFifoPtr->tail, bytesToEnd);
-                memcpy((uint8_t *)data + bytesToEnd, m_inFifoPtr->buffer, (bytesToRead - bytesToEnd));
-                m_inFifoPtr->tail = bytesToRead - bytesToEnd;
-            }
-            else
-            {
-                memcpy((uint8_t *)data, m_inFifoPtr->buffer + m_inFifoPtr->tail, bytesToRead);
-                m_inFifoPtr->tail += bytesToRead;
-            }
-
-            m_inFifoPtr->mutex.lock();
-            m_inFifoPtr->count -= bytesToRead;
-            m_inFifoPtr->countChanged.wakeAll();
-            m_inFifoPtr->mutex.unlock();
-
-            // unmute request
-            muteRequest = false;
-        }
-        else
-        {  // not enough samples ==> inserting silence
-            qCDebug(audioOutput, "Muted: Inserting silence [%u ms]", static_cast<unsigned int>(bytesToRead / (m_bytesPerFrame * m_sampleRate_kHz)));
-
-            memset(data, 0, bytesToRead);
-
-            // done
-            return bytesToRead;
-        }
-    }
-    else
-    {  // (AudioOutputPlaybackState::Muted != m_playbackState)
-        // cannot be anything else than Muted or Playing ==> playing
-
-        // condition to mute is not enough samples || muteFlag
-        if (count < bytesToRead)
-        {  // not enough samples -> reading what we have and filling rest with zeros
-            // minimum mute time is 1ms (m_sampleRate_kHz samples) , if less then hard mute
-            if (m_sampleRate_kHz * m_bytesPerFrame > count)
-            {  // nothing to play
-                qCInfo(audioOutput, "Hard mute [no samples available]");
-                memset(data, 0, bytesToRead);
-                m_playbackState = AudioOutputPlaybackState::Muted;
-                return bytesToRead;
-            }
-
-            // there are some samples available
-
-            //            // this condition is to avoid mute when there are still enough samples
-            //            if (!muteRequest && (count > AUDIOOUTPUT_FADE_TIME_MS*m_sampleRate_kHz*m_bytesPerFrame))
-            //            {  // at least 2x mute time is available
-            //                bytesToRead = count - AUDIOOUTPUT_FADE_TIME_MS*m_sampleRate_kHz*m_bytesPerFrame;
-
-            //                uint64_t bytesToEnd = AUDIO_FIFO_SIZE - m_inFifoPtr->tail;
-            //                if (bytesToEnd < bytesToRead)
-            //                {
-            //                    memcpy((uint8_t*)data, m_inFifoPtr->buffer+m_inFifoPtr->tail, bytesToEnd);
-            //                    memcpy((uint8_t*)data + bytesToEnd, m_inFifoPtr->buffer, (bytesToRead - bytesToEnd));
-            //                    m_inFifoPtr->tail = bytesToRead - bytesToEnd;
-            //                }
-            //                else
-            //                {
-            //                    memcpy((uint8_t*) data, m_inFifoPtr->buffer+m_inFifoPtr->tail, bytesToRead);
-            //                    m_inFifoPtr->tail += bytesToRead;
-            //                }
-
-            //                m_inFifoPtr->mutex.lock();
-            //                m_inFifoPtr->count -= bytesToRead;
-            //                m_inFifoPtr->countChanged.wakeAll();
-            //                m_inFifoPtr->mutex.unlock();
-
-            //                return bytesToRead;
-            //            }
-
-            // copy all available samples to output buffer
-            uint64_t bytesToEnd = AUDIO_FIFO_SIZE - m_inFifoPtr->tail;
-            if (bytesToEnd < count)
-            {
-                memcpy((uint8_t *)data, m_inFifoPtr->buffer + m_inFifoPtr->tail, bytesToEnd);
-                memcpy((uint8_t *)data + bytesToEnd, m_inFifoPtr->buffer, (count - bytesToEnd));
-                m_inFifoPtr->tail = count - bytesToEnd;
-            }
-            else
-            {
-                memcpy((uint8_t *)data, m_inFifoPtr->buffer + m_inFifoPtr->tail, count);
-                m_inFifoPtr->tail += count;
-            }
-            // set rest of the samples to be 0
-            memset((uint8_t *)data + count, 0, bytesToRead - count);
-
-            m_inFifoPtr->mutex.lock();
-            m_inFifoPtr->count -= count;
-            m_inFifoPtr->countChanged.wakeAll();
-            m_inFifoPtr->mutex.unlock();
-
-            numSamples = count / m_bytesPerFrame;
 
-            // request to apply mute ramp
-            muteRequest = true;  // mute
-        }
-        else
-        {  // enough sample available -> reading samples
-            uint64_t bytesToEnd = AUDIO_FIFO_SIZE - m_inFifoPtr->tail;
-            if (bytesToEnd < bytesToRead)
-            {
-                memcpy((uint8_t *)data, m_inFifoPtr->buffer + m_inFifoPtr->tail, bytesToEnd);
-                memcpy((uint8_t *)data + bytesToEnd, m_inFifoPtr->buffer, (bytesToRead - bytesToEnd));
-                m_inFifoPtr->tail = bytesToRead - bytesToEnd;
-            }
-            else
-            {
-                memcpy((uint8_t *)data, m_inFifoPtr->buffer + m_inFifoPtr->tail, bytesToRead);
-                m_inFifoPtr->tail += bytesToRead;
-            }
-
-            m_inFifoPtr->mutex.lock();
-            m_inFifoPtr->count -= bytesToRead;
-            m_inFifoPtr->countChanged.wakeAll();
-            m_inFifoPtr->mutex.unlock();
-
-            if (!muteRequest)
-            {  // done
-                return bytesToRead;
-            }
-        }
-    }
-
-    // at this point we have buffer that needs to be muted or unmuted
-    // it is indicated by playbackState variable
-
-    // unmute
-    if (false == muteRequest)
-    {  // unmute can be requested only when there is enough samples
-        qCInfo(audioOutput) << "Unmuting audio";
+    m_renderer.render(reinterpret_cast<audioSample_t *>(data), numFrames, muteRequest);
 
 #ifdef Q_OS_ANDROID
-        // Notify Android that playback is active to reset timeout
+    if (wasMuted && !m_renderer.isMuted())
+    {  // Notify Android that playback is active to reset timeout
         try
         {
             QJniObject::callStaticMethod<void>("org/qtproject/abracadabra/AudioServiceHelper", "onPlaybackActive", "()V");
@@ -608,73 +468,10 @@ qint64 AudioIODevice::readData(char *data, qint64 len)
         {
             // Ignore exceptions
         }
-#endif
-
-        float coe = 2.0 - m_muteFactor;
-        if (numSamples < AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz)
-        {
-            coe = 2.0 - powf(10, AUDIOOUTPUT_FADE_MIN_DB / (20.0 * numSamples));
-        }
-        else
-        {
-            numSamples = AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz;
-        }
-
-        float gain = AUDIOOUTPUT_FADE_MIN_LIN;
-        int16_t *dataPtr = (int16_t *)data;
-        for (uint_fast32_t n = 0; n < numSamples; ++n)
-        {
-            for (uint_fast8_t c = 0; c < m_numChannels; ++c)
-            {
-                *dataPtr = int16_t(qRound(gain * *dataPtr));
-                dataPtr++;
-            }
-            gain = gain * coe;  // after by purpose
-        }
-        m_playbackState = AudioOutputPlaybackState::Playing;  // playing
-
-        return bytesToRead;
-    }
-    else
-    {  // mute can be requested when there is not enough samples or from HMI
-        qCInfo(audioOutput, "Muting... [available %u samples]", static_cast<unsigned int>(numSamples));
-        if (numSamples < AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz)
-        {
-            float gain = 1.0;
-            float coe = powf(10, AUDIOOUTPUT_FADE_MIN_DB / (20.0 * numSamples));
-
-            int16_t *dataPtr = (int16_t *)data;
-            for (uint_fast32_t n = 0; n < numSamples; ++n)
-            {
-                gain = gain * coe;  // before by purpose
-                for (uint_fast8_t c = 0; c < m_numChannels; ++c)
-                {
-                    *dataPtr = int16_t(qRound(gain * *dataPtr));
-                    dataPtr++;
-                }
-            }
-        }
-        else
-        {
-            float gain = 1.0;
-            float coe = m_muteFactor;
-
-            int16_t *dataPtr = (int16_t *)data;
-            for (uint_fast32_t n = 0; n < AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz; ++n)
-            {
-                gain = gain * coe;  // before by purpose
-                for (uint_fast8_t c = 0; c < m_numChannels; ++c)
-                {
-                    *dataPtr = int16_t(qRound(gain * *dataPtr));
-                    dataPtr++;
-                }
-            }
-            memset(dataPtr, 0, bytesToRead - AUDIOOUTPUT_FADE_TIME_MS * m_sampleRate_kHz * m_bytesPerFrame);
-        }
-        m_playbackState = AudioOutputPlaybackState::Muted;  // muted
     }
+#endif
 
-    return bytesToRead;
+    return qint64(numFrames) * m_bytesPerFrame;
 }
 
 qint64 AudioIODevice::writeData(const char *data, qint64 len)
@@ -750,9 +547,7 @@ void AudioOutputQt::updateAndroidNotification(const QString &title, const QStrin
 
 qint64 AudioIODevice::bytesAvailable() const
 {
-    m_inFifoPtr->mutex.lock();
     int64_t count = m_inFifoPtr->count;
-    m_inFifoPtr->mutex.unlock();
 
 #ifdef Q_OS_ANDROID
     // On Android, always report data available when device is open and not stopping.
@@ -38,6 +38,14 @@
 
 #include "audiofifo.h"
 #include "audiooutput.h"
+#include "audiorenderer.h"
+
+// initial jitter buffer target in FIFO chunks
+#ifdef Q_OS_ANDROID
+#define AUDIOOUTPUTQT_JITTER_BUFFER_CHUNKS (3)
+#else
+#define AUDIOOUTPUTQT_JITTER_BUFFER_CHUNKS (8)
+#endif
 
 class AudioIODevice;
 
@@ -95,21 +103,22 @@ public:
     qint64 bytesAvailable() const override;
 
     void mute(bool on);
-    bool isMuted() const { return AudioOutputPlaybackState::Muted == m_playbackState; }
+    bool isMuted() const { return m_renderer.isMuted(); }
     bool isStopRequested() const { return m_stopFlag; }
+    void logStatistics();
 
 private:
     audioFifo_t *m_inFifoPtr = nullptr;
-    AudioOutputPlaybackState m_playbackState;
+    AudioRenderer m_renderer{AUDIOOUTPUTQT_JITTER_BUFFER_CHUNKS};
     uint8_t m_bytesPerFrame;
-    uint32_t m_sampleRate_kHz;
-    uint8_t m_numChannels;
-    float m_muteFactor;
     bool m_doStop = false;
 
     std::atomic<bool> m_muteFlag = false;
     std::atomic<bool> m_stopFlag = false;
 
+    // readData() can be called from audio thread, renderer events are logged by timer
+    QTimer *m_eventTimer = nullptr;
+
 #ifdef AUDIO_DEBUG_STATS
     QTimer *m_statsTimer = nullptr;
     int m_byteCounter = 0;
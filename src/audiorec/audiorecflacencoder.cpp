@@ -0,0 +1,278 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "audiorecflacencoder.h"
+
+#include <QLoggingCategory>
+#include <QtEndian>
+
+Q_LOGGING_CATEGORY(audioRecFlac, "AudioRecFlac", QtInfoMsg)
+
+// fLaC marker + STREAMINFO block
+#define FLAC_SEEKTABLE_POS (4 + 4 + 34)
+#define FLAC_SEEKPOINT_SIZE (18)
+
+AudioRecFlacEncoder::AudioRecFlacEncoder(QFile *file, int sampleRate, int compressionLevel)
+    : m_file(file), m_sampleRate(sampleRate), m_compressionLevel(compressionLevel)
+{}
+
+AudioRecFlacEncoder::~AudioRecFlacEncoder()
+{
+    if (nullptr != m_encoder)
+    {
+        FLAC__stream_encoder_delete(m_encoder);
+    }
+    for (auto metadata : m_metadata)
+    {
+        if (nullptr != metadata)
+        {
+            FLAC__metadata_object_delete(metadata);
+        }
+    }
+}
+
+bool AudioRecFlacEncoder::open(const Metadata &metadata)
+{
+    m_encoder = FLAC__stream_encoder_new();
+    if (nullptr == m_encoder)
+    {
+        qCWarning(audioRecFlac) << "Failed to create FLAC encoder";
+        return false;
+    }
+
+    bool ok = FLAC__stream_encoder_set_verify(m_encoder, false);
+    ok = ok && FLAC__stream_encoder_set_streamable_subset(m_encoder, true);
+    ok = ok && FLAC__stream_encoder_set_channels(m_encoder, 2);
+    ok = ok && FLAC__stream_encoder_set_bits_per_sample(m_encoder, 16);
+    ok = ok && FLAC__stream_encoder_set_sample_rate(m_encoder, m_sampleRate);
+    ok = ok && FLAC__stream_encoder_set_compression_level(m_encoder, m_compressionLevel);
+
+    // seek table is filled by placeholders, real seek points are written when recording is finished
+    m_metadata[0] = FLAC__metadata_object_new(FLAC__METADATA_TYPE_SEEKTABLE);
+    m_metadata[1] = FLAC__metadata_object_new(FLAC__METADATA_TYPE_VORBIS_COMMENT);
+    m_metadata[2] = FLAC__metadata_object_new(FLAC__METADATA_TYPE_PADDING);
+    ok = ok && (nullptr != m_metadata[0]) && (nullptr != m_metadata[1]) && (nullptr != m_metadata[2]);
+    ok = ok && FLAC__metadata_object_seektable_template_append_placeholders(m_metadata[0], AUDIORECFLAC_SEEKPOINTS);
+    for (const auto &item : metadata)
+    {
+        FLAC__StreamMetadata_VorbisComment_Entry entry;
+        ok = ok && FLAC__metadata_object_vorbiscomment_entry_from_name_value_pair(&entry, item.first.toUtf8().constData(),
+                                                                                   item.second.toUtf8().constData());
+        ok = ok && FLAC__metadata_object_vorbiscomment_append_comment(m_metadata[1], entry, false);
+    }
+    if (ok)
+    {
+        m_metadata[2]->length = AUDIORECFLAC_PADDING;
+        ok = FLAC__stream_encoder_set_metadata(m_encoder, m_metadata, 3);
+    }
+    if (!ok)
+    {
+        qCWarning(audioRecFlac) << "Failed to configure FLAC encoder";
+        return false;
+    }
+
+    FLAC__StreamEncoderInitStatus status =
+        FLAC__stream_encoder_init_stream(m_encoder, &AudioRecFlacEncoder::writeCallback, &AudioRecFlacEncoder::seekCallback,
+                                         &AudioRecFlacEncoder::tellCallback, nullptr, this);
+    if (FLAC__STREAM_ENCODER_INIT_STATUS_OK != status)
+    {
+        qCWarning(audioRecFlac) << "Failed to initialize FLAC encoder:" << FLAC__StreamEncoderInitStatusString[status];
+        return false;
+    }
+    return true;
+}
+
+bool AudioRecFlacEncoder::encode(const int16_t *data, size_t numSamples)
+{
+    m_buffer.resize(numSamples);
+    for (size_t n = 0; n < numSamples; ++n)
+    {
+        m_buffer[n] = data[n];
+    }
+    if (!FLAC__stream_encoder_process_interleaved(m_encoder, m_buffer.data(), numSamples / 2))
+    {
+        qCWarning(audioRecFlac) << "FLAC encoder error:" << FLAC__stream_encoder_get_resolved_state_string(m_encoder);
+        return false;
+    }
+    return true;
+}
+
+bool AudioRecFlacEncoder::close(const Metadata &metadata)
+{
+    // encoder updates STREAMINFO (length, MD5)
+    bool ok = FLAC__stream_encoder_finish(m_encoder);
+    if (ok && (m_firstFrameOffset > 0))
+    {
+        ok = rewriteMetadata(metadata);
+    }
+    return ok;
+}
+
+bool AudioRecFlacEncoder::rewriteMetadata(const Metadata &metadata)
+{
+    // seek table
+    std::vector<SeekPoint> points;
+    if (m_seekPoints.size() > AUDIORECFLAC_SEEKPOINTS)
+    {  // recording is longer than expected, seek points are decimated to fit the table
+        for (size_t n = 0; n < AUDIORECFLAC_SEEKPOINTS; ++n)
+        {
+            points.push_back(m_seekPoints[(n * m_seekPoints.size()) / AUDIORECFLAC_SEEKPOINTS]);
+        }
+    }
+    else
+    {
+        points = m_seekPoints;
+    }
+    QByteArray seekTable(AUDIORECFLAC_SEEKPOINTS * FLAC_SEEKPOINT_SIZE, '\0');
+    uchar *ptr = reinterpret_cast<uchar *>(seekTable.data());
+    for (size_t n = 0; n < AUDIORECFLAC_SEEKPOINTS; ++n)
+    {
+        if (n < points.size())
+        {
+            qToBigEndian<quint64>(points[n].sampleNumber, ptr);
+            qToBigEndian<quint64>(points[n].offset, ptr + 8);
+            qToBigEndian<quint16>(points[n].frameSamples, ptr + 16);
+        }
+        else
+        {
+            qToBigEndian<quint64>(FLAC__STREAM_METADATA_SEEKPOINT_PLACEHOLDER, ptr);
+        }
+        ptr += FLAC_SEEKPOINT_SIZE;
+    }
+
+    // Vorbis comment and padding fill the space between seek table and first audio frame
+    qint64 commentPos = FLAC_SEEKTABLE_POS + 4 + seekTable.size();
+    qint64 spaceSize = m_firstFrameOffset - commentPos;
+    QByteArray comment = vorbisComment(metadata, spaceSize - 2 * 4);
+    if (comment.isEmpty())
+    {
+        qCWarning(audioRecFlac) << "Unable to write FLAC metadata";
+        return false;
+    }
+
+    QByteArray block(spaceSize, '\0');
+    block[0] = FLAC__METADATA_TYPE_VORBIS_COMMENT;
+    block[1] = (comment.size() >> 16) & 0xFF;
+    block[2] = (comment.size() >> 8) & 0xFF;
+    block[3] = comment.size() & 0xFF;
+    block.replace(4, comment.size(), comment);
+    qint64 paddingPos = 4 + comment.size();
+    qint64 paddingSize = spaceSize - paddingPos - 4;
+    block[paddingPos] = 0x80 | FLAC__METADATA_TYPE_PADDING;  // last metadata block
+    block[paddingPos + 1] = (paddingSize >> 16) & 0xFF;
+    block[paddingPos + 2] = (paddingSize >> 8) & 0xFF;
+    block[paddingPos + 3] = paddingSize & 0xFF;
+
+    bool ok = m_file->seek(FLAC_SEEKTABLE_POS + 4) && (m_file->write(seekTable) == seekTable.size());
+    ok = ok && m_file->seek(commentPos) && (m_file->write(block) == block.size());
+    return ok;
+}
+
+QByteArray AudioRecFlacEncoder::vorbisComment(const Metadata &metadata, qint64 maxSize) const
+{
+    QList<QByteArray> entries;
+    for (const auto &item : metadata)
+    {
+        entries.append(item.first.toUtf8() + '=' + item.second.toUtf8());
+    }
+
+    QByteArray vendor(FLAC__VENDOR_STRING);
+    auto size = [&vendor, &entries]()
+    {
+        qint64 size = 4 + vendor.size() + 4;
+        for (const auto &entry : entries)
+        {
+            size += 4 + entry.size();
+        }
+        return size;
+    };
+    while (!entries.isEmpty() && (size() > maxSize))
+    {  // latest entries are dropped, reserved space is large enough for many hours of DL messages
+        qCWarning(audioRecFlac) << "FLAC metadata does not fit to reserved space, dropping:" << entries.last();
+        entries.removeLast();
+    }
+    if (size() > maxSize)
+    {
+        return QByteArray();
+    }
+
+    QByteArray comment;
+    uchar le[4];
+    qToLittleEndian<quint32>(vendor.size(), le);
+    comment.append(reinterpret_cast<const char *>(le), 4);
+    comment.append(vendor);
+    qToLittleEndian<quint32>(entries.size(), le);
+    comment.append(reinterpret_cast<const char *>(le), 4);
+    for (const auto &entry : entries)
+    {
+        qToLittleEndian<quint32>(entry.size(), le);
+        comment.append(reinterpret_cast<const char *>(le), 4);
+        comment.append(entry);
+    }
+    return comment;
+}
+
+FLAC__StreamEncoderWriteStatus AudioRecFlacEncoder::writeCallback(const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[], size_t bytes,
+                                                                  uint32_t samples, uint32_t currentFrame, void *ctx)
+{
+    Q_UNUSED(encoder);
+    Q_UNUSED(currentFrame);
+    AudioRecFlacEncoder *flac = static_cast<AudioRecFlacEncoder *>(ctx);
+    if (samples > 0)
+    {  // audio frame (metadata is written with zero samples)
+        qint64 offset = flac->m_file->pos();
+        if (flac->m_firstFrameOffset < 0)
+        {
+            flac->m_firstFrameOffset = offset;
+        }
+        if (flac->m_samplesEncoded >= flac->m_nextSeekPointSample)
+        {
+            flac->m_seekPoints.push_back({flac->m_samplesEncoded, uint64_t(offset - flac->m_firstFrameOffset), uint16_t(samples)});
+            flac->m_nextSeekPointSample += flac->m_sampleRate * AUDIORECFLAC_SEEKPOINT_SEC;
+        }
+        flac->m_samplesEncoded += samples;
+    }
+    if (flac->m_file->write(reinterpret_cast<const char *>(buffer), bytes) != qint64(bytes))
+    {
+        return FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+    }
+    return FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+}
+
+FLAC__StreamEncoderSeekStatus AudioRecFlacEncoder::seekCallback(const FLAC__StreamEncoder *encoder, FLAC__uint64 absoluteByteOffset, void *ctx)
+{
+    Q_UNUSED(encoder);
+    AudioRecFlacEncoder *flac = static_cast<AudioRecFlacEncoder *>(ctx);
+    return flac->m_file->seek(absoluteByteOffset) ? FLAC__STREAM_ENCODER_SEEK_STATUS_OK : FLAC__STREAM_ENCODER_SEEK_STATUS_ERROR;
+}
+
+FLAC__StreamEncoderTellStatus AudioRecFlacEncoder::tellCallback(const FLAC__StreamEncoder *encoder, FLAC__uint64 *absoluteByteOffset, void *ctx)
+{
+    Q_UNUSED(encoder);
+    AudioRecFlacEncoder *flac = static_cast<AudioRecFlacEncoder *>(ctx);
+    *absoluteByteOffset = flac->m_file->pos();
+    return FLAC__STREAM_ENCODER_TELL_STATUS_OK;
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AUDIORECFLACENCODER_H
+#define AUDIORECFLACENCODER_H
+
+#include <FLAC/stream_encoder.h>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <vector>
+
+#define AUDIORECFLAC_SEEKPOINT_SEC (10)       // seek point every 10 seconds
+#define AUDIORECFLAC_SEEKPOINTS (12 * 360)    // reserved seek points, longer recordings use sparser seek table
+#define AUDIORECFLAC_PADDING (128 * 1024)     // reserved space for metadata added during recording (DL)
+
+// Encodes 16bit stereo PCM to seekable FLAC file
+// Seek table and Vorbis comments are written in place when the encoding is finished
+class AudioRecFlacEncoder
+{
+public:
+    using Metadata = QList<QPair<QString, QString>>;
+
+    AudioRecFlacEncoder(QFile *file, int sampleRate, int compressionLevel);
+    ~AudioRecFlacEncoder();
+    bool open(const Metadata &metadata);
+    bool encode(const int16_t *data, size_t numSamples);
+    bool close(const Metadata &metadata);
+
+private:
+    struct SeekPoint
+    {
+        uint64_t sampleNumber;
+        uint64_t offset;
+        uint16_t frameSamples;
+    };
+
+    QFile *m_file;
+    int m_sampleRate;
+    int m_compressionLevel;
+    FLAC__StreamEncoder *m_encoder = nullptr;
+    FLAC__StreamMetadata *m_metadata[3] = {nullptr, nullptr, nullptr};  // must exist until encoder is finished
+    std::vector<FLAC__int32> m_buffer;
+
+    qint64 m_firstFrameOffset = -1;
+    uint64_t m_samplesEncoded = 0;
+    uint64_t m_nextSeekPointSample = 0;
+    std::vector<SeekPoint> m_seekPoints;
+
+    bool rewriteMetadata(const Metadata &metadata);
+    QByteArray vorbisComment(const Metadata &metadata, qint64 maxSize) const;
+
+    static FLAC__StreamEncoderWriteStatus writeCallback(const FLAC__StreamEncoder *encoder, const FLAC__byte buffer[], size_t bytes,
+                                                        uint32_t samples, uint32_t currentFrame, void *ctx);
+    static FLAC__StreamEncoderSeekStatus seekCallback(const FLAC__StreamEncoder *encoder, FLAC__uint64 absoluteByteOffset, void *ctx);
+    static FLAC__StreamEncoderTellStatus tellCallback(const FLAC__StreamEncoder *encoder, FLAC__uint64 *absoluteByteOffset, void *ctx);
+};
+
+#endif  // AUDIORECFLACENCODER_H
@@ -48,9 +48,11 @@ AudioRecManager::AudioRecManager(AudioRecScheduleModel *model, SLModel *slModel,
     m_serviceSelectionModel = new QItemSelectionModel(m_slModel, this);
     connect(this, &AudioRecManager::startRecording, m_recorder, &AudioRecorder::start, Qt::QueuedConnection);
     connect(this, &AudioRecManager::stopRecording, m_recorder, &AudioRecorder::stop, Qt::QueuedConnection);
+    connect(this, &AudioRecManager::recordDLMessage, m_recorder, &AudioRecorder::addDLMessage, Qt::QueuedConnection);
     connect(m_recorder, &AudioRecorder::recordingStarted, this, &AudioRecManager::onAudioRecordingStarted, Qt::QueuedConnection);
     connect(m_recorder, &AudioRecorder::recordingStopped, this, &AudioRecManager::onAudioRecordingStopped, Qt::QueuedConnection);
     connect(m_recorder, &AudioRecorder::recordingProgress, this, &AudioRecManager::onAudioRecordingProgress, Qt::QueuedConnection);
+    connect(m_recorder, &AudioRecorder::recordingStatistics, this, &AudioRecManager::audioRecordingStatistics, Qt::QueuedConnection);
 
     connect(m_scheduleModel, &QAbstractItemModel::modelReset, this, &AudioRecManager::onModelReset);
     connect(m_scheduleModel, &QAbstractItemModel::rowsRemoved, this, &AudioRecManager::onModelRowsRemoved);
@@ -373,6 +375,10 @@ void AudioRecManager::onAudioRecordingStarted(const QString &recpath, const QStr
 {
     m_audioRecordingFile = filename;
     isAudioRecordingActive(true);
+    if (m_settings->audioRec.dl && !m_dlText.isEmpty())
+    {  // DL is also stored in recording metadata (FLAC)
+        emit recordDLMessage(dlMessage(0, m_dlText));
+    }
     if (m_settings->audioRec.dl && (nullptr == m_dlLogFile))
     {
         QFileInfo fi(filename);
@@ -383,14 +389,7 @@ void AudioRecManager::onAudioRecordingStarted(const QString &recpath, const QStr
             QTextStream out(m_dlLogFile);
             if (!m_dlText.isEmpty())
             {
-                if (m_settings->audioRec.dlAbsTime)
-                {
-                    out << "00:00:00\t" << EPGTime::getInstance()->dabTime().toString("yyyy-MM-dd-hhmmss\t") << m_dlText << Qt::endl;
-                }
-                else
-                {
-                    out << "00:00:00\t" << m_dlText << Qt::endl;
-                }
+                out << dlMessage(0, m_dlText) << Qt::endl;
             }
         }
         else
@@ -466,29 +465,35 @@ void AudioRecManager::onDLComplete(const QString &dl)
     if (m_dlText != dl)
     {
         m_dlText = dl;
-        if (m_isAudioRecordingActive && m_dlLogFile)
+        if (m_isAudioRecordingActive && m_settings->audioRec.dl)
         {
-            QTextStream out(m_dlLogFile);
-
-            int hours = m_recTimeSec / 3600;
-            int min = (m_recTimeSec - hours * 3600) / 60;
-            int sec = (m_recTimeSec - hours * 3600 - min * 60);
-            if (m_settings->audioRec.dlAbsTime)
+            QString message = dlMessage(m_recTimeSec, dl);
+            if (m_dlLogFile)
             {
-                out << QString("%1:%2:%3\t%4\t%5\n")
-                           .arg(hours, 2, 10, QChar('0'))
-                           .arg(min, 2, 10, QChar('0'))
-                           .arg(sec, 2, 10, QChar('0'))
-                           .arg(EPGTime::getInstance()->dabTime().toString("yyyy-MM-dd-hhmmss"), dl);
-            }
-            else
-            {
-                out << QString("%1:%2:%3\t%4\n").arg(hours, 2, 10, QChar('0')).arg(min, 2, 10, QChar('0')).arg(sec, 2, 10, QChar('0')).arg(dl);
+                QTextStream out(m_dlLogFile);
+                out << message << "\n";
             }
+            emit recordDLMessage(message);
         }
     }
 }
 
+QString AudioRecManager::dlMessage(qint64 recTimeSec, const QString &dl) const
+{
+    int hours = recTimeSec / 3600;
+    int min = (recTimeSec - hours * 3600) / 60;
+    int sec = (recTimeSec - hours * 3600 - min * 60);
+    if (m_settings->audioRec.dlAbsTime)
+    {
+        return QString("%1:%2:%3\t%4\t%5")
+            .arg(hours, 2, 10, QChar('0'))
+            .arg(min, 2, 10, QChar('0'))
+            .arg(sec, 2, 10, QChar('0'))
+            .arg(EPGTime::getInstance()->dabTime().toString("yyyy-MM-dd-hhmmss"), dl);
+    }
+    return QString("%1:%2:%3\t%4").arg(hours, 2, 10, QChar('0')).arg(min, 2, 10, QChar('0')).arg(sec, 2, 10, QChar('0')).arg(dl);
+}
+
 void AudioRecManager::updateScheduledRecording()
 {
     if (m_scheduleModel->isEmpty())
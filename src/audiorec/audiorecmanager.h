@@ -78,11 +78,13 @@ signals:
     void audioRecordingStarted();
     void audioRecordingStopped();
     void audioRecordingProgress(size_t bytes, qint64 timeSec);
+    void audioRecordingStatistics(int queueDepth, int queueCapacity, int maxWriteLatencyMs);
     void requestServiceSelection(const ServiceListId &serviceId);
 
     // used to communicate with worker
     void startRecording();
     void stopRecording();
+    void recordDLMessage(const QString &message);
 
 protected:
     void timerEvent(QTimerEvent *);
@@ -126,6 +128,7 @@ private:
     void addItem();
     void editItem();
     void updateScheduledRecording();
+    QString dlMessage(qint64 recTimeSec, const QString &dl) const;
     void onModelReset();
     void onModelRowsRemoved(const QModelIndex &, int first, int last);
     void onAudioRecordingStarted(const QString &recpath, const QString &filename);
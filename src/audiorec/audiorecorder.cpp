@@ -31,14 +31,16 @@
 #include <QLoggingCategory>
 #include <QRegularExpression>
 #include <QStandardPaths>
+#include <cstring>
 
 #include "androidfilehelper.h"
+#include "config.h"
 #include "settings.h"
 
 Q_LOGGING_CATEGORY(audioRecorder, "AudioRecorder", QtInfoMsg)
 
 AudioRecorder::AudioRecorder(QObject *parent)
-    : QObject{parent}, m_sid(0), m_doOutputRecording(false), m_file(nullptr), m_recordingState(RecordingState::Stopped)
+    : QObject{parent}, m_sid(0), m_doOutputRecording(false), m_flacLevel(-1), m_writer(nullptr), m_recordingState(RecordingState::Stopped)
 {}
 
 AudioRecorder::~AudioRecorder()
@@ -51,10 +53,23 @@ QString AudioRecorder::recordingPath() const
     return m_recordingPath;
 }
 
-void AudioRecorder::setup(const QString &recordingPath, bool doOutputRecording)
+void AudioRecorder::setup(const QString &recordingPath, bool doOutputRecording, int flacLevel)
 {
     m_recordingPath = recordingPath;
     m_doOutputRecording = doOutputRecording;
+#if HAVE_FLAC
+    m_flacLevel = flacLevel;
+#else
+    m_flacLevel = -1;
+#endif
+}
+
+void AudioRecorder::addDLMessage(const QString &message)
+{
+    if (RecordingState::RecordingFlac == m_recordingState)
+    {
+        m_writer->addMetadata("DL", message);
+    }
 }
 
 void AudioRecorder::setAudioService(const RadioControlServiceComponent &s)
@@ -78,68 +93,45 @@ void AudioRecorder::setDataFormat(int sampleRateKHz, bool isAAC)
     m_isAAC = isAAC;
 }
 
-void AudioRecorder::writeWavHeader()
+void AudioRecorder::updateProgress(size_t bytes, int timeMs)
 {
-    QDataStream out(m_file);
-    out.setByteOrder(QDataStream::LittleEndian);
-
-    // Details: http://soundfile.sapp.org/doc/WaveFormat/
-
-    // RIFF chunk
-    out.writeRawData("RIFF", 4);
-    out << quint32(36 + m_bytesWritten);  // RIFF chunk size (total size - 8)
-    out.writeRawData("WAVE", 4);
-
-    // Format description chunk
-    out.writeRawData("fmt ", 4);
-    out << quint32(16);  // "fmt " chunk size (always 16 for PCM)
-    out << quint16(1);   // data format (1 => PCM)
-    out << quint16(2);   // num channels
-    out << quint32(m_sampleRateKHz * 1000);
-    out << quint32(m_sampleRateKHz * 1000 * 2 * sizeof(int16_t));  // bytes per second
-    out << quint16(2 * sizeof(int16_t));                           // Block align
-    out << quint16(sizeof(int16_t) * 8);                           // Significant Bits Per Sample
-
-    // Data chunk
-    out.writeRawData("data", 4);
-    out << quint32(m_bytesWritten);  // Data chunk size
-    Q_ASSERT(m_file->pos() == 44);   // Must be 44 for WAV PCM
+    m_bytesWritten += bytes;
+    m_timeWrittenMs += timeMs;
+    if (m_timeWrittenMs >= (m_timeSec + 1) * 1000)
+    {
+        m_timeSec += 1;
+        AudioRecWriter::Statistics stats = m_writer->statistics();
+
+        // size of encoded file is known only to writer
+        emit recordingProgress((RecordingState::RecordingFlac == m_recordingState) ? stats.fileBytes : m_bytesWritten, m_timeSec);
+        emit recordingStatistics(stats.queueDepth, stats.queueCapacity, stats.maxLatencyMs);
+    }
 }
 
-void AudioRecorder::writeWav(const int16_t *data, size_t numSamples)
+void AudioRecorder::writeWav(const audioSample_t *data, size_t numSamples)
 {
-    qint64 bytesWritten = m_file->write(reinterpret_cast<const char *>(data), sizeof(int16_t) * numSamples);
-    if (bytesWritten != sizeof(uint16_t) * numSamples)
+#if USE_FLOAT_AUDIO
+    if (m_wavBuffer.size() < numSamples)
     {
-        qCWarning(audioRecorder) << "Error while recoding WAV data";
-        stop();
-        return;
+        m_wavBuffer.resize(numSamples);
     }
-    m_bytesWritten += bytesWritten;
-    m_timeWrittenMs += bytesWritten / (2 * sizeof(int16_t) * m_sampleRateKHz);
-    if (m_timeWrittenMs >= (m_timeSec + 1) * 1000)
+    AudioDsp::toInt16(m_wavBuffer.data(), data, numSamples);
+    const int16_t *wavData = m_wavBuffer.data();
+#else
+    const int16_t *wavData = data;
+#endif
+    size_t bytes = sizeof(int16_t) * numSamples;
+    if (m_writer->write(reinterpret_cast<const char *>(wavData), bytes))
     {
-        m_timeSec += 1;
-        emit recordingProgress(m_bytesWritten, m_timeSec);
+        updateProgress(bytes, bytes / (2 * sizeof(int16_t) * m_sampleRateKHz));
     }
 }
 
 void AudioRecorder::writeMP2(const std::vector<uint8_t> &data)
 {
-    qint64 bytesWritten = m_file->write(reinterpret_cast<const char *>(data.data()), sizeof(uint8_t) * data.size());
-    if (bytesWritten != sizeof(uint8_t) * data.size())
+    if (m_writer->write(reinterpret_cast<const char *>(data.data()), sizeof(uint8_t) * data.size()))
     {
-        qCWarning(audioRecorder) << "Error while recoding MP2 data";
-        stop();
-        return;
-    }
-    m_bytesWritten += bytesWritten;
-    m_timeWrittenMs += (m_sampleRateKHz == 24 ? 48 : 24);
-
-    if (m_timeWrittenMs >= (m_timeSec + 1) * 1000)
-    {
-        m_timeSec += 1;
-        emit recordingProgress(m_bytesWritten, m_timeSec);
+        updateProgress(data.size(), (m_sampleRateKHz == 24 ? 48 : 24));
     }
 }
 
@@ -258,7 +250,12 @@ void AudioRecorder::writeAAC(const std::vector<uint8_t> &data, const dabsdrAudio
     aac_header[1] |= (len >> 8) & 0x1F;
     aac_header[2] = len & 0xFF;
 
-    qint64 bytesWritten = m_file->write(reinterpret_cast<const char *>(aac_header), sizeof(uint8_t) * (9 + aacHeader.bits.sbr_flag + au_size_255));
+    // frame is serialized to buffer and passed to writer in one call
+    size_t headerSize = 9 + aacHeader.bits.sbr_flag + au_size_255;
+    m_frameBuffer.resize(headerSize + au_size + 1);
+    uint8_t *outPtr = m_frameBuffer.data();
+    std::memcpy(outPtr, aac_header, headerSize);
+    outPtr += headerSize;
 
     uint8_t byte = *aac_header_ptr;
     const uint8_t *auPtr = &data[0];  //&buffer[mscDataPtr->au_start[r]];
@@ -266,32 +263,21 @@ void AudioRecorder::writeAAC(const std::vector<uint8_t> &data, const dabsdrAudio
     for (int i = 0; i < au_size; ++i)
     {
         byte |= (*auPtr) >> (5 + sbr_flag);
-        bytesWritten += m_file->write(reinterpret_cast<const char *>(&byte), sizeof(uint8_t));
+        *outPtr++ = byte;
         byte = (uint8_t)*auPtr++ << (3 - sbr_flag);
     }
-    bytesWritten += m_file->write(reinterpret_cast<const char *>(&byte), sizeof(uint8_t));
+    *outPtr = byte;
 
-    if (bytesWritten != sizeof(uint8_t) * (9 + aacHeader.bits.sbr_flag + au_size_255 + au_size + 1))
+    if (m_writer->write(reinterpret_cast<const char *>(m_frameBuffer.data()), m_frameBuffer.size()))
     {
-        qCWarning(audioRecorder) << "Error while recoding AAC data";
-        stop();
-        return;
-    }
-    m_bytesWritten += bytesWritten;
-
-    m_timeWrittenMs += timeMs;
-
-    if (m_timeWrittenMs >= (m_timeSec + 1) * 1000)
-    {
-        m_timeSec += 1;
-        emit recordingProgress(m_bytesWritten, m_timeSec);
+        updateProgress(m_frameBuffer.size(), timeMs);
     }
 }
 
 void AudioRecorder::start()
 {
     static const QRegularExpression regexp("[" + QRegularExpression::escape("/:*?\"<>|") + "]");
-    if (nullptr == m_file)
+    if (nullptr == m_writer)
     {
         const QString recPath = AndroidFileHelper::buildSubdirPath(m_recordingPath, AUDIO_DIR_NAME);
 
@@ -319,9 +305,18 @@ void AudioRecorder::start()
         QString mimeType;
         if (m_doOutputRecording)
         {
-            fileName += ".wav";
-            mimeType = "audio/wav";
-            m_recordingState = RecordingState::RecordingWav;
+            if (m_flacLevel >= 0)
+            {
+                fileName += ".flac";
+                mimeType = "audio/flac";
+                m_recordingState = RecordingState::RecordingFlac;
+            }
+            else
+            {
+                fileName += ".wav";
+                mimeType = "audio/wav";
+                m_recordingState = RecordingState::RecordingWav;
+            }
         }
         else
         {
@@ -339,24 +334,40 @@ void AudioRecorder::start()
             }
         }
 
-        m_file = AndroidFileHelper::openFileForWriting(recPath, fileName, mimeType);
-        if (m_file)
+        QFile *file = AndroidFileHelper::openFileForWriting(recPath, fileName, mimeType);
+        if (file)
         {
             qCInfo(audioRecorder) << "Recording file:" << fileName;
             m_bytesWritten = 0;
             m_timeWrittenMs = 0;
             m_timeSec = 0;
-            if (m_doOutputRecording)
-            {  // reserving WAV header space
-                m_file->write(QByteArray(44, '\x55'));
+
+            // file is written from writer thread, WAV header and FLAC encoding are handled by writer
+            switch (m_recordingState)
+            {
+                case RecordingState::RecordingWav:
+                    m_writer = new AudioRecWriter(file, AudioRecWriter::Format::Wav, m_sampleRateKHz * 1000, this);
+                    break;
+                case RecordingState::RecordingFlac:
+                    m_writer = new AudioRecWriter(file, AudioRecWriter::Format::Flac, m_sampleRateKHz * 1000, this);
+                    m_writer->setFlacCompressionLevel(m_flacLevel);
+                    m_writer->addMetadata("TITLE", QString("%1 %2").arg(m_serviceName.trimmed(), QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm")));
+                    m_writer->addMetadata("ORGANIZATION", m_serviceName.trimmed());
+                    m_writer->addMetadata("DATE", QDateTime::currentDateTime().toString("yyyy-MM-dd"));
+                    m_writer->addMetadata("ENCODER", QString("AbracaDABra %1").arg(PROJECT_VER));
+                    break;
+                default:
+                    m_writer = new AudioRecWriter(file, AudioRecWriter::Format::Raw, 0, this);
+                    break;
             }
+            connect(m_writer, &AudioRecWriter::finished, m_writer, &QObject::deleteLater);
+            m_writer->start();
+
             emit recordingStarted(recPath, fileName);
         }
         else
         {
             qCCritical(audioRecorder) << "Unable to open file:" << fileName;
-            delete m_file;
-            m_file = nullptr;
             m_recordingState = RecordingState::Stopped;
             emit recordingStopped();
         }
@@ -368,17 +379,17 @@ void AudioRecorder::start()
 
 void AudioRecorder::stop()
 {
-    if (nullptr != m_file)
+    if (nullptr != m_writer)
     {
-        if (m_doOutputRecording)
+        AudioRecWriter::Statistics stats = m_writer->statistics();
+        if (stats.droppedBytes > 0)
         {
-            m_file->seek(0);
-            writeWavHeader();
+            qCWarning(audioRecorder) << "Recording data dropped due to slow storage [bytes]:" << stats.droppedBytes;
         }
-        m_file->flush();
-        m_file->close();
-        delete m_file;
-        m_file = nullptr;
+
+        // writer flushes remaining data, updates WAV header and closes the file in its thread
+        m_writer->finish();
+        m_writer = nullptr;
         m_recordingState = RecordingState::Stopped;
         emit recordingStopped();
 
@@ -389,12 +400,18 @@ void AudioRecorder::stop()
     }
 }
 
-void AudioRecorder::recordData(const RadioControlAudioData *inData, const int16_t *outputData, size_t numOutputSamples)
+void AudioRecorder::recordData(const RadioControlAudioData *inData, const audioSample_t *outputData, size_t numOutputSamples)
 {
     if (RecordingState::Stopped == m_recordingState)
     {
         return;
     }
+    if (m_writer->hasError())
+    {
+        qCWarning(audioRecorder) << "Error while recording audio data";
+        stop();
+        return;
+    }
 
     switch (m_recordingState)
     {
@@ -405,6 +422,7 @@ void AudioRecorder::recordData(const RadioControlAudioData *inData, const int16_
             writeMP2(inData->data);
             break;
         case RecordingState::RecordingWav:
+        case RecordingState::RecordingFlac:
             writeWav(outputData, numOutputSamples);
             break;
         default:
@@ -27,9 +27,10 @@
 #ifndef AUDIORECORDER_H
 #define AUDIORECORDER_H
 
-#include <QFile>
 #include <QObject>
 
+#include "audiodsp.h"
+#include "audiorecwriter.h"
 #include "dabsdr.h"
 #include "radiocontrol.h"
 
@@ -42,41 +43,49 @@ public:
         Stopped = 0,
         RecordingMP2,
         RecordingAAC,
-        RecordingWav
+        RecordingWav,
+        RecordingFlac
     };
 
     explicit AudioRecorder(QObject *parent = nullptr);
     ~AudioRecorder();
     QString recordingPath() const;
-    void setup(const QString &recordingPath, bool doOutputRecording = false);
+    void setup(const QString &recordingPath, bool doOutputRecording = false, int flacLevel = -1);
     void setAudioService(const RadioControlServiceComponent &s);
     void setDataFormat(int sampleRateKHz, bool isAAC);
     void start();
     void stop();
-    void recordData(const RadioControlAudioData *inData, const int16_t *outputData, size_t numOutputSamples);
+    void recordData(const RadioControlAudioData *inData, const audioSample_t *outputData, size_t numOutputSamples);
+    void addDLMessage(const QString &message);
 
 signals:
     void recordingStarted(const QString &recpath, const QString &filename);
     void recordingStopped();
     void recordingProgress(size_t bytes, size_t timeSec);
+    void recordingStatistics(int queueDepth, int queueCapacity, int maxWriteLatencyMs);
 
 private:
     QString m_recordingPath;
-    QFile *m_file;
+    AudioRecWriter *m_writer;
     DabSId m_sid;
     QString m_serviceName;
     RecordingState m_recordingState;
     bool m_doOutputRecording;
+    int m_flacLevel;
     size_t m_bytesWritten;
     size_t m_timeSec;
     size_t m_timeWrittenMs;
     int m_sampleRateKHz;
     bool m_isAAC;
+    std::vector<uint8_t> m_frameBuffer;
+#if USE_FLOAT_AUDIO
+    std::vector<int16_t> m_wavBuffer;  // decoded output converted to int16
+#endif
 
     void writeMP2(const std::vector<uint8_t> &data);
     void writeAAC(const std::vector<uint8_t> &data, const dabsdrAudioFrameHeader_t &aacHeader);
-    void writeWav(const int16_t *data, size_t numSamples);
-    void writeWavHeader();
+    void writeWav(const audioSample_t *data, size_t numSamples);
+    void updateProgress(size_t bytes, int timeMs);
 };
 
 #endif  // AUDIORECORDER_H
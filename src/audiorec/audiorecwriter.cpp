@@ -0,0 +1,335 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "audiorecwriter.h"
+
+#include <QDataStream>
+#include <QLoggingCategory>
+#include <cstring>
+
+#if HAVE_FLAC
+#include "audiorecflacencoder.h"
+#endif
+
+Q_LOGGING_CATEGORY(audioRecWriter, "AudioRecWriter", QtInfoMsg)
+
+AudioRecWriter::AudioRecWriter(QFile *file, Format format, int sampleRate, QObject *parent)
+    : QThread(parent), m_file(file), m_format(format), m_sampleRate(sampleRate)
+{
+    m_blocks.resize(AUDIORECWRITER_NUM_BLOCKS);
+    m_pool.reserve(AUDIORECWRITER_NUM_BLOCKS);
+    for (auto &block : m_blocks)
+    {
+        block.data.resize(AUDIORECWRITER_BLOCK_SIZE);
+        m_pool.push_back(&block);
+    }
+}
+
+AudioRecWriter::~AudioRecWriter()
+{
+    finish();
+    wait();
+    delete m_file;
+}
+
+void AudioRecWriter::addMetadata(const QString &key, const QString &value)
+{
+    if (Format::Flac != m_format)
+    {  // not supported
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    m_metadata.append(qMakePair(key, value));
+}
+
+bool AudioRecWriter::write(const char *data, qint64 len)
+{
+    while (len > 0)
+    {
+        if (nullptr == m_currentBlock)
+        {
+            m_currentBlock = acquireBlock();
+            if (nullptr == m_currentBlock)
+            {  // all blocks are waiting for writing, storage is too slow
+                QMutexLocker locker(&m_mutex);
+                if (0 == m_droppedBytes)
+                {
+                    qCWarning(audioRecWriter) << "Write queue is full, recorded data is dropped";
+                }
+                m_droppedBytes += len;
+                return false;
+            }
+            m_blockTimer.start();
+        }
+
+        qint64 num = qMin(len, qint64(AUDIORECWRITER_BLOCK_SIZE) - m_currentBlock->size);
+        std::memcpy(m_currentBlock->data.data() + m_currentBlock->size, data, num);
+        m_currentBlock->size += num;
+        data += num;
+        len -= num;
+
+        if (AUDIORECWRITER_BLOCK_SIZE == m_currentBlock->size)
+        {
+            submitBlock();
+        }
+    }
+
+    if ((nullptr != m_currentBlock) && (m_blockTimer.elapsed() >= AUDIORECWRITER_BLOCK_AGE_MS))
+    {  // low bitrate streams would otherwise stay in memory for a long time
+        submitBlock();
+    }
+    return true;
+}
+
+void AudioRecWriter::finish()
+{
+    if (nullptr != m_currentBlock)
+    {
+        submitBlock();
+    }
+    QMutexLocker locker(&m_mutex);
+    m_stopRequest = true;
+    m_dataAvailable.wakeAll();
+}
+
+AudioRecWriter::Statistics AudioRecWriter::statistics()
+{
+    QMutexLocker locker(&m_mutex);
+    Statistics stats;
+    stats.fileBytes = m_fileBytes;
+    stats.queueDepth = m_queue.size();
+    stats.queueCapacity = AUDIORECWRITER_NUM_BLOCKS;
+    stats.maxLatencyMs = m_latencyMaxNs / 1000000;
+    stats.avgLatencyMs = (m_latencyCount > 0) ? (m_latencySumNs / m_latencyCount / 1000000) : 0;
+    stats.droppedBytes = m_droppedBytes;
+    m_latencyMaxNs = 0;
+    m_latencySumNs = 0;
+    m_latencyCount = 0;
+    return stats;
+}
+
+AudioRecWriter::Block *AudioRecWriter::acquireBlock()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_pool.empty())
+    {
+        return nullptr;
+    }
+    Block *block = m_pool.back();
+    m_pool.pop_back();
+    block->size = 0;
+    return block;
+}
+
+void AudioRecWriter::submitBlock()
+{
+    QMutexLocker locker(&m_mutex);
+    m_queue.push_back(m_currentBlock);
+    m_currentBlock = nullptr;
+    m_dataAvailable.wakeOne();
+}
+
+void AudioRecWriter::run()
+{
+    if (!openFile())
+    {
+        m_error = true;
+    }
+    QElapsedTimer headerTimer;
+    headerTimer.start();
+
+    m_mutex.lock();
+    while (true)
+    {
+        if (m_queue.empty())
+        {
+            if (m_stopRequest)
+            {
+                break;
+            }
+            m_dataAvailable.wait(&m_mutex);
+            continue;
+        }
+        Block *block = m_queue.front();
+        m_queue.pop_front();
+        m_mutex.unlock();
+
+        QElapsedTimer timer;
+        timer.start();
+        bool ok = (0 == m_error) && writeBlock(block);
+        qint64 latencyNs = timer.nsecsElapsed();
+
+        if ((Format::Wav == m_format) && ok && (headerTimer.elapsed() >= AUDIORECWRITER_HEADER_MS))
+        {  // lazy header update - file is playable even if application is terminated
+            writeWavHeader();
+            headerTimer.start();
+        }
+
+        m_mutex.lock();
+        m_pool.push_back(block);
+        m_fileBytes = m_file->pos();
+        m_latencySumNs += latencyNs;
+        m_latencyCount += 1;
+        m_latencyMaxNs = qMax(m_latencyMaxNs, latencyNs);
+        m_latencyPeakNs = qMax(m_latencyPeakNs, latencyNs);
+        if (!ok && (0 == m_error))
+        {
+            qCWarning(audioRecWriter) << "Error while writing recorded data:" << m_file->errorString();
+            m_error = true;
+        }
+    }
+    qint64 peakMs = m_latencyPeakNs / 1000000;
+    m_mutex.unlock();
+
+    closeFile();
+
+    qCInfo(audioRecWriter) << "Recording file closed, data bytes:" << m_dataBytes << "file bytes:" << m_fileBytes
+                           << "max write latency [ms]:" << peakMs;
+}
+
+bool AudioRecWriter::openFile()
+{
+    switch (m_format)
+    {
+        case Format::Wav:
+            // header is valid from the beginning, it is updated periodically
+            writeWavHeader();
+            break;
+        case Format::Flac:
+#if HAVE_FLAC
+        {
+            m_mutex.lock();
+            auto metadata = m_metadata;
+            m_mutex.unlock();
+            m_flacEncoder = new AudioRecFlacEncoder(m_file, m_sampleRate, m_flacLevel);
+            return m_flacEncoder->open(metadata);
+        }
+#else
+            qCWarning(audioRecWriter) << "FLAC format is not supported";
+            return false;
+#endif
+        case Format::Raw:
+            break;
+    }
+    return true;
+}
+
+bool AudioRecWriter::writeBlock(const Block *block)
+{
+#if HAVE_FLAC
+    if (nullptr != m_flacEncoder)
+    {  // block contains 16bit stereo samples, block size and all writes are multiple of 4 bytes
+        if (!m_flacEncoder->encode(reinterpret_cast<const int16_t *>(block->data.data()), block->size / sizeof(int16_t)))
+        {
+            return false;
+        }
+        m_dataBytes += block->size;
+        return true;
+    }
+#endif
+    qint64 bytesWritten = m_file->write(block->data.data(), block->size);
+    if (bytesWritten != block->size)
+    {
+        return false;
+    }
+    m_dataBytes += bytesWritten;
+    return true;
+}
+
+void AudioRecWriter::closeFile()
+{
+    switch (m_format)
+    {
+        case Format::Wav:
+            if (0 == m_error)
+            {
+                writeWavHeader();
+            }
+            break;
+        case Format::Flac:
+#if HAVE_FLAC
+            if (nullptr != m_flacEncoder)
+            {
+                m_mutex.lock();
+                auto metadata = m_metadata;
+                m_mutex.unlock();
+                if (!m_flacEncoder->close(metadata))
+                {
+                    qCWarning(audioRecWriter) << "Failed to finish FLAC file";
+                }
+                delete m_flacEncoder;
+                m_flacEncoder = nullptr;
+            }
+#endif
+            break;
+        case Format::Raw:
+            break;
+    }
+
+    m_file->flush();
+    QMutexLocker locker(&m_mutex);
+    m_fileBytes = m_file->size();
+    m_file->close();
+}
+
+void AudioRecWriter::writeWavHeader()
+{
+    qint64 pos = m_file->pos();
+    if (pos > 0)
+    {
+        m_file->seek(0);
+    }
+
+    QDataStream out(m_file);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    // Details: http://soundfile.sapp.org/doc/WaveFormat/
+
+    // RIFF chunk
+    out.writeRawData("RIFF", 4);
+    out << quint32(36 + m_dataBytes);  // RIFF chunk size (total size - 8)
+    out.writeRawData("WAVE", 4);
+
+    // Format description chunk
+    out.writeRawData("fmt ", 4);
+    out << quint32(16);  // "fmt " chunk size (always 16 for PCM)
+    out << quint16(1);   // data format (1 => PCM)
+    out << quint16(2);   // num channels
+    out << quint32(m_sampleRate);
+    out << quint32(m_sampleRate * 2 * sizeof(int16_t));  // bytes per second
+    out << quint16(2 * sizeof(int16_t));                 // Block align
+    out << quint16(sizeof(int16_t) * 8);                 // Significant Bits Per Sample
+
+    // Data chunk
+    out.writeRawData("data", 4);
+    out << quint32(m_dataBytes);    // Data chunk size
+    Q_ASSERT(m_file->pos() == 44);  // Must be 44 for WAV PCM
+
+    if (pos > 0)
+    {
+        m_file->seek(pos);
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AUDIORECWRITER_H
+#define AUDIORECWRITER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QThread>
+#include <QWaitCondition>
+#include <deque>
+#include <vector>
+
+#include "config.h"
+
+#if HAVE_FLAC
+class AudioRecFlacEncoder;
+#endif
+
+#define AUDIORECWRITER_BLOCK_SIZE (64 * 1024)  // bytes written to file in one call
+#define AUDIORECWRITER_NUM_BLOCKS (32)         // 2 MB = ~10 seconds of 48kHz stereo WAV
+#define AUDIORECWRITER_BLOCK_AGE_MS (2000)     // partially filled block is queued after this time
+#define AUDIORECWRITER_HEADER_MS (5000)        // WAV header update period
+
+// Writes recorded audio from its own thread so that slow storage does not delay audio decoding.
+// Producer (audio decoder thread) copies data to pooled blocks, full blocks are queued to the writer thread.
+// When all blocks are in use the data is dropped, decoder is never blocked.
+class AudioRecWriter : public QThread
+{
+    Q_OBJECT
+public:
+    enum class Format
+    {
+        Raw,  // data is written as is
+        Wav,  // 16bit stereo PCM with WAV header
+        Flac  // 16bit stereo PCM encoded to FLAC
+    };
+
+    struct Statistics
+    {
+        qint64 fileBytes;
+        int queueDepth;
+        int queueCapacity;
+        int maxLatencyMs;  // since last statistics() call
+        int avgLatencyMs;  // since last statistics() call
+        qint64 droppedBytes;
+    };
+
+    // file ownership is transferred to writer, sample rate is required for PCM formats
+    explicit AudioRecWriter(QFile *file, Format format = Format::Raw, int sampleRate = 0, QObject *parent = nullptr);
+    ~AudioRecWriter();
+    void setFlacCompressionLevel(int level) { m_flacLevel = level; }
+
+    // metadata are stored in file when format supports it (FLAC), thread safe
+    void addMetadata(const QString &key, const QString &value);
+
+    // producer side, not thread safe
+    bool write(const char *data, qint64 len);
+    void finish();
+    bool hasError() const { return m_error; }
+    Statistics statistics();
+
+protected:
+    void run() override;
+
+private:
+    struct Block
+    {
+        std::vector<char> data;
+        qint64 size = 0;
+    };
+
+    QFile *m_file;
+    Format m_format;
+    int m_sampleRate;
+    int m_flacLevel = 5;
+    qint64 m_dataBytes = 0;
+    QList<QPair<QString, QString>> m_metadata;
+#if HAVE_FLAC
+    AudioRecFlacEncoder *m_flacEncoder = nullptr;
+#endif
+
+    std::vector<Block> m_blocks;
+    std::vector<Block *> m_pool;
+    std::deque<Block *> m_queue;
+    QMutex m_mutex;
+    QWaitCondition m_dataAvailable;
+    bool m_stopRequest = false;
+    QAtomicInt m_error = false;
+
+    Block *m_currentBlock = nullptr;
+    QElapsedTimer m_blockTimer;
+
+    // statistics, protected by mutex
+    qint64 m_droppedBytes = 0;
+    qint64 m_fileBytes = 0;
+    qint64 m_latencySumNs = 0;
+    qint64 m_latencyMaxNs = 0;
+    int m_latencyCount = 0;
+    qint64 m_latencyPeakNs = 0;
+
+    Block *acquireBlock();
+    void submitBlock();
+    bool openFile();
+    bool writeBlock(const Block *block);
+    void closeFile();
+    void writeWavHeader();
+};
+
+#endif  // AUDIORECWRITER_H
@@ -0,0 +1,235 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "audiorenderer.h"
+
+#include <QLoggingCategory>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "audiodsp.h"
+
+Q_DECLARE_LOGGING_CATEGORY(audioOutput)
+
+void AudioRenderer::init(uint32_t sampleRate_kHz, uint8_t numChannels, uint32_t chunkMs, uint32_t fifoMs)
+{
+    m_sampleRate_kHz = sampleRate_kHz;
+    m_numChannels = numChannels;
+    m_bytesPerFrame = numChannels * sizeof(audioSample_t);
+
+    // mute ramp is exponential
+    // value are precalculated to save MIPS in runtime
+    // unmute ramp is then calculated as 2.0 - m_fadeCoe in runtime
+    m_fadeFrames = AUDIOOUTPUT_FADE_TIME_MS * sampleRate_kHz;
+    m_fadeCoe = powf(10, AUDIOOUTPUT_FADE_MIN_DB / (20.0 * m_fadeFrames));
+
+    m_jitterBuffer.init(sampleRate_kHz, numChannels, chunkMs, fifoMs);
+    m_targetMs = m_jitterBuffer.targetMs();
+}
+
+void AudioRenderer::start(audioFifo_t *fifo)
+{
+    m_fifo = fifo;
+    m_state = AudioOutputPlaybackState::Muted;
+    m_underruns = 0;
+    m_hardMutes = 0;
+    m_muteRamps = 0;
+    m_unmuteRamps = 0;
+    m_silenceFrames = 0;
+    m_loggedEvents = statistics();
+}
+
+void AudioRenderer::render(audioSample_t *out, uint32_t numFrames, bool mute)
+{
+    // read samples from input buffer
+    uint64_t count = m_fifo->count;
+    uint64_t bytes = uint64_t(numFrames) * m_bytesPerFrame;
+    uint64_t bytesNeeded = m_jitterBuffer.inputBytesNeeded(numFrames);
+
+    if (AudioOutputPlaybackState::Muted == m_state)
+    {
+        // condition to unmute is enough samples (jitter buffer target)
+        if (!m_jitterBuffer.isFilled(count) || (count < bytesNeeded) || (count <= m_unmuteMargin * bytes))
+        {  // not enough samples ==> inserting silence
+            silence(out, numFrames);
+            return;
+        }
+        if (mute)
+        {  // staying muted, FIFO is consumed so that decoder is not blocked
+            silence(out, numFrames);
+            skip(bytes);
+            commit(count, bytes);
+            return;
+        }
+
+        // at this point we have enough sample to unmute and there is no request
+        m_jitterBuffer.reset();
+        commit(count, m_jitterBuffer.read(m_fifo, out, numFrames, count));
+        applyGain(out, numFrames);
+        rampUp(out, numFrames);
+        return;
+    }
+
+    // playing
+    if (count < bytesNeeded)
+    {  // not enough samples -> reading what we have and filling rest with zeros
+        if (m_jitterBuffer.underrun())
+        {
+            m_targetMs.store(m_jitterBuffer.targetMs(), std::memory_order_relaxed);
+        }
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+
+        // minimum mute time is 1ms (m_sampleRate_kHz samples), if less then hard mute
+        if (count < uint64_t(m_sampleRate_kHz) * m_bytesPerFrame)
+        {  // nothing to play (cannot apply mute ramp)
+            m_hardMutes.fetch_add(1, std::memory_order_relaxed);
+            silence(out, numFrames);
+            m_state = AudioOutputPlaybackState::Muted;
+            return;
+        }
+
+        // resampler needs few more samples than requested, there may be more than numFrames available
+        uint32_t availableFrames = std::min(count, bytes) / m_bytesPerFrame;
+        uint64_t bytesAvailable = uint64_t(availableFrames) * m_bytesPerFrame;
+        copy(out, bytesAvailable);
+        commit(count, bytesAvailable);
+        applyGain(out, availableFrames);
+        rampDown(out, availableFrames, numFrames);
+        return;
+    }
+
+    // enough samples available -> reading samples, jitter buffer compensates clock drift
+    commit(count, m_jitterBuffer.read(m_fifo, out, numFrames, count));
+    applyGain(out, numFrames);
+    if (mute)
+    {
+        rampDown(out, numFrames, numFrames);
+    }
+}
+
+AudioRenderer::Statistics AudioRenderer::statistics() const
+{
+    Statistics stats;
+    stats.underruns = m_underruns.load(std::memory_order_relaxed);
+    stats.hardMutes = m_hardMutes.load(std::memory_order_relaxed);
+    stats.muteRamps = m_muteRamps.load(std::memory_order_relaxed);
+    stats.unmuteRamps = m_unmuteRamps.load(std::memory_order_relaxed);
+    stats.silenceFrames = m_silenceFrames.load(std::memory_order_relaxed);
+    stats.targetMs = m_targetMs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioRenderer::logStatistics() const
+{
+    Statistics stats = statistics();
+    qCInfo(audioOutput, "Playback statistics: underruns %u (hard mute %u), mute ramps %u, unmute ramps %u, silence %llu ms, target %u ms",
+           stats.underruns, stats.hardMutes, stats.muteRamps, stats.unmuteRamps,
+           static_cast<unsigned long long>(m_sampleRate_kHz ? stats.silenceFrames / m_sampleRate_kHz : 0), stats.targetMs);
+}
+
+void AudioRenderer::logEvents()
+{  // more events of the same type since last call are logged once
+    Statistics stats = statistics();
+    if (stats.hardMutes != m_loggedEvents.hardMutes)
+    {
+        qCInfo(audioOutput, "Hard mute [no samples available]");
+    }
+    if (stats.muteRamps != m_loggedEvents.muteRamps)
+    {
+        qCInfo(audioOutput, "Muting... [available %u samples]", m_muteRampFrames.load(std::memory_order_relaxed));
+    }
+    if ((stats.underruns != m_loggedEvents.underruns) && (stats.targetMs != m_loggedEvents.targetMs))
+    {
+        qCInfo(audioOutput, "Audio buffer underrun, target latency increased to %u ms", stats.targetMs);
+    }
+    if (stats.unmuteRamps != m_loggedEvents.unmuteRamps)
+    {
+        qCInfo(audioOutput) << "Unmuting audio";
+    }
+    m_loggedEvents = stats;
+}
+
+void AudioRenderer::copy(audioSample_t *out, uint64_t bytes)
+{
+    // data wraps around FIFO end at most once, second copy is empty when it does not
+    uint64_t bytesToEnd = std::min<uint64_t>(bytes, m_fifo->size - m_fifo->tail);
+    memcpy(out, m_fifo->buffer + m_fifo->tail, bytesToEnd);
+    memcpy(reinterpret_cast<uint8_t *>(out) + bytesToEnd, m_fifo->buffer, bytes - bytesToEnd);
+    skip(bytes);
+}
+
+void AudioRenderer::skip(uint64_t bytes)
+{
+    int64_t tail = m_fifo->tail + bytes;
+    m_fifo->tail = tail - ((tail >= m_fifo->size) ? m_fifo->size : 0);
+}
+
+void AudioRenderer::commit(uint64_t fifoBytes, uint64_t bytes)
+{
+    m_fifo->commitRead(bytes);
+    LatencyTracer::getInstance()->record(LatencyTracer::AudioFifo, m_fifo->latencyStamps.pop(fifoBytes, bytes));
+}
+
+void AudioRenderer::applyGain(audioSample_t *data, uint32_t numFrames)
+{
+    float gain = m_gain.load(std::memory_order_relaxed);
+    if (gain != 1.0f)
+    {
+        AudioDsp::gain(data, size_t(numFrames) * m_numChannels, gain);
+    }
+}
+
+void AudioRenderer::silence(audioSample_t *out, uint32_t numFrames)
+{
+    memset(out, 0, size_t(numFrames) * m_bytesPerFrame);
+    m_silenceFrames.fetch_add(numFrames, std::memory_order_relaxed);
+}
+
+void AudioRenderer::rampUp(audioSample_t *data, uint32_t numFrames)
+{
+    uint32_t rampFrames = std::min(numFrames, m_fadeFrames);
+    float coe = (rampFrames == m_fadeFrames) ? m_fadeCoe : powf(10, AUDIOOUTPUT_FADE_MIN_DB / (20.0 * rampFrames));
+    AudioDsp::expRamp(data, rampFrames, m_numChannels, AUDIOOUTPUT_FADE_MIN_LIN, 2.0 - coe);
+
+    m_unmuteRamps.fetch_add(1, std::memory_order_relaxed);
+    m_state = AudioOutputPlaybackState::Playing;
+}
+
+void AudioRenderer::rampDown(audioSample_t *data, uint32_t validFrames, uint32_t numFrames)
+{
+    // mute can be requested when there is not enough samples or from HMI
+    m_muteRampFrames.store(validFrames, std::memory_order_relaxed);
+    uint32_t rampFrames = std::min(validFrames, m_fadeFrames);
+    float coe = (rampFrames == m_fadeFrames) ? m_fadeCoe : powf(10, AUDIOOUTPUT_FADE_MIN_DB / (20.0 * rampFrames));
+
+    // first frame is already attenuated by coe
+    AudioDsp::expRamp(data, rampFrames, m_numChannels, coe, coe);
+    memset(data + size_t(rampFrames) * m_numChannels, 0, size_t(numFrames - rampFrames) * m_bytesPerFrame);
+
+    m_muteRamps.fetch_add(1, std::memory_order_relaxed);
+    m_state = AudioOutputPlaybackState::Muted;
+}
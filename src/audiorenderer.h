@@ -0,0 +1,124 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AUDIORENDERER_H
+#define AUDIORENDERER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "audiofifo.h"
+#include "audiojitterbuffer.h"
+
+// muting
+#define AUDIOOUTPUT_FADE_TIME_MS 60
+// these 2 values must be aligned
+#define AUDIOOUTPUT_FADE_MIN_DB -80.0
+#define AUDIOOUTPUT_FADE_MIN_LIN 0.0001
+
+enum class AudioOutputPlaybackState
+{
+    Muted = 0,
+    Playing = 1,
+};
+
+// Reads audio from AudioFifo to output device buffer, used by all audio output backends
+// Implements muted/playing state machine: playback is unmuted with exponential ramp when jitter buffer target is reached,
+// it is muted with ramp on underrun or on request (HMI mute, stop, restart). Ramps last AUDIOOUTPUT_FADE_TIME_MS
+// or the whole output buffer if it is shorter. Volume is applied by vectorized gain kernel.
+// render() is realtime safe: no locks, no allocations and no logging, it is called from audio output callback.
+// Playback events are only counted by render(), they are logged by logEvents() called periodically from non-realtime thread.
+class AudioRenderer
+{
+public:
+    struct Statistics
+    {
+        uint32_t underruns;    // FIFO did not contain enough samples during playback
+        uint32_t hardMutes;    // underrun without samples for mute ramp
+        uint32_t muteRamps;    // mute on underrun or on request
+        uint32_t unmuteRamps;  // playback (re)started
+        uint64_t silenceFrames;
+        uint32_t targetMs;  // jitter buffer target [ms]
+    };
+
+    explicit AudioRenderer(uint32_t initialJitterChunks) : m_jitterBuffer(initialJitterChunks) {}
+
+    // sets stream and FIFO parameters, allocates working buffers, not realtime safe
+    void init(uint32_t sampleRate_kHz, uint8_t numChannels, uint32_t chunkMs, uint32_t fifoMs);
+
+    // to be called before playback starts, output is muted until FIFO is filled, statistics are reset
+    void start(audioFifo_t *fifo);
+
+    // playback is unmuted only when FIFO contains more than margin x requested data
+    void setUnmuteMargin(uint32_t margin) { m_unmuteMargin = margin; }
+
+    // linear gain, thread safe
+    void setVolume(float gain) { m_gain = gain; }
+
+    // writes numFrames frames to out, mute requests muted output (it is applied with ramp when playing)
+    void render(audioSample_t *out, uint32_t numFrames, bool mute);
+
+    bool isMuted() const { return AudioOutputPlaybackState::Muted == m_state; }
+    Statistics statistics() const;
+    void logStatistics() const;
+
+    // logs events counted by render() since last call, not realtime safe
+    void logEvents();
+
+private:
+    audioFifo_t *m_fifo = nullptr;
+    AudioJitterBuffer m_jitterBuffer;
+    std::atomic<AudioOutputPlaybackState> m_state = AudioOutputPlaybackState::Muted;
+    std::atomic<float> m_gain = 1.0;
+    uint32_t m_unmuteMargin = 0;
+    uint32_t m_sampleRate_kHz = 0;
+    uint8_t m_numChannels = 0;
+    uint8_t m_bytesPerFrame = 0;
+    uint32_t m_fadeFrames = 0;
+    float m_fadeCoe = 1.0;  // per frame coefficient of AUDIOOUTPUT_FADE_TIME_MS mute ramp
+
+    // statistics, written by render() only
+    std::atomic<uint32_t> m_underruns = 0;
+    std::atomic<uint32_t> m_hardMutes = 0;
+    std::atomic<uint32_t> m_muteRamps = 0;
+    std::atomic<uint32_t> m_unmuteRamps = 0;
+    std::atomic<uint64_t> m_silenceFrames = 0;
+    std::atomic<uint32_t> m_targetMs = 0;
+    std::atomic<uint32_t> m_muteRampFrames = 0;  // samples available for last mute ramp
+
+    // events already logged, used by logEvents() only
+    Statistics m_loggedEvents = {};
+
+    void copy(audioSample_t *out, uint64_t bytes);
+    void skip(uint64_t bytes);
+    void commit(uint64_t fifoBytes, uint64_t bytes);
+    void applyGain(audioSample_t *data, uint32_t numFrames);
+    void silence(audioSample_t *out, uint32_t numFrames);
+    void rampUp(audioSample_t *data, uint32_t numFrames);
+    void rampDown(audioSample_t *data, uint32_t validFrames, uint32_t numFrames);
+};
+
+#endif  // AUDIORENDERER_H
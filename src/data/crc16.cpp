@@ -0,0 +1,92 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "crc16.h"
+
+#include <array>
+
+namespace
+{
+constexpr uint16_t CRC16_POLY = 0x1021;
+
+// table[k][b] is CRC of byte b followed by k zero bytes (register starting at 0)
+constexpr std::array<std::array<uint16_t, 256>, 8> makeTables()
+{
+    std::array<std::array<uint16_t, 256>, 8> table = {};
+    for (int b = 0; b < 256; ++b)
+    {
+        uint16_t crc = b << 8;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ CRC16_POLY) : (crc << 1);
+        }
+        table[0][b] = crc;
+    }
+    for (int k = 1; k < 8; ++k)
+    {
+        for (int b = 0; b < 256; ++b)
+        {
+            uint16_t crc = table[k - 1][b];
+            table[k][b] = (crc << 8) ^ table[0][crc >> 8];
+        }
+    }
+    return table;
+}
+
+constexpr std::array<std::array<uint16_t, 256>, 8> crcTable = makeTables();
+}  // namespace
+
+uint16_t Crc16::calc(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    // register affects only first 2 bytes of each 8 bytes block
+    while (len >= 8)
+    {
+        crc = crcTable[7][data[0] ^ (crc >> 8)] ^ crcTable[6][data[1] ^ (crc & 0xFF)] ^ crcTable[5][data[2]] ^ crcTable[4][data[3]] ^
+              crcTable[3][data[4]] ^ crcTable[2][data[5]] ^ crcTable[1][data[6]] ^ crcTable[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+
+    while (len-- > 0)
+    {
+        crc = (crc << 8) ^ crcTable[0][*data++ ^ (crc >> 8)];
+    }
+
+    return crc;
+}
+
+bool Crc16::check(const uint8_t *data, size_t len)
+{
+    if (len < 2)
+    {
+        return false;
+    }
+
+    uint16_t invTxCRC = ~((uint16_t(data[len - 2]) << 8) | data[len - 1]);
+    return (calc(data, len - 2) == invTxCRC);
+}
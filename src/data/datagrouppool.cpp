@@ -0,0 +1,65 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "datagrouppool.h"
+
+#include <atomic>
+#include <cstring>
+
+DataGroupPool::DataGroupPool(int size)
+{
+    m_size = size;
+    m_next = 0;
+    m_buffers.reserve(m_size);
+}
+
+QByteArray DataGroupPool::acquire(const uint8_t *data, int len)
+{
+    for (int n = 0; n < m_buffers.size(); ++n)
+    {
+        QByteArray &buffer = m_buffers[m_next];
+        m_next = (m_next + 1) % m_buffers.size();
+        if (buffer.isDetached())
+        {  // no receiver holds the buffer
+            // make sure that receiver is done with the data before it is overwritten
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // resize keeps capacity, no allocation when buffer is large enough
+            buffer.resize(len);
+            memcpy(buffer.data(), data, len);
+            return buffer;
+        }
+    }
+
+    if (m_buffers.size() < m_size)
+    {  // all buffers are used, adding new one
+        m_buffers.append(QByteArray(reinterpret_cast<const char *>(data), len));
+        return m_buffers.last();
+    }
+
+    // pool is exhausted, receivers are too slow
+    return QByteArray(reinterpret_cast<const char *>(data), len);
+}
@@ -0,0 +1,51 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DATAGROUPPOOL_H
+#define DATAGROUPPOOL_H
+
+#include <QByteArray>
+#include <QList>
+
+#define DATAGROUPPOOL_SIZE (64)  // number of buffers, data groups are usually processed immediately
+
+// Pool of buffers for data groups received from DAB SDR library
+// Data group is copied to pooled buffer and passed to decoders as implicitly shared QByteArray,
+// buffer is reused (without allocation) when all receivers released it.
+// Pool is not thread safe, it is used from DAB SDR library callback only.
+class DataGroupPool
+{
+public:
+    explicit DataGroupPool(int size = DATAGROUPPOOL_SIZE);
+    QByteArray acquire(const uint8_t *data, int len);
+
+private:
+    QList<QByteArray> m_buffers;
+    int m_size;
+    int m_next;
+};
+
+#endif  // DATAGROUPPOOL_H
@@ -56,32 +56,14 @@ void DLDecoder::reset()
     emit resetTerminal();
 }
 
-bool DLDecoder::crc16check(const QByteArray &data)
-{
-    uint16_t crc = 0xFFFF;
-    uint16_t mask = 0x1020;
-
-    for (int n = 0; n < data.size() - 2; ++n)
-    {
-        for (int bit = 7; bit >= 0; --bit)
-        {
-            uint16_t in = (data[n] >> bit) & 0x1;
-            uint16_t tmp = in ^ ((crc >> 15) & 0x1);
-            crc <<= 1;
-
-            crc ^= (tmp * mask);
-            crc += tmp;
-        }
-    }
-
-    uint16_t invTxCRC = ~(uint16_t(data[data.size() - 2] << 8) | uint8_t(data[data.size() - 1]));
-
-    return (crc == invTxCRC);
-}
-
 void DLDecoder::newDataGroup(const QByteArray &dataGroup)
 {
     // CRC check is done in dabsdr
+    if (dataGroup.size() < 2)
+    {  // prefix is missing
+        return;
+    }
+
     if (dataGroup.at(0) & 0x10)
     {  // C flag == 1
         switch (dataGroup.at(0) & 0x0F)
@@ -181,7 +163,7 @@ bool DLDecoder::assembleDL(const QByteArray &dataGroup)
     segmentCntr++;  // incrementing expected segment number for next call
 
     // copy characters
-    label.append(dataGroup.mid(2, numChars));
+    label.append(QByteArrayView(dataGroup).mid(2, numChars));
 
     // if this was last message we have complete message
     if (dataGroup[0] & 0x20)
@@ -238,7 +220,7 @@ bool DLDecoder::assembleDLPlusCommand(const QByteArray &dataGroup)
     segmentCntr++;  // incrementing expected segment number for next call
 
     // copy characters
-    dlCommand.append(dataGroup.mid(2, numBytes));
+    dlCommand.append(QByteArrayView(dataGroup).mid(2, numBytes));
 
     // if this was last message we have complete message
     if (dataGroup.at(0) & 0x20)
@@ -166,8 +166,6 @@ private:
     QByteArray dlCommand;
     QString message;
 
-    bool crc16check(const QByteArray &data);
-
     bool assembleDL(const QByteArray &dataGroup);
     bool assembleDLPlusCommand(const QByteArray &dataGroup);
     void parseDLPlusCommand();
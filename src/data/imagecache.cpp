@@ -0,0 +1,238 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "imagecache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+Q_LOGGING_CATEGORY(imageCache, "ImageCache", QtInfoMsg)
+
+#define IMAGECACHE_FILE_MAGIC (0x41424943)  // "ABIC"
+#define IMAGECACHE_FILE_VERSION (1)
+
+ImageCache *ImageCache::getInstance()
+{
+    static ImageCache instance;
+    return &instance;
+}
+
+ImageCache::ImageCache()
+{
+    m_diskBudget = 0;
+    m_diskBytes = 0;
+    m_cache.setMaxCost(qint64(IMAGECACHE_MEMORY_BUDGET) * 1024 * 1024);
+}
+
+QImage ImageCache::image(const QByteArray &data, int maxHeight, QSize *originalSize)
+{
+    if (data.isEmpty())
+    {
+        return QImage();
+    }
+
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    const QByteArray key = hash + QByteArray::number(maxHeight);
+
+    Entry entry;
+    QString filename;
+    bool found = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        const Entry *cachedEntry = m_cache.object(key);
+        if (nullptr != cachedEntry)
+        {
+            entry = *cachedEntry;
+            found = true;
+        }
+        else if (m_diskBudget > 0)
+        {
+            filename = QString("%1/%2_%3.img").arg(m_diskPath, QString::fromLatin1(hash.toHex())).arg(maxHeight);
+        }
+        else
+        { /* disk tier disabled */
+        }
+    }
+
+    if (!found)
+    {
+        if (filename.isEmpty() || !loadFromDisk(filename, entry))
+        {  // decoding is done without lock, decoders in other threads are not blocked
+            if (!entry.image.loadFromData(data))
+            {
+                return QImage();
+            }
+            if (entry.image.colorCount() > 0)
+            {  // indexed formats are converted so that raw pixels can be stored without color table
+                entry.image.convertTo(QImage::Format_ARGB32);
+            }
+            entry.size = entry.image.size();
+            if ((maxHeight > 0) && (entry.image.height() > maxHeight))
+            {
+                entry.image = entry.image.scaledToHeight(maxHeight, Qt::SmoothTransformation);
+            }
+            if (!filename.isEmpty())
+            {
+                saveToDisk(filename, entry);
+            }
+        }
+        insert(key, entry);
+    }
+
+    if (nullptr != originalSize)
+    {
+        *originalSize = entry.size;
+    }
+    return entry.image;
+}
+
+void ImageCache::setMemoryBudget(int budgetMB)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(qint64(qMax(0, budgetMB)) * 1024 * 1024);
+}
+
+void ImageCache::setDiskBudget(int budgetMB)
+{
+    QMutexLocker locker(&m_mutex);
+    m_diskBudget = qint64(qMax(0, budgetMB)) * 1024 * 1024;
+    m_diskBytes = 0;
+    if (m_diskBudget > 0)
+    {
+        m_diskPath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + IMAGECACHE_DIR_NAME;
+        QDir dir;
+        if (!dir.mkpath(m_diskPath))
+        {
+            qCWarning(imageCache) << "Failed to create directory" << m_diskPath << ", disk cache is disabled";
+            m_diskBudget = 0;
+            return;
+        }
+
+        const QFileInfoList files = QDir(m_diskPath).entryInfoList(QStringList() << "*.img", QDir::Files);
+        for (const QFileInfo &file : files)
+        {
+            m_diskBytes += file.size();
+        }
+        pruneDisk();
+    }
+    else
+    { /* disk tier disabled, files are kept for next time */
+    }
+}
+
+void ImageCache::insert(const QByteArray &key, const Entry &entry)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // image larger than budget is not inserted
+    m_cache.insert(key, new Entry(entry), qMax(qsizetype(1), entry.image.sizeInBytes()));
+}
+
+bool ImageCache::loadFromDisk(const QString &filename, Entry &entry) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {  // not in disk cache
+        return false;
+    }
+
+    QDataStream in(&file);
+    quint32 magic;
+    quint8 version;
+    qint32 width, height, format, bytesPerLine, origWidth, origHeight;
+    in >> magic >> version >> width >> height >> format >> bytesPerLine >> origWidth >> origHeight;
+    if ((in.status() != QDataStream::Ok) || (IMAGECACHE_FILE_MAGIC != magic) || (IMAGECACHE_FILE_VERSION != version) || (format <= QImage::Format_Invalid) ||
+        (format >= QImage::NImageFormats))
+    {
+        qCWarning(imageCache) << "Invalid cache file" << filename;
+        return false;
+    }
+
+    QImage image(width, height, QImage::Format(format));
+    if (image.isNull() || (image.bytesPerLine() != bytesPerLine) ||
+        (in.readRawData(reinterpret_cast<char *>(image.bits()), image.sizeInBytes()) != image.sizeInBytes()))
+    {
+        qCWarning(imageCache) << "Invalid cache file" << filename;
+        return false;
+    }
+
+    entry.image = image;
+    entry.size = QSize(origWidth, origHeight);
+    return true;
+}
+
+void ImageCache::saveToDisk(const QString &filename, const Entry &entry)
+{
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(imageCache) << "Failed to write cache file" << filename;
+        return;
+    }
+
+    QDataStream out(&file);
+    out << quint32(IMAGECACHE_FILE_MAGIC) << quint8(IMAGECACHE_FILE_VERSION) << qint32(entry.image.width()) << qint32(entry.image.height())
+        << qint32(entry.image.format()) << qint32(entry.image.bytesPerLine()) << qint32(entry.size.width()) << qint32(entry.size.height());
+    out.writeRawData(reinterpret_cast<const char *>(entry.image.constBits()), entry.image.sizeInBytes());
+    if (!file.commit())
+    {
+        qCWarning(imageCache) << "Failed to write cache file" << filename;
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_diskBytes += QFileInfo(filename).size();
+    pruneDisk();
+}
+
+void ImageCache::pruneDisk()
+{  // called with locked mutex
+    if ((m_diskBudget <= 0) || (m_diskBytes <= m_diskBudget))
+    {
+        return;
+    }
+
+    // oldest files are removed first, some space is freed to avoid pruning on every insertion
+    const qint64 target = m_diskBudget * 3 / 4;
+    const QFileInfoList files = QDir(m_diskPath).entryInfoList(QStringList() << "*.img", QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &file : files)
+    {
+        if (m_diskBytes <= target)
+        {
+            break;
+        }
+        if (QFile::remove(file.absoluteFilePath()))
+        {
+            m_diskBytes -= file.size();
+        }
+    }
+    qCDebug(imageCache) << "Disk cache pruned to" << m_diskBytes << "bytes";
+}
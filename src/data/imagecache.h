@@ -0,0 +1,78 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+#define IMAGECACHE_MEMORY_BUDGET (32)  // [MB] default budget of decoded images kept in memory
+#define IMAGECACHE_DIR_NAME "images"   // disk tier subdirectory of application cache location
+
+// Content addressed cache of decoded images (slides, logos)
+// Images are identified by hash of encoded data, so the same content is decoded only once
+// no matter how many times it is received or under which name.
+// Decoded images are kept in memory up to the budget (least recently used are dropped),
+// optional disk tier stores raw pixels so that the images survive the memory cache and application restart.
+// Class is thread safe, decoding is done in calling thread.
+class ImageCache
+{
+public:
+    static ImageCache *getInstance();
+
+    // returns image decoded from data or null image if data cannot be decoded
+    // image higher than maxHeight is scaled down (0 = no scaling), originalSize is resolution before scaling
+    QImage image(const QByteArray &data, int maxHeight = 0, QSize *originalSize = nullptr);
+
+    void setMemoryBudget(int budgetMB);
+    void setDiskBudget(int budgetMB);  // 0 = disk tier disabled
+
+private:
+    struct Entry
+    {
+        QImage image;
+        QSize size;
+    };
+
+    ImageCache();
+    bool loadFromDisk(const QString &filename, Entry &entry) const;
+    void saveToDisk(const QString &filename, const Entry &entry);
+    void insert(const QByteArray &key, const Entry &entry);
+    void pruneDisk();
+
+    mutable QMutex m_mutex;
+    QCache<QByteArray, Entry> m_cache;  // cost is size of image in bytes
+    QString m_diskPath;
+    qint64 m_diskBudget;  // [bytes], 0 = disabled
+    qint64 m_diskBytes;
+};
+
+#endif  // IMAGECACHE_H
@@ -83,8 +83,15 @@ void MOTDecoder::newDataGroup(const QByteArray &dataGroup)
     { /* datagroup was valid */
     }
 
+    // data field is not copied, data group buffer is referenced
+    const QByteArrayView dataField = mscDataGroup.dataField();
+    if (dataField.size() < 2)
+    {  // segmentation header is missing
+        return;
+    }
+
     // unsigned required
-    const uint8_t *dataFieldPtr = reinterpret_cast<const uint8_t *>(mscDataGroup.dataFieldConstBegin());
+    const uint8_t *dataFieldPtr = reinterpret_cast<const uint8_t *>(dataField.constData());
 
     // [ETSI EN 301 234, 5.1.1 Segmentation header]
     uint8_t repetitionCount = (*dataFieldPtr >> 5) & 0x7;
@@ -93,6 +100,11 @@ void MOTDecoder::newDataGroup(const QByteArray &dataGroup)
     // Only the last segment may have a smaller size (to carry the remaining bytes of the MOT entity).
     uint16_t segmentSize = (*dataFieldPtr++ << 8) & 0x1FFF;
     segmentSize += *dataFieldPtr++;
+    if (segmentSize > dataField.size() - 2)
+    {  // segment does not fit into data field
+        qCWarning(motDecoder) << "Unexpected segment size" << segmentSize << "data field size" << dataField.size();
+        return;
+    }
 
     qCDebug(motDecoder) << "Data group type =" << mscDataGroup.getType();
     qCDebug(motDecoder) << "Segment number = " << mscDataGroup.getSegmentNum() << ", last = " << mscDataGroup.getLastFlag();
@@ -120,7 +132,7 @@ void MOTDecoder::newDataGroup(const QByteArray &dataGroup)
             }
 
             // add header segment
-            objIt->addSegment((const uint8_t *)dataFieldPtr, mscDataGroup.getSegmentNum(), segmentSize, mscDataGroup.getLastFlag(), true);
+            m_objCache->addSegment(objIt, (const uint8_t *)dataFieldPtr, mscDataGroup.getSegmentNum(), segmentSize, mscDataGroup.getLastFlag(), true);
         }
         break;
         case 4:
@@ -154,7 +166,8 @@ void MOTDecoder::newDataGroup(const QByteArray &dataGroup)
 
                     objIt = m_objCache->addMotObj(MOTObject(mscDataGroup.getTransportId()));
                 }
-                objIt->addSegment((const uint8_t *)dataFieldPtr, mscDataGroup.getSegmentNum(), segmentSize, mscDataGroup.getLastFlag());
+                objIt = m_objCache->addSegment(objIt, (const uint8_t *)dataFieldPtr, mscDataGroup.getSegmentNum(), segmentSize,
+                                               mscDataGroup.getLastFlag());
 
                 if (objIt->isComplete())
                 {
@@ -50,6 +50,8 @@ public:
     MOTObjectCache::const_iterator find(const QString &filename) const;
     MOTObjectCache::const_iterator directoryBegin() const { return m_directory->begin(); }
     MOTObjectCache::const_iterator directoryEnd() const { return m_directory->end(); }
+    void setCacheBudget(qint64 bytes) { m_objCache->setByteBudget(bytes); }
+    MOTObjectCache::Statistics cacheStatistics() const { return m_objCache->statistics(); }
 
 signals:
     void newMOTObject(const MOTObject &obj);
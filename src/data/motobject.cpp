@@ -28,6 +28,8 @@
 
 #include <QDebug>
 #include <QLoggingCategory>
+#include <cstring>
+#include <limits>
 
 #include "dabtables.h"
 Q_LOGGING_CATEGORY(motObject, "MOTObject", QtInfoMsg)
@@ -37,104 +39,123 @@ MOTEntity::MOTEntity()
     reset();
 }
 
-bool MOTEntity::isComplete() const
+void MOTEntity::addSegment(const uint8_t *segment, uint16_t segmentNum, uint16_t segmentSize, bool lastFlag)
 {
-    if (m_numSegments < 0)
-    {  // last segment was not received yet
-        return false;
+    if ((segmentNum >= 8192) || (segmentSize == 0))
+    {
+        return;
     }
     else
-    { /* last segment was already received and we know expected size => we could have complete entity */
+    { /* continue with adding */
     }
 
-    // lets check if all segments were received
-
     // [ETSI EN 301 234, 5.1 Segmentation of MOT entities]
     // MOT entities will be split up in segments with equal size. Only the last segment may have a smaller size
     // (to carry the remaining bytes of the MOT entity). Every MOT entity (e.g. every MOT body) can use a different segmentation size.
-    int lastSegmentSize = m_segments.last().size();
-
-    if (m_numSegments != m_segments.size())
+    // Segment that does not match segmentation received so far means that entity was changed -> starting again
+    bool isConsistent;
+    if (lastFlag)
     {
-        qCWarning(motObject) << "numSegments != segments.size()";
+        isConsistent = ((m_numSegments < 0) || ((m_numSegments == segmentNum + 1) && (m_lastSegmentSize == segmentSize))) &&
+                       (m_received.size() <= segmentNum + 1) && ((m_segmentSize < 0) || (segmentSize <= m_segmentSize));
     }
-
-    for (int n = 0; n < m_numSegments - 1; ++n)
+    else
     {
-        if (m_segments.at(n).size() < lastSegmentSize)
-        {  // some segment is smaller than last segment thus not received
-            return false;
-        }
+        isConsistent = ((m_numSegments < 0) || (segmentNum < m_numSegments - 1)) && ((m_segmentSize < 0) || (segmentSize == m_segmentSize)) &&
+                       (m_lastSegment.isEmpty() || (m_lastSegment.size() <= segmentSize));
     }
-    return true;
-}
-
-int MOTEntity::size()
-{
-    int receivedSize = 0;
-    for (int n = 0; n < m_numSegments; ++n)
+    if (!isConsistent)
     {
-        receivedSize += m_segments[n].size();
+        qCDebug(motObject) << "MOT entity segmentation changed, segment" << segmentNum << "size" << segmentSize;
+        reset();
+    }
+    else
+    { /* segment matches segmentation */
     }
 
-    return receivedSize;
-}
-
-void MOTEntity::addSegment(const uint8_t *segment, uint16_t segmentNum, uint16_t segmentSize, bool lastFlag)
-{
-    if ((segmentNum >= 8192) || (segmentSize == 0))
-    {
+    if ((segmentNum < m_received.size()) && m_received.testBit(segmentNum))
+    {  // segment was already received before
         return;
     }
     else
-    { /* continue with adding */
+    { /* new segment */
     }
 
     if (lastFlag)
     {  // current segment is marked as last, thus we know number of segments
         m_numSegments = segmentNum + 1;
+        m_lastSegmentSize = segmentSize;
+        if (0 == segmentNum)
+        {  // entity with single segment
+            m_segmentSize = segmentSize;
+        }
+    }
+    else if (m_segmentSize < 0)
+    {
+        m_segmentSize = segmentSize;
     }
     else
-    { /* do nothing */
+    { /* segment size is known already */
     }
 
-    // all segments have the same size only the last can be shorter
-    if (segmentNum > m_segments.size())
-    {  // insert empty items
-        for (int n = m_segments.size(); n < segmentNum; ++n)
-        {
-            m_segments.append(QByteArray());
-        }
+    if (segmentNum >= m_received.size())
+    {
+        m_received.resize(segmentNum + 1);
     }
-    else
-    { /* do nothing - segment is somewhere in the middle */
+    m_received.setBit(segmentNum);
+    m_numReceived += 1;
+    m_receivedSize += segmentSize;
+
+    if (m_segmentSize < 0)
+    {  // only last segment is received, its position is not known until segment size is known
+        m_lastSegment = QByteArray((const char *)segment, segmentSize);
+        return;
+    }
+
+    writeSegment(segmentNum, segment, segmentSize);
+    if (!m_lastSegment.isEmpty())
+    {  // last segment received before can be written now
+        writeSegment(m_numSegments - 1, reinterpret_cast<const uint8_t *>(m_lastSegment.constData()), m_lastSegment.size());
+        m_lastSegment.clear();
+    }
+}
+
+void MOTEntity::writeSegment(uint16_t segmentNum, const uint8_t *segment, uint16_t segmentSize)
+{
+    qsizetype offset = qsizetype(segmentNum) * m_segmentSize;
+    qsizetype dataSize = offset + segmentSize;
+    if (m_numSegments > 0)
+    {  // number of segments is known -> final size of the entity is known
+        dataSize = qsizetype(m_numSegments - 1) * m_segmentSize + m_lastSegmentSize;
     }
 
-    if (segmentNum < m_segments.size())
+    if (m_data.size() < dataSize)
     {
-        if (m_segments.at(segmentNum).size() != segmentSize)
-        {  // current segment size is diffrent than recieved size, it could happen when no segment #segmentNum was received yet
-            m_segments.replace(segmentNum, QByteArray((const char *)segment, segmentSize));
+        if (dataSize > m_data.capacity())
+        {  // growing geometrically while number of segments is not known
+            m_data.reserve(qMax(dataSize, 2 * m_data.capacity()));
         }
-        else
-        { /* do nothing - segment was already received before */
-        }
-    }
-    else if (segmentNum == m_segments.size())
-    {  // add segment to the end
-        m_segments.append(QByteArray((const char *)segment, segmentSize));
+        m_data.resize(dataSize);
     }
+    memcpy(m_data.data() + offset, segment, segmentSize);
 }
 
 void MOTEntity::reset()
 {
-    m_segments.clear();
+    m_data.clear();
+    m_received.clear();
+    m_lastSegment.clear();
     m_numSegments = -1;
+    m_segmentSize = -1;
+    m_lastSegmentSize = -1;
+    m_numReceived = 0;
+    m_receivedSize = 0;
 }
 
 QByteArray MOTEntity::getData() const
 {
-    return m_segments.join();
+    // data is implicitly shared, no copy is made
+    return m_data;
 }
 
 MOTObjectData::MOTObjectData(int_fast32_t transportId)
@@ -169,7 +190,7 @@ MOTObject::MOTObject(int_fast32_t transportId)
 
 void MOTObjectData::parseHeader()
 {
-    const QByteArray headerData = m_header.getData();
+    const QByteArrayView headerData = m_header.getDataView();
 
     // [ETSI EN 301 234, 6.1 Header core]
     // minium header size is 56 bits => 7 bytes (header core)
@@ -368,6 +389,12 @@ QByteArray MOTObject::getBody() const
     return QByteArray();
 }
 
+void MOTObject::discardBody()
+{
+    d->m_body.reset();
+    d->m_objectIsComplete = false;
+}
+
 uint16_t MOTObject::getContentType() const
 {
     return d->m_contentType;
@@ -435,7 +462,7 @@ bool MOTDirectory::addObjectSegment(uint_fast32_t transportId, const uint8_t *se
 
     if (!it->isComplete())
     {
-        it->addSegment(segment, segmentNum, segmentSize, lastFlag);
+        it = m_carousel->addSegment(it, segment, segmentNum, segmentSize, lastFlag);
         if (it->isComplete())
         {
             m_numComplete += 1;
@@ -587,7 +614,7 @@ bool MOTDirectory::parse(const QByteArray &dirData)
 
         // add header segment
         // number 0, last = true, size is the rest of the directory, object takes what it needs
-        it->addSegment((const uint8_t *)(dataPtr + n + 2), 0, headerSize, true, true);
+        it = m_carousel->addSegment(it, (const uint8_t *)(dataPtr + n + 2), 0, headerSize, true, true);
         n += 2 + headerSize;
 
         if (it->isComplete())
@@ -619,7 +646,15 @@ bool MOTDirectory::parse(const QByteArray &dirData)
 
 //=================================================================================
 MOTObjectCache::MOTObjectCache()
-{}
+{
+    m_accessCounter = 0;
+    m_bytes = 0;
+    m_pendingBytes = 0;
+    m_byteBudget = 0;
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+}
 
 MOTObjectCache::~MOTObjectCache()
 {
@@ -628,53 +663,75 @@ MOTObjectCache::~MOTObjectCache()
 
 void MOTObjectCache::clear()
 {
+    // statistics counters are kept, cache is cleared with every new MOT header in header mode
     m_cache.clear();
+    m_index.clear();
+    m_bytes = 0;
+    m_pendingBytes = 0;
 }
 
 MOTObjectCache::iterator MOTObjectCache::findMotObj(uint16_t transportId)
 {
-    MOTObjectCache::iterator it;
-    for (it = m_cache.begin(); it < m_cache.end(); ++it)
+    QHash<uint16_t, IndexEntry>::const_iterator indexIt = m_index.constFind(transportId);
+    if (m_index.cend() != indexIt)
     {
-        if (it->getId() == transportId)
-        {
-            return it;
-        }
+        m_hits += 1;
+        return m_cache.begin() + indexIt->pos;
     }
-    return it;
+    m_misses += 1;
+    return m_cache.end();
 }
 
-MOTObjectCache::const_iterator MOTObjectCache::cfindMotObj(uint16_t transportId)
+MOTObjectCache::const_iterator MOTObjectCache::cfindMotObj(uint16_t transportId) const
 {
-    MOTObjectCache::const_iterator it;
-    for (it = m_cache.cbegin(); it < m_cache.cend(); ++it)
+    QHash<uint16_t, IndexEntry>::const_iterator indexIt = m_index.constFind(transportId);
+    if (m_index.cend() != indexIt)
     {
-        if (it->getId() == transportId)
-        {
-            return it;
-        }
+        return m_cache.cbegin() + indexIt->pos;
     }
-    return it;
+    return m_cache.cend();
 }
 
 void MOTObjectCache::deleteMotObj(uint16_t transportId)
 {
-    for (int n = 0; n < m_cache.size(); ++n)
+    QHash<uint16_t, IndexEntry>::const_iterator indexIt = m_index.constFind(transportId);
+    if (m_index.cend() != indexIt)
     {
-        if (m_cache[n].getId() == transportId)
-        {
-            m_cache.removeAt(n);
-            return;
-        }
+        removeAt(indexIt->pos);
     }
 }
 
 MOTObjectCache::iterator MOTObjectCache::addMotObj(const MOTObject &obj)
 {
+    if (m_index.contains(obj.getId()))
+    {  // transport ID must be unique in the cache, replacing existing object
+        deleteMotObj(obj.getId());
+    }
+
     m_cache.append(obj);
+    IndexEntry &entry = m_index.insert(obj.getId(), IndexEntry{m_cache.size() - 1, ++m_accessCounter, 0, 0}).value();
+    account(entry, obj);
     return --(m_cache.end());
 }
 
+MOTObjectCache::iterator MOTObjectCache::addSegment(MOTObjectCache::iterator it, const uint8_t *segment, uint16_t segmentNum,
+                                                    uint16_t segmentSize, bool lastFlag, bool isHeader)
+{
+    uint16_t transportId = it->getId();
+    it->addSegment(segment, segmentNum, segmentSize, lastFlag, isHeader);
+
+    IndexEntry &entry = m_index[transportId];
+    account(entry, *it);
+    entry.lastAccess = ++m_accessCounter;
+
+    if ((m_byteBudget > 0) && (m_pendingBytes > m_byteBudget))
+    {
+        evict(transportId);
+        return m_cache.begin() + m_index.value(transportId).pos;
+    }
+    return it;
+}
+
 void MOTObjectCache::markAllObsolete()
 {
     for (int n = 0; n < m_cache.size(); ++n)
@@ -685,14 +742,10 @@ void MOTObjectCache::markAllObsolete()
 
 MOTObjectCache::iterator MOTObjectCache::markObjObsolete(uint16_t transportId, bool obsolete)
 {
-    MOTObjectCache::iterator it;
-    for (it = m_cache.begin(); it < m_cache.end(); ++it)
+    MOTObjectCache::iterator it = findMotObj(transportId);
+    if (m_cache.end() != it)
     {
-        if (it->getId() == transportId)
-        {
-            it->setObsolete(obsolete);
-            return it;
-        }
+        it->setObsolete(obsolete);
     }
     return it;
 }
@@ -704,6 +757,9 @@ void MOTObjectCache::deleteObsolete()
     {
         if (it->isObsolete())
         {
+            const IndexEntry &entry = m_index[it->getId()];
+            m_bytes -= entry.bytes;
+            m_pendingBytes -= entry.pendingBytes;
             it = m_cache.erase(it);
         }
         else
@@ -711,4 +767,109 @@ void MOTObjectCache::deleteObsolete()
             ++it;
         }
     }
+    reindex();
+}
+
+void MOTObjectCache::setByteBudget(qint64 budget)
+{
+    m_byteBudget = budget;
+    if ((m_byteBudget > 0) && (m_pendingBytes > m_byteBudget))
+    {
+        evict(-1);
+    }
+}
+
+MOTObjectCache::Statistics MOTObjectCache::statistics() const
+{
+    MOTObjectCache::Statistics stats;
+    stats.objects = m_cache.size();
+    stats.bytes = m_bytes;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    stats.evictions = m_evictions;
+    return stats;
+}
+
+void MOTObjectCache::account(IndexEntry &entry, const MOTObject &obj)
+{
+    // complete objects are not counted in the budget, they are kept until they are obsolete
+    int pendingBytes = obj.isComplete() ? 0 : obj.receivedSize();
+    m_bytes += obj.receivedSize() - entry.bytes;
+    m_pendingBytes += pendingBytes - entry.pendingBytes;
+    entry.bytes = obj.receivedSize();
+    entry.pendingBytes = pendingBytes;
+}
+
+void MOTObjectCache::removeAt(qsizetype pos)
+{
+    // order of objects is not significant, last object is moved to the free position to keep removal O(1)
+    const IndexEntry &entry = m_index[m_cache.at(pos).getId()];
+    m_bytes -= entry.bytes;
+    m_pendingBytes -= entry.pendingBytes;
+    m_index.remove(m_cache.at(pos).getId());
+
+    qsizetype lastPos = m_cache.size() - 1;
+    if (pos != lastPos)
+    {
+        m_cache.swapItemsAt(pos, lastPos);
+        m_index[m_cache.at(pos).getId()].pos = pos;
+    }
+    m_cache.removeLast();
+}
+
+void MOTObjectCache::evict(int keepId)
+{
+    // complete objects are never evicted, only bodies of incomplete objects that are least recently updated
+    // the carousel will transmit them again, headers are kept
+    while (m_pendingBytes > m_byteBudget)
+    {
+        qsizetype lruPos = -1;
+        quint64 lruAccess = std::numeric_limits<quint64>::max();
+        for (auto indexIt = m_index.cbegin(); indexIt != m_index.cend(); ++indexIt)
+        {
+            if ((indexIt.key() != keepId) && (indexIt->pendingBytes > 0) && (indexIt->lastAccess < lruAccess) &&
+                (m_cache.at(indexIt->pos).bodySize() > 0))
+            {
+                lruPos = indexIt->pos;
+                lruAccess = indexIt->lastAccess;
+            }
+        }
+
+        if (lruPos < 0)
+        {  // nothing to evict
+            return;
+        }
+
+        qint64 pendingBytes = m_pendingBytes;
+        MOTObject &obj = m_cache[lruPos];
+        qCDebug(motObject) << "Evicting MOT object ID" << obj.getId() << "size" << obj.receivedSize() << "cache size" << m_pendingBytes;
+        m_evictions += 1;
+        if (obj.hasHeader())
+        {  // header is kept, it is needed by MOT directory
+            obj.discardBody();
+            account(m_index[obj.getId()], obj);
+        }
+        else
+        {  // body without header
+            removeAt(lruPos);
+        }
+
+        if (m_pendingBytes >= pendingBytes)
+        {  // nothing was freed
+            return;
+        }
+    }
+}
+
+void MOTObjectCache::reindex()
+{
+    QHash<uint16_t, IndexEntry> index;
+    index.reserve(m_cache.size());
+    for (qsizetype n = 0; n < m_cache.size(); ++n)
+    {
+        IndexEntry entry = m_index.value(m_cache.at(n).getId());
+        entry.pos = n;
+        index.insert(m_cache.at(n).getId(), entry);
+    }
+    m_index = index;
 }
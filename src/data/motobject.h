@@ -27,7 +27,9 @@
 #ifndef MOTOBJECT_H
 #define MOTOBJECT_H
 
-#include <QByteArrayList>
+#include <QBitArray>
+#include <QByteArray>
+#include <QByteArrayView>
 #include <QHash>
 #include <QObject>
 #include <QSharedData>
@@ -38,15 +40,24 @@ class MOTEntity
 {
 public:
     MOTEntity();
-    bool isComplete() const;
-    int size();
+    bool isComplete() const { return (m_numSegments > 0) && (m_numReceived == m_numSegments); }
+    int size() const { return m_receivedSize; }
     void addSegment(const uint8_t *segment, uint16_t segmentNum, uint16_t segmentSize, bool lastFlag);
     QByteArray getData() const;
+    QByteArrayView getDataView() const { return QByteArrayView(m_data); }
     void reset();
 
 private:
-    QByteArrayList m_segments;
+    QByteArray m_data;         // segments are reassembled in place, segment n starts at n * m_segmentSize
+    QBitArray m_received;      // received segments
+    QByteArray m_lastSegment;  // last segment received before segment size is known
     int_fast32_t m_numSegments;
+    int m_segmentSize;
+    int m_lastSegmentSize;
+    int m_numReceived;
+    int m_receivedSize;  // sum of all received segments, used for cache memory accounting
+
+    void writeSegment(uint16_t segmentNum, const uint8_t *segment, uint16_t segmentSize);
 };
 
 class MOTObjectData : public QSharedData
@@ -86,6 +97,10 @@ public:
     QByteArray getBody() const;
     bool isObsolete() const { return d->m_objectIsObsolete; }
     void setObsolete(bool obsolete) { d->m_objectIsObsolete = obsolete; };
+    bool hasHeader() const { return d->m_header.size() > 0; }
+    int receivedSize() const { return d->m_header.size() + d->m_body.size(); }
+    int bodySize() const { return d->m_body.size(); }
+    void discardBody();
 
     uint16_t getContentType() const;
     uint16_t getContentSubType() const;
@@ -104,6 +119,15 @@ private:
 class MOTObjectCache
 {
 public:
+    struct Statistics
+    {
+        int objects = 0;
+        qint64 bytes = 0;
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+    };
+
     MOTObjectCache();
     ~MOTObjectCache();
     void clear();
@@ -113,24 +137,57 @@ public:
     typedef QList<MOTObject>::iterator iterator;
     typedef QList<MOTObject>::const_iterator const_iterator;
 
-    MOTObjectCache::iterator findMotObj(uint16_t transportId);         // find MOT object in the cache
-    MOTObjectCache::const_iterator cfindMotObj(uint16_t transportId);  // find MOT object in the cache
-    MOTObjectCache::iterator addMotObj(const MOTObject &obj);          // add MOT boject to cache
-    void deleteMotObj(uint16_t transportId);                           // delete mote object from the cache, this deletes the object completely
+    MOTObjectCache::iterator findMotObj(uint16_t transportId);               // find MOT object in the cache
+    MOTObjectCache::const_iterator cfindMotObj(uint16_t transportId) const;  // find MOT object in the cache
+    MOTObjectCache::iterator addMotObj(const MOTObject &obj);                // add MOT boject to cache
+    void deleteMotObj(uint16_t transportId);  // delete mote object from the cache, this deletes the object completely
+
+    // adds segment to object in the cache and keeps memory accounting, returned iterator points to the same object
+    // (it can be moved when other object is evicted)
+    MOTObjectCache::iterator addSegment(MOTObjectCache::iterator it, const uint8_t *segment, uint16_t segmentNum, uint16_t segmentSize,
+                                        bool lastFlag, bool isHeader = false);
 
     void markAllObsolete();
     MOTObjectCache::iterator markObjObsolete(uint16_t transportId, bool obsolete = true);
     void deleteObsolete();
 
+    // memory budget for received segments of incomplete objects [bytes], 0 = unlimited
+    void setByteBudget(qint64 budget);
+    qint64 byteBudget() const { return m_byteBudget; }
+    MOTObjectCache::Statistics statistics() const;
+
     MOTObjectCache::iterator begin() { return m_cache.begin(); }
     MOTObjectCache::iterator end() { return m_cache.end(); }
     MOTObjectCache::const_iterator cbegin() const { return m_cache.cbegin(); }
     MOTObjectCache::const_iterator cend() const { return m_cache.cend(); }
 
 private:
+    struct IndexEntry
+    {
+        qsizetype pos;       // position in m_cache
+        quint64 lastAccess;  // value of m_accessCounter when segment was added last time
+        int bytes;           // bytes accounted for the object
+        int pendingBytes;    // bytes accounted in budget, 0 for complete object
+    };
+
     QList<MOTObject> m_cache;
+    QHash<uint16_t, IndexEntry> m_index;  // transport ID -> object
+    quint64 m_accessCounter;
+    qint64 m_bytes;
+    qint64 m_pendingBytes;  // bytes of incomplete objects
+    qint64 m_byteBudget;
+    quint64 m_hits;
+    quint64 m_misses;
+    quint64 m_evictions;
+
+    void account(IndexEntry &entry, const MOTObject &obj);
+    void removeAt(qsizetype pos);
+    void evict(int keepId);  // keepId = -1 means any object can be evicted
+    void reindex();
 };
 
+Q_DECLARE_METATYPE(MOTObjectCache::Statistics)
+
 class MOTDirectory
 {
 public:
@@ -28,11 +28,13 @@
 
 #include <QDebug>
 
-MSCDataGroup::MSCDataGroup(const QByteArray &dataGroup)
+#include "crc16.h"
+
+MSCDataGroup::MSCDataGroup(const QByteArray &dataGroup) : m_dataGroup(dataGroup)
 {
     m_isValid = false;
-    if (dataGroup.size() <= 0)
-    {  // no data
+    if (m_dataGroup.size() < 2)
+    {  // no data or incomplete header
         return;
     }
     else
@@ -40,11 +42,13 @@ MSCDataGroup::MSCDataGroup(const QByteArray &dataGroup)
     }
 
     // some data available => first check header
-    const uint8_t *inputDataPtr = (const uint8_t *)dataGroup.constBegin();
+    const uint8_t *const dataGroupPtr = reinterpret_cast<const uint8_t *>(m_dataGroup.constData());
+    const uint8_t *const dataGroupEnd = dataGroupPtr + m_dataGroup.size();
+    const uint8_t *inputDataPtr = dataGroupPtr;
     bool crcFlag = (*inputDataPtr & 0x40) != 0;
     if (crcFlag)  // bit 6
     {             // if CRC present, do check CRC16 according to [ETSI EN 300 401, 5.3.3.4]
-        if (!crc16check(dataGroup))
+        if (!Crc16::check(dataGroupPtr, m_dataGroup.size()))
         {
             qDebug() << "CRC failed";
             return;
@@ -67,13 +71,19 @@ MSCDataGroup::MSCDataGroup(const QByteArray &dataGroup)
     m_continuityIdx = (*inputDataPtr >> 4) & 0x0F;  // byte 1, bits 7-4
     m_repetitionIdx = (*inputDataPtr++ & 0x0F);     // byte 1, bits 3-0
 
+    // size of header fields is known from the flags, checking it before parsing
+    if (inputDataPtr + m_extensionFlag * 2 + m_segmentFlag * 2 + m_userAccessFlag + crcFlag * 2 > dataGroupEnd)
+    {
+        return;
+    }
+
     // inputDataPtr->byte 2 (extension field)
     if (m_extensionFlag)
     {  // extension field is present
         // Extension field: this 16-bit field shall be used to carry information for CA on data group level
         // (see ETSI TS 102 367 [4]). For other Data group types, the Extension field is reserved for future
         // additions to the Data group header.
-        m_extensionField = (*inputDataPtr << 8) | (*inputDataPtr + 1);
+        m_extensionField = (*inputDataPtr << 8) | *(inputDataPtr + 1);
         inputDataPtr += 2;
     }
     else
@@ -101,6 +111,11 @@ MSCDataGroup::MSCDataGroup(const QByteArray &dataGroup)
     {
         m_transportIdFlag = (*inputDataPtr & 0x10) != 0;
         m_lengthIndicator = (*inputDataPtr++ & 0x0F);
+        if ((inputDataPtr + m_lengthIndicator + crcFlag * 2 > dataGroupEnd) || (m_lengthIndicator < m_transportIdFlag * 2))
+        {  // user access field does not fit into data group
+            return;
+        }
+
         if (m_transportIdFlag)
         {
             m_transportId = (*inputDataPtr << 8) | *(inputDataPtr + 1);
@@ -112,8 +127,9 @@ MSCDataGroup::MSCDataGroup(const QByteArray &dataGroup)
 
         if (m_lengthIndicator - m_transportIdFlag * 2 > 0)
         {  // end user address field is present
-            m_endUserAddrField = QByteArray((const char *)inputDataPtr, (m_lengthIndicator - m_transportIdFlag * 2));
-            inputDataPtr += m_lengthIndicator - m_transportIdFlag * 2;
+            m_endUserAddrFieldOffset = inputDataPtr - dataGroupPtr;
+            m_endUserAddrFieldSize = m_lengthIndicator - m_transportIdFlag * 2;
+            inputDataPtr += m_endUserAddrFieldSize;
         }
         else
         { /* no end user address field */
@@ -124,16 +140,25 @@ MSCDataGroup::MSCDataGroup(const QByteArray &dataGroup)
     }
 
     // inputDataPtr -> beginning of MSC data group data field
-    int dataFieldSize = dataGroup.size() - (inputDataPtr - (const uint8_t *)dataGroup.constBegin()) - crcFlag * 2;
-
-    m_dataField = QByteArray((const char *)inputDataPtr, dataFieldSize);
+    m_dataFieldOffset = inputDataPtr - dataGroupPtr;
+    m_dataFieldSize = m_dataGroup.size() - m_dataFieldOffset - crcFlag * 2;
 
     m_isValid = true;
 }
 
 QByteArray::const_iterator MSCDataGroup::dataFieldConstBegin() const
 {
-    return m_dataField.constBegin();
+    return m_dataGroup.constBegin() + m_dataFieldOffset;
+}
+
+QByteArrayView MSCDataGroup::dataField() const
+{
+    return QByteArrayView(m_dataGroup.constData() + m_dataFieldOffset, m_dataFieldSize);
+}
+
+QByteArrayView MSCDataGroup::endUserAddressField() const
+{
+    return QByteArrayView(m_dataGroup.constData() + m_endUserAddrFieldOffset, m_endUserAddrFieldSize);
 }
 
 uint8_t MSCDataGroup::getType() const
@@ -160,26 +185,3 @@ bool MSCDataGroup::isValid() const
 {
     return m_isValid;
 }
-
-bool MSCDataGroup::crc16check(const QByteArray &data)
-{
-    uint16_t crc = 0xFFFF;
-    uint16_t mask = 0x1020;
-
-    for (int n = 0; n < data.size() - 2; ++n)
-    {
-        for (int bit = 7; bit >= 0; --bit)
-        {
-            uint16_t in = (data[n] >> bit) & 0x1;
-            uint16_t tmp = in ^ ((crc >> 15) & 0x1);
-            crc <<= 1;
-
-            crc ^= (tmp * mask);
-            crc += tmp;
-        }
-    }
-
-    uint16_t invTxCRC = ~((uint16_t(data[data.size() - 2]) << 8) | uint8_t(data[data.size() - 1]));
-
-    return (crc == invTxCRC);
-}
@@ -28,12 +28,18 @@
 #define MSCDATAGROUP_H
 
 #include <QByteArray>
+#include <QByteArrayView>
 
+// MSC data group [ETSI EN 300 401, 5.3.3]
+// Data group is parsed in place, the object keeps implicitly shared reference to data group buffer
+// and the fields are accessed as views to this buffer, no data is copied.
 class MSCDataGroup
 {
 public:
     explicit MSCDataGroup(const QByteArray &dataGroup);
     QByteArray::const_iterator dataFieldConstBegin() const;
+    QByteArrayView dataField() const;
+    QByteArrayView endUserAddressField() const;
 
     uint8_t getType() const;
     uint16_t getSegmentNum() const;
@@ -42,6 +48,7 @@ public:
     bool isValid() const;
 
 private:
+    QByteArray m_dataGroup;
     bool m_isValid = false;
     bool m_extensionFlag;
     bool m_segmentFlag;
@@ -55,10 +62,10 @@ private:
     bool m_transportIdFlag;
     uint8_t m_lengthIndicator;
     uint16_t m_transportId;
-    QByteArray m_endUserAddrField;
-    QByteArray m_dataField;
-
-    bool crc16check(const QByteArray &data);
+    qsizetype m_endUserAddrFieldOffset = 0;
+    qsizetype m_endUserAddrFieldSize = 0;
+    qsizetype m_dataFieldOffset = 0;
+    qsizetype m_dataFieldSize = 0;
 };
 
 #endif  // MSCDATAGROUP_H
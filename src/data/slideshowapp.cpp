@@ -26,6 +26,7 @@
 
 #include "slideshowapp.h"
 
+#include <QCoreApplication>
 #include <QDir>
 #include <QLoggingCategory>
 #include <QRegularExpression>
@@ -33,6 +34,7 @@
 
 #include "androidfilehelper.h"
 #include "dabtables.h"
+#include "imagecache.h"
 
 Q_LOGGING_CATEGORY(slideShowApp, "SlideShowApp", QtInfoMsg)
 
@@ -40,10 +42,18 @@ SlideShowApp::SlideShowApp(QObject *parent) : UserApplication(parent)
 {
     m_decoder = nullptr;
     m_dumpEna = false;
+    m_prescaleHeight = 0;
+    m_decodeSeqNext = 0;
+    m_decodeSeqProcessed = 0;
+    m_decoderPool.setMaxThreadCount(SLIDESHOWAPP_DECODER_THREADS);
 }
 
 SlideShowApp::~SlideShowApp()
 {
+    // pending decoding jobs are not needed anymore
+    m_decoderPool.clear();
+    m_decoderPool.waitForDone();
+
     if (nullptr != m_decoder)
     {
         delete m_decoder;
@@ -76,6 +86,11 @@ void SlideShowApp::stop()
     }
     m_isRunning = false;
 
+    // drop slides that are being decoded
+    m_decoderPool.clear();
+    m_decodeSeqProcessed = m_decodeSeqNext;
+    m_decodedSlides.clear();
+
     // clear cache
     m_cache.clear();
 
@@ -92,6 +107,14 @@ void SlideShowApp::restart()
     start();
 }
 
+void SlideShowApp::waitForDecoding()
+{
+    m_decoderPool.waitForDone();
+
+    // deliver decoded slides queued to this object
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
 void SlideShowApp::setDataDumping(const Settings::UADumpSettings &settings)
 {
     m_dumpEna = settings.slsEna;
@@ -315,16 +338,50 @@ void SlideShowApp::onNewMOTObject(const MOTObject &obj)
 
     // required for dumping functionality
     slide.setTransportID(obj.getId());
+    slide.setRawData(obj.getBody());
+
+    // image is decoded in worker thread, slides are processed in order of reception
+    uint32_t seq = m_decodeSeqNext++;
+    int maxHeight = m_prescaleHeight;
+    m_decoderPool.start(
+        [this, seq, slide, maxHeight]() mutable
+        {
+            if (!slide.decode(maxHeight))
+            {  // loading of data failed -> null slide is passed to skip the sequence number
+                slide = Slide();
+            }
+            QMetaObject::invokeMethod(this, [this, seq, slide]() { onSlideDecoded(seq, slide); }, Qt::QueuedConnection);
+        });
+}
 
-    // we can try to load data to Slide
-    if (!slide.setPixmap(obj.getBody()))
-    {  // loading of data failed
+void SlideShowApp::onSlideDecoded(uint32_t seq, const Slide &slide)
+{
+    if (uint32_t(seq - m_decodeSeqProcessed) >= uint32_t(m_decodeSeqNext - m_decodeSeqProcessed))
+    {  // slide was decoded before stop() -> ignoring
         return;
     }
-    else
-    { /* slide body is correct */
+    m_decodedSlides.insert(seq, slide);
+
+    // process all slides that are ready in order of reception
+    auto it = m_decodedSlides.find(m_decodeSeqProcessed);
+    while (m_decodedSlides.end() != it)
+    {
+        Slide decodedSlide = *it;
+        m_decodedSlides.erase(it);
+        ++m_decodeSeqProcessed;
+        if (!decodedSlide.getImage().isNull())
+        {
+            processSlide(decodedSlide);
+        }
+        else
+        { /* decoding failed */
+        }
+        it = m_decodedSlides.find(m_decodeSeqProcessed);
     }
+}
 
+void SlideShowApp::processSlide(const Slide &slide)
+{
     // dump slide if requested
     if (m_dumpEna)
     {
@@ -345,7 +402,7 @@ void SlideShowApp::onNewMOTObject(const MOTObject &obj)
         if (m_cache.cend() != cacheIt)
         {  // item is in the cache -> decategorize and delete from cache
 #if (USER_APPLICATION_VERBOSE > 1)
-            qCDebug(slideShowApp) << "Item" << obj.getContentName() << "is already in cache";
+            qCDebug(slideShowApp) << "Item" << slide.getContentName() << "is already in cache";
 #endif
             // remove old slide from category
             removeSlideFromCategory(*cacheIt);
@@ -366,7 +423,7 @@ void SlideShowApp::onNewMOTObject(const MOTObject &obj)
         if (m_cache.cend() != cacheIt)
         {  // item is already received
 #if (USER_APPLICATION_VERBOSE > 1)
-            qCDebug(slideShowApp) << "Item" << obj.getContentName() << "is already in cache";
+            qCDebug(slideShowApp) << "Item" << slide.getContentName() << "is already in cache";
 #endif
             // ETSI TS 101 499 V3.1.1 [6.3 Updating parameters]
             // The CategoryID/SlideID parameter is used to change the category and/or ordering of a previously delivered slide or to decategorize the
@@ -631,24 +688,27 @@ void SlideShowApp::getNextCatSlide(int catId, bool forward)
 
 SlideData::SlideData()
 {
-    pixmap = QPixmap(0, 0);  // this creates NULL pixmap
     contentName = QString("");
     categoryTitle = QString("");
     clickThroughURL = QString("");
     alternativeLocationURL = QString("");
     format = QString("");
+    transportID = 0;
     categoryID = 0;
     slideID = 0;
     numBytes = 0;
 }
 
 SlideData::SlideData(const SlideData &other)
-    : pixmap(other.pixmap),
+    : image(other.image),
+      size(other.size),
+      rawData(other.rawData),
       contentName(other.contentName),
       categoryTitle(other.categoryTitle),
       clickThroughURL(other.clickThroughURL),
       alternativeLocationURL(other.alternativeLocationURL),
       format(other.format),
+      transportID(other.transportID),
       categoryID(other.categoryID),
       slideID(other.slideID),
       numBytes(other.numBytes)
@@ -661,20 +721,28 @@ Slide::Slide()
 
 QPixmap Slide::getPixmap() const
 {
-    return d->pixmap;
+    return QPixmap::fromImage(d->image);
 }
 
-bool Slide::setPixmap(const QByteArray &data)
+bool Slide::setPixmap(const QPixmap &pixmap)
+{
+    d->image = pixmap.toImage();
+    d->size = d->image.size();
+    return true;
+}
+
+void Slide::setRawData(const QByteArray &data)
 {
     d->numBytes = data.size();
     d->rawData = data;
-    return d->pixmap.loadFromData(data);
 }
 
-bool Slide::setPixmap(const QPixmap &pixmap)
+bool Slide::decode(int maxHeight)
 {
-    d->pixmap = pixmap;
-    return true;
+    // broadcasters repeat the same slides, the image is decoded only when the content was not seen yet
+    // prescaling to display size is done by cache, original data are kept in rawData
+    d->image = ImageCache::getInstance()->image(d->rawData, maxHeight, &d->size);
+    return !d->image.isNull();
 }
 
 const QString &Slide::getContentName() const
@@ -28,14 +28,19 @@
 #define SLIDESHOWAPP_H
 
 #include <QHash>
+#include <QImage>
+#include <QMap>
 #include <QObject>
 #include <QPixmap>
 #include <QSharedData>
+#include <QThreadPool>
 
 #include "motdecoder.h"
 #include "radiocontrol.h"
 #include "userapplication.h"
 
+#define SLIDESHOWAPP_DECODER_THREADS (2)  // number of threads decoding slide images
+
 class SlideData : public QSharedData
 {
 public:
@@ -43,7 +48,8 @@ public:
     SlideData(const SlideData &other);
     ~SlideData() {}
 
-    QPixmap pixmap;
+    QImage image;
+    QSize size;  // original resolution, image can be prescaled
     QByteArray rawData;
     QString contentName;
     QString categoryTitle;
@@ -62,9 +68,12 @@ public:
     Slide();
     Slide(const Slide &other) : d(other.d) {}
 
-    QPixmap getPixmap() const;
-    bool setPixmap(const QByteArray &data);
+    QImage getImage() const { return d->image; }
+    QSize getSize() const { return d->size; }
+    QPixmap getPixmap() const;  // GUI thread only
     bool setPixmap(const QPixmap &pixmap);
+    void setRawData(const QByteArray &data);
+    bool decode(int maxHeight = 0);  // decodes raw data to image, image higher than maxHeight is scaled down (0 = no scaling)
 
     const QString &getContentName() const;
     void setContentName(const QString &newContentName);
@@ -130,6 +139,8 @@ public:
 
     void getCurrentCatSlide(int catId);
     void getNextCatSlide(int catId, bool forward = true);
+    void setPrescaleHeight(int height) { m_prescaleHeight = height; }
+    void waitForDecoding();  // blocks until all received slides are decoded and processed
 signals:
     // this signal is emitted anytime when new slide is received
     void currentSlide(const Slide &slide);
@@ -145,6 +156,15 @@ private:
     QHash<QString, Slide> m_cache;
     QHash<int, Category> m_catSls;
 
+    // slides are decoded in worker threads and processed in order of reception
+    int m_prescaleHeight;
+    uint32_t m_decodeSeqNext;
+    uint32_t m_decodeSeqProcessed;
+    QMap<uint32_t, Slide> m_decodedSlides;
+    QThreadPool m_decoderPool;
+
+    void onSlideDecoded(uint32_t seq, const Slide &slide);
+    void processSlide(const Slide &slide);
     void addSlideToCategory(const Slide &slide);
     void removeSlideFromCategory(const Slide &slide);
     void dumpSlide(const Slide &slide);
@@ -46,6 +46,9 @@ SPIApp::SPIApp(QObject *parent) : UserApplication(parent)
     // m_decoder = nullptr;
     m_dnsLookup = nullptr;
     m_netAccessManager = nullptr;
+    m_cacheBudget = 0;
+    m_isProgrammeInfo = false;
+    m_scheduleHasScope = false;
     m_useInternet = false;
     m_enaRadioDNS = false;
 #ifdef Q_OS_ANDROID
@@ -171,6 +174,15 @@ void SPIApp::enable(bool ena)
     }
 }
 
+void SPIApp::setCacheBudget(int budgetMB)
+{
+    m_cacheBudget = qint64(budgetMB) * 1024 * 1024;
+    for (const auto &decoder : std::as_const(m_decoderMap))
+    {
+        decoder->setCacheBudget(m_cacheBudget);
+    }
+}
+
 void SPIApp::setEnableRadioDNS(bool ena)
 {
     if (m_enaRadioDNS != ena)
@@ -194,6 +206,7 @@ void SPIApp::onUserAppData(const RadioControlUserAppData &data)
         {  // we do not have decoder for this channel
             // create new decoder
             decoderPtr = new MOTDecoder(this);
+            decoderPtr->setCacheBudget(m_cacheBudget);
             connect(decoderPtr, &MOTDecoder::newMOTDirectory, this, &SPIApp::onNewMOTDirectory);
             connect(decoderPtr, &MOTDecoder::newMOTObjectInDirectory, this, &SPIApp::onNewMOTObjectInDirectory);
             m_decoderMap[data.SCId] = decoderPtr;
@@ -256,7 +269,8 @@ void SPIApp::onNewMOTDirectory()
     }
     if (m_decoderMap.count() <= 2)
     {
-        emit decodingProgress(decoderId != 0xFFFF, decoderPtr->directoryCountCompleted(), decoderPtr->directoryCount());
+        emit decodingProgress(decoderId != 0xFFFF, decoderPtr->directoryCountCompleted(), decoderPtr->directoryCount(),
+                              decoderPtr->cacheStatistics());
     }
 }
 
@@ -303,7 +317,8 @@ void SPIApp::onNewMOTObjectInDirectory(const QString &contentName)
         }
         if (m_decoderMap.count() <= 2)
         {
-            emit decodingProgress(decoderId != 0xFFFF, decoderPtr->directoryCountCompleted(), decoderPtr->directoryCount());
+            emit decodingProgress(decoderId != 0xFFFF, decoderPtr->directoryCountCompleted(), decoderPtr->directoryCount(),
+                                  decoderPtr->cacheStatistics());
         }
     }
 }
@@ -327,7 +342,7 @@ void SPIApp::processObject(uint16_t decoderId, MOTObjectCache::const_iterator ob
                 auto requests = m_motObjRequestList[decoderId].values(objIt->getContentName());
                 for (const auto &requestId : requests)
                 {
-                    emit requestedFile(objIt->getBody(), requestId);
+                    emit requestedFile(objIt->getBody(), requestId, decoderId);
                 }
                 m_motObjRequestList[decoderId].remove(objIt->getContentName());
             }
@@ -434,7 +449,7 @@ void SPIApp::onFileRequest(uint16_t decoderId, const QString &url, const QString
             const auto it = decoder->find(filename);
             if (it != decoder->directoryEnd() && it->isComplete())
             {
-                emit requestedFile(it->getBody(), requestId);
+                emit requestedFile(it->getBody(), requestId, decoderId);
                 return;
             }
         }
@@ -529,72 +544,66 @@ void SPIApp::parseBinaryInfo(uint16_t decoderId, const MOTObject &motObj)
         }
     }
 
+    // scope parameters are used when scope element is not present
+    m_isProgrammeInfo = (motObj.getContentSubType() == 1);
+    m_paramScopeStart = scopeStart;
+    m_paramScopeEnd = scopeEnd;
+    m_paramScopeId = scopeId;
+
+    // binary encoded SPI is decoded directly to metadata, XML document is created only for dumping
     const QByteArray data = motObj.getBody();
-    m_xmldocument.clear();
+    SPIMetadataBuilder builder;
+    parseBody(data, builder);
+
+    if (m_dumpEna)
+    {
+        SPIXmlWriter writer;
+        parseBody(data, writer);
+        dumpFile(decoderId, motObj.getId(), motObj.getContentName() + ".xml", writer.toByteArray());
+    }
+
+    emit metadata(builder.metadata(), m_paramScopeId, decoderId);
+}
+
+void SPIApp::parseBody(const QByteArray &data, SPIVisitor &visitor)
+{
     m_tokenTable.clear();
 
     // compatibility with encoding according to ETSI TS 102 371 V1.3.1 (2008-07)
     m_contentId.clear();
     m_scopeStart = QDateTime();
 
-    QDomProcessingInstruction header = m_xmldocument.createProcessingInstruction("xml", "version=\"1.0\" encoding=\"utf-8\"");
-    m_xmldocument.appendChild(header);
-    const uint8_t *dataPtr = (uint8_t *)data.data();
-
-    QDomElement empty;
-    parseTag(dataPtr, empty, uint8_t(SPIElement::Tag::_invalid), data.size());
-
-    // if (m_dumpEna)
-    // {
-    //     dumpFile(decoderId, motObj.getContentName()+".xml", m_xmldocument.toByteArray());
-    // }
+    const uint8_t *dataPtr = reinterpret_cast<const uint8_t *>(data.constData());
+    parseTag(dataPtr, visitor, uint8_t(SPIElement::Tag::_invalid), data.size());
+}
 
-    // add service scope if not in XML
-    if (motObj.getContentSubType() == 1)
+void SPIApp::addScope(SPIVisitor &visitor)
+{
+    QString scopeStart = m_paramScopeStart;
+    if (scopeStart.isEmpty())
     {
-        QDomElement root = m_xmldocument.documentElement();
-        if (root.tagName() == "epg")
-        {
-            QDomElement schedule = root.firstChildElement("schedule");
-            if (!schedule.isNull())
-            {
-                QDomElement scope = schedule.firstChildElement("scope");
-                if (scope.isNull())
-                {  // scope not found creating using MOT objects params
-                    scope = m_xmldocument.createElement("scope");
-                    if (scopeStart.isEmpty())
-                    {
-                        scopeStart = m_scopeStart.toString(Qt::ISODate);
-                    }
-                    scope.setAttribute("startTime", scopeStart);
-                    if (scopeEnd.isEmpty())
-                    {
-                        scopeEnd = QDateTime::fromString(scopeStart, Qt::ISODate).addDays(1).toString(Qt::ISODate);
-                    }
-                    scope.setAttribute("stopTime", scopeEnd);
-
-                    if (scopeId.isEmpty())
-                    {
-                        scopeId = m_contentId;  // compatibility with encoding according to ETSI TS 102 371 V1.3.1 (2008-07)
-                    }
-                    QDomElement serviceScope = m_xmldocument.createElement("serviceScope");
-                    serviceScope.setAttribute("id", scopeId);
-                    scope.appendChild(serviceScope);
-                    schedule.insertBefore(scope, QDomNode());
-                }
-            }
-        }
+        scopeStart = m_scopeStart.toString(Qt::ISODate);
     }
-
-    if (m_dumpEna)
+    QString scopeEnd = m_paramScopeEnd;
+    if (scopeEnd.isEmpty())
+    {
+        scopeEnd = QDateTime::fromString(scopeStart, Qt::ISODate).addDays(1).toString(Qt::ISODate);
+    }
+    if (m_paramScopeId.isEmpty())
     {
-        dumpFile(decoderId, motObj.getId(), motObj.getContentName() + ".xml", m_xmldocument.toByteArray());
+        m_paramScopeId = m_contentId;  // compatibility with encoding according to ETSI TS 102 371 V1.3.1 (2008-07)
     }
 
-    emit xmlDocument(m_xmldocument.toString(), scopeId, decoderId);
+    visitor.startElement("scope");
+    visitor.attribute("startTime", scopeStart);
+    visitor.attribute("stopTime", scopeEnd);
+    visitor.startElement("serviceScope");
+    visitor.attribute("id", m_paramScopeId);
+    visitor.endElement();
+    visitor.endElement();
 }
 
-uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, uint8_t parentTag, int maxSize)
+uint32_t SPIApp::parseTag(const uint8_t *dataPtr, SPIVisitor &visitor, uint8_t parentTag, int maxSize)
 {
     if (maxSize < 2)
     {  // not enough data
@@ -646,30 +655,22 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
     }
 
     // we know that we have enough data here
-    QDomElement element;
+    const char *elementName = nullptr;
     if (tag < 0x80)
     {  // element tags
         switch (SPIElement::Tag(tag))
         {
             case SPIElement::Tag::CDATA:
             {  // ETSI TS 102 371 V3.2.1 [4.5.0]
-                if (!parentElement.isNull())
+                if (uint8_t(SPIElement::Tag::_invalid) != parentTag)
                 {
-                    if (("point" == parentElement.tagName()) || ("polygon" == parentElement.tagName()))
+                    if ((uint8_t(SPIElement::Tag::point) == parentTag) || (uint8_t(SPIElement::Tag::polygon) == parentTag))
                     {  // point or polygon are coded as doubleListType
-                        QString str = getDoubleList(dataPtr, len);
-                        parentElement.appendChild(m_xmldocument.createTextNode(str));
+                        visitor.text(getDoubleList(dataPtr, len));
                     }
                     else
                     {
-                        QString str = getString(dataPtr, len, true);
-                        parentElement.appendChild(m_xmldocument.createCDATASection(str));
-                        // QDomText txt = m_xmldocument.createTextNode(str);
-                        // if (txt.isNull())
-                        // {
-                        //     txt = m_xmldocument.createCDATASection(str);
-                        // }
-                        // parentElement.appendChild(txt);
+                        visitor.text(getString(dataPtr, len, true));
                     }
                 }
                 else
@@ -680,10 +681,10 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
             }
             break;
             case SPIElement::Tag::epg:
-                element = m_xmldocument.createElement("epg");
+                elementName = "epg";
                 break;
             case SPIElement::Tag::serviceInformation:
-                element = m_xmldocument.createElement("serviceInformation");
+                elementName = "serviceInformation";
                 break;
             case SPIElement::Tag::tokenTable:
                 m_tokenTable.clear();
@@ -717,108 +718,110 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 // default language element is present, then whenever an xml:lang attribute with the same value as the default language occurs within
                 // an element, it does not need to be encoded. Whenever a decoder finds a missing xml:lang attribute for an element, then it shall use
                 // the default language value.
-                QString defaultLang = getString(dataPtr, len, false);
-                parentElement.setAttribute("xml:lang", defaultLang);
+                if (uint8_t(SPIElement::Tag::_invalid) != parentTag)
+                {
+                    visitor.attribute("xml:lang", getString(dataPtr, len, false));
+                }
                 bytesRead += len;
             }
             break;
             case SPIElement::Tag::shortName:
-                element = m_xmldocument.createElement("shortName");
+                elementName = "shortName";
                 break;
             case SPIElement::Tag::mediumName:
-                element = m_xmldocument.createElement("mediumName");
+                elementName = "mediumName";
                 break;
             case SPIElement::Tag::longName:
-                element = m_xmldocument.createElement("longName");
+                elementName = "longName";
                 break;
             case SPIElement::Tag::mediaDescription:
-                element = m_xmldocument.createElement("mediaDescription");
+                elementName = "mediaDescription";
                 break;
             case SPIElement::Tag::genre:
-                element = m_xmldocument.createElement("genre");
+                elementName = "genre";
                 break;
             case SPIElement::Tag::keywords:
-                element = m_xmldocument.createElement("keywords");
+                elementName = "keywords";
                 break;
             case SPIElement::Tag::memberOf:
-                element = m_xmldocument.createElement("memberOf");
+                elementName = "memberOf";
                 break;
             case SPIElement::Tag::link:
-                element = m_xmldocument.createElement("link");
+                elementName = "link";
                 break;
             case SPIElement::Tag::location:
-                element = m_xmldocument.createElement("location");
+                elementName = "location";
                 break;
             case SPIElement::Tag::shortDescription:
-                element = m_xmldocument.createElement("shortDescription");
+                elementName = "shortDescription";
                 break;
             case SPIElement::Tag::longDescription:
-                element = m_xmldocument.createElement("longDescription");
+                elementName = "longDescription";
                 break;
             case SPIElement::Tag::programme:
-                element = m_xmldocument.createElement("programme");
+                elementName = "programme";
                 break;
             case SPIElement::Tag::programmeGroups:
-                element = m_xmldocument.createElement("programmeGroups");
+                elementName = "programmeGroups";
                 break;
             case SPIElement::Tag::schedule:
-                element = m_xmldocument.createElement("schedule");
+                elementName = "schedule";
                 break;
             case SPIElement::Tag::programmeGroup:
-                element = m_xmldocument.createElement("programmeGroup");
+                elementName = "programmeGroup";
                 break;
             case SPIElement::Tag::scope:
-                element = m_xmldocument.createElement("scope");
+                elementName = "scope";
                 break;
             case SPIElement::Tag::serviceScope:
-                element = m_xmldocument.createElement("serviceScope");
+                elementName = "serviceScope";
                 break;
             case SPIElement::Tag::ensemble:
                 // ETSI TS 102 818 V3.4.1 (2022-05) Annex F: ensemble element has been replaced by the services element
-                element = m_xmldocument.createElement("services");
+                elementName = "services";
                 break;
             case SPIElement::Tag::service:
-                element = m_xmldocument.createElement("service");
+                elementName = "service";
                 break;
             case SPIElement::Tag::multimedia:
-                element = m_xmldocument.createElement("multimedia");
+                elementName = "multimedia";
                 break;
             case SPIElement::Tag::time:
-                element = m_xmldocument.createElement("time");
+                elementName = "time";
                 break;
             case SPIElement::Tag::bearer_serviceID:
             case SPIElement::Tag::bearer:
-                element = m_xmldocument.createElement("bearer");
+                elementName = "bearer";
                 break;
             case SPIElement::Tag::programmeEvent:
-                element = m_xmldocument.createElement("programmeEvent");
+                elementName = "programmeEvent";
                 break;
             case SPIElement::Tag::relativeTime:
-                element = m_xmldocument.createElement("relativeTime");
+                elementName = "relativeTime";
                 break;
             case SPIElement::Tag::radiodns:
-                element = m_xmldocument.createElement("radiodns");
+                elementName = "radiodns";
                 break;
             case SPIElement::Tag::geolocation:
-                element = m_xmldocument.createElement("geolocation");
+                elementName = "geolocation";
                 break;
             case SPIElement::Tag::country:
-                element = m_xmldocument.createElement("country");
+                elementName = "country";
                 break;
             case SPIElement::Tag::point:
-                element = m_xmldocument.createElement("point");
+                elementName = "point";
                 break;
             case SPIElement::Tag::polygon:
-                element = m_xmldocument.createElement("polygon");
+                elementName = "polygon";
                 break;
             case SPIElement::Tag::onDemand:
-                element = m_xmldocument.createElement("onDemand");
+                elementName = "onDemand";
                 break;
             case SPIElement::Tag::presentationTime:
-                element = m_xmldocument.createElement("presentationTime");
+                elementName = "presentationTime";
                 break;
             case SPIElement::Tag::acquisitionTime:
-                element = m_xmldocument.createElement("acquisitionTime");
+                elementName = "acquisitionTime";
                 break;
             default:
                 // unknown
@@ -827,24 +830,39 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 break;
         }
 
-        // parse attributes
-        if (!element.tagName().isEmpty())
+        // parse attributes and child elements
+        if (nullptr != elementName)
         {
-            while (len > bytesRead)
+            visitor.startElement(elementName);
+            if ((SPIElement::Tag::programme == SPIElement::Tag(tag)) || (SPIElement::Tag::programmeEvent == SPIElement::Tag(tag)))
+            {  // optional attributes default values
+                visitor.attribute("broadcast", "on-air");
+                visitor.attribute("recommendation", "no");
+            }
+            else if (SPIElement::Tag::schedule == SPIElement::Tag(tag))
             {
-                uint32_t numBytes = parseTag(dataPtr, element, tag, len);
-                bytesRead += numBytes;
-                dataPtr += numBytes;
+                m_scheduleHasScope = false;
             }
-
-            if (parentElement.isNull())
+            else if ((SPIElement::Tag::scope == SPIElement::Tag(tag)) && (uint8_t(SPIElement::Tag::schedule) == parentTag))
             {
-                m_xmldocument.appendChild(element);
+                m_scheduleHasScope = true;
             }
             else
+            { /* no special handling */
+            }
+
+            while (len > bytesRead)
             {
-                parentElement.appendChild(element);
+                uint32_t numBytes = parseTag(dataPtr, visitor, tag, len);
+                bytesRead += numBytes;
+                dataPtr += numBytes;
+            }
+
+            if ((SPIElement::Tag::schedule == SPIElement::Tag(tag)) && m_isProgrammeInfo && !m_scheduleHasScope)
+            {  // scope not found, creating using MOT objects params
+                addScope(visitor);
             }
+            visitor.endElement();
         }
     }
     else
@@ -859,16 +877,16 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                     case SPIElement::serviceInformation::attribute::version:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.8.3 version]
                         // Encoded as a 16-bit unsigned integer.
-                        setAttribute_uint16(parentElement, "version", dataPtr, len);
+                        setAttribute_uint16(visitor, "version", dataPtr, len);
                         break;
                     case SPIElement::serviceInformation::attribute::creationTime:
-                        setAttribute_timePoint(parentElement, "creationTime", dataPtr, len);
+                        setAttribute_timePoint(visitor, "creationTime", dataPtr, len);
                         break;
                     case SPIElement::serviceInformation::attribute::originator:
-                        setAttribute_string(parentElement, "originator", dataPtr, len, false);
+                        setAttribute_string(visitor, "originator", dataPtr, len, false);
                         break;
                     case SPIElement::serviceInformation::attribute::serviceProvider:
-                        setAttribute_string(parentElement, "serviceProvider", dataPtr, len, false);
+                        setAttribute_string(visitor, "serviceProvider", dataPtr, len, false);
                         break;
                 }
                 break;
@@ -880,7 +898,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::shortName::attribute(tag))
                 {
                     case SPIElement::shortName::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                 }
                 break;
@@ -888,7 +906,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::mediumName::attribute(tag))
                 {
                     case SPIElement::mediumName::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                 }
                 break;
@@ -896,7 +914,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::longName::attribute(tag))
                 {
                     case SPIElement::longName::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                 }
                 break;
@@ -904,7 +922,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::shortDescription::attribute(tag))
                 {
                     case SPIElement::shortDescription::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                 }
                 break;
@@ -912,7 +930,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::longDescription::attribute(tag))
                 {
                     case SPIElement::longDescription::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                 }
                 break;
@@ -963,20 +981,20 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                             href += QString(".%1").arg(*dataPtr++);
                         }
 
-                        parentElement.setAttribute("href", href);
+                        visitor.attribute("href", href);
                     }
                     break;
                     case SPIElement::genre::attribute::type:
                         switch (*dataPtr)
                         {
                             case 0x01:
-                                parentElement.setAttribute("type", "main");
+                                visitor.attribute("type", "main");
                                 break;
                             case 0x02:
-                                parentElement.setAttribute("type", "secondary");
+                                visitor.attribute("type", "secondary");
                                 break;
                             case 0x03:
-                                parentElement.setAttribute("type", "other");
+                                visitor.attribute("type", "other");
                                 break;
                         }
                         break;
@@ -986,7 +1004,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::keywords::attribute(tag))
                 {
                     case SPIElement::keywords::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                 }
                 break;
@@ -994,15 +1012,15 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::memberOf::attribute(tag))
                 {
                     case SPIElement::memberOf::attribute::id:
-                        setAttribute_string(parentElement, "id", dataPtr, len, false);
+                        setAttribute_string(visitor, "id", dataPtr, len, false);
                         break;
                     case SPIElement::memberOf::attribute::shortId:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.7.2]
                         // All attributes defined as shortCRID type are encoded as a 24-bit unsigned integer.
-                        setAttribute_uint24(parentElement, "shortId", dataPtr, len);
+                        setAttribute_uint24(visitor, "shortId", dataPtr, len);
                         break;
                     case SPIElement::memberOf::attribute::index:
-                        setAttribute_uint16(parentElement, "index", dataPtr, len);
+                        setAttribute_uint16(visitor, "index", dataPtr, len);
                         break;
                 }
                 break;
@@ -1010,19 +1028,19 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::link::attribute(tag))
                 {
                     case SPIElement::link::attribute::uri:
-                        setAttribute_string(parentElement, "uri", dataPtr, len, true);
+                        setAttribute_string(visitor, "uri", dataPtr, len, true);
                         break;
                     case SPIElement::link::attribute::mimeValue:
-                        setAttribute_string(parentElement, "mimeValue", dataPtr, len, false);
+                        setAttribute_string(visitor, "mimeValue", dataPtr, len, false);
                         break;
                     case SPIElement::link::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                     case SPIElement::link::attribute::description:
-                        setAttribute_string(parentElement, "description", dataPtr, len, true);
+                        setAttribute_string(visitor, "description", dataPtr, len, true);
                         break;
                     case SPIElement::link::attribute::expiryTime:
-                        setAttribute_timePoint(parentElement, "expiryTime", dataPtr, len);
+                        setAttribute_timePoint(visitor, "expiryTime", dataPtr, len);
                         break;
                 }
                 break;
@@ -1030,32 +1048,29 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 //            break;
             case SPIElement::Tag::programme:
             case SPIElement::Tag::programmeEvent:
-                // optional attributes default values
-                parentElement.setAttribute("broadcast", "on-air");
-                parentElement.setAttribute("recommendation", "no");
                 switch (SPIElement::programme_programmeEvent::attribute(tag))
                 {
                     case SPIElement::programme_programmeEvent::attribute::id:
-                        setAttribute_string(parentElement, "id", dataPtr, len, false);
+                        setAttribute_string(visitor, "id", dataPtr, len, false);
                         break;
                     case SPIElement::programme_programmeEvent::attribute::shortId:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.7.2]
                         // All attributes defined as shortCRID type are encoded as a 24-bit unsigned integer.
-                        setAttribute_uint24(parentElement, "shortId", dataPtr, len);
+                        setAttribute_uint24(visitor, "shortId", dataPtr, len);
                         break;
                     case SPIElement::programme_programmeEvent::attribute::version:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.8.3 version]
                         // Encoded as a 16-bit unsigned integer.
-                        setAttribute_uint16(parentElement, "version", dataPtr, len);
+                        setAttribute_uint16(visitor, "version", dataPtr, len);
                         break;
                     case SPIElement::programme_programmeEvent::attribute::recommendation:
                         switch (*dataPtr)
                         {
                             case 0x01:
-                                parentElement.setAttribute("recommendation", "no");
+                                visitor.attribute("recommendation", "no");
                                 break;
                             case 0x02:
-                                parentElement.setAttribute("recommendation", "yes");
+                                visitor.attribute("recommendation", "yes");
                                 break;
                         }
                         break;
@@ -1063,15 +1078,15 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                         switch (*dataPtr)
                         {
                             case 0x01:
-                                parentElement.setAttribute("broadcast", "on-air");
+                                visitor.attribute("broadcast", "on-air");
                                 break;
                             case 0x02:
-                                parentElement.setAttribute("broadcast", "off-air");
+                                visitor.attribute("broadcast", "off-air");
                                 break;
                         }
                         break;
                     case SPIElement::programme_programmeEvent::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                 }
                 break;
@@ -1082,13 +1097,13 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                     case SPIElement::programmeGroups_schedule::attribute::version:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.8.3 version]
                         // Encoded as a 16-bit unsigned integer.
-                        setAttribute_uint16(parentElement, "version", dataPtr, len);
+                        setAttribute_uint16(visitor, "version", dataPtr, len);
                         break;
                     case SPIElement::programmeGroups_schedule::attribute::creationTime:
-                        setAttribute_timePoint(parentElement, "creationTime", dataPtr, len);
+                        setAttribute_timePoint(visitor, "creationTime", dataPtr, len);
                         break;
                     case SPIElement::programmeGroups_schedule::attribute::originator:
-                        setAttribute_string(parentElement, "originator", dataPtr, len, true);
+                        setAttribute_string(visitor, "originator", dataPtr, len, true);
                         break;
                 }
                 break;
@@ -1096,51 +1111,51 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::programmeGroup::attribute(tag))
                 {
                     case SPIElement::programmeGroup::attribute::id:
-                        setAttribute_string(parentElement, "id", dataPtr, len, false);
+                        setAttribute_string(visitor, "id", dataPtr, len, false);
                         break;
                     case SPIElement::programmeGroup::attribute::shortId:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.7.2]
                         // All attributes defined as shortCRID type are encoded as a 24-bit unsigned integer.
-                        setAttribute_uint24(parentElement, "shortId", dataPtr, len);
+                        setAttribute_uint24(visitor, "shortId", dataPtr, len);
                         break;
                     case SPIElement::programmeGroup::attribute::version:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.8.3 version]
                         // Encoded as a 16-bit unsigned integer.
-                        setAttribute_uint16(parentElement, "version", dataPtr, len);
+                        setAttribute_uint16(visitor, "version", dataPtr, len);
                         break;
                     case SPIElement::programmeGroup::attribute::type:
                         switch (*dataPtr)
                         {
                             case 0x02:
-                                parentElement.setAttribute("type", "series");
+                                visitor.attribute("type", "series");
                                 break;
                             case 0x03:
-                                parentElement.setAttribute("type", "show");
+                                visitor.attribute("type", "show");
                                 break;
                             case 0x04:
-                                parentElement.setAttribute("type", "programConcept");
+                                visitor.attribute("type", "programConcept");
                                 break;
                             case 0x05:
-                                parentElement.setAttribute("type", "magazine");
+                                visitor.attribute("type", "magazine");
                                 break;
                             case 0x06:
-                                parentElement.setAttribute("type", "programCompilation");
+                                visitor.attribute("type", "programCompilation");
                                 break;
                             case 0x07:
-                                parentElement.setAttribute("type", "otherCollection");
+                                visitor.attribute("type", "otherCollection");
                                 break;
                             case 0x08:
-                                parentElement.setAttribute("type", "otherChoice");
+                                visitor.attribute("type", "otherChoice");
                                 break;
                             case 0x09:
-                                parentElement.setAttribute("type", "topic");
+                                visitor.attribute("type", "topic");
                                 break;
                         }
                         break;
                     case SPIElement::programmeGroup::attribute::numOfItems:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.8.4 numOfItems]
                         // Encoded as a 16-bit unsigned integer.
-                        setAttribute_uint16(parentElement, "numOfItems", dataPtr, len);
+                        setAttribute_uint16(visitor, "numOfItems", dataPtr, len);
                         break;
                 }
                 break;
@@ -1148,10 +1163,10 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::scope::attribute(tag))
                 {
                     case SPIElement::scope::attribute::startTime:
-                        setAttribute_timePoint(parentElement, "startTime", dataPtr, len);
+                        setAttribute_timePoint(visitor, "startTime", dataPtr, len);
                         break;
                     case SPIElement::scope::attribute::stopTime:
-                        setAttribute_timePoint(parentElement, "stopTime", dataPtr, len);
+                        setAttribute_timePoint(visitor, "stopTime", dataPtr, len);
                         break;
                 }
                 break;
@@ -1161,7 +1176,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                     case SPIElement::serviceScope::attribute::id:
                         // When the domain of the id attribute matches the delivery system, it shall be encoded according to clause 4.7.6.
                         // ==> bearerURI DAB
-                        setAttribute_dabBearerURI(parentElement, "id", dataPtr, len);
+                        setAttribute_dabBearerURI(visitor, "id", dataPtr, len);
                         break;
                 }
                 break;
@@ -1173,7 +1188,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                         uint16_t eid = *dataPtr++;
                         eid = (eid << 8) | *dataPtr++;
 
-                        parentElement.setAttribute("id", QString("%1%2").arg(ecc, 2, 16, QChar('0')).arg(eid, 4, 16, QChar('0')));
+                        visitor.attribute("id", QString("%1%2").arg(ecc, 2, 16, QChar('0')).arg(eid, 4, 16, QChar('0')));
                         break;
                 }
                 break;
@@ -1183,7 +1198,7 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                     case SPIElement::service::attribute::version:
                         // ETSI TS 102 371 V3.2.1 (2016-05) [4.8.3 version]
                         // Encoded as a 16-bit unsigned integer.
-                        setAttribute_uint16(parentElement, "version", dataPtr, len);
+                        setAttribute_uint16(visitor, "version", dataPtr, len);
                         break;
                 }
                 break;
@@ -1200,10 +1215,10 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                     case SPIElement::bearer::attribute::id:
                         // When the domain of the id attribute matches the delivery system, it shall be encoded according to clause 4.7.6.
                         // ==> bearerURI DAB
-                        setAttribute_dabBearerURI(parentElement, "id", dataPtr, len);
+                        setAttribute_dabBearerURI(visitor, "id", dataPtr, len);
                         break;
                     case SPIElement::bearer::attribute::url:
-                        setAttribute_string(parentElement, "url", dataPtr, len, false);
+                        setAttribute_string(visitor, "url", dataPtr, len, false);
                         break;
                 }
             }
@@ -1212,34 +1227,34 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::multimedia::attribute(tag))
                 {
                     case SPIElement::multimedia::attribute::mimeValue:
-                        setAttribute_string(parentElement, "mimeValue", dataPtr, len, false);
+                        setAttribute_string(visitor, "mimeValue", dataPtr, len, false);
                         break;
                     case SPIElement::multimedia::attribute::xml_lang:
-                        setAttribute_string(parentElement, "xml:lang", dataPtr, len, false);
+                        setAttribute_string(visitor, "xml:lang", dataPtr, len, false);
                         break;
                     case SPIElement::multimedia::attribute::url:
-                        setAttribute_string(parentElement, "url", dataPtr, len, true);
+                        setAttribute_string(visitor, "url", dataPtr, len, true);
                         break;
                     case SPIElement::multimedia::attribute::type:
                         switch (*dataPtr)
                         {
                             case 0x02:
-                                parentElement.setAttribute("type", "logo_unrestricted");
+                                visitor.attribute("type", "logo_unrestricted");
                                 break;
                             case 0x04:
-                                parentElement.setAttribute("type", "logo_colour_square");
+                                visitor.attribute("type", "logo_colour_square");
                                 break;
                             case 0x06:
-                                parentElement.setAttribute("type", "logo_colour_rectangle");
+                                visitor.attribute("type", "logo_colour_rectangle");
                                 break;
                         }
 
                         break;
                     case SPIElement::multimedia::attribute::width:
-                        setAttribute_uint16(parentElement, "width", dataPtr, len);
+                        setAttribute_uint16(visitor, "width", dataPtr, len);
                         break;
                     case SPIElement::multimedia::attribute::height:
-                        setAttribute_uint16(parentElement, "height", dataPtr, len);
+                        setAttribute_uint16(visitor, "height", dataPtr, len);
                         break;
                 }
                 break;
@@ -1248,16 +1263,16 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::time_relativeTime::attribute(tag))
                 {
                     case SPIElement::time_relativeTime::attribute::time:
-                        setAttribute_timePoint(parentElement, "time", dataPtr, len);
+                        setAttribute_timePoint(visitor, "time", dataPtr, len);
                         break;
                     case SPIElement::time_relativeTime::attribute::duration:
-                        setAttribute_duration(parentElement, "duration", dataPtr, len);
+                        setAttribute_duration(visitor, "duration", dataPtr, len);
                         break;
                     case SPIElement::time_relativeTime::attribute::actualTime:
-                        setAttribute_timePoint(parentElement, "actualTime", dataPtr, len);
+                        setAttribute_timePoint(visitor, "actualTime", dataPtr, len);
                         break;
                     case SPIElement::time_relativeTime::attribute::actualDuration:
-                        setAttribute_duration(parentElement, "actualDuration", dataPtr, len);
+                        setAttribute_duration(visitor, "actualDuration", dataPtr, len);
                         break;
                 }
                 break;
@@ -1265,10 +1280,10 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::radiodns::attribute(tag))
                 {
                     case SPIElement::radiodns::attribute::fqdn:
-                        setAttribute_string(parentElement, "fqdn", dataPtr, len, true);
+                        setAttribute_string(visitor, "fqdn", dataPtr, len, true);
                         break;
                     case SPIElement::radiodns::attribute::serviceIdentifier:
-                        setAttribute_string(parentElement, "serviceIdentifier", dataPtr, len, true);
+                        setAttribute_string(visitor, "serviceIdentifier", dataPtr, len, true);
                         break;
                 }
                 break;
@@ -1276,10 +1291,10 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::geolocation::attribute(tag))
                 {
                     case SPIElement::geolocation::attribute::xml_id:
-                        setAttribute_string(parentElement, "xml:id", dataPtr, len, true);
+                        setAttribute_string(visitor, "xml:id", dataPtr, len, true);
                         break;
                     case SPIElement::geolocation::attribute::ref:
-                        setAttribute_string(parentElement, "ref", dataPtr, len, true);
+                        setAttribute_string(visitor, "ref", dataPtr, len, true);
                         break;
                 }
                 break;
@@ -1295,13 +1310,13 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::presentationTime::attribute(tag))
                 {
                     case SPIElement::presentationTime::attribute::start:
-                        setAttribute_timePoint(parentElement, "start", dataPtr, len);
+                        setAttribute_timePoint(visitor, "start", dataPtr, len);
                         break;
                     case SPIElement::presentationTime::attribute::end:
-                        setAttribute_timePoint(parentElement, "end", dataPtr, len);
+                        setAttribute_timePoint(visitor, "end", dataPtr, len);
                         break;
                     case SPIElement::presentationTime::attribute::duration:
-                        setAttribute_duration(parentElement, "duration", dataPtr, len);
+                        setAttribute_duration(visitor, "duration", dataPtr, len);
                         break;
                 }
                 break;
@@ -1309,10 +1324,10 @@ uint32_t SPIApp::parseTag(const uint8_t *dataPtr, QDomElement &parentElement, ui
                 switch (SPIElement::acquisitionTime::attribute(tag))
                 {
                     case SPIElement::acquisitionTime::attribute::start:
-                        setAttribute_timePoint(parentElement, "start", dataPtr, len);
+                        setAttribute_timePoint(visitor, "start", dataPtr, len);
                         break;
                     case SPIElement::acquisitionTime::attribute::end:
-                        setAttribute_timePoint(parentElement, "end", dataPtr, len);
+                        setAttribute_timePoint(visitor, "end", dataPtr, len);
                         break;
                 }
                 break;
@@ -1362,10 +1377,10 @@ QString SPIApp::getString(const uint8_t *dataPtr, int len, bool doReplaceTokens)
     return str;
 }
 
-void SPIApp::setAttribute_string(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len, bool doReplaceTokens)
+void SPIApp::setAttribute_string(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len, bool doReplaceTokens)
 {
     QString str = getString(dataPtr, len, doReplaceTokens);
-    element.setAttribute(name, str);
+    visitor.attribute(name, str);
 }
 
 QString SPIApp::getTime(const uint8_t *dataPtr, int len)
@@ -1463,20 +1478,20 @@ QString SPIApp::getDoubleList(const uint8_t *dataPtr, int len)
     return doubleList;
 }
 
-void SPIApp::setAttribute_timePoint(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len)
+void SPIApp::setAttribute_timePoint(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len)
 {
     QString str = getTime(dataPtr, len);
 
     if (!str.isEmpty())
     {
-        element.setAttribute(name, str);
+        visitor.attribute(name, str);
     }
     else
     { /* string is empty => some error happened */
     }
 }
 
-void SPIApp::setAttribute_uint16(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len)
+void SPIApp::setAttribute_uint16(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len)
 {
     if (len < 2)
     {  // not enough data
@@ -1489,10 +1504,10 @@ void SPIApp::setAttribute_uint16(QDomElement &element, const QString &name, cons
 
     uint16_t val = *dataPtr++;
     val = (val << 8) | *dataPtr++;
-    element.setAttribute(name, val);
+    visitor.attribute(name, QString::number(val));
 }
 
-void SPIApp::setAttribute_uint24(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len)
+void SPIApp::setAttribute_uint24(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len)
 {
     if (len < 3)
     {  // not enough data
@@ -1506,10 +1521,10 @@ void SPIApp::setAttribute_uint24(QDomElement &element, const QString &name, cons
     uint32_t val = *dataPtr++;
     val = (val << 8) | *dataPtr++;
     val = (val << 8) | *dataPtr++;
-    element.setAttribute(name, val);
+    visitor.attribute(name, QString::number(val));
 }
 
-void SPIApp::setAttribute_duration(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len)
+void SPIApp::setAttribute_duration(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len)
 {  // ETSI TS 102 371 V3.2.1 (2016-05) [4.7.5 Duration type]
     // All attributes defined as duration type are encoded as a 16-bit unsigned integer,
     // representing the duration in seconds from 0 to 65 535 (just over 18 hours).
@@ -1531,7 +1546,7 @@ void SPIApp::setAttribute_duration(QDomElement &element, const QString &name, co
     numSec = (numSec << 8) | *dataPtr++;
 
     QTime time = QTime(0, 0).addSecs(numSec);
-    element.setAttribute(name, QString("PT%1H%2M%3S").arg(time.hour()).arg(time.minute()).arg(time.second()));
+    visitor.attribute(name, QString("PT%1H%2M%3S").arg(time.hour()).arg(time.minute()).arg(time.second()));
 }
 
 QString SPIApp::getBearerURI(const uint8_t *dataPtr, int len)
@@ -1601,12 +1616,12 @@ QString SPIApp::getBearerURI(const uint8_t *dataPtr, int len)
     return QString();
 }
 
-void SPIApp::setAttribute_dabBearerURI(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len)
+void SPIApp::setAttribute_dabBearerURI(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len)
 {
     QString str = getBearerURI(dataPtr, len);
     if (!str.isEmpty())
     {
-        element.setAttribute(name, str);
+        visitor.attribute(name, str);
     }
     else
     { /* string is empty => some error happened */
@@ -1899,7 +1914,7 @@ void SPIApp::onFileDownloaded(QNetworkReply *reply)
         }
         else
         {  // logo
-            emit requestedFile(reply->readAll(), requestId);
+            emit requestedFile(reply->readAll(), requestId, SPI_APP_INVALID_DECODER_ID);
         }
     }
     else
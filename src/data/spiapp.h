@@ -27,8 +27,8 @@
 #ifndef SPIAPP_H
 #define SPIAPP_H
 
+#include <QDateTime>
 #include <QDnsLookup>
-#include <QDomDocument>
 #include <QNetworkAccessManager>
 #include <QObject>
 #include <QPair>
@@ -36,6 +36,7 @@
 
 #include "motdecoder.h"
 #include "servicelistid.h"
+#include "spimetadata.h"
 #include "userapplication.h"
 
 // #define SPI_APP_INVALID_TAG 0x7F
@@ -67,6 +68,7 @@ public:
     void reset() override;
     void setDataDumping(const Settings::UADumpSettings &settings) override;
     void enable(bool ena);
+    void setCacheBudget(int budgetMB);
 
     // RadioDNS
     void setUseInternet(bool ena) { m_useInternet = ena; }
@@ -76,32 +78,42 @@ public:
 
 signals:
     void xmlDocument(const QString &xmldocument, const QString &scopeId, uint16_t decoderId);
-    void requestedFile(const QByteArray &data, const QString &requestId);
+    void metadata(const SPIMetadata &metadata, const QString &scopeId, uint16_t decoderId);
+    void requestedFile(const QByteArray &data, const QString &requestId, uint16_t decoderId);
     void radioDNSAvailable();
     void decodingStart(bool isEns);
-    void decodingProgress(bool isEns, int decoded, int total);
+    void decodingProgress(bool isEns, int decoded, int total, const MOTObjectCache::Statistics &cacheStats);
 
 private:
     QHash<uint16_t, MOTDecoder *> m_decoderMap;
+    qint64 m_cacheBudget;  // [bytes] MOT object cache budget of each decoder, 0 = unlimited
 
     void processObject(uint16_t decoderId, MOTObjectCache::const_iterator objIt);
     void parseBinaryInfo(uint16_t decoderId, const MOTObject &motObj);
-    uint32_t parseTag(const uint8_t *dataPtr, QDomElement &parentElement, uint8_t parentTag, int maxSize);
+    void parseBody(const QByteArray &data, SPIVisitor &visitor);
+    uint32_t parseTag(const uint8_t *dataPtr, SPIVisitor &visitor, uint8_t parentTag, int maxSize);
+    void addScope(SPIVisitor &visitor);
     const uint8_t *parseAttributes(const uint8_t *attrPtr, uint8_t tag, int maxSize);
     QString getString(const uint8_t *dataPtr, int len, bool doReplaceTokens = true);
     QString getTime(const uint8_t *dataPtr, int len);
     QString getDoubleList(const uint8_t *dataPtr, int len);
     QString getBearerURI(const uint8_t *dataPtr, int len);
 
-    void setAttribute_string(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len, bool doReplaceTokens);
-    void setAttribute_timePoint(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len);
-    void setAttribute_uint16(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len);
-    void setAttribute_uint24(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len);
-    void setAttribute_duration(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len);
-    void setAttribute_dabBearerURI(QDomElement &element, const QString &name, const uint8_t *dataPtr, int len);
+    void setAttribute_string(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len, bool doReplaceTokens);
+    void setAttribute_timePoint(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len);
+    void setAttribute_uint16(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len);
+    void setAttribute_uint24(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len);
+    void setAttribute_duration(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len);
+    void setAttribute_dabBearerURI(SPIVisitor &visitor, const QString &name, const uint8_t *dataPtr, int len);
 
     QHash<uint8_t, QString> m_tokenTable;
-    QDomDocument m_xmldocument;
+
+    // scope of programme information from MOT parameters
+    bool m_isProgrammeInfo;
+    bool m_scheduleHasScope;
+    QString m_paramScopeStart;
+    QString m_paramScopeEnd;
+    QString m_paramScopeId;
 
     // compatibility with encoding according to ETSI TS 102 371 V1.3.1 (2008-07)
     QString m_contentId;
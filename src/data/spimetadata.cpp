@@ -0,0 +1,324 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "spimetadata.h"
+
+#include <QLoggingCategory>
+#include <QXmlStreamReader>
+
+Q_LOGGING_CATEGORY(spiMetadata, "SPIMetadata", QtInfoMsg)
+
+SPIXmlWriter::SPIXmlWriter() : m_writer(&m_data)
+{
+    m_isStartPending = false;
+    m_writer.setAutoFormatting(true);
+    m_writer.writeStartDocument();
+}
+
+void SPIXmlWriter::startElement(const QString &name)
+{
+    flushStartElement();
+    m_pendingName = name;
+    m_isStartPending = true;
+}
+
+void SPIXmlWriter::attribute(const QString &name, const QString &value)
+{
+    if (!m_isStartPending)
+    {  // element content was already written
+        return;
+    }
+
+    for (auto &attr : m_pendingAttributes)
+    {
+        if (attr.first == name)
+        {
+            attr.second = value;
+            return;
+        }
+    }
+    m_pendingAttributes.append(qMakePair(name, value));
+}
+
+void SPIXmlWriter::text(const QString &text)
+{
+    flushStartElement();
+    m_writer.writeCharacters(text);
+}
+
+void SPIXmlWriter::endElement()
+{
+    flushStartElement();
+    m_writer.writeEndElement();
+}
+
+QByteArray SPIXmlWriter::toByteArray()
+{
+    flushStartElement();
+    m_writer.writeEndDocument();
+    return m_data;
+}
+
+void SPIXmlWriter::flushStartElement()
+{
+    if (m_isStartPending)
+    {
+        m_writer.writeStartElement(m_pendingName);
+        for (const auto &attr : std::as_const(m_pendingAttributes))
+        {
+            m_writer.writeAttribute(attr.first, attr.second);
+        }
+        m_pendingAttributes.clear();
+        m_isStartPending = false;
+    }
+}
+
+SPIMetadataBuilder::SPIMetadataBuilder()
+{
+    m_numScopes = 0;
+}
+
+void SPIMetadataBuilder::startElement(const QString &name)
+{
+    if (m_stack.isEmpty())
+    {
+        m_metadata.root = name;
+    }
+    else if ((m_stack.size() == 2) && isAt(0, "epg") && isAt(1, "schedule") && ("scope" == name))
+    {  // only first scope is used
+        m_numScopes += 1;
+    }
+    else
+    { /* nothing to do */
+    }
+
+    m_stack.append(Element{name, {}, {}});
+}
+
+void SPIMetadataBuilder::attribute(const QString &name, const QString &value)
+{
+    if (!m_stack.isEmpty())
+    {
+        m_stack.last().attributes.insert(name, value);
+    }
+}
+
+void SPIMetadataBuilder::text(const QString &text)
+{
+    if (!m_stack.isEmpty())
+    {
+        m_stack.last().text += text;
+    }
+}
+
+void SPIMetadataBuilder::endElement()
+{
+    if (m_stack.isEmpty())
+    {  // unbalanced call
+        return;
+    }
+
+    const Element &element = m_stack.last();
+    const int depth = m_stack.size();
+    if (isAt(0, "serviceInformation"))
+    {  // ETSI TS 102 818 V3.4.1 [6.2]
+        const bool inServices = isAt(1, "services") || isAt(1, "ensemble");
+        if (inServices && isAt(2, "service"))
+        {  // ETSI TS 102 818 V3.4.1 [6.5]
+            if (3 == depth)
+            {
+                m_metadata.services.append(m_service);
+                m_service = SPIMetadata::Service();
+            }
+            else if ("bearer" == element.name)
+            {  // bearer at any level
+                m_service.bearers.append(element.attributes.value("id"));
+            }
+            else if ((4 == depth) && (("shortName" == element.name) || ("mediumName" == element.name) || ("longName" == element.name)))
+            {
+                m_service.info[element.name] = element.text;
+            }
+            else if ((5 == depth) && isAt(3, "mediaDescription"))
+            {
+                if (("shortDescription" == element.name) || ("longDescription" == element.name))
+                {
+                    m_service.info[element.name] = element.text;
+                }
+                else if ("multimedia" == element.name)
+                {
+                    m_service.logos.append(logo(element));
+                }
+                else
+                { /* not used */
+                }
+            }
+            else
+            { /* not used */
+            }
+        }
+        else if (inServices && (4 == depth) && isAt(2, "mediaDescription") && ("multimedia" == element.name))
+        {  // binary encoding does not support serviceProvider element, ensemble logo is child of services element with UEID in id attribute
+            // ETSI TS 102 371 V3.2.1 [4.17.1 DAB ensemble element encoding]
+            m_ensemble.id = m_stack.at(1).attributes.value("id");
+            m_ensemble.logos.append(logo(element));
+        }
+        else if (inServices && (2 == depth))
+        {
+            if (!m_ensemble.logos.isEmpty())
+            {
+                m_metadata.ensembles.append(m_ensemble);
+            }
+            m_ensemble = SPIMetadata::Ensemble();
+        }
+        else
+        { /* not used */
+        }
+    }
+    else if (isAt(0, "epg") && isAt(1, "schedule"))
+    {
+        if (2 == depth)
+        {
+            m_metadata.schedules.append(m_schedule);
+            m_schedule = SPIMetadata::Schedule();
+            m_numScopes = 0;
+        }
+        else if ((3 == depth) && ("scope" == element.name) && (1 == m_numScopes))
+        {
+            m_schedule.scopeStart = element.attributes.value("startTime");
+        }
+        else if ((4 == depth) && isAt(2, "scope") && ("serviceScope" == element.name) && (1 == m_numScopes))
+        {
+            m_schedule.serviceScopes.append(element.attributes.value("id"));
+        }
+        else if (isAt(2, "programme"))
+        {  // ETSI TS 102 818 V3.3.1 [7.8]
+            if (3 == depth)
+            {
+                m_programme.shortId = element.attributes.value("shortId");
+                m_schedule.programmes.append(m_programme);
+                m_programme = SPIMetadata::Programme();
+            }
+            else if (4 == depth)
+            {
+                if ("shortName" == element.name)
+                {
+                    m_programme.shortName = element.text;
+                }
+                else if ("mediumName" == element.name)
+                {
+                    m_programme.mediumName = element.text;
+                }
+                else if ("longName" == element.name)
+                {
+                    m_programme.longName = element.text;
+                }
+                else
+                { /* not used */
+                }
+            }
+            else if ((5 == depth) && isAt(3, "location") && ("time" == element.name))
+            {
+                m_programme.times.append(qMakePair(element.attributes.value("time"), element.attributes.value("duration")));
+            }
+            else if ((5 == depth) && isAt(3, "mediaDescription"))
+            {
+                if ("shortDescription" == element.name)
+                {
+                    m_programme.shortDescription = element.text;
+                }
+                else if ("longDescription" == element.name)
+                {
+                    m_programme.longDescription = element.text;
+                }
+                else
+                { /* not used */
+                }
+            }
+            else
+            { /* not used */
+            }
+        }
+        else
+        { /* not used */
+        }
+    }
+    else
+    { /* not used */
+    }
+
+    m_stack.removeLast();
+}
+
+bool SPIMetadataBuilder::readXml(const QString &xml, SPIVisitor &visitor)
+{
+    QXmlStreamReader reader(xml);
+    while (!reader.atEnd())
+    {
+        switch (reader.readNext())
+        {
+            case QXmlStreamReader::StartElement:
+                visitor.startElement(reader.name().toString());
+                for (const auto &attr : reader.attributes())
+                {
+                    visitor.attribute(attr.qualifiedName().toString(), attr.value().toString());
+                }
+                break;
+            case QXmlStreamReader::Characters:
+                if (!reader.isWhitespace())
+                {
+                    visitor.text(reader.text().toString());
+                }
+                break;
+            case QXmlStreamReader::EndElement:
+                visitor.endElement();
+                break;
+            default:
+                break;
+        }
+    }
+    if (reader.hasError())
+    {
+        qCWarning(spiMetadata) << "XML error:" << reader.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool SPIMetadataBuilder::isAt(int level, const char *name) const
+{
+    return (m_stack.size() > level) && (m_stack.at(level).name == QLatin1String(name));
+}
+
+SPIMetadata::Logo SPIMetadataBuilder::logo(const Element &element) const
+{
+    SPIMetadata::Logo logo;
+    logo.url = element.attributes.value("url");
+    logo.mimeValue = element.attributes.value("mimeValue");
+    logo.type = element.attributes.value("type");
+    logo.width = element.attributes.value("width");
+    logo.height = element.attributes.value("height");
+    return logo;
+}
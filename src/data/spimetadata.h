@@ -0,0 +1,158 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPIMETADATA_H
+#define SPIMETADATA_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QXmlStreamWriter>
+
+// Receiver of SPI document structure (ETSI TS 102 818)
+// Binary encoded SPI (ETSI TS 102 371) and SPI XML are both decoded to this sequence of calls,
+// attributes of an element are passed after startElement() and before any child element or text.
+class SPIVisitor
+{
+public:
+    virtual ~SPIVisitor() = default;
+    virtual void startElement(const QString &name) = 0;
+    virtual void attribute(const QString &name, const QString &value) = 0;
+    virtual void text(const QString &text) = 0;
+    virtual void endElement() = 0;
+};
+
+// Creates XML document, used for dumping of binary encoded SPI
+class SPIXmlWriter : public SPIVisitor
+{
+public:
+    SPIXmlWriter();
+    void startElement(const QString &name) override;
+    void attribute(const QString &name, const QString &value) override;
+    void text(const QString &text) override;
+    void endElement() override;
+
+    // finishes the document and returns it
+    QByteArray toByteArray();
+
+private:
+    QByteArray m_data;
+    QXmlStreamWriter m_writer;
+
+    // start tag is written when the first child is written, repeated attributes replace the previous value
+    bool m_isStartPending;
+    QString m_pendingName;
+    QList<QPair<QString, QString>> m_pendingAttributes;
+
+    void flushStartElement();
+};
+
+// SPI data used by application (service information and programme information)
+// Values are kept as strings from SPI document, interpretation is done by MetadataManager.
+struct SPIMetadata
+{
+    struct Logo
+    {
+        QString url;
+        QString mimeValue;
+        QString type;
+        QString width;
+        QString height;
+    };
+    struct Service
+    {
+        QStringList bearers;           // bearer id attributes
+        QHash<QString, QString> info;  // names and descriptions, key is element name
+        QList<Logo> logos;
+    };
+    struct Ensemble
+    {
+        QString id;  // UEID from binary encoding (id attribute of services element)
+        QList<Logo> logos;
+    };
+    struct Programme
+    {
+        QString shortId;
+        QList<QPair<QString, QString>> times;  // location/time: time and duration attributes
+        QString shortName;
+        QString mediumName;
+        QString longName;
+        QString shortDescription;
+        QString longDescription;
+    };
+    struct Schedule
+    {
+        QString scopeStart;
+        QStringList serviceScopes;
+        QList<Programme> programmes;
+    };
+
+    QString root;  // name of top level element
+    QList<Service> services;
+    QList<Ensemble> ensembles;
+    QList<Schedule> schedules;
+};
+Q_DECLARE_METATYPE(SPIMetadata)
+
+// Collects SPIMetadata from SPI document structure, no intermediate document is created
+class SPIMetadataBuilder : public SPIVisitor
+{
+public:
+    SPIMetadataBuilder();
+    void startElement(const QString &name) override;
+    void attribute(const QString &name, const QString &value) override;
+    void text(const QString &text) override;
+    void endElement() override;
+
+    const SPIMetadata &metadata() const { return m_metadata; }
+
+    // reads SPI XML document and passes its structure to visitor, returns false on XML error
+    static bool readXml(const QString &xml, SPIVisitor &visitor);
+
+private:
+    struct Element
+    {
+        QString name;
+        QHash<QString, QString> attributes;
+        QString text;
+    };
+    QList<Element> m_stack;
+    SPIMetadata m_metadata;
+    SPIMetadata::Service m_service;
+    SPIMetadata::Ensemble m_ensemble;
+    SPIMetadata::Schedule m_schedule;
+    SPIMetadata::Programme m_programme;
+    int m_numScopes;
+
+    bool isAt(int level, const char *name) const;
+    SPIMetadata::Logo logo(const Element &element) const;
+};
+
+#endif  // SPIMETADATA_H
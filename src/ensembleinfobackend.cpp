@@ -33,7 +33,9 @@
 
 #include "androidfilehelper.h"
 #include "dabtables.h"
+#include "latencytracer.h"
 #include "settings.h"
+#include "threadplacement.h"
 
 Q_DECLARE_LOGGING_CATEGORY(application)
 
@@ -89,6 +91,19 @@ EnsembleInfoBackend::EnsembleInfoBackend(QObject *parent) : QAbstractListModel{p
     m_modelData[LabelId::SelectedServices0] = new EnsembleInfoModelItem(group, tr("Services"), tr("List of services transmitted in sub-channel"));
     m_modelData[LabelId::SelectedServices1] = new EnsembleInfoModelItem(group, tr(""), tr("List of services transmitted in sub-channel"));
     m_modelData[LabelId::SelectedServices2] = new EnsembleInfoModelItem(group, tr(""), tr("List of services transmitted in sub-channel"));
+    group += 1;  // group 7
+    m_modelData[LabelId::LatencyInputFifo] = new EnsembleInfoModelItem(group, tr("Input buffer"), tr("Time IQ samples spend in input buffer<br>(median / 95th percentile / max)"));
+    m_modelData[LabelId::LatencyDemodulator] = new EnsembleInfoModelItem(group, tr("DAB processing"), tr("Time from last IQ samples read to audio frame output<br>(median / 95th percentile / max)"));
+    m_modelData[LabelId::LatencyAudioDecoder] = new EnsembleInfoModelItem(group, tr("Audio decoder"), tr("Time from audio frame output to decoded PCM samples<br>(median / 95th percentile / max)"));
+    m_modelData[LabelId::LatencyAudioFifo] = new EnsembleInfoModelItem(group, tr("Audio buffer"), tr("Time PCM samples spend in audio buffer<br>(median / 95th percentile / max)"));
+    m_modelData[LabelId::LatencyOutputDevice] = new EnsembleInfoModelItem(group, tr("Audio device"), tr("Output latency reported by audio device"));
+    m_modelData[LabelId::LatencyTotal] = new EnsembleInfoModelItem(group, tr("Total latency"), tr("Sum of median latencies of all stages and audio device latency"));
+    m_modelData[LabelId::CpuRadioControl] = new EnsembleInfoModelItem(group, tr("CPU radio control"), tr("CPU usage of radio control thread<br>(100% = one core) and CPU it last run on"));
+    m_modelData[LabelId::CpuDabProcessing] = new EnsembleInfoModelItem(group, tr("CPU DAB processing"), tr("CPU usage of DAB processing thread<br>(100% = one core) and CPU it last run on"));
+    m_modelData[LabelId::CpuInput] = new EnsembleInfoModelItem(group, tr("CPU input device"), tr("CPU usage of input device thread<br>(100% = one core) and CPU it last run on"));
+    m_modelData[LabelId::CpuAudioDecoder] = new EnsembleInfoModelItem(group, tr("CPU audio decoder"), tr("CPU usage of audio decoder thread<br>(100% = one core) and CPU it last run on"));
+    m_modelData[LabelId::CpuAudioOutput] = new EnsembleInfoModelItem(group, tr("CPU audio output"), tr("CPU usage of audio output thread<br>(100% = one core) and CPU it last run on"));
+    m_modelData[LabelId::CpuSpiDecoder] = new EnsembleInfoModelItem(group, tr("CPU SPI decoder"), tr("CPU usage of SPI decoder thread<br>(100% = one core) and CPU it last run on"));
     // clang-format on
 
     m_fibStats = new uint16_t[StatsHistorySize * 2];
@@ -106,6 +121,12 @@ EnsembleInfoBackend::EnsembleInfoBackend(QObject *parent) : QAbstractListModel{p
     resetFibStat();
     resetMscStat();
 
+    m_latencyTimer = new QTimer(this);
+    m_latencyTimer->setInterval(1000);
+    connect(m_latencyTimer, &QTimer::timeout, this, &EnsembleInfoBackend::updateLatencyStats);
+    m_latencyTimer->start();
+    updateLatencyStats();
+
     enableRecording(false);
 }
 
@@ -530,6 +551,83 @@ void EnsembleInfoBackend::resetMscStat()
     emit dataChanged(index(LabelId::RsUncorr, 0), index(LabelId::AudioCrcErrRate, 0), {Roles::InfoRole});
 }
 
+void EnsembleInfoBackend::resetLatencyStats()
+{
+    LatencyTracer::getInstance()->reset();
+    updateLatencyStats();
+}
+
+void EnsembleInfoBackend::updateLatencyStats()
+{
+    const QList<LatencyTracer::StageStatistics> stats = LatencyTracer::getInstance()->statistics();
+    float totalMs = 0.0;
+    bool isValid = true;
+    for (int n = 0; n < LatencyTracer::NumStages; ++n)
+    {
+        const LatencyTracer::StageStatistics &s = stats.at(n);
+        if (s.count > 0)
+        {
+            m_modelData.at(LabelId::LatencyInputFifo + n)
+                ->setInfo(QString("%1 / %2 / %3 ms").arg(s.p50Ms, 0, 'f', 1).arg(s.p95Ms, 0, 'f', 1).arg(s.maxMs, 0, 'f', 1));
+            totalMs += s.p50Ms;
+        }
+        else
+        {
+            m_modelData.at(LabelId::LatencyInputFifo + n)->setInfo("");
+            isValid = false;
+        }
+    }
+    float deviceMs = LatencyTracer::getInstance()->outputDeviceLatency();
+    m_modelData.at(LabelId::LatencyOutputDevice)->setInfo(deviceMs > 0 ? QString("%1 ms").arg(deviceMs, 0, 'f', 1) : "");
+    totalMs += deviceMs;
+    m_modelData.at(LabelId::LatencyTotal)->setInfo(isValid ? QString("%1 ms").arg(totalMs, 0, 'f', 1) : "");
+    emit dataChanged(index(LabelId::LatencyInputFifo, 0), index(LabelId::LatencyTotal, 0), {Roles::InfoRole});
+
+    updateThreadStats();
+}
+
+void EnsembleInfoBackend::updateThreadStats()
+{
+    const QList<ThreadPlacement::ThreadStatistics> stats = ThreadPlacement::getInstance()->statistics();
+    for (int n = 0; n < ThreadPlacement::NumRoles; ++n)
+    {
+        const ThreadPlacement::ThreadStatistics &s = stats.at(n);
+        m_modelData.at(LabelId::CpuRadioControl + n)->setInfo(s.isRunning ? QString("%1 % (CPU %2)").arg(s.cpuPercent, 0, 'f', 1).arg(s.lastCpu) : "");
+    }
+    emit dataChanged(index(LabelId::CpuRadioControl, 0), index(LabelId::CpuSpiDecoder, 0), {Roles::InfoRole});
+}
+
+void EnsembleInfoBackend::exportLatencyTrace()
+{
+    QString fileName = QString("latency_%1.json").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hhmmss"));
+
+    const QString ensemblePath = AndroidFileHelper::buildSubdirPath(m_settings->dataStoragePath, ENSEMBLE_DIR_NAME);
+    if (!AndroidFileHelper::mkpath(m_settings->dataStoragePath, ENSEMBLE_DIR_NAME))
+    {
+        qCWarning(application) << "Failed to create latency trace export directory:" << AndroidFileHelper::lastError();
+        emit showInfoMessage(tr("Latency trace export failed"), -1);
+        return;
+    }
+
+    if (!AndroidFileHelper::hasWritePermission(ensemblePath))
+    {
+        qCWarning(application) << "No permission to write to:" << ensemblePath;
+        emit showInfoMessage(tr("No permission to write latency trace"), -1);
+        return;
+    }
+
+    if (AndroidFileHelper::writeTextFile(ensemblePath, fileName, QString::fromUtf8(LatencyTracer::getInstance()->chromeTrace()), "application/json"))
+    {
+        qCInfo(application) << "Latency trace exported to:" << QString("%1/%2").arg(ensemblePath, fileName);
+        emit showInfoMessage(tr("Latency trace exported"), 1);
+    }
+    else
+    {
+        qCWarning(application) << "Failed to export latency trace:" << AndroidFileHelper::lastError();
+        emit showInfoMessage(tr("Failed to export latency trace"), -1);
+    }
+}
+
 void EnsembleInfoBackend::enableRecording(bool ena)
 {
     isRecordingVisible(ena);
@@ -569,6 +667,23 @@ void EnsembleInfoBackend::startStopRecording()
     }
 }
 
+void EnsembleInfoBackend::onServiceStreamRecording(bool isActive)
+{
+    isServiceStreamRecording(isActive);
+}
+
+void EnsembleInfoBackend::startStopServiceStreamRecording()
+{
+    if (isServiceStreamRecording())
+    {
+        emit serviceStreamRecordingStop();
+    }
+    else
+    {
+        emit serviceStreamRecordingStart();
+    }
+}
+
 void EnsembleInfoBackend::saveCSV()
 {
     emit requestEnsembleCSV();
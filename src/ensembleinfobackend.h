@@ -30,6 +30,7 @@
 #include <QAbstractListModel>
 #include <QObject>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 #include <QtQmlIntegration>
 
 #include "audiodecoder.h"
@@ -55,6 +56,7 @@ class EnsembleInfoBackend : public QAbstractListModel
     UI_PROPERTY_DEFAULT(bool, isCsvUploadEnabled, false);
     UI_PROPERTY(QString, recordingSize);
     UI_PROPERTY(QString, recordingLength);
+    UI_PROPERTY_DEFAULT(bool, isServiceStreamRecording, false);
 
 public:
     enum Roles
@@ -98,6 +100,8 @@ public:
     void clearSubchInfo();
     Q_INVOKABLE void resetFibStat();
     Q_INVOKABLE void resetMscStat();
+    Q_INVOKABLE void resetLatencyStats();
+    Q_INVOKABLE void exportLatencyTrace();
 
     void enableRecording(bool ena);
     void onRecording(bool isActive);
@@ -105,6 +109,8 @@ public:
     Q_INVOKABLE void startStopRecording();
     Q_INVOKABLE void saveCSV();
     Q_INVOKABLE void uploadCSV();
+    void onServiceStreamRecording(bool isActive);
+    Q_INVOKABLE void startStopServiceStreamRecording();
 
     QString ensembleConfigurationText() const;
     void setEnsembleConfigurationText(const QString &ensembleConfigurationText);
@@ -114,6 +120,8 @@ signals:
     void ensembleConfigurationTextChanged();
     void recordingStart(int timeoutSec);
     void recordingStop();
+    void serviceStreamRecordingStart();
+    void serviceStreamRecordingStop();
     void requestEnsembleConfiguration();
     void requestEnsembleCSV();
     void requestUploadCVS();
@@ -165,6 +173,19 @@ private:
         SelectedServices0,
         SelectedServices1,
         SelectedServices2,
+        // group 7
+        LatencyInputFifo,
+        LatencyDemodulator,
+        LatencyAudioDecoder,
+        LatencyAudioFifo,
+        LatencyOutputDevice,
+        LatencyTotal,
+        CpuRadioControl,  // order follows ThreadPlacement::Role
+        CpuDabProcessing,
+        CpuInput,
+        CpuAudioDecoder,
+        CpuAudioOutput,
+        CpuSpiDecoder,
 
         NumLabels
 
@@ -203,6 +224,10 @@ private:
     float m_serviceBitrateNet = 0;
     QString m_ensembleConfigurationText;
     EnsembleSubchModel *m_ensembleSubchModel = nullptr;
+    QTimer *m_latencyTimer = nullptr;
+
+    void updateLatencyStats();
+    void updateThreadStats();
 };
 
 class EnsembleInfoModel : public QSortFilterProxyModel
@@ -32,12 +32,32 @@
 
 Q_DECLARE_LOGGING_CATEGORY(metadataManager)
 
+// roles that do not need names and descriptions
+static bool isTimeRole(int role)
+{
+    switch (role)
+    {
+        case EPGModelRoles::NameRole:
+        case EPGModelRoles::LongNameRole:
+        case EPGModelRoles::MediumNameRole:
+        case EPGModelRoles::ShortNameRole:
+        case EPGModelRoles::LongDescriptionRole:
+        case EPGModelRoles::ShortDescriptionRole:
+            return false;
+        default:
+            return true;
+    }
+}
+
 EPGModel::EPGModel(QObject *parent) : QAbstractListModel{parent}
 {}
 
 EPGModel::~EPGModel()
 {
-    qDeleteAll(m_itemList);
+    for (const auto &row : std::as_const(m_rows))
+    {
+        delete row.item;
+    }
 }
 
 QVariant EPGModel::data(const QModelIndex &index, int role) const
@@ -51,7 +71,19 @@ QVariant EPGModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
     // valid index
-    const EPGModelItem *item = m_itemList.at(index.row());
+    // proxy model filter reads time of every row, item is loaded from store only for rows where names are needed
+    const EPGModelItem *item = nullptr;
+    EPGModelItem timeItem;
+    const Row &row = m_rows.at(index.row());
+    if ((nullptr == row.item) && isTimeRole(role))
+    {
+        timeItem = m_stores.at(row.store)->timeItem(row.record);
+        item = &timeItem;
+    }
+    else
+    {
+        item = this->item(index.row());
+    }
     switch (static_cast<EPGModelRoles>(role))
     {
         case EPGModelRoles::ShortIdRole:
@@ -166,29 +198,75 @@ void EPGModel::setServiceId(const ServiceListId &newServiceId)
 
 bool EPGModel::addItem(EPGModelItem *item)
 {
-    if (item->isValid())
+    return addItems({item}) > 0;
+}
+
+int EPGModel::addItems(const QList<EPGModelItem *> &items)
+{  // all new items are inserted at once so that the views are updated only once per batch
+    QList<Row> newRows;
+    for (auto item : items)
     {
-        if (m_startTimeList.contains(item->startTime()))
-        {  // already in list
-            if (item->shortId() != m_startTimeList[item->startTime()])
-            {
-                qCDebug(metadataManager) << "Unexpected EPG item ID" << item->shortId() << "start time:" << item->startTime();
+        if (item->isValid())
+        {
+            if (m_startTimeList.contains(item->startTimeSecSinceEpoch()))
+            {  // already in list
+                if (item->shortId() != m_startTimeList[item->startTimeSecSinceEpoch()])
+                {
+                    qCDebug(metadataManager) << "Unexpected EPG item ID" << item->shortId() << "start time:" << item->startTime();
+                }
+                delete item;
+                continue;
             }
+            m_startTimeList[item->startTimeSecSinceEpoch()] = item->shortId();
+            newRows.append({item, -1, -1});
+        }
+        else
+        {
+            qCDebug(metadataManager) << "Invalid item:" << item->shortId();
             delete item;
-            return false;
         }
+    }
 
-        // we are here if item was not in list
-        beginInsertRows(QModelIndex(), m_itemList.size(), m_itemList.size());
-        m_startTimeList[item->startTime()] = item->shortId();
-        m_itemList.append(item);
+    if (!newRows.isEmpty())
+    {
+        beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + newRows.size() - 1);
+        m_rows.append(newRows);
         endInsertRows();
+    }
 
-        return true;
+    return newRows.size();
+}
+
+int EPGModel::addStoreItems(const std::shared_ptr<const EPGStore::Service> &store, int first, int count)
+{
+    QList<Row> newRows;
+    for (int record = first; record < first + count; ++record)
+    {  // only start time and ID are read here
+        qint64 startTime = store->startTimeSecSinceEpoch(record);
+        if (!m_startTimeList.contains(startTime))
+        {
+            m_startTimeList[startTime] = store->shortId(record);
+            newRows.append({nullptr, int(m_stores.size()), record});
+        }
     }
-    else
+
+    if (!newRows.isEmpty())
+    {
+        m_stores.append(store);
+        beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + newRows.size() - 1);
+        m_rows.append(newRows);
+        endInsertRows();
+    }
+
+    return newRows.size();
+}
+
+const EPGModelItem *EPGModel::item(int row) const
+{
+    Row &r = m_rows[row];
+    if (nullptr == r.item)
     {
-        qCDebug(metadataManager) << "Invalid item:" << item->shortId();
+        r.item = m_stores.at(r.store)->item(r.record);
     }
-    return false;
+    return r.item;
 }
@@ -29,8 +29,10 @@
 
 #include <QAbstractListModel>
 #include <QtQmlIntegration>
+#include <memory>
 
 #include "epgmodelitem.h"
+#include "epgstore.h"
 #include "servicelistid.h"
 
 enum EPGModelRoles
@@ -63,16 +65,29 @@ public:
     ~EPGModel();
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
-    int rowCount(const QModelIndex &parent = QModelIndex()) const override { return m_itemList.count(); }
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override { return m_rows.count(); }
     QHash<int, QByteArray> roleNames() const override;
     bool addItem(EPGModelItem *item);
+    int addItems(const QList<EPGModelItem *> &items);
+    // adds records [first, first + count) of the store, items are created when the row is accessed for the first time
+    int addStoreItems(const std::shared_ptr<const EPGStore::Service> &store, int first, int count);
     ServiceListId serviceId() const;
     void setServiceId(const ServiceListId &newServiceId);
 
 private:
-    QHash<QDateTime, int> m_startTimeList;
-    QList<EPGModelItem *> m_itemList;
+    struct Row
+    {
+        EPGModelItem *item;  // nullptr until loaded from store
+        int store;           // index to m_stores
+        int record;
+    };
+
+    QHash<qint64, int> m_startTimeList;  // start time in seconds since epoch ==> short ID
+    mutable QList<Row> m_rows;
+    QList<std::shared_ptr<const EPGStore::Service>> m_stores;
     ServiceListId m_serviceId;
+
+    const EPGModelItem *item(int row) const;
 };
 
 #endif  // EPGMODEL_H
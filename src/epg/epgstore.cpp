@@ -0,0 +1,527 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "epgstore.h"
+
+#include <QDir>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+
+Q_DECLARE_LOGGING_CATEGORY(metadataManager)
+
+namespace
+{
+const char storeMagic[4] = {'A', 'E', 'P', 'G'};
+const uint32_t storeVersion = 1;
+const uint32_t emptyString = 0xFFFFFFFF;
+
+enum StringId
+{
+    LongName = 0,
+    MediumName,
+    ShortName,
+    LongDescription,
+    ShortDescription,
+    NumStrings
+};
+
+enum DayFlags
+{
+    ScheduleReceived = 0x1
+};
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t numDays;
+    uint32_t numRecords;
+    uint32_t stringsSize;
+};
+static_assert(sizeof(FileHeader) == 20, "Unexpected EPG store header size");
+}  // namespace
+
+struct EPGStore::Service::DayEntry
+{
+    int32_t julianDay;
+    uint32_t firstRecord;
+    uint32_t numRecords;
+    uint32_t flags;
+};
+
+struct EPGStore::Service::Record
+{
+    int64_t startSecSinceEpoch;
+    int32_t utcOffsetSec;
+    int32_t durationSec;
+    int32_t shortId;
+    uint32_t strings[NumStrings];  // offsets to string table
+    uint32_t reserved[2];
+};
+
+struct EPGStore::Entry
+{
+    qint64 startSecSinceEpoch;
+    int utcOffsetSec;
+    int durationSec;
+    int shortId;
+    QDate date;  // local date of programme start
+    QString strings[NumStrings];
+};
+
+bool EPGStore::Service::open(const QString &filename)
+{
+    static_assert(sizeof(DayEntry) == 16, "Unexpected EPG store day entry size");
+    static_assert(sizeof(Record) == 48, "Unexpected EPG store record size");
+
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    qint64 size = m_file.size();
+    if (size < qint64(sizeof(FileHeader)))
+    {
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    // file that is mapped cannot be replaced on Windows ==> store is read to memory
+    m_data = m_file.readAll();
+    m_file.close();
+#else
+    const uchar *ptr = m_file.map(0, size);
+    if (nullptr == ptr)
+    {
+        return false;
+    }
+    m_data = QByteArray::fromRawData(reinterpret_cast<const char *>(ptr), size);
+#endif
+
+    FileHeader header;
+    std::memcpy(&header, m_data.constData(), sizeof(FileHeader));
+    if ((0 != std::memcmp(header.magic, storeMagic, sizeof(storeMagic))) || (storeVersion != header.version))
+    {
+        qCDebug(metadataManager) << "Unsupported EPG store file:" << filename;
+        return false;
+    }
+
+    m_numDays = header.numDays;
+    m_numRecords = header.numRecords;
+    m_recordsOffset = sizeof(FileHeader) + qint64(header.numDays) * sizeof(DayEntry);
+    m_stringsOffset = m_recordsOffset + qint64(header.numRecords) * sizeof(Record);
+    if (m_stringsOffset + header.stringsSize != m_data.size())
+    {
+        qCWarning(metadataManager) << "Corrupted EPG store file:" << filename;
+        return false;
+    }
+    for (int n = 0; n < m_numDays; ++n)
+    {  // records are accessed through day index without further checks
+        DayEntry entry = day(n);
+        if (quint64(entry.firstRecord) + entry.numRecords > quint64(m_numRecords))
+        {
+            qCWarning(metadataManager) << "Corrupted EPG store day index:" << filename;
+            return false;
+        }
+    }
+    return true;
+}
+
+EPGStore::Service::DayEntry EPGStore::Service::day(int idx) const
+{
+    DayEntry entry;
+    std::memcpy(&entry, m_data.constData() + sizeof(FileHeader) + idx * sizeof(DayEntry), sizeof(DayEntry));
+    return entry;
+}
+
+EPGStore::Service::Record EPGStore::Service::record(int idx) const
+{
+    Record rec;
+    std::memcpy(&rec, m_data.constData() + m_recordsOffset + idx * sizeof(Record), sizeof(Record));
+    return rec;
+}
+
+QString EPGStore::Service::string(uint32_t offset) const
+{
+    qint64 pos = m_stringsOffset + offset;
+    if ((emptyString == offset) || (pos + qint64(sizeof(uint32_t)) > m_data.size()))
+    {
+        return QString();
+    }
+    uint32_t len;
+    std::memcpy(&len, m_data.constData() + pos, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    if (pos + qint64(len) * qint64(sizeof(char16_t)) > m_data.size())
+    {
+        return QString();
+    }
+    return QString(reinterpret_cast<const QChar *>(m_data.constData() + pos), len);
+}
+
+int EPGStore::Service::numRecords() const
+{
+    return m_numRecords;
+}
+
+qint64 EPGStore::Service::startTimeSecSinceEpoch(int idx) const
+{
+    return record(idx).startSecSinceEpoch;
+}
+
+int EPGStore::Service::shortId(int idx) const
+{
+    return record(idx).shortId;
+}
+
+EPGModelItem EPGStore::Service::timeItem(int idx) const
+{
+    Record rec = record(idx);
+    EPGModelItem progItem;
+    progItem.setStartTime(QDateTime::fromSecsSinceEpoch(rec.startSecSinceEpoch).toOffsetFromUtc(rec.utcOffsetSec));
+    progItem.setDurationSec(rec.durationSec);
+    progItem.setShortId(rec.shortId);
+    return progItem;
+}
+
+EPGModelItem *EPGStore::Service::item(int idx) const
+{
+    Record rec = record(idx);
+    EPGModelItem *progItem = new EPGModelItem(timeItem(idx));
+    progItem->setLongName(string(rec.strings[LongName]));
+    progItem->setMediumName(string(rec.strings[MediumName]));
+    progItem->setShortName(string(rec.strings[ShortName]));
+    progItem->setLongDescription(string(rec.strings[LongDescription]));
+    progItem->setShortDescription(string(rec.strings[ShortDescription]));
+    return progItem;
+}
+
+bool EPGStore::Service::hasSchedule(const QDate &date) const
+{
+    for (int n = 0; n < m_numDays; ++n)
+    {
+        DayEntry entry = day(n);
+        if (entry.julianDay == date.toJulianDay())
+        {
+            return (entry.flags & ScheduleReceived) != 0;
+        }
+    }
+    return false;
+}
+
+QList<QDate> EPGStore::Service::dates(const QDate &from, const QDate &to) const
+{
+    QList<QDate> ret;
+    for (int n = 0; n < m_numDays; ++n)
+    {
+        DayEntry entry = day(n);
+        if ((entry.numRecords > 0) && (entry.julianDay >= from.toJulianDay()) && (entry.julianDay < to.toJulianDay()))
+        {
+            ret.append(QDate::fromJulianDay(entry.julianDay));
+        }
+    }
+    return ret;
+}
+
+int EPGStore::Service::recordRange(const QDate &from, const QDate &to, int *count) const
+{  // records are sorted by date ==> days in range form continuous block of records
+    int first = m_numRecords;
+    int last = 0;
+    for (int n = 0; n < m_numDays; ++n)
+    {
+        DayEntry entry = day(n);
+        if ((entry.numRecords > 0) && (entry.julianDay >= from.toJulianDay()) && (entry.julianDay < to.toJulianDay()))
+        {
+            first = qMin(first, int(entry.firstRecord));
+            last = qMax(last, int(entry.firstRecord + entry.numRecords));
+        }
+    }
+    *count = qMax(0, last - first);
+    return first;
+}
+
+EPGStore::EPGStore()
+{
+    m_path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + EPGSTORE_DIR_NAME;
+}
+
+QString EPGStore::fileName(const ServiceListId &id) const
+{
+    return QString("%1/%2.%3%4").arg(m_path).arg(id.sid(), 6, 16, QChar('0')).arg(id.scids()).arg(EPGSTORE_FILE_EXT);
+}
+
+std::shared_ptr<const EPGStore::Service> EPGStore::service(const ServiceListId &id) const
+{
+    QString filename = fileName(id);
+    if (!QFile::exists(filename))
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<Service> svc(new Service);
+    if (!svc->open(filename))
+    {
+        return nullptr;
+    }
+    return svc;
+}
+
+bool EPGStore::readEntries(const Service &service, const QDate &retentionDate, QList<Entry> &entries, QList<QDate> &scheduleDates) const
+{
+    bool dropped = false;
+    for (int n = 0; n < service.m_numDays; ++n)
+    {
+        Service::DayEntry entry = service.day(n);
+        if (entry.flags & ScheduleReceived)
+        {
+            QDate date = QDate::fromJulianDay(entry.julianDay);
+            if (date >= retentionDate)
+            {
+                scheduleDates.append(date);
+            }
+            else
+            {
+                dropped = true;
+            }
+        }
+        if (entry.julianDay < retentionDate.toJulianDay())
+        {
+            dropped = dropped || (entry.numRecords > 0);
+            continue;
+        }
+        for (uint32_t r = entry.firstRecord; r < entry.firstRecord + entry.numRecords; ++r)
+        {
+            Service::Record rec = service.record(r);
+            Entry e;
+            e.startSecSinceEpoch = rec.startSecSinceEpoch;
+            e.utcOffsetSec = rec.utcOffsetSec;
+            e.durationSec = rec.durationSec;
+            e.shortId = rec.shortId;
+            e.date = QDate::fromJulianDay(entry.julianDay);
+            for (int s = 0; s < NumStrings; ++s)
+            {
+                e.strings[s] = service.string(rec.strings[s]);
+            }
+            entries.append(e);
+        }
+    }
+    return dropped;
+}
+
+bool EPGStore::write(const ServiceListId &id, const QDate &scheduleDate, const QList<EPGModelItem> &items, const QDate &retentionDate)
+{
+    QList<Entry> entries;
+    QList<QDate> scheduleDates;
+    bool changed = false;
+
+    auto svc = service(id);
+    if (nullptr != svc)
+    {
+        changed = readEntries(*svc, retentionDate, entries, scheduleDates);
+        svc.reset();  // file is unmapped before it is replaced
+    }
+
+    QSet<qint64> startTimes;
+    for (const auto &e : std::as_const(entries))
+    {
+        startTimes.insert(e.startSecSinceEpoch);
+    }
+    for (const auto &progItem : items)
+    {
+        if (!progItem.isValid() || (progItem.startTime().date() < retentionDate) || startTimes.contains(progItem.startTimeSecSinceEpoch()))
+        {  // already stored items are kept
+            continue;
+        }
+        Entry e;
+        e.startSecSinceEpoch = progItem.startTimeSecSinceEpoch();
+        e.utcOffsetSec = progItem.startTime().offsetFromUtc();
+        e.durationSec = progItem.durationSec();
+        e.shortId = progItem.shortId();
+        e.date = progItem.startTime().date();
+        e.strings[LongName] = progItem.longName();
+        e.strings[MediumName] = progItem.mediumName();
+        e.strings[ShortName] = progItem.shortName();
+        e.strings[LongDescription] = progItem.longDescription();
+        e.strings[ShortDescription] = progItem.shortDescription();
+        entries.append(e);
+        startTimes.insert(e.startSecSinceEpoch);
+        changed = true;
+    }
+    if (scheduleDate.isValid() && (scheduleDate >= retentionDate) && !scheduleDates.contains(scheduleDate))
+    {
+        scheduleDates.append(scheduleDate);
+        changed = true;
+    }
+
+    if (!changed)
+    {
+        return true;
+    }
+    return writeFile(fileName(id), entries, scheduleDates);
+}
+
+void EPGStore::prune(const QDate &retentionDate)
+{
+    QDir directory(m_path);
+    const QStringList files = directory.entryList({QString("*%1").arg(EPGSTORE_FILE_EXT)}, QDir::Files);
+    for (const QString &file : files)
+    {
+        QString filename = directory.absoluteFilePath(file);
+        QList<Entry> entries;
+        QList<QDate> scheduleDates;
+        bool dropped;
+        {
+            Service svc;
+            if (!svc.open(filename))
+            {  // not valid
+                dropped = true;
+            }
+            else
+            {
+                dropped = readEntries(svc, retentionDate, entries, scheduleDates);
+            }
+        }
+        if (!dropped)
+        {
+            continue;
+        }
+        if (entries.isEmpty() && scheduleDates.isEmpty())
+        {
+            qCDebug(metadataManager) << "EPG store" << file << "is old ===> deleting";
+            directory.remove(file);
+        }
+        else
+        {
+            writeFile(filename, entries, scheduleDates);
+        }
+    }
+}
+
+bool EPGStore::writeFile(const QString &filename, QList<Entry> &entries, const QList<QDate> &scheduleDates) const
+{
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &a, const Entry &b)
+              {
+                  if (a.date != b.date)
+                  {
+                      return a.date < b.date;
+                  }
+                  return a.startSecSinceEpoch < b.startSecSinceEpoch;
+              });
+
+    // day index, sorted by date
+    QMap<qint64, Service::DayEntry> days;
+    for (const QDate &date : scheduleDates)
+    {
+        days[date.toJulianDay()] = {int32_t(date.toJulianDay()), 0, 0, ScheduleReceived};
+    }
+
+    QByteArray strings;
+    QHash<QString, uint32_t> stringOffsets;
+    auto internString = [&strings, &stringOffsets](const QString &str) -> uint32_t
+    {
+        if (str.isEmpty())
+        {
+            return emptyString;
+        }
+        auto it = stringOffsets.constFind(str);
+        if (it != stringOffsets.cend())
+        {
+            return it.value();
+        }
+        uint32_t offset = strings.size();
+        uint32_t len = str.size();
+        strings.append(reinterpret_cast<const char *>(&len), sizeof(len));
+        strings.append(reinterpret_cast<const char *>(str.utf16()), len * sizeof(char16_t));
+        if (len & 0x1)
+        {  // 4 bytes alignment
+            strings.append(2, '\0');
+        }
+        stringOffsets.insert(str, offset);
+        return offset;
+    };
+
+    QByteArray records;
+    records.reserve(entries.size() * sizeof(Service::Record));
+    for (int n = 0; n < entries.size(); ++n)
+    {
+        const Entry &e = entries.at(n);
+        Service::Record rec = {};
+        rec.startSecSinceEpoch = e.startSecSinceEpoch;
+        rec.utcOffsetSec = e.utcOffsetSec;
+        rec.durationSec = e.durationSec;
+        rec.shortId = e.shortId;
+        for (int s = 0; s < NumStrings; ++s)
+        {
+            rec.strings[s] = internString(e.strings[s]);
+        }
+        records.append(reinterpret_cast<const char *>(&rec), sizeof(rec));
+
+        auto it = days.find(e.date.toJulianDay());
+        if (it == days.end())
+        {
+            it = days.insert(e.date.toJulianDay(), {int32_t(e.date.toJulianDay()), uint32_t(n), 0, 0});
+        }
+        else if (0 == it->numRecords)
+        {
+            it->firstRecord = n;
+        }
+        it->numRecords += 1;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, storeMagic, sizeof(storeMagic));
+    header.version = storeVersion;
+    header.numDays = days.size();
+    header.numRecords = entries.size();
+    header.stringsSize = strings.size();
+
+    QDir().mkpath(m_path);
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(metadataManager) << "Failed to write EPG store:" << filename;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const auto &entry : std::as_const(days))
+    {
+        file.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+    }
+    file.write(records);
+    file.write(strings);
+    if (!file.commit())
+    {
+        qCWarning(metadataManager) << "Failed to write EPG store:" << filename;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EPGSTORE_H
+#define EPGSTORE_H
+
+#include <QDate>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <memory>
+
+#include "epgmodelitem.h"
+#include "servicelistid.h"
+
+#define EPGSTORE_DIR_NAME "EPG"    // subdirectory of application cache location
+#define EPGSTORE_FILE_EXT ".epg"  // store file per service: <sid>.<scids>.epg
+
+// On-disk EPG store
+// Programmes of each service are kept in one binary file that is used directly from memory mapping:
+//   header | day index | programme records sorted by start time | interned UTF-16 strings
+// Day index gives range of records for each local date and marks the dates that programme information (PI) was received for.
+// Strings (names and descriptions) are stored only once per file no matter how many programmes use them.
+// SPI updates are merged into the store per schedule, programmes older than retention date are dropped on each write.
+class EPGStore
+{
+public:
+    // read only view of one service file, file stays mapped for the lifetime of the object
+    class Service
+    {
+    public:
+        int numRecords() const;
+        qint64 startTimeSecSinceEpoch(int idx) const;
+        int shortId(int idx) const;
+        EPGModelItem *item(int idx) const;  // new item created from record, ownership is passed to caller
+        EPGModelItem timeItem(int idx) const;  // item with ID, start time and duration only, strings are not decoded
+
+        bool hasSchedule(const QDate &date) const;  // true if PI for date was stored
+        QList<QDate> dates(const QDate &from, const QDate &to) const;  // dates with programmes in [from, to)
+        // returns index of first record in [from, to) and number of records
+        int recordRange(const QDate &from, const QDate &to, int *count) const;
+
+    private:
+        friend class EPGStore;
+        Service() = default;
+        bool open(const QString &filename);
+
+        struct DayEntry;
+        struct Record;
+        DayEntry day(int idx) const;
+        Record record(int idx) const;
+        QString string(uint32_t offset) const;
+
+        QFile m_file;
+        QByteArray m_data;  // mapped file
+        int m_numDays = 0;
+        int m_numRecords = 0;
+        qint64 m_recordsOffset = 0;
+        qint64 m_stringsOffset = 0;
+    };
+
+    EPGStore();
+
+    // returns nullptr if there is no valid store file for the service
+    std::shared_ptr<const EPGStore::Service> service(const ServiceListId &id) const;
+
+    // merges items into the store of the service and marks scheduleDate as received
+    // can be called from worker thread while service() is used, writes must not run concurrently
+    bool write(const ServiceListId &id, const QDate &scheduleDate, const QList<EPGModelItem> &items, const QDate &retentionDate);
+
+    // drops programmes older than retentionDate from all stores, empty stores are removed
+    void prune(const QDate &retentionDate);
+
+private:
+    struct Entry;
+    QString fileName(const ServiceListId &id) const;
+    bool writeFile(const QString &filename, QList<Entry> &entries, const QList<QDate> &scheduleDates) const;
+    // returns true if any data older than retentionDate was dropped
+    bool readEntries(const Service &service, const QDate &retentionDate, QList<Entry> &entries, QList<QDate> &scheduleDates) const;
+
+    QString m_path;
+};
+
+#endif  // EPGSTORE_H
@@ -688,4 +688,5 @@ void AirspyInput::processInputData(airspy_transfer *transfer)
     inputBuffer.count = inputBuffer.count + bytesToWrite;
     pthread_cond_signal(&inputBuffer.countCondition);
     pthread_mutex_unlock(&inputBuffer.countMutex);
+    inputBuffer.latencyStamps.push(bytesToWrite, LatencyTracer::timestamp());
 }
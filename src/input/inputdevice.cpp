@@ -26,6 +26,8 @@
 
 #include "inputdevice.h"
 
+#include "threadplacement.h"
+
 // input FIFO
 fifo_t inputBuffer;
 
@@ -36,6 +38,7 @@ void ComplexFifo::reset()
     count = 0;
     head = 0;
     tail = 0;
+    latencyStamps.reset();
 
     pthread_mutex_unlock(&countMutex);
 }
@@ -56,6 +59,7 @@ InputDevice::InputDevice(QObject *parent) : QObject(parent)
     inputBuffer.count = 0;
     inputBuffer.head = 0;
     inputBuffer.tail = 0;
+    inputBuffer.latencyStamps.reset();
     pthread_mutex_init(&inputBuffer.countMutex, NULL);
     pthread_cond_init(&inputBuffer.countCondition, NULL);
 }
@@ -68,6 +72,14 @@ InputDevice::~InputDevice()
 
 void getSamples(float buffer[], uint16_t numSamples)
 {
+    // this is called from libdabsdr thread, it is registered on first call
+    thread_local bool isThreadRegistered = false;
+    if (!isThreadRegistered)
+    {
+        ThreadPlacement::getInstance()->registerCurrentThread(ThreadPlacement::DabProcessing);
+        isThreadRegistered = true;
+    }
+
     // input read -> lets store it to FIFO
     pthread_mutex_lock(&inputBuffer.countMutex);
     uint64_t count = inputBuffer.count;
@@ -79,6 +91,10 @@ void getSamples(float buffer[], uint16_t numSamples)
     }
     pthread_mutex_unlock(&inputBuffer.countMutex);
 
+    LatencyTracer *tracer = LatencyTracer::getInstance();
+    tracer->record(LatencyTracer::InputFifo, inputBuffer.latencyStamps.pop(count, numIQ * sizeof(float)));
+    tracer->inputDequeued();
+
     // there is enough samples in input buffer
     uint64_t bytesTillEnd = INPUT_FIFO_SIZE - inputBuffer.tail;
     if (bytesTillEnd >= numIQ * sizeof(float))
@@ -114,6 +130,7 @@ void skipSamples(float buffer[], uint16_t numSamples)
         count = inputBuffer.count;
     }
 
+    inputBuffer.latencyStamps.pop(count, numSamples * 2 * sizeof(float));
     inputBuffer.tail = (inputBuffer.tail + numSamples * 2 * sizeof(float)) % INPUT_FIFO_SIZE;
 
     inputBuffer.count = inputBuffer.count - numSamples * 2 * sizeof(float);
@@ -34,6 +34,8 @@
 #include <QVariant>
 #include <QWaitCondition>
 
+#include "latencytracer.h"
+
 // this is chunk that is received from input device to be stored in input FIFO
 #define INPUT_CHUNK_MS (50)
 #define INPUT_CHUNK_IQ_SAMPLES (2048 * INPUT_CHUNK_MS)
@@ -56,6 +58,9 @@ struct ComplexFifo
     pthread_mutex_t countMutex;
     pthread_cond_t countCondition;
 
+    // enqueue timestamps for latency tracing
+    LatencyStampRing latencyStamps;
+
     void reset();
     void fillDummy();
 };
@@ -4,6 +4,8 @@
 #include <QDir>
 #include <QLoggingCategory>
 
+#include "threadplacement.h"
+
 Q_LOGGING_CATEGORY(rartTcpInput, "RaRTTcpInput", QtInfoMsg)
 
 #if defined(_WIN32)
@@ -436,6 +438,8 @@ void RartTcpWorker::startStopRecording(bool ena)
 
 void RartTcpWorker::run()
 {
+    ThreadPlacementScope placement(ThreadPlacement::Input);
+
     m_watchdogFlag = false;  // first callback sets it to true
 
     // read samples
@@ -609,4 +613,5 @@ void RartTcpWorker::processInputData(unsigned char *buf, uint32_t len)
     inputBuffer.count = inputBuffer.count + numSamples * sizeof(float);
     pthread_cond_signal(&inputBuffer.countCondition);
     pthread_mutex_unlock(&inputBuffer.countMutex);
+    inputBuffer.latencyStamps.push(numSamples * sizeof(float), LatencyTracer::timestamp());
 }
@@ -33,6 +33,7 @@
 #include <QLoggingCategory>
 
 #include "dabtables.h"
+#include "threadplacement.h"
 
 Q_LOGGING_CATEGORY(rawFileInput, "RawFileInput", QtInfoMsg)
 
@@ -601,6 +602,8 @@ void RawFileWorker::stop()
 
 void RawFileWorker::run()
 {
+    ThreadPlacementScope placement(ThreadPlacement::Input);
+
     m_watchdogFlag = false;
 
     while (1)
@@ -720,6 +723,7 @@ void RawFileWorker::run()
         inputBuffer.count = inputBuffer.count + samplesRead * sizeof(float);
         pthread_cond_signal(&inputBuffer.countCondition);
         pthread_mutex_unlock(&inputBuffer.countMutex);
+        inputBuffer.latencyStamps.push(samplesRead * sizeof(float), LatencyTracer::timestamp());
 
         emit bytesRead(m_bytesRead);
 
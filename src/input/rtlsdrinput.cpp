@@ -34,6 +34,8 @@
 #include <QJniObject>
 #endif
 
+#include "threadplacement.h"
+
 Q_LOGGING_CATEGORY(rtlsdrInput, "RtlSdrInput", QtInfoMsg)
 
 InputDeviceList RtlSdrInput::getDeviceList()
@@ -820,6 +822,8 @@ RtlSdrWorker::RtlSdrWorker(struct rtlsdr_dev *device, QObject *parent) : QThread
 
 void RtlSdrWorker::run()
 {
+    ThreadPlacementScope placement(ThreadPlacement::Input);
+
     m_dcI = 0.0;
     m_dcQ = 0.0;
     m_agcLevel = 0.0;
@@ -1079,4 +1083,5 @@ void RtlSdrWorker::processInputData(unsigned char *buf, uint32_t len)
     inputBuffer.count = inputBuffer.count + len * sizeof(float);
     pthread_cond_signal(&inputBuffer.countCondition);
     pthread_mutex_unlock(&inputBuffer.countMutex);
+    inputBuffer.latencyStamps.push(len * sizeof(float), LatencyTracer::timestamp());
 }
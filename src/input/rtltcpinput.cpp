@@ -30,6 +30,8 @@
 #include <QDir>
 #include <QLoggingCategory>
 
+#include "threadplacement.h"
+
 Q_LOGGING_CATEGORY(rtlTcpInput, "RtlTcpInput", QtInfoMsg)
 
 const int RtlTcpInput::e4k_gains[] = {-10, 15, 40, 65, 90, 115, 140, 165, 190, 215, 240, 290, 340, 420};
@@ -805,6 +807,8 @@ void RtlTcpWorker::startStopRecording(bool ena)
 
 void RtlTcpWorker::run()
 {
+    ThreadPlacementScope placement(ThreadPlacement::Input);
+
     m_dcI = 0.0;
     m_dcQ = 0.0;
     m_agcLevel = 0.0;
@@ -1113,4 +1117,5 @@ void RtlTcpWorker::processInputData(unsigned char *buf, uint32_t len)
     inputBuffer.count = inputBuffer.count + len * sizeof(float);
     pthread_cond_signal(&inputBuffer.countCondition);
     pthread_mutex_unlock(&inputBuffer.countMutex);
+    inputBuffer.latencyStamps.push(len * sizeof(float), LatencyTracer::timestamp());
 }
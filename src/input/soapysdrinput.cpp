@@ -30,6 +30,8 @@
 #include <QDir>
 #include <QLoggingCategory>
 
+#include "threadplacement.h"
+
 Q_LOGGING_CATEGORY(soapySdrInput, "SoapySdrInput", QtInfoMsg)
 
 SoapySdrInput::SoapySdrInput(QObject *parent) : InputDevice(parent)
@@ -638,6 +640,8 @@ SoapySdrWorker::~SoapySdrWorker()
 
 void SoapySdrWorker::run()
 {
+    ThreadPlacementScope placement(ThreadPlacement::Input);
+
     m_doReadIQ = true;
 
     m_agcLevel = 0.0;
@@ -792,4 +796,5 @@ void SoapySdrWorker::processInputData(std::complex<float> buff[], size_t numSamp
     inputBuffer.count = inputBuffer.count + bytesToWrite;
     pthread_cond_signal(&inputBuffer.countCondition);
     pthread_mutex_unlock(&inputBuffer.countMutex);
+    inputBuffer.latencyStamps.push(bytesToWrite, LatencyTracer::timestamp());
 }
@@ -0,0 +1,287 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "latencytracer.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtAlgorithms>
+#include <chrono>
+
+void LatencyStampRing::push(uint64_t bytes, int64_t timestampNs)
+{
+    m_written += bytes;
+
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= Size)
+    {  // full -> stamp is lost, bytes are accounted to the next stamp
+        return;
+    }
+    m_stamps[head & Mask] = {m_written, timestampNs};
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+int64_t LatencyStampRing::pop(uint64_t fifoCount, uint64_t bytes)
+{
+    uint32_t head = m_head.load(std::memory_order_acquire);
+    uint32_t tail = m_tail.load(std::memory_order_relaxed);
+    if (m_resetRequest.exchange(false, std::memory_order_acq_rel))
+    {  // all stamps are dropped, read position is resynchronized with the next stamp
+        if (head != tail)
+        {
+            m_read = m_stamps[(head - 1) & Mask].end;
+        }
+        m_tail.store(head, std::memory_order_release);
+        return -1;
+    }
+    if (head == tail)
+    {
+        return -1;
+    }
+
+    // FIFO could be flushed by producer without reading (tune, reset)
+    // in that case there is more stamped than available in FIFO
+    uint64_t written = m_stamps[(head - 1) & Mask].end;
+    if (written - m_read > fifoCount)
+    {
+        m_read = written - fifoCount;
+    }
+    m_read += bytes;
+
+    int64_t timestampNs = -1;
+    while (tail != head)
+    {
+        const Stamp &stamp = m_stamps[tail & Mask];
+        timestampNs = stamp.timestampNs;
+        if (stamp.end > m_read)
+        {  // last byte read is in this chunk
+            break;
+        }
+        tail += 1;
+        if (stamp.end == m_read)
+        {
+            break;
+        }
+    }
+    m_tail.store(tail, std::memory_order_release);
+
+    return timestampNs;
+}
+
+LatencyTracer *LatencyTracer::getInstance()
+{
+    static LatencyTracer instance;
+    return &instance;
+}
+
+LatencyTracer::LatencyTracer()
+{
+    m_originNs = timestamp();
+    reset();
+}
+
+int64_t LatencyTracer::timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int LatencyTracer::binIndex(uint64_t us)
+{
+    if (us < 4)
+    {
+        return us;
+    }
+    int msb = 63 - qCountLeadingZeroBits(quint64(us));
+    int bin = 4 * msb + ((us >> (msb - 2)) & 0x3) - 4;
+    return (bin < NumBins) ? bin : (NumBins - 1);
+}
+
+uint64_t LatencyTracer::binLowerBoundUs(int bin)
+{
+    if (bin < 4)
+    {
+        return bin;
+    }
+    int msb = (bin + 4) / 4;
+    return uint64_t(4 + (bin & 0x3)) << (msb - 2);
+}
+
+void LatencyTracer::record(Stage stage, int64_t startNs, int64_t endNs)
+{
+    if (startNs < 0 || endNs < startNs)
+    {
+        return;
+    }
+
+    StageData &data = m_stage[stage];
+    uint64_t us = (endNs - startNs) / 1000;
+
+    data.bins[binIndex(us)].fetch_add(1, std::memory_order_relaxed);
+    data.count.fetch_add(1, std::memory_order_relaxed);
+    data.sumUs.fetch_add(us, std::memory_order_relaxed);
+    uint64_t maxUs = data.maxUs.load(std::memory_order_relaxed);
+    while (us > maxUs && !data.maxUs.compare_exchange_weak(maxUs, us, std::memory_order_relaxed))
+    {
+    }
+
+    Event &event = data.events[data.eventIdx.fetch_add(1, std::memory_order_relaxed) & EventsMask];
+    event.startNs.store(startNs, std::memory_order_relaxed);
+    event.durNs.store(endNs - startNs, std::memory_order_relaxed);
+}
+
+void LatencyTracer::audioFrameReceived()
+{
+    record(Stage::Demodulator, m_lastDequeueNs.load(std::memory_order_relaxed));
+}
+
+QList<LatencyTracer::StageStatistics> LatencyTracer::statistics() const
+{
+    QList<StageStatistics> stats;
+    for (int s = 0; s < NumStages; ++s)
+    {
+        const StageData &data = m_stage[s];
+        StageStatistics stageStats;
+
+        uint32_t bins[NumBins];
+        uint64_t total = 0;
+        for (int n = 0; n < NumBins; ++n)
+        {
+            bins[n] = data.bins[n].load(std::memory_order_relaxed);
+            total += bins[n];
+        }
+        stageStats.count = total;
+        if (total > 0)
+        {
+            stageStats.meanMs = data.sumUs.load(std::memory_order_relaxed) * 0.001 / data.count.load(std::memory_order_relaxed);
+            stageStats.maxMs = data.maxUs.load(std::memory_order_relaxed) * 0.001;
+
+            // percentiles are taken as lower bound of the bin
+            uint64_t p50Count = (total + 1) / 2;
+            uint64_t p95Count = (total * 95 + 99) / 100;
+            uint64_t cumulative = 0;
+            bool p50Found = false;
+            for (int n = 0; n < NumBins; ++n)
+            {
+                cumulative += bins[n];
+                if (!p50Found && cumulative >= p50Count)
+                {
+                    stageStats.p50Ms = binLowerBoundUs(n) * 0.001;
+                    p50Found = true;
+                }
+                if (cumulative >= p95Count)
+                {
+                    stageStats.p95Ms = binLowerBoundUs(n) * 0.001;
+                    break;
+                }
+            }
+        }
+        stats.append(stageStats);
+    }
+    return stats;
+}
+
+void LatencyTracer::reset()
+{
+    for (int s = 0; s < NumStages; ++s)
+    {
+        StageData &data = m_stage[s];
+        for (int n = 0; n < NumBins; ++n)
+        {
+            data.bins[n] = 0;
+        }
+        data.count = 0;
+        data.sumUs = 0;
+        data.maxUs = 0;
+        data.eventIdx = 0;
+        for (int n = 0; n < EventsSize; ++n)
+        {
+            data.events[n].startNs = 0;
+            data.events[n].durNs = 0;
+        }
+    }
+}
+
+QByteArray LatencyTracer::chromeTrace() const
+{
+    QJsonArray traceEvents;
+    for (int s = 0; s < NumStages; ++s)
+    {
+        // each stage is shown as separate track
+        QJsonObject threadName;
+        threadName["name"] = "thread_name";
+        threadName["ph"] = "M";
+        threadName["pid"] = 1;
+        threadName["tid"] = s;
+        threadName["args"] = QJsonObject{{"name", stageName(static_cast<Stage>(s))}};
+        traceEvents.append(threadName);
+
+        const StageData &data = m_stage[s];
+        uint32_t idx = data.eventIdx.load(std::memory_order_relaxed);
+        uint32_t num = qMin(idx, uint32_t(EventsSize));
+        for (uint32_t n = idx - num; n != idx; ++n)
+        {
+            const Event &event = data.events[n & EventsMask];
+            int64_t startNs = event.startNs.load(std::memory_order_relaxed);
+            if (startNs < m_originNs)
+            {
+                continue;
+            }
+            QJsonObject obj;
+            obj["name"] = stageName(static_cast<Stage>(s));
+            obj["cat"] = "latency";
+            obj["ph"] = "X";
+            obj["pid"] = 1;
+            obj["tid"] = s;
+            obj["ts"] = (startNs - m_originNs) * 0.001;
+            obj["dur"] = event.durNs.load(std::memory_order_relaxed) * 0.001;
+            traceEvents.append(obj);
+        }
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = traceEvents;
+    trace["displayTimeUnit"] = "ms";
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+const char *LatencyTracer::stageName(Stage stage)
+{
+    switch (stage)
+    {
+        case InputFifo:
+            return "Input FIFO";
+        case Demodulator:
+            return "DAB processing";
+        case AudioDecoder:
+            return "Audio decoder";
+        case AudioFifo:
+            return "Audio FIFO";
+        case NumStages:
+            break;
+    }
+    return "";
+}
@@ -0,0 +1,157 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <QByteArray>
+#include <QList>
+#include <atomic>
+#include <cstdint>
+
+// Latency of the receive pipeline is traced in these stages:
+//   InputFifo    - IQ chunk enqueued by input device -> dequeued by getSamples()
+//   Demodulator  - last getSamples() dequeue -> audioDataCb() (libdabsdr processing)
+//   AudioDecoder - audioDataCb() -> AudioDecoder::decodeData() finished
+//   AudioFifo    - PCM written to AudioFifo -> consumed by audio output callback
+// All methods used in the data path are lock-free, they can be called from realtime threads.
+
+// Single producer / single consumer ring of (cumulative bytes, timestamp) pairs
+// Producer stamps each chunk written to FIFO, consumer gets the timestamp of the last byte read
+class LatencyStampRing
+{
+public:
+    // can be called from any thread, stamps are dropped by consumer in the next pop()
+    void reset() { m_resetRequest.store(true, std::memory_order_release); }
+
+    // producer: to be called after FIFO count was increased by bytes
+    void push(uint64_t bytes, int64_t timestampNs);
+
+    // consumer: fifoCount is number of bytes in FIFO before reading
+    // returns enqueue timestamp of the last byte read or -1 if not known
+    int64_t pop(uint64_t fifoCount, uint64_t bytes);
+
+private:
+    enum
+    {
+        Size = 256,  // must be power of 2
+        Mask = Size - 1
+    };
+    struct Stamp
+    {
+        uint64_t end;
+        int64_t timestampNs;
+    };
+    Stamp m_stamps[Size];
+    uint64_t m_written = 0;  // producer only, never reset (consumer resynchronizes to FIFO count)
+    uint64_t m_read = 0;     // consumer only
+    std::atomic<uint32_t> m_head = 0;
+    std::atomic<uint32_t> m_tail = 0;
+    std::atomic<bool> m_resetRequest = false;
+};
+
+class LatencyTracer
+{
+public:
+    enum Stage
+    {
+        InputFifo = 0,
+        Demodulator,
+        AudioDecoder,
+        AudioFifo,
+        NumStages
+    };
+
+    struct StageStatistics
+    {
+        uint64_t count = 0;
+        float meanMs = 0.0;
+        float p50Ms = 0.0;
+        float p95Ms = 0.0;
+        float maxMs = 0.0;
+    };
+
+    static LatencyTracer *getInstance();
+
+    // monotonic time in nanoseconds
+    static int64_t timestamp();
+
+    void record(Stage stage, int64_t startNs, int64_t endNs);
+    void record(Stage stage, int64_t startNs) { record(stage, startNs, timestamp()); }
+
+    // these two are used to measure libdabsdr processing time
+    void inputDequeued() { m_lastDequeueNs.store(timestamp(), std::memory_order_relaxed); }
+    void audioFrameReceived();
+
+    QList<StageStatistics> statistics() const;
+    void reset();
+
+    // latency of audio output device (sound card buffer) reported by audio output backend
+    void setOutputDeviceLatency(float ms) { m_outputDeviceLatencyMs.store(ms, std::memory_order_relaxed); }
+    float outputDeviceLatency() const { return m_outputDeviceLatencyMs.load(std::memory_order_relaxed); }
+
+    // returns recent events in Chrome trace event format (chrome://tracing, Perfetto)
+    QByteArray chromeTrace() const;
+
+    static const char *stageName(Stage stage);
+
+private:
+    LatencyTracer();
+
+    enum
+    {
+        // histogram has quarter-octave bins of microseconds: bin = 4*log2(us)
+        NumBins = 4 * 26,
+        EventsSize = 2048,  // must be power of 2
+        EventsMask = EventsSize - 1
+    };
+
+    struct Event
+    {
+        std::atomic<int64_t> startNs = 0;
+        std::atomic<int64_t> durNs = 0;
+    };
+
+    struct StageData
+    {
+        std::atomic<uint32_t> bins[NumBins];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sumUs;
+        std::atomic<uint64_t> maxUs;
+        std::atomic<uint32_t> eventIdx;
+        Event events[EventsSize];
+    };
+
+    StageData m_stage[NumStages];
+    std::atomic<int64_t> m_lastDequeueNs = 0;
+    std::atomic<float> m_outputDeviceLatencyMs = 0.0;
+    int64_t m_originNs;
+
+    static int binIndex(uint64_t us);
+    static uint64_t binLowerBoundUs(int bin);
+};
+
+#endif  // LATENCYTRACER_H
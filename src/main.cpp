@@ -33,6 +33,7 @@
 
 #include "application.h"
 #include "config.h"
+#include "threadplacement.h"
 
 #if HAVE_QTWIDGETS
 #include <QApplication>
@@ -108,12 +109,35 @@ int main(int argc, char *argv[])
 
         parser.addOption(slFileOption);
 
+        // role list is generated so that it is aligned with ThreadPlacement
+        QStringList threadRoles;
+        for (int r = 0; r < ThreadPlacement::NumRoles; ++r)
+        {
+            threadRoles.append(ThreadPlacement::roleName(ThreadPlacement::Role(r)));
+        }
+        QCommandLineOption threadOption(
+            QStringList() << "t" << "thread",
+            QObject::tr("Optional CPU affinity and scheduling of pipeline thread, overrides INI file. Can be used multiple times. "
+                        "Roles: %1. Example: audioOutput:3::10 (CPU 3, SCHED_FIFO priority 10).")
+                .arg(threadRoles.join(", ")),
+            "role:cpus[:nice[:rtPriority]]");
+        parser.addOption(threadOption);
+
         // Process the actual command line arguments given by the user
         parser.process(guiApp);
 
         QString iniFile = parser.value(iniFileOption);
         QString slFile = parser.value(slFileOption);
 
+        const QStringList threadConfigs = parser.values(threadOption);
+        for (const QString &threadConfig : threadConfigs)
+        {
+            if (!ThreadPlacement::getInstance()->parseCommandLine(threadConfig))
+            {
+                qWarning() << "Invalid thread placement:" << threadConfig;
+            }
+        }
+
 #ifdef Q_OS_LINUX
         // Set icon
         guiApp.setWindowIcon(QIcon(":/resources/appIcon-linux.png"));
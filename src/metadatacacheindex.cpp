@@ -0,0 +1,289 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "metadatacacheindex.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+#include <algorithm>
+
+Q_DECLARE_LOGGING_CATEGORY(metadataManager)
+
+static const quint32 indexMagic = 0x41424349;  // "ABCI"
+static const quint32 indexVersion = 1;
+
+MetadataCacheIndex::MetadataCacheIndex(const QString &cachePath)
+    : m_cachePath(cachePath),
+      m_totalSize(0),
+      m_maxAge(qint64(METADATACACHEINDEX_MAX_AGE) * 24 * 3600 * 1000),
+      m_diskBudget(qint64(METADATACACHEINDEX_DISK_BUDGET) * 1024 * 1024),
+      m_isDirty(false)
+{
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(METADATACACHEINDEX_SAVE_DELAY * 1000);
+    QObject::connect(&m_saveTimer, &QTimer::timeout, &m_saveTimer, [this]() { save(); });
+
+    load();
+    indexExistingFiles();
+}
+
+MetadataCacheIndex::~MetadataCacheIndex()
+{
+    save();
+}
+
+void MetadataCacheIndex::load()
+{
+    QFile file(m_cachePath + "/" + METADATACACHEINDEX_FILE_NAME);
+    if (!file.open(QIODevice::ReadOnly))
+    {  // no index yet
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    in >> magic >> version >> count;
+    if ((indexMagic != magic) || (indexVersion != version))
+    {
+        qCWarning(metadataManager) << "Unsupported metadata cache index, creating new one";
+        return;
+    }
+    for (quint32 n = 0; (n < count) && (in.status() == QDataStream::Ok); ++n)
+    {
+        QString path;
+        Entry entry;
+        quint8 source;
+        in >> path >> entry.size >> entry.hash >> source >> entry.lastSeen;
+        entry.source = static_cast<Source>(source);
+        if (in.status() == QDataStream::Ok)
+        {
+            m_entries.insert(path, entry);
+            m_totalSize += entry.size;
+        }
+    }
+}
+
+void MetadataCacheIndex::indexExistingFiles()
+{  // logos received by older version or before index was saved would never be removed otherwise
+    // service:  "e21234.0/e22139/320x240.jpg"
+    // ensemble: "e24321/320x240.jpg"
+    static const QRegularExpression dirRe("^[0-9a-f]{6}(\\.\\d+)?$", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression fileRe("^[0-9a-f]{6}(\\.\\d+)?(/[0-9a-f]{6})?/\\d+x\\d+\\.(png|jpg)$",
+                                           QRegularExpression::CaseInsensitiveOption);
+
+    QDir cacheDir(m_cachePath);
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QSet<QString> existingFiles;
+    int numAdded = 0;
+    const QStringList baseDirs = cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &baseDir : baseDirs)
+    {
+        if (!dirRe.match(baseDir).hasMatch())
+        {  // TII, EPG, flags, etc.
+            continue;
+        }
+        QDirIterator it(cacheDir.absoluteFilePath(baseDir), {"*.png", "*.jpg"}, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext())
+        {
+            it.next();
+            QString path = cacheDir.relativeFilePath(it.filePath());
+            if (!fileRe.match(path).hasMatch())
+            {
+                continue;
+            }
+            existingFiles.insert(path);
+            if (!m_entries.contains(path))
+            {  // hash is not known, it is calculated when the file is received again
+                // modification time is when the file was first received (unchanged files were not rewritten)
+                // so the age is counted from indexing, otherwise logos still broadcast would be removed
+                QFileInfo fileInfo = it.fileInfo();
+                m_entries.insert(path, {fileInfo.size(), QByteArray(), Source::Unknown, now});
+                m_totalSize += fileInfo.size();
+                numAdded += 1;
+            }
+        }
+    }
+
+    int numRemoved = 0;
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (!existingFiles.contains(it.key()))
+        {  // removed outside of application
+            m_totalSize -= it->size;
+            it = m_entries.erase(it);
+            numRemoved += 1;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if ((numAdded > 0) || (numRemoved > 0))
+    {
+        setDirty();
+    }
+    qCDebug(metadataManager) << "Metadata cache index:" << m_entries.size() << "files," << m_totalSize << "bytes," << numAdded << "added," << numRemoved
+                             << "removed";
+}
+
+void MetadataCacheIndex::setDirty()
+{  // timer is not restarted, continuous reception must not postpone saving forever
+    m_isDirty = true;
+    if (!m_saveTimer.isActive())
+    {
+        m_saveTimer.start();
+    }
+}
+
+void MetadataCacheIndex::save()
+{
+    m_saveTimer.stop();
+    if (!m_isDirty)
+    {
+        return;
+    }
+
+    QDir().mkpath(m_cachePath);
+    QSaveFile file(m_cachePath + "/" + METADATACACHEINDEX_FILE_NAME);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qCWarning(metadataManager) << "Failed to write metadata cache index:" << file.fileName();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << indexMagic << indexVersion << quint32(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+    {
+        out << it.key() << it->size << it->hash << quint8(it->source) << it->lastSeen;
+    }
+    if (file.commit())
+    {
+        m_isDirty = false;
+    }
+}
+
+bool MetadataCacheIndex::isUnchanged(const QString &path, const QByteArray &hash, qint64 size, Source source)
+{
+    QFileInfo fileInfo(m_cachePath + "/" + path);
+    auto it = m_entries.find(path);
+    if ((it == m_entries.end()) || it->hash.isEmpty())
+    {  // not indexed or found on startup ==> file is hashed once
+        if (!fileInfo.exists() || (fileInfo.size() != size))
+        {
+            return false;
+        }
+        QFile file(fileInfo.absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return false;
+        }
+        QCryptographicHash md5gen(QCryptographicHash::Md5);
+        md5gen.addData(&file);
+        insert(path, md5gen.result(), size, Source::Unknown);
+        it = m_entries.find(path);
+    }
+    else if (fileInfo.size() != it->size)
+    {  // file was removed or modified outside of application
+        return false;
+    }
+
+    if ((it->size != size) || (it->hash != hash))
+    {
+        return false;
+    }
+
+    it->lastSeen = QDateTime::currentMSecsSinceEpoch();
+    it->source = source;
+    setDirty();
+    return true;
+}
+
+void MetadataCacheIndex::insert(const QString &path, const QByteArray &hash, qint64 size, Source source)
+{
+    auto it = m_entries.find(path);
+    if (it != m_entries.end())
+    {
+        m_totalSize -= it->size;
+    }
+    m_entries.insert(path, {size, hash, source, QDateTime::currentMSecsSinceEpoch()});
+    m_totalSize += size;
+    setDirty();
+}
+
+void MetadataCacheIndex::setLimits(int maxAgeDays, int diskBudgetMB)
+{
+    m_maxAge = qint64(qMax(0, maxAgeDays)) * 24 * 3600 * 1000;
+    m_diskBudget = qint64(qMax(0, diskBudgetMB)) * 1024 * 1024;
+}
+
+QStringList MetadataCacheIndex::collectGarbage()
+{
+    QStringList removed;
+    QDir dir(m_cachePath);
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // least recently seen first
+    QList<QString> paths = m_entries.keys();
+    std::sort(paths.begin(), paths.end(), [this](const QString &a, const QString &b) { return m_entries[a].lastSeen < m_entries[b].lastSeen; });
+
+    for (const QString &path : std::as_const(paths))
+    {
+        const Entry &entry = m_entries[path];
+        bool isOld = (m_maxAge > 0) && (now - entry.lastSeen > m_maxAge);
+        bool isOverBudget = (m_diskBudget > 0) && (m_totalSize > m_diskBudget);
+        if (!isOld && !isOverBudget)
+        {  // remaining files are newer
+            break;
+        }
+        qCDebug(metadataManager) << "Removing" << path << "from cache," << (isOld ? "not received for long time" : "cache is full");
+        dir.remove(path);
+        m_totalSize -= entry.size;
+        m_entries.remove(path);
+        removed.append(path);
+    }
+
+    if (!removed.isEmpty())
+    {
+        m_isDirty = true;
+        save();
+    }
+    return removed;
+}
@@ -0,0 +1,98 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef METADATACACHEINDEX_H
+#define METADATACACHEINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#define METADATACACHEINDEX_FILE_NAME "metadata.idx"  // index file in application cache location
+#define METADATACACHEINDEX_MAX_AGE (90)              // [days] default age of files that are removed
+#define METADATACACHEINDEX_DISK_BUDGET (64)          // [MB] default size limit of indexed files
+#define METADATACACHEINDEX_SAVE_DELAY (10)           // [s] index is saved with this delay after first change
+
+// Persistent index of files received by MetadataManager (logos)
+// Size and hash of each file are stored so that received data can be compared with the cache without reading the file.
+// Files not received for maximum age and least recently received files over the disk budget are removed from the cache.
+// Paths are relative to cache location (same as file request ID).
+// Logo files found in cache on startup are indexed with unknown hash, they are hashed when received again.
+// Index is saved with delay after change, it needs event loop in the thread where it is used.
+class MetadataCacheIndex
+{
+public:
+    enum class Source : uint8_t
+    {
+        Unknown = 0,
+        SPI,       // received in SPI application
+        RadioDNS,  // downloaded from internet
+    };
+
+    explicit MetadataCacheIndex(const QString &cachePath);
+    ~MetadataCacheIndex();
+
+    // returns true if cached file is the same as received data (hash is MD5 of data)
+    // last seen time of the file is updated in such case
+    // file that is not in index (cache created by older version) is read and hashed only once
+    bool isUnchanged(const QString &path, const QByteArray &hash, qint64 size, Source source);
+
+    // records file that was written to cache
+    void insert(const QString &path, const QByteArray &hash, qint64 size, Source source);
+
+    // 0 = no limit
+    void setLimits(int maxAgeDays, int diskBudgetMB);
+
+    // removes files over limits from cache, returns paths of removed files
+    QStringList collectGarbage();
+
+    void save();
+
+private:
+    struct Entry
+    {
+        qint64 size;
+        QByteArray hash;
+        Source source;
+        qint64 lastSeen;  // [ms since epoch]
+    };
+
+    QString m_cachePath;
+    QHash<QString, Entry> m_entries;
+    qint64 m_totalSize;
+    qint64 m_maxAge;      // [ms], 0 = no limit
+    qint64 m_diskBudget;  // [bytes], 0 = no limit
+    bool m_isDirty;
+    QTimer m_saveTimer;
+
+    void load();
+    void indexExistingFiles();
+    void setDirty();
+};
+
+#endif  // METADATACACHEINDEX_H
@@ -39,18 +39,40 @@
 #include <QThread>
 
 #include "epgtime.h"
+#include "imagecache.h"
 #include "spiapp.h"
 
 Q_LOGGING_CATEGORY(metadataManager, "MetadataManager", QtInfoMsg)
 
+// logos are requested by every view that shows the service, decoded images are taken from shared cache
+static QPixmap loadPixmap(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QPixmap();
+    }
+    return QPixmap::fromImage(ImageCache::getInstance()->image(file.readAll()));
+}
+
 MetadataManager::MetadataManager(const ServiceList *serviceList, QObject *parent)
-    : QObject(parent), m_serviceList(serviceList), m_isLoadingFromCache(false), m_cleanEpgCache(true)
-{}
+    : QObject(parent),
+      m_serviceList(serviceList),
+      m_cleanEpgCache(true),
+      m_cacheIndex(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+{
+    m_pixmapCache.setMaxCost(METADATAMANAGER_PIXMAP_CACHE_BUDGET * 1024 * 1024);
+    m_epgStoreWriter.setMaxThreadCount(1);  // writes of the same service must not run concurrently
+}
 
 MetadataManager::~MetadataManager()
 {
+    m_epgStoreWriter.waitForDone();
     if (m_cleanEpgCache && EPGTime::getInstance()->isValid())
     {  // do chache maintenance
+        m_epgStore.prune(EPGTime::getInstance()->currentDate().addDays(-2));
+
+        // XML files are only exported, they are not loaded anymore
         QDir directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/EPG/");
         QStringList xmlFiles = directory.entryList({"*_PI.xml"}, QDir::Files);
         QString currentDateStr2 = EPGTime::getInstance()->currentDate().addDays(-2).toString("yyyyMMdd");
@@ -67,461 +89,337 @@ MetadataManager::~MetadataManager()
 
 void MetadataManager::processXML(const QString &xml, const QString &scopeId, uint16_t decoderId)
 {
-    QDomDocument xmldocument;
-    if (!xmldocument.setContent(xml, QDomDocument::ParseOption::UseNamespaceProcessing))
+    qCDebug(metadataManager) << qPrintable(xml);
+
+    SPIMetadataBuilder builder;
+    if (!SPIMetadataBuilder::readXml(xml, builder))
     {
         qCWarning(metadataManager) << "Failed to parse SPI document for:" << scopeId;
-        qCDebug(metadataManager) << qPrintable(xmldocument.toString());
         return;
     }
 
-    qCDebug(metadataManager) << qPrintable(xmldocument.toString());
+    processMetadata(builder.metadata(), scopeId, decoderId);
+}
 
-    QDomElement docElem = xmldocument.documentElement();
-    if ("serviceInformation" == docElem.tagName())
+void MetadataManager::processMetadata(const SPIMetadata &metadata, const QString &scopeId, uint16_t decoderId)
+{
+    if ("serviceInformation" == metadata.root)
     {
-        QDomNode node = docElem.firstChild();
-        while (!node.isNull())
-        {  // ETSI TS 102 818 V3.4.1 [6.2]
-            // serviceInformation: can contain zero or one of each of the following elements in this order:
-            //      services
-            //      serviceGroups
-            QDomElement element = node.toElement();  // try to convert the node to an element
-            if (!element.isNull())
+        for (const auto &service : metadata.services)
+        {  // ETSI TS 102 818 V3.4.1 [6.5]
+            // Service element describes metadata and available bearers for a service.
+            QStringList sidList;
+            for (const QString &bearer : service.bearers)
             {
-                if (("services" == element.tagName()) || ("ensemble" == element.tagName()))
-                {
-                    QDomNode servicesNode = element.firstChild();
-                    while (!servicesNode.isNull())
-                    {  // ETSI TS 102 818 V3.4.1 [6.3]
-                        // Services element can contain zero or one "serviceProvider" element and zero or more "service" elements
-                        QDomElement servicesElement = servicesNode.toElement();  // try to convert the node to an element
-                        if (!servicesElement.isNull())
-                        {
-                            if ("service" == servicesElement.tagName())
-                            {  // ETSI TS 102 818 V3.4.1 [6.5]
-                                // Service element describes metadata and available bearers for a service.
-                                QStringList sidList;
-                                serviceInfo_t serviceInfo;
-
-                                // first analyze bearer(s)
-                                QDomNodeList bearerList = servicesElement.elementsByTagName("bearer");
-                                for (int b = 0; b < bearerList.count(); ++b)
-                                {
-                                    QDomElement bearerElement = bearerList.at(b).toElement();  // try to convert the node to an element
-                                    if (!bearerElement.isNull())
-                                    {
-                                        QString bearer = bearerElement.attribute("id", "");
-                                        static const QRegularExpression sidRegex("dab:[a-f0-9]([a-f0-9]{2}).(\\w{4}).(\\w{4}.\\d+)",
-                                                                                 QRegularExpression::CaseInsensitiveOption);
-                                        QRegularExpressionMatch match = sidRegex.match(bearer);
-                                        if (match.hasMatch())
-                                        {  // found valid DAB SId ==> service is available in DAB
-                                            QString sidStr = QString("%1%2/%1%3").arg(match.captured(1), match.captured(3), match.captured(2));
-                                            // this creates string like e2abcd.1/E22004 for SId with ECC=E2, SID=ABCD and SCIds=1 and ens ID 2004
-                                            if (!sidList.contains(sidStr))
-                                            {  // append if not in list
-                                                sidList.append(sidStr);
-                                            }
-                                        }
-                                    }
-                                }
+                static const QRegularExpression sidRegex("dab:[a-f0-9]([a-f0-9]{2}).(\\w{4}).(\\w{4}.\\d+)", QRegularExpression::CaseInsensitiveOption);
+                QRegularExpressionMatch match = sidRegex.match(bearer);
+                if (match.hasMatch())
+                {  // found valid DAB SId ==> service is available in DAB
+                    QString sidStr = QString("%1%2/%1%3").arg(match.captured(1), match.captured(3), match.captured(2));
+                    // this creates string like e2abcd.1/E22004 for SId with ECC=E2, SID=ABCD and SCIds=1 and ens ID 2004
+                    if (!sidList.contains(sidStr))
+                    {  // append if not in list
+                        sidList.append(sidStr);
+                    }
+                }
+            }
 
-                                QDomNode serviceNode = servicesElement.firstChild();
-                                while (!serviceNode.isNull())
-                                {  // ETSI TS 102 818 V3.4.1 [6.5]
-                                    // Service element can contain the following elements, which should be provided in the defined order:
-                                    // * nameGroup (shortName, mediumName, longName);
-                                    // * alias;
-                                    // * phoneme;
-                                    // * mediaDescription;
-                                    // * genre;
-                                    // * keywords;
-                                    // * link;
-                                    // * bearer;
-                                    // * radiodns;
-                                    // * geolocation;
-                                    // * serviceGroupMember
-
-                                    if (!sidList.isEmpty())
-                                    {  // at least one valid DAB SId was found => go through elements
-                                        QDomElement serviceElement = serviceNode.toElement();  // try to convert the node to an element
-                                        if (!serviceElement.isNull())
-                                        {  // ETSI TS 102 818 V3.4.1 [6.5]
-                                            // at lease one of these shall be provided
-                                            if (("shortName" == serviceElement.tagName()) || ("mediumName" == serviceElement.tagName()) ||
-                                                ("longName" == serviceElement.tagName()))
-                                            {
-                                                serviceInfo[serviceElement.tagName()] = serviceElement.text();
-                                            }
-                                            else if ("mediaDescription" == serviceElement.tagName())
-                                            {
-                                                QDomNode mediaDescNode = serviceElement.firstChild();
-                                                while (!mediaDescNode.isNull())
-                                                {
-                                                    QDomElement mediaDescElement =
-                                                        mediaDescNode.toElement();  // try to convert the node to an element
-                                                    if (!mediaDescElement.isNull())
-                                                    {
-                                                        if (("shortDescription" == mediaDescElement.tagName()) ||
-                                                            ("longDescription" == mediaDescElement.tagName()))
-                                                        {  // service description long and/or short
-                                                            serviceInfo[mediaDescElement.tagName()] = mediaDescElement.text();
-                                                        }
-                                                        else if ("multimedia" == mediaDescElement.tagName())
-                                                        {  // Service logos shall be provided using the mediaDescription/multimedia element
-                                                            QString type = mediaDescElement.attribute("type");
-                                                            QString url = mediaDescElement.attribute("url");
-                                                            QString width = mediaDescElement.attribute("width");
-                                                            QString height = mediaDescElement.attribute("height");
-                                                            QString ext = "png";
-                                                            if ("logo_colour_square" == type)
-                                                            {
-                                                                width = height = "32";
-                                                            }
-                                                            else if ("logo_colour_rectangle" == type)
-                                                            {
-                                                                width = "112";
-                                                                height = "32";
-                                                            }
-                                                            else
-                                                            {
-                                                                if (mediaDescElement.attribute("mimeValue") == "image/jpeg")
-                                                                {
-                                                                    ext = "jpg";
-                                                                }
-                                                            }
-                                                            int widthVal = width.toInt();
-                                                            int heightVal = height.toInt();
-
-                                                            // only SLS size or logo size is accepted
-                                                            if (((widthVal == 320) && (heightVal == 240)) || ((widthVal == 32) && (heightVal == 32)))
-                                                            {
-                                                                for (const QString &sidStr : sidList)
-                                                                {  // ask for logo for each SId (actually there should be only one valid DAB SId)
-                                                                    QString filename = QString("%1/%2x%3.%4").arg(sidStr, width, height, ext);
-                                                                    qCDebug(metadataManager) << url << "===>" << filename;
-
-                                                                    emit getFile(decoderId, url, filename);
-                                                                }
-                                                            }
-                                                        }
-                                                    }
-                                                    mediaDescNode = mediaDescNode.nextSibling();
-                                                }
-                                            }
-                                        }
-                                    }
-                                    serviceNode = serviceNode.nextSibling();
-                                }
-                                for (const QString &sidStr : sidList)
-                                {  // insert in database
-                                    qCDebug(metadataManager) << sidStr << serviceInfo;
-                                    m_info.insert(sidStr, serviceInfo);
-                                }
-                            }
-                            else if ("serviceProvider" == servicesElement.tagName())
-                            {  // not service/ensemble or serviceGroups
-                                // this should not happen for XML from internet but it may be coming from binary encondig that does not support
-                                // serviceProvider element
-                                qCDebug(metadataManager, "serviceProvider found");
-                            }
-                            else
-                            {  // not service/ensemble or serviceGroups
-                                // this may happen for XML coming from binary encondig that does not support serviceProvider element
-                                // in this case services element has id attribute that is UEID
-                                // ETSI TS 102 371 V3.2.1 [4.17.1 DAB ensemble element encoding]
-                                if (element.hasAttribute("id"))
-                                {
-                                    qCDebug(metadataManager) << "Ensemble" << element.attribute("id") << servicesElement.tagName();
+            if (sidList.isEmpty())
+            {  // no valid DAB SId found
+                continue;
+            }
 
-                                    QString eidStr = element.attribute("id");
-                                    bool isEidValid = (eidStr.length() == 6);
-                                    if (isEidValid)
-                                    {
-                                        eidStr.toInt(&isEidValid, 16);
-                                    }
-                                    if (isEidValid && "mediaDescription" == servicesElement.tagName())
-                                    {
-                                        QDomNode mediaDescNode = servicesElement.firstChild();
-                                        while (!mediaDescNode.isNull())
-                                        {
-                                            QDomElement mediaDescElement = mediaDescNode.toElement();  // try to convert the node to an element
-                                            if (!mediaDescElement.isNull())
-                                            {
-                                                if ("multimedia" == mediaDescElement.tagName())
-                                                {  // Ensemble logos shall be provided using the mediaDescription/multimedia element
-                                                    QString type = mediaDescElement.attribute("type");
-                                                    QString url = mediaDescElement.attribute("url");
-                                                    QString width = mediaDescElement.attribute("width");
-                                                    QString height = mediaDescElement.attribute("height");
-                                                    QString ext = "png";
-                                                    if ("logo_colour_square" == type)
-                                                    {
-                                                        width = height = "32";
-                                                    }
-                                                    else if ("logo_colour_rectangle" == type)
-                                                    {
-                                                        width = "112";
-                                                        height = "32";
-                                                    }
-                                                    else
-                                                    {
-                                                        if (mediaDescElement.attribute("mimeValue") == "image/jpeg")
-                                                        {
-                                                            ext = "jpg";
-                                                        }
-                                                    }
-                                                    int widthVal = width.toInt();
-                                                    int heightVal = height.toInt();
-
-                                                    // only SLS size or logo size is accepted
-                                                    if (((widthVal == 320) && (heightVal == 240)) || ((widthVal == 32) && (heightVal == 32)))
-                                                    {
-                                                        // ask for logo
-                                                        QString filename = QString("%1/%2x%3.%4").arg(eidStr, width, height, ext);
-                                                        qCDebug(metadataManager) << url << "===>" << filename;
-
-                                                        emit getFile(decoderId, url, filename);
-                                                    }
-                                                }
-                                            }
-                                            mediaDescNode = mediaDescNode.nextSibling();
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                        servicesNode = servicesNode.nextSibling();
+            // Service logos shall be provided using the mediaDescription/multimedia element
+            for (const auto &logo : service.logos)
+            {
+                QString logoFile = logoFileName(logo);
+                if (!logoFile.isEmpty())
+                {
+                    for (const QString &sidStr : sidList)
+                    {  // ask for logo for each SId (actually there should be only one valid DAB SId)
+                        QString filename = QString("%1/%2").arg(sidStr, logoFile);
+                        qCDebug(metadataManager) << logo.url << "===>" << filename;
+
+                        emit getFile(decoderId, logo.url, filename);
                     }
                 }
-                else if ("serviceGroups" == element.tagName())
+            }
+
+            for (const QString &sidStr : sidList)
+            {  // insert in database
+                qCDebug(metadataManager) << sidStr << service.info;
+                m_info.insert(sidStr, service.info);
+            }
+        }
+
+        for (const auto &ensemble : metadata.ensembles)
+        {  // ETSI TS 102 371 V3.2.1 [4.17.1 DAB ensemble element encoding]
+            qCDebug(metadataManager) << "Ensemble" << ensemble.id;
+
+            bool isEidValid = (ensemble.id.length() == 6);
+            if (isEidValid)
+            {
+                ensemble.id.toInt(&isEidValid, 16);
+            }
+            if (isEidValid)
+            {  // Ensemble logos shall be provided using the mediaDescription/multimedia element
+                for (const auto &logo : ensemble.logos)
                 {
-                    qCDebug(metadataManager, "serviceGroups found");
-                }
-                else
-                {  // not service/ensemble or serviceGroups - this should not happen
-                    qCDebug(metadataManager) << element.tagName();
+                    QString logoFile = logoFileName(logo);
+                    if (!logoFile.isEmpty())
+                    {
+                        // ask for logo
+                        QString filename = QString("%1/%2").arg(ensemble.id, logoFile);
+                        qCDebug(metadataManager) << logo.url << "===>" << filename;
+
+                        emit getFile(decoderId, logo.url, filename);
+                    }
                 }
             }
-            node = node.nextSibling();
         }
     }
-    else if ("epg" == docElem.tagName())
+    else if ("epg" == metadata.root)
     {
-        // qCInfo(metadataManager) << "======================= EPG =========================>";
-        // qCInfo(metadataManager) << qPrintable(xmldocument.toString());
-        // qCInfo(metadataManager) << "<=====================================================";
-        QDomNode node = docElem.firstChild();
-        while (!node.isNull())
+        for (const auto &schedule : metadata.schedules)
         {
-            QDomElement element = node.toElement();  // try to convert the node to an element.
-            if (!element.isNull() && ("schedule" == element.tagName()))
+            QString scId = scopeId;
+            for (const QString &serviceScope : schedule.serviceScopes)
             {
-                QString scStart;
-                QString scId = scopeId;
-                if (!element.firstChildElement("scope").isNull())
-                {  // found scope element
-                    QDomElement scope = element.firstChildElement("scope");
-                    scStart = scope.attribute("startTime");
-                    QDomElement serviceScope = scope.firstChildElement("serviceScope");
-                    while (!serviceScope.isNull())
-                    {
-                        ServiceListId id = bearerToServiceId(serviceScope.attribute("id"));
-                        if (id.isValid())
-                        {  // found valid DAB service scope
-                            scId = serviceScope.attribute("id");
-                            break;
-                        }
-                        serviceScope = serviceScope.nextSiblingElement("serviceScope");
-                    }
+                ServiceListId id = bearerToServiceId(serviceScope);
+                if (id.isValid())
+                {  // found valid DAB service scope
+                    scId = serviceScope;
+                    break;
                 }
+            }
 
-                qCDebug(metadataManager) << "Service scope ID:" << scId;
-                if (!scId.isEmpty() && !scStart.isEmpty())
+            qCDebug(metadataManager) << "Service scope ID:" << scId;
+            if (!scId.isEmpty() && !schedule.scopeStart.isEmpty())
+            {
+                ServiceListId id = bearerToServiceId(scId);
+                if (id.isValid())
                 {
-                    ServiceListId id = bearerToServiceId(scId);
-                    if (id.isValid())
+                    QList<EPGModelItem *> itemList;
+                    for (const auto &programme : schedule.programmes)
                     {
-                        bool valid = false;
-                        QDomElement child = element.firstChildElement("programme");
-                        while (!child.isNull())
-                        {
-                            valid = parseProgramme(child, id) || valid;
-                            child = child.nextSiblingElement("programme");
-                        }
+                        itemList.append(parseProgramme(programme));
+                    }
 
-                        if (!m_isLoadingFromCache && valid)
-                        {  // save parsed file to the cache
-                            // "20140805_e1c221.0_PI.xml"
-                            QString filename = QString("%1/EPG/%2_%3.%4_PI.xml")
-                                                   .arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation),
-                                                        QDateTime::fromString(scStart, Qt::ISODate)
-                                                            .toUTC()
-                                                            .toOffsetFromUtc(EPGTime::getInstance()->ltoSec())
-                                                            .toString("yyyyMMdd"))
-                                                   .arg(id.sid(), 6, 16, QChar('0'))
-                                                   .arg(id.scids());
-
-                            QDir dir;
-                            dir.mkpath(QFileInfo(filename).absolutePath());
-                            QFile file(filename);
-                            if (!file.exists())
-                            {
-                                if (file.open(QIODevice::WriteOnly))
-                                {
-                                    QTextStream output(&file);
-                                    output << xml;
-                                    file.close();
-                                }
-                            }
-                            else
+                    // store is updated in worker thread from copy of items (model takes ownership of items)
+                    QDate scopeDate =
+                        QDateTime::fromString(schedule.scopeStart, Qt::ISODate).toUTC().toOffsetFromUtc(EPGTime::getInstance()->ltoSec()).date();
+                    QDate retentionDate = EPGTime::getInstance()->isValid() ? EPGTime::getInstance()->currentDate().addDays(-2) : QDate();
+                    QList<EPGModelItem> storeItems;
+                    storeItems.reserve(itemList.size());
+                    for (const auto &progItem : std::as_const(itemList))
+                    {
+                        storeItems.append(*progItem);
+                    }
+                    m_epgStoreWriter.start([this, id, scopeDate, storeItems, retentionDate]()
+                                           { m_epgStore.write(id, scopeDate, storeItems, retentionDate); });
+
+                    bool valid = addEpgItems(id, itemList);
+                    if (valid)
+                    {  // export parsed schedule to XML file
+                        // "20140805_e1c221.0_PI.xml"
+                        QString filename = QString("%1/EPG/%2_%3.%4_PI.xml")
+                                               .arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation), scopeDate.toString("yyyyMMdd"))
+                                               .arg(id.sid(), 6, 16, QChar('0'))
+                                               .arg(id.scids());
+
+                        QDir dir;
+                        dir.mkpath(QFileInfo(filename).absolutePath());
+                        QFile file(filename);
+                        if (!file.exists())
+                        {
+                            if (file.open(QIODevice::WriteOnly))
                             {
-                                // qDebug() << "!!!!!!!!!!!!!!!!!!!!!!!!! File EXISTS";
+                                file.write(scheduleToXml(schedule, scId));
+                                file.close();
                             }
                         }
+                        else
+                        { /* already in cache */
+                        }
                     }
                 }
             }
-            node = node.nextSibling();
         }
     }
     else
     {
-        qCInfo(metadataManager) << "=====================================================>";
-        qCInfo(metadataManager) << qPrintable(xmldocument.toString());
-        qCInfo(metadataManager) << "<=====================================================";
+        qCInfo(metadataManager) << "Unsupported SPI document:" << metadata.root;
     }
 }
 
-bool MetadataManager::parseProgramme(const QDomElement &element, const ServiceListId &id)
+QString MetadataManager::logoFileName(const SPIMetadata::Logo &logo) const
 {
-    bool ret = false;
-
-    // ETSI TS 102 818 V3.3.1 (2020-08) [7.8]
-    // The location element may appear zero or more times within a programme or programmeEvent element.
-    QList<EPGModelItem *> itemList;
-    int ltoSec = EPGTime::getInstance()->ltoSec();
-    QDomElement locationElement = element.firstChildElement("location");
-    while (!locationElement.isNull())
+    QString width = logo.width;
+    QString height = logo.height;
+    QString ext = "png";
+    if ("logo_colour_square" == logo.type)
+    {
+        width = height = "32";
+    }
+    else if ("logo_colour_rectangle" == logo.type)
     {
-        QDomElement timeElement = locationElement.firstChildElement("time");
-        while (!timeElement.isNull())
+        width = "112";
+        height = "32";
+    }
+    else
+    {
+        if (logo.mimeValue == "image/jpeg")
         {
-            EPGModelItem *progItem = new EPGModelItem;
-
-            QDateTime startTime = QDateTime::fromString(timeElement.attribute("time"), Qt::ISODate);
-            progItem->setStartTime(startTime.toUTC().toOffsetFromUtc(ltoSec));
-
-            // ETSI TS 102 818 V3.3.1 (2020-08) [5.2.5 duration type]
-            // Duration is based on the ISO 8601 [2] format: PTnHnMnS, where "T" represents the date/time separator,
-            // "nH" the number of hours, "nM" the number of minutes and "nS" the number of seconds.
-            static const QRegularExpression durationRe("^PT((\\d+)H)?((\\d+)M)?((\\d+)S)?");
-            QRegularExpressionMatch match = durationRe.match(timeElement.attribute("duration"));
-            int duration = 0;
-            if (match.hasMatch())
-            {
-                // hours
-                duration += 3600 * (match.captured(2).isEmpty() ? 0 : match.captured(2).toInt());
-                // minutes
-                duration += 60 * (match.captured(4).isEmpty() ? 0 : match.captured(4).toInt());
-                // seconds
-                duration += (match.captured(6).isEmpty() ? 0 : match.captured(6).toInt());
-
-                progItem->setDurationSec(duration);
-                progItem->setShortId(element.attribute("shortId").toInt());
-
-                itemList.append(progItem);
-            }
-            else
-            {  // duration not valid
-                delete progItem;
-            }
-
-            timeElement = timeElement.nextSiblingElement("time");
+            ext = "jpg";
         }
-        locationElement = locationElement.nextSiblingElement("location");
     }
+    int widthVal = width.toInt();
+    int heightVal = height.toInt();
 
-    QDomElement child = element.firstChildElement();
-    while (!child.isNull())
+    // only SLS size or logo size is accepted
+    if (((widthVal == 320) && (heightVal == 240)) || ((widthVal == 32) && (heightVal == 32)))
     {
-        if ("longName" == child.tagName())
-        {
-            for (auto &progItem : itemList)
-            {
-                progItem->setLongName(child.text());
-            }
-        }
-        else if ("mediumName" == child.tagName())
+        return QString("%1x%2.%3").arg(width, height, ext);
+    }
+    return QString();
+}
+
+QByteArray MetadataManager::scheduleToXml(const SPIMetadata::Schedule &schedule, const QString &scopeId) const
+{  // XML is created only for the data used by application
+    SPIXmlWriter writer;
+    auto writeTextElement = [&writer](const QString &name, const QString &text)
+    {
+        if (!text.isEmpty())
         {
-            for (auto &progItem : itemList)
-            {
-                progItem->setMediumName(child.text());
-            }
+            writer.startElement(name);
+            writer.text(text);
+            writer.endElement();
         }
-        else if ("shortName" == child.tagName())
+    };
+
+    writer.startElement("epg");
+    writer.startElement("schedule");
+    writer.startElement("scope");
+    writer.attribute("startTime", schedule.scopeStart);
+    writer.startElement("serviceScope");
+    writer.attribute("id", scopeId);
+    writer.endElement();
+    writer.endElement();
+    for (const auto &programme : schedule.programmes)
+    {
+        writer.startElement("programme");
+        writer.attribute("shortId", programme.shortId);
+        writeTextElement("shortName", programme.shortName);
+        writeTextElement("mediumName", programme.mediumName);
+        writeTextElement("longName", programme.longName);
+        writer.startElement("location");
+        for (const auto &time : programme.times)
         {
-            for (auto &progItem : itemList)
-            {
-                progItem->setShortName(child.text());
-            }
+            writer.startElement("time");
+            writer.attribute("time", time.first);
+            writer.attribute("duration", time.second);
+            writer.endElement();
         }
-        else if ("mediaDescription" == child.tagName())
+        writer.endElement();
+        if (!programme.shortDescription.isEmpty() || !programme.longDescription.isEmpty())
         {
-            for (auto &progItem : itemList)
-            {
-                parseDescription(child, progItem);
-            }
+            writer.startElement("mediaDescription");
+            writeTextElement("shortDescription", programme.shortDescription);
+            writeTextElement("longDescription", programme.longDescription);
+            writer.endElement();
         }
-
-        child = child.nextSiblingElement();
+        writer.endElement();
     }
+    writer.endElement();
+    writer.endElement();
 
-    if (!itemList.isEmpty())
+    return writer.toByteArray();
+}
+
+QList<EPGModelItem *> MetadataManager::parseProgramme(const SPIMetadata::Programme &programme) const
+{
+    // ETSI TS 102 818 V3.3.1 (2020-08) [7.8]
+    // The location element may appear zero or more times within a programme or programmeEvent element.
+    QList<EPGModelItem *> itemList;
+    int ltoSec = EPGTime::getInstance()->ltoSec();
+    for (const auto &time : programme.times)
     {
-        if (m_epgList.value(id, nullptr) == nullptr)
-        {
-            EPGModel *model = new EPGModel(this);
-            model->setServiceId(id);
-            m_epgList[id] = model;
-            emit epgModelChanged(id);
-            emit epgAvailable();
-        }
+        EPGModelItem *progItem = new EPGModelItem;
+
+        QDateTime startTime = QDateTime::fromString(time.first, Qt::ISODate);
+        progItem->setStartTime(startTime.toUTC().toOffsetFromUtc(ltoSec));
 
-        for (auto &progItem : itemList)
+        // ETSI TS 102 818 V3.3.1 (2020-08) [5.2.5 duration type]
+        // Duration is based on the ISO 8601 [2] format: PTnHnMnS, where "T" represents the date/time separator,
+        // "nH" the number of hours, "nM" the number of minutes and "nS" the number of seconds.
+        static const QRegularExpression durationRe("^PT((\\d+)H)?((\\d+)M)?((\\d+)S)?");
+        QRegularExpressionMatch match = durationRe.match(time.second);
+        int duration = 0;
+        if (match.hasMatch())
         {
-            if (progItem->startTime().date() < EPGTime::getInstance()->currentDate().addDays(7))
-            {
-                addEpgDate(progItem->startTime().date());
-                ret = m_epgList[id]->addItem(progItem) || ret;
-            }
-            else
-            {
-                delete progItem;
-            }
+            // hours
+            duration += 3600 * (match.captured(2).isEmpty() ? 0 : match.captured(2).toInt());
+            // minutes
+            duration += 60 * (match.captured(4).isEmpty() ? 0 : match.captured(4).toInt());
+            // seconds
+            duration += (match.captured(6).isEmpty() ? 0 : match.captured(6).toInt());
+
+            progItem->setDurationSec(duration);
+            progItem->setShortId(programme.shortId.toInt());
+            progItem->setLongName(programme.longName);
+            progItem->setMediumName(programme.mediumName);
+            progItem->setShortName(programme.shortName);
+            progItem->setShortDescription(QString(programme.shortDescription).replace(QChar('\\'), QChar()).trimmed());
+            progItem->setLongDescription(QString(programme.longDescription).replace(QChar('\\'), QChar()).trimmed());
+
+            itemList.append(progItem);
+        }
+        else
+        {  // duration not valid
+            delete progItem;
         }
     }
 
-    return ret;
+    return itemList;
 }
 
-void MetadataManager::parseDescription(const QDomElement &element, EPGModelItem *progItem)
-{
-    QDomElement child = element.firstChildElement();
-    while (!child.isNull())
+bool MetadataManager::addEpgItems(const ServiceListId &id, const QList<EPGModelItem *> &itemList)
+{  // whole schedule is added at once ==> one model update and one dates update per batch
+    if (itemList.isEmpty())
+    {
+        return false;
+    }
+
+    if (m_epgList.value(id, nullptr) == nullptr)
+    {
+        EPGModel *model = new EPGModel(this);
+        model->setServiceId(id);
+        m_epgList[id] = model;
+        emit epgModelChanged(id);
+        emit epgAvailable();
+    }
+
+    bool datesChanged = false;
+    QList<EPGModelItem *> newItems;
+    QDate maxDate = EPGTime::getInstance()->currentDate().addDays(7);
+    for (auto &progItem : itemList)
     {
-        if ("shortDescription" == child.tagName())
+        if (progItem->startTime().date() < maxDate)
         {
-            progItem->setShortDescription(child.text().replace(QChar('\\'), QChar()).trimmed());
+            datesChanged = addEpgDate(progItem->startTime().date()) || datesChanged;
+            newItems.append(progItem);
         }
-        else if ("longDescription" == child.tagName())
+        else
         {
-            progItem->setLongDescription(child.text().replace(QChar('\\'), QChar()).trimmed());
+            delete progItem;
         }
-
-        child = child.nextSiblingElement();
     }
+    if (datesChanged)
+    {
+        emit epgDatesListChanged();
+    }
+
+    return m_epgList[id]->addItems(newItems) > 0;
 }
 
 ServiceListId MetadataManager::bearerToServiceId(const QString &bearerUri) const
@@ -542,7 +440,7 @@ ServiceListId MetadataManager::bearerToServiceId(const QString &bearerUri) const
     return ServiceListId();
 }
 
-void MetadataManager::onFileReceived(const QByteArray &data, const QString &requestId)
+void MetadataManager::onFileReceived(const QByteArray &data, const QString &requestId, uint16_t decoderId)
 {
     if (data.size() == 0)
     {  // empty data, do nothing
@@ -556,100 +454,72 @@ void MetadataManager::onFileReceived(const QByteArray &data, const QString &requ
     // ensemble: "e24321/320x240.jpg"
     static const QRegularExpression re("([0-9a-f]{6})(\\.(\\d+))?(/[0-9a-f]{6})?/(\\d+x\\d+)\\..*", QRegularExpression::CaseInsensitiveOption);
 
+    // file in cache is compared using index, it is not read
+    QByteArray md5 = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    MetadataCacheIndex::Source source =
+        (SPI_APP_INVALID_DECODER_ID == decoderId) ? MetadataCacheIndex::Source::RadioDNS : MetadataCacheIndex::Source::SPI;
+    if (m_cacheIndex.isUnchanged(requestId, md5, data.size(), source))
+    { /* do nothing, file is the same */
+        qCDebug(metadataManager) << filename << "is the same";
+        return;
+    }
+
     QDir dir;
     dir.mkpath(QFileInfo(filename).absolutePath());
 
     QFile file(filename);
-    if (file.exists())
+    if (file.open(QIODevice::WriteOnly))
     {
-        QCryptographicHash md5gen(QCryptographicHash::Md5);
-        QFile file(filename);
-        if (file.open(QIODevice::ReadOnly))
-        {
-            md5gen.addData(file.readAll());
-            file.close();
-        }
-
-        QByteArray md5FileInCache = md5gen.result();
-        md5gen.reset();
-        md5gen.addData(data);
-        if (md5gen.result() != md5FileInCache)
-        {  // different file => overwrite
-            if (file.open(QIODevice::WriteOnly))
-            {
-                file.write(data);
-                file.close();
-            }
+        file.write(data);
+        file.close();
+        m_cacheIndex.insert(requestId, md5, data.size(), source);
+    }
 
-            QRegularExpressionMatch match = re.match(requestId);
-            if (match.hasMatch())
+    QRegularExpressionMatch match = re.match(requestId);
+    if (match.hasMatch())
+    {
+        invalidatePixmaps(match.captured(1) + match.captured(2));
+        if (match.captured(2).isEmpty())
+        {  // ensemble
+            uint32_t ueid = match.captured(1).toUInt(nullptr, 16);
+            QString size = match.captured(5);
+            MetadataRole role = MetadataRole::SLSLogo;
+            if (size == "32x32")
             {
-                if (match.captured(2).isEmpty())
-                {  // ensemble
-                    uint32_t ueid = match.captured(1).toUInt(nullptr, 16);
-                    QString size = match.captured(5);
-                    MetadataRole role = MetadataRole::SLSLogo;
-                    if (size == "32x32")
-                    {
-                        role = MetadataRole::SmallLogo;
-                    }
-                    emit dataUpdated(ServiceListId(174928, ueid), role);  // using some frequency (5A)
-                }
-                else
-                {
-                    uint32_t sid = match.captured(1).toUInt(nullptr, 16);
-                    uint8_t scids = match.captured(3).toUInt();
-                    QString size = match.captured(5);
-                    MetadataRole role = MetadataRole::SLSLogo;
-                    if (size == "32x32")
-                    {
-                        role = MetadataRole::SmallLogo;
-                    }
-                    emit dataUpdated(ServiceListId(sid, scids), role);
-                }
+                role = MetadataRole::SmallLogo;
             }
+            emit dataUpdated(ServiceListId(174928, ueid), role);  // using some frequency (5A)
         }
         else
-        { /* do nothing, file is the same */
-            qCDebug(metadataManager) << filename << "is the same";
-        }
-    }
-    else
-    {
-        if (file.open(QIODevice::WriteOnly))
         {
-            file.write(data);
-            file.close();
-        }
-
-        QRegularExpressionMatch match = re.match(requestId);
-        if (match.hasMatch())
-        {
-            if (match.captured(2).isEmpty())
-            {  // ensemble
-                uint32_t ueid = match.captured(1).toUInt(nullptr, 16);
-                QString size = match.captured(5);
-                MetadataRole role = MetadataRole::SLSLogo;
-                if (size == "32x32")
-                {
-                    role = MetadataRole::SmallLogo;
-                }
-                emit dataUpdated(ServiceListId(174928, ueid), role);  // using some frequency (5A)
-            }
-            else
+            uint32_t sid = match.captured(1).toUInt(nullptr, 16);
+            uint8_t scids = match.captured(3).toUInt();
+            QString size = match.captured(5);
+            MetadataRole role = MetadataRole::SLSLogo;
+            if (size == "32x32")
             {
-                uint32_t sid = match.captured(1).toUInt(nullptr, 16);
-                uint8_t scids = match.captured(3).toUInt();
-                QString size = match.captured(5);
-                MetadataRole role = MetadataRole::SLSLogo;
-                if (size == "32x32")
-                {
-                    role = MetadataRole::SmallLogo;
-                }
-                emit dataUpdated(ServiceListId(sid, scids), role);
+                role = MetadataRole::SmallLogo;
             }
+            emit dataUpdated(ServiceListId(sid, scids), role);
         }
     }
+
+    collectCacheGarbage();
+}
+
+void MetadataManager::setCacheLimits(int maxAgeDays, int diskBudgetMB)
+{
+    m_cacheIndex.setLimits(maxAgeDays, diskBudgetMB);
+    collectCacheGarbage();
+}
+
+void MetadataManager::collectCacheGarbage()
+{
+    const QStringList removed = m_cacheIndex.collectGarbage();
+    for (const QString &path : removed)
+    {  // removed logo must not be shown anymore
+        invalidatePixmaps(path.section('/', 0, 0));
+    }
 }
 
 QVariant MetadataManager::data(uint32_t ueid, uint32_t sid, uint8_t SCIdS, MetadataRole role) const
@@ -687,51 +557,16 @@ QVariant MetadataManager::data(const ServiceListId &ensId, const ServiceListId &
                 h = 240;
             }
 
-            QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + baseDir);
-            if (dir.exists())
-            {
-                QString filename =
-                    QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + baseDir + subDir + QString("/%1x%2.").arg(w).arg(h);
-                if (QFileInfo::exists(filename + "png"))
-                {
-                    QPixmap pixmap;
-                    pixmap.load(filename + "png");
-                    if (pixmap.width() <= w && pixmap.height() <= h)
-                    {
-                        return QVariant(pixmap);
-                    }
-                    return QVariant();
-                }
-                else if (QFileInfo::exists(filename + "jpg"))
-                {
-                    QPixmap pixmap;
-                    pixmap.load(filename + "jpg");
-                    if (pixmap.width() <= w && pixmap.height() <= h)
-                    {
-                        return QVariant(pixmap);
-                    }
-                    return QVariant();
-                }
-                else  // neither png nor jpg exists
-                {     // fallback for service -> going through subdirs and looking for files with correct name
-                    if (servId.isValid())
-                    {  // iterate through subdirs and find file with correct name
-                        QDirIterator it(dir.absolutePath(), QStringList() << QString("%1x%2.png").arg(w).arg(h) << QString("%1x%2.jpg").arg(w).arg(h),
-                                        QDir::Files, QDirIterator::Subdirectories);
-                        while (it.hasNext())
-                        {
-                            QString filePath = it.next();
-                            QPixmap pixmap;
-                            pixmap.load(filePath);
-                            if (pixmap.width() <= w && pixmap.height() <= h)
-                            {
-                                return QVariant(pixmap);
-                            }
-                        }
-                    }
-                }
+            // key has the same format as file request ID without extension: "e21234.0/e22139/320x240"
+            QString key = baseDir + subDir + QString("/%1x%2").arg(w).arg(h);
+            const QPixmap *cached = m_pixmapCache.object(key);
+            if (nullptr == cached)
+            {  // not in cache (or evicted) ==> look for the file
+                QPixmap pixmap = loadLogo(baseDir, subDir, w, h, servId.isValid());
+                insertPixmap(key, pixmap);
+                return pixmap.isNull() ? QVariant() : QVariant(pixmap);
             }
-            return QVariant();
+            return cached->isNull() ? QVariant() : QVariant(*cached);
         }
         break;
         case CountryFlag:
@@ -750,15 +585,23 @@ QVariant MetadataManager::data(const ServiceListId &ensId, const ServiceListId &
                 return QVariant();
             }
 
+            QString key = QString("flags/%1").arg(countryCode);
+            const QPixmap *cached = m_pixmapCache.object(key);
+            if (nullptr != cached)
+            {  // flag that is not available is not downloaded again until it is evicted from cache
+                return cached->isNull() ? QVariant() : QVariant(*cached);
+            }
+
             QString filename = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/flags/" + QString("%1.png").arg(countryCode);
             if (QFileInfo::exists(filename))
             {
-                QPixmap pixmap;
-                pixmap.load(filename);
+                QPixmap pixmap = loadPixmap(filename);
+                insertPixmap(key, pixmap);
                 return QVariant(pixmap);
             }
             else
             {  // download flag
+                insertPixmap(key, QPixmap());
                 if (!countryCode.isEmpty())
                 {
                     QNetworkAccessManager *manager = new QNetworkAccessManager();
@@ -775,6 +618,7 @@ QVariant MetadataManager::data(const ServiceListId &ensId, const ServiceListId &
                                     {
                                         file.write(reply->readAll());
                                         file.close();
+                                        m_pixmapCache.remove(key);
                                         emit dataUpdated(servId, MetadataManager::CountryFlag);
                                     }
                                 }
@@ -795,6 +639,69 @@ QVariant MetadataManager::data(const ServiceListId &ensId, const ServiceListId &
     return QVariant();
 }
 
+QPixmap MetadataManager::loadLogo(const QString &baseDir, const QString &subDir, int w, int h, bool isService) const
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + baseDir);
+    if (dir.exists())
+    {
+        QString filename = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/" + baseDir + subDir + QString("/%1x%2.").arg(w).arg(h);
+        if (QFileInfo::exists(filename + "png"))
+        {
+            QPixmap pixmap = loadPixmap(filename + "png");
+            if (pixmap.width() <= w && pixmap.height() <= h)
+            {
+                return pixmap;
+            }
+            return QPixmap();
+        }
+        else if (QFileInfo::exists(filename + "jpg"))
+        {
+            QPixmap pixmap = loadPixmap(filename + "jpg");
+            if (pixmap.width() <= w && pixmap.height() <= h)
+            {
+                return pixmap;
+            }
+            return QPixmap();
+        }
+        else  // neither png nor jpg exists
+        {     // fallback for service -> going through subdirs and looking for files with correct name
+            if (isService)
+            {  // iterate through subdirs and find file with correct name
+                QDirIterator it(dir.absolutePath(), QStringList() << QString("%1x%2.png").arg(w).arg(h) << QString("%1x%2.jpg").arg(w).arg(h),
+                                QDir::Files, QDirIterator::Subdirectories);
+                while (it.hasNext())
+                {
+                    QString filePath = it.next();
+                    QPixmap pixmap = loadPixmap(filePath);
+                    if (pixmap.width() <= w && pixmap.height() <= h)
+                    {
+                        return pixmap;
+                    }
+                }
+            }
+        }
+    }
+    return QPixmap();
+}
+
+void MetadataManager::insertPixmap(const QString &key, const QPixmap &pixmap) const
+{  // null pixmap is stored as well, it means that the file is not available
+    qsizetype cost = qMax(qsizetype(1), qsizetype(pixmap.width()) * pixmap.height() * pixmap.depth() / 8);
+    m_pixmapCache.insert(key, new QPixmap(pixmap), cost);
+}
+
+void MetadataManager::invalidatePixmaps(const QString &baseDir)
+{  // all logos of the service or ensemble are removed, logo of the service could be used as fallback for another ensemble
+    const QList<QString> keys = m_pixmapCache.keys();
+    for (const QString &key : keys)
+    {
+        if (key.startsWith(baseDir + "/"))
+        {
+            m_pixmapCache.remove(key);
+        }
+    }
+}
+
 EPGModel *MetadataManager::epgModel(const ServiceListId &id) const
 {
     return m_epgList.value(id, nullptr);
@@ -809,41 +716,49 @@ void MetadataManager::loadEpg(const ServiceListId &servId, const QList<uint32_t>
 {
     if (EPGTime::getInstance()->isValid() && servId.isValid())
     {
-        m_isLoadingFromCache = true;
-
-        QDir directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/EPG/");
         QDate currentDate = EPGTime::getInstance()->currentDate();
-        for (int day = -2; day < +7; ++day)
-        {
-            QDate date = currentDate.addDays(day);
-            QString xmlFileName = QString("%1_%2.%3_PI.xml").arg(date.toString("yyyyMMdd")).arg(servId.sid(), 6, 16, QChar('0')).arg(servId.scids());
-            if (directory.exists(xmlFileName))
+        std::shared_ptr<const EPGStore::Service> store = m_epgStore.service(servId);
+        if (nullptr != store)
+        {  // only day index and start times are read here, programmes are loaded when they are displayed
+            int count = 0;
+            int first = store->recordRange(currentDate.addDays(-2), currentDate.addDays(7), &count);
+            if (count > 0)
             {
-                QFile xmlfile(directory.absolutePath() + "/" + xmlFileName);
-                qCDebug(metadataManager) << "Loading:" << xmlfile.fileName();
-                if (xmlfile.open(QIODevice::ReadOnly | QIODevice::Text))
+                qCDebug(metadataManager) << "Loading" << count << "programmes of service" << Qt::hex << servId.sid() << "from EPG store";
+                if (m_epgList.value(servId, nullptr) == nullptr)
+                {
+                    EPGModel *model = new EPGModel(this);
+                    model->setServiceId(servId);
+                    m_epgList[servId] = model;
+                    emit epgModelChanged(servId);
+                    emit epgAvailable();
+                }
+
+                bool datesChanged = false;
+                for (const QDate &date : store->dates(currentDate.addDays(-2), currentDate.addDays(7)))
+                {
+                    datesChanged = addEpgDate(date) || datesChanged;
+                }
+                if (datesChanged)
                 {
-                    DabSId dabSid(servId.sid());
-                    QString scopeId = QString("dab:%1.%2.%3.0")
-                                          .arg(dabSid.gcc(), 3, 16, QChar('0'))
-                                          .arg(uint16_t(ueidList.at(0)), 4, 16, QChar('0'))
-                                          .arg(dabSid.progSId(), 4, 16, QChar('0'));
-                    QTextStream in(&xmlfile);
-                    processXML(in.readAll(), scopeId, SPI_APP_INVALID_DECODER_ID);
-                    xmlfile.close();
+                    emit epgDatesListChanged();
                 }
+
+                m_epgList[servId]->addStoreItems(store, first, count);
             }
-            else
+        }
+
+        if (currentDate >= QDateTime::currentDateTime().date().addDays(-5))
+        {  // this is to avoid downloading PI for recordings
+            for (int day = -2; day < +7; ++day)
             {
-                if (currentDate >= QDateTime::currentDateTime().date().addDays(-5))
-                {  // this is to avoid downloading PI for recordings
-                    QDate date = currentDate.addDays(day);
+                QDate date = currentDate.addDays(day);
+                if ((nullptr == store) || !store->hasSchedule(date))
+                {
                     emit getPI(servId, ueidList, date);
                 }
             }
         }
-
-        m_isLoadingFromCache = false;
     }
     else
     { /* do nothing */
@@ -930,13 +845,14 @@ void MetadataManager::clearEpg()
     emit epgDatesListChanged();
 }
 
-void MetadataManager::addEpgDate(const QDate &date)
+bool MetadataManager::addEpgDate(const QDate &date)
 {
     if (date.isValid() && !m_epgDates.contains(date))
     {
         m_epgDates[date] = date.toString("d. M.");
-        emit epgDatesListChanged();
+        return true;
     }
+    return false;
 }
 
 QDate MetadataManager::epgDate(int idx) const
@@ -27,13 +27,18 @@
 #ifndef METADATAMANAGER_H
 #define METADATAMANAGER_H
 
-#include <QDomDocument>
+#include <QCache>
 #include <QHash>
 #include <QObject>
 #include <QPixmap>
+#include <QThreadPool>
 
 #include "epgmodel.h"
+#include "metadatacacheindex.h"
 #include "servicelist.h"
+#include "spimetadata.h"
+
+#define METADATAMANAGER_PIXMAP_CACHE_BUDGET (16)  // [MB] logos and flags kept in memory
 
 typedef QHash<QString, QString> serviceInfo_t;
 
@@ -56,7 +61,8 @@ public:
     explicit MetadataManager(const ServiceList *serviceList, QObject *parent = nullptr);
     ~MetadataManager();
     void processXML(const QString &xmldocument, const QString &scopeId, uint16_t decoderId);
-    void onFileReceived(const QByteArray &data, const QString &requestId);
+    void processMetadata(const SPIMetadata &metadata, const QString &scopeId, uint16_t decoderId);
+    void onFileReceived(const QByteArray &data, const QString &requestId, uint16_t decoderId);
     QVariant data(uint32_t ueid, uint32_t sid, uint8_t SCIdS, MetadataManager::MetadataRole role) const;
     QVariant data(const ServiceListId &endId, const ServiceListId &id, MetadataManager::MetadataRole role) const;
 
@@ -73,6 +79,7 @@ public:
     void addServiceEpg(const ServiceListId &ensId, const ServiceListId &servId);
     void removeServiceEpg(const ServiceListId &servId);
     void clearEpg();
+    void setCacheLimits(int maxAgeDays, int diskBudgetMB);  // 0 = no limit
 
 signals:
     void getFile(uint16_t decoderId, const QString &url, const QString &requestId);
@@ -86,20 +93,29 @@ signals:
 
 private:
     const ServiceList *m_serviceList;
-    bool m_isLoadingFromCache;
     bool m_cleanEpgCache;
     QMap<QDate, QString> m_epgDates;
     QHash<QString, serviceInfo_t> m_info;
     QHash<ServiceListId, EPGModel *> m_epgList;
     ServiceListId m_currentEnsemble;
-
-    bool parseProgramme(const QDomElement &element, const ServiceListId &id);
-    void parseDescription(const QDomElement &element, EPGModelItem *progItem);
+    EPGStore m_epgStore;
+    QThreadPool m_epgStoreWriter;  // store files are written in one worker thread, not to block GUI
+    MetadataCacheIndex m_cacheIndex;
+    mutable QCache<QString, QPixmap> m_pixmapCache;  // logos and flags, cost is size in bytes, null pixmap = file not available
+
+    QList<EPGModelItem *> parseProgramme(const SPIMetadata::Programme &programme) const;
+    bool addEpgItems(const ServiceListId &id, const QList<EPGModelItem *> &itemList);
+    QString logoFileName(const SPIMetadata::Logo &logo) const;
+    QPixmap loadLogo(const QString &baseDir, const QString &subDir, int w, int h, bool isService) const;
+    void insertPixmap(const QString &key, const QPixmap &pixmap) const;
+    void invalidatePixmaps(const QString &baseDir);
+    void collectCacheGarbage();
+    QByteArray scheduleToXml(const SPIMetadata::Schedule &schedule, const QString &scopeId) const;
 
     ServiceListId bearerToServiceId(const QString &bearerUri) const;
 
     void loadEpg(const ServiceListId &servId, const QList<uint32_t> &ueidList);
-    void addEpgDate(const QDate &date);
+    bool addEpgDate(const QDate &date);
 };
 
 #endif  // METADATAMANAGER_H
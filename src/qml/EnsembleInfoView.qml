@@ -287,13 +287,88 @@ UndockablePage {
                             }
                         }
                     }
+                    Rectangle {
+                        id: latencyBox
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: latencyBoxLayout.implicitHeight + 2 * UI.standardMargin
+
+                        color: "transparent"
+                        border.width: 1
+                        border.color: UI.colors.inactive
+                        radius: UI.controlRadius
+
+                        ColumnLayout {
+                            id: latencyBoxLayout
+                            x: UI.standardMargin
+                            y: UI.standardMargin
+                            width: latencyBox.width - 2 * UI.standardMargin
+                            Repeater {
+                                model: EnsembleInfoModel {
+                                    group: 7
+                                    sourceModel: ensembleInfo
+                                }
+                                delegate: RowLayout {
+                                    required property string label
+                                    required property string info
+                                    AbracaLabel {
+                                        text: label
+                                        elide: Text.ElideMiddle
+                                        role: UI.LabelRole.Secondary
+                                    }
+                                    AbracaLabel {
+                                        text: info
+                                        Layout.fillWidth: true
+                                        horizontalAlignment: Text.AlignRight
+                                    }
+                                }
+                            }
+                        }
+                        MouseArea {
+                            anchors.fill: parent
+                            acceptedButtons: Qt.LeftButton | Qt.RightButton
+                            onClicked: (mouse)=> {
+                                if (mouse.button === Qt.RightButton) {
+                                    latencyContextMenu.x = mouse.x;
+                                    latencyContextMenu.y = mouse.y;
+                                    latencyContextMenu.open();
+                                }
+                            }
+                            onPressAndHold: (mouse) => {
+                                latencyContextMenu.x = mouse.x;
+                                latencyContextMenu.y = mouse.y;
+                                latencyContextMenu.open();
+                            }
+                        }
+                        AbracaMenu {
+                            id: latencyContextMenu
+                            AbracaMenuItem {
+                                text: qsTr("Reset latency statistics")
+                                onTriggered: {
+                                    ensembleInfo.resetLatencyStats()
+                                }
+                            }
+                            AbracaMenuSeparator {}
+                            AbracaMenuItem {
+                                text: qsTr("Export latency trace")
+                                onTriggered: {
+                                    ensembleInfo.exportLatencyTrace()
+                                }
+                            }
+                            AbracaMenuItem {
+                                text: ensembleInfo.isServiceStreamRecording ? qsTr("Stop service stream recording") : qsTr("Start service stream recording")
+                                onTriggered: {
+                                    ensembleInfo.startStopServiceStreamRecording()
+                                }
+                            }
+                        }
+                    }
 
                     Item {
                         id: ensTextItem
                         Layout.fillWidth: true
                         Layout.fillHeight: true
-                        Layout.preferredHeight: controlRow.visible ? (contentItem.height - infoGrid.height - subchView.height - subchGrid.height - 4 * colLayout.spacing - 3 * UI.standardMargin - controlRow.height)
-                                                                   : (contentItem.height - infoGrid.height - subchView.height - subchGrid.height - 4 * colLayout.spacing - 3 * UI.standardMargin - controlGridEnsTextVisible.implicitHeight)
+                        Layout.preferredHeight: controlRow.visible ? (contentItem.height - infoGrid.height - subchView.height - subchGrid.height - latencyBox.height - 5 * colLayout.spacing - 3 * UI.standardMargin - controlRow.height)
+                                                                   : (contentItem.height - infoGrid.height - subchView.height - subchGrid.height - latencyBox.height - 5 * colLayout.spacing - 3 * UI.standardMargin - controlGridEnsTextVisible.implicitHeight)
                         Layout.minimumHeight: 150
                         visible: controlRow.visible || (Layout.preferredHeight > 150 && contentItem.width > contentItem.controlGridMinWidth)
                         onVisibleChanged: Qt.callLater(contentItem.setFittingLayout)
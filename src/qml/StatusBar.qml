@@ -72,6 +72,37 @@ Rectangle {
             Layout.preferredHeight: 22
         }
 
+        RowLayout {
+            id: timeShiftControl
+            visible: appUI.isTimeShiftEnabled && appUI.isServiceSelected
+            spacing: 2
+            AbracaLabel {
+                visible: appUI.isTimeShiftLive === false
+                text: appUI.timeShiftLabel
+                toolTipText: qsTr("Playback delay behind live broadcast")
+            }
+            AbracaImgButton {
+                source: UI.imagesUrl + "chevron-left.svg"
+                toolTipText: qsTr("Rewind")
+                onClicked: application.timeShiftSkip(false)
+            }
+            AbracaImgButton {
+                source: appUI.isTimeShiftPaused ? UI.imagesUrl + "icon-play.svg" : UI.imagesUrl + "icon-pause.svg"
+                toolTipText: appUI.isTimeShiftPaused ? qsTr("Resume playback") : qsTr("Pause playback")
+                onClicked: application.timeShiftPauseToggle()
+            }
+            AbracaImgButton {
+                enabled: appUI.isTimeShiftLive === false
+                source: UI.imagesUrl + "chevron-right.svg"
+                toolTipText: qsTr("Forward")
+                onClicked: application.timeShiftSkip(true)
+            }
+            AbracaButton {
+                visible: appUI.isTimeShiftLive === false
+                text: qsTr("Live")
+                onClicked: application.timeShiftJumpToLive()
+            }
+        }
         RowLayout {
             id: volumeControl
             visible: UI.isDesktop === true
@@ -64,7 +64,6 @@ Item {
                     AbracaGroupBox {
                         title: qsTr("Audio decoder")
                         Layout.fillWidth: true
-                        visible: settingsBackend.audioDecoderModel.currentIndex === 0  // FAAD2
                         RowLayout {
                             AbracaLabel {
                                 text: qsTr("Noise level during audio drop-out:")
@@ -97,7 +96,55 @@ Item {
                         isVertical: false
                         Layout.topMargin: UI.standardMargin
                         Layout.bottomMargin: 2*UI.standardMargin
-                        visible: settingsBackend.audioDecoderModel.currentIndex === 0  // FAAD2
+                    }
+                    AbracaGroupBox {
+                        id: timeShiftGroupBox
+                        title: qsTr("Time shift")
+                        Layout.fillWidth: true
+                        Item {
+                            width: timeShiftGroupBox.width
+                            implicitHeight: timeShiftLayout.implicitHeight
+                            GridLayout {
+                                id: timeShiftLayout
+                                anchors.fill: parent
+                                columns: 2
+                                AbracaLabel {
+                                    text: qsTr("Buffer length:")
+                                }
+                                AbracaComboBox {
+                                    model: settingsBackend.timeShiftLengthModel
+                                    textRole: "itemName"
+                                    currentIndex: settingsBackend.timeShiftLengthModel.currentIndex
+                                    onActivated: {
+                                        if (settingsBackend.timeShiftLengthModel.currentIndex !== currentIndex) {
+                                            settingsBackend.timeShiftLengthModel.currentIndex = currentIndex;
+                                        }
+                                    }
+                                }
+                                AbracaLabel {
+                                    text: qsTr("Memory (older data is stored in temporary file):")
+                                    wrapMode: Text.WordWrap
+                                    Layout.fillWidth: true
+                                }
+                                AbracaComboBox {
+                                    enabled: settingsBackend.timeShiftLengthModel.currentIndex > 0
+                                    model: settingsBackend.timeShiftMemoryModel
+                                    textRole: "itemName"
+                                    currentIndex: settingsBackend.timeShiftMemoryModel.currentIndex
+                                    onActivated: {
+                                        if (settingsBackend.timeShiftMemoryModel.currentIndex !== currentIndex) {
+                                            settingsBackend.timeShiftMemoryModel.currentIndex = currentIndex;
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    AbracaLine {
+                        Layout.fillWidth: true
+                        isVertical: false
+                        Layout.topMargin: UI.standardMargin
+                        Layout.bottomMargin: 2*UI.standardMargin
                     }
                     AbracaGroupBox {
                         id: recGroupBox
@@ -142,7 +189,7 @@ Item {
                                     AbracaRadioButton {
                                         anchors.left: captureOutputColumn.left
                                         anchors.right: captureOutputColumn.right
-                                        text: qsTr("Record decoded audio (WAV format)")
+                                        text: settingsBackend.haveFlac ? qsTr("Record decoded audio (WAV or FLAC format)") : qsTr("Record decoded audio (WAV format)")
                                         wrapMode: Text.WordWrap
                                         elideMode: Text.ElideNone
                                         checked: settingsBackend.audioRecCaptureOutput === true
@@ -153,6 +200,25 @@ Item {
                                         }
                                     }
                                 }
+                                RowLayout {
+                                    Layout.fillWidth: true
+                                    spacing: UI.standardMargin
+                                    visible: settingsBackend.haveFlac
+                                    enabled: settingsBackend.audioRecCaptureOutput
+                                    AbracaLabel {
+                                        text: qsTr("Decoded audio format:")
+                                    }
+                                    AbracaComboBox {
+                                        model: settingsBackend.audioRecFormatModel
+                                        textRole: "itemName"
+                                        currentIndex: settingsBackend.audioRecFormatModel.currentIndex
+                                        onActivated: {
+                                            if (settingsBackend.audioRecFormatModel.currentIndex !== currentIndex) {
+                                                settingsBackend.audioRecFormatModel.currentIndex = currentIndex;
+                                            }
+                                        }
+                                    }
+                                }
                                 AbracaSwitch {
                                     id: autoStopSwitch
                                     Layout.fillWidth: true
@@ -286,6 +352,43 @@ Item {
                                     wrapMode: Text.WordWrap
                                     visible: settingsBackend.audioOutputChanged
                                 }
+                                AbracaLabel {
+                                    text: qsTr("Audio latency profile:")
+                                }
+                                AbracaComboBox {
+                                    model: settingsBackend.audioLatencyModel
+                                    textRole: "itemName"
+                                    currentIndex: settingsBackend.audioLatencyModel.currentIndex
+                                    onActivated: {
+                                        if (settingsBackend.audioLatencyModel.currentIndex !== currentIndex) {
+                                            settingsBackend.audioLatencyModel.currentIndex = currentIndex;
+                                        }
+                                    }
+                                    property int w: -1
+                                    Layout.preferredWidth: w > 0 ? w : implicitWidth
+                                    onImplicitWidthChanged: {
+                                        if (implicitWidth > w) {
+                                            w = implicitWidth
+                                        }
+                                    }
+                                }
+                                AbracaButton {
+                                    text: qsTr("Restart")
+                                    visible: settingsBackend.audioLatencyChanged
+                                    onClicked: settingsBackend.requestRestart()
+                                }
+                                Item {
+                                    Layout.columnSpan: settingsBackend.audioLatencyChanged ? 1 : 2
+                                    Layout.fillWidth: true
+                                }
+                                AbracaLabel {
+                                    Layout.columnSpan: 4
+                                    Layout.fillWidth: true
+                                    text: qsTr("Audio latency profile change will take effect after application restart.")
+                                    color: "red"
+                                    wrapMode: Text.WordWrap
+                                    visible: settingsBackend.audioLatencyChanged
+                                }
                                 Item {
                                     Layout.columnSpan: 4
                                     Layout.fillWidth: true
@@ -35,6 +35,8 @@
 #include <QTime>
 
 #include "inputdevice.h"
+#include "latencytracer.h"
+#include "threadplacement.h"
 
 // Q_LOGGING_CATEGORY(radioControl, "RadioControl", QtWarningMsg)
 Q_LOGGING_CATEGORY(radioControl, "RadioControl", QtInfoMsg)
@@ -75,6 +77,7 @@ RadioControl::~RadioControl()
 
     // this cancels dabsdr thread
     dabsdrDeinit(&m_dabsdrHandle);
+    ThreadPlacement::getInstance()->unregisterThread(ThreadPlacement::DabProcessing);
 }
 
 // returns false if not successfull
@@ -2529,8 +2532,8 @@ void RadioControl::dataGroupCb(dabsdrDataGroupCBData_t *p, void *ctx)
     pData->userAppType = DabUserApplicationType(p->userAppType);
     pData->id = p->id;
     pData->SCId = p->SCId;
-    // copy data to QByteArray
-    pData->data = QByteArray((const char *)p->pDgData, p->dgLen);
+    // copy data to pooled buffer, decoders parse it without further copies
+    pData->data = radioCtrl->m_dataGroupPool.acquire(p->pDgData, p->dgLen);
 
     RadioControlEvent *pEvent = new RadioControlEvent;
     pEvent->type = RadioControlEventType::USERAPP_DATA;
@@ -2539,23 +2542,33 @@ void RadioControl::dataGroupCb(dabsdrDataGroupCBData_t *p, void *ctx)
     radioCtrl->emit_dabEvent(pEvent);
 }
 
+static RadioControlAudioData *newAudioData(dabsdrAudioCBData_t *p, bool onAir)
+{
+    RadioControlAudioData *pAudioData = new RadioControlAudioData;
+    pAudioData->id = p->id;
+    pAudioData->ASCTy = static_cast<DabAudioDataSCty>(p->ASCTy);
+    pAudioData->header = p->header;
+    pAudioData->data.assign(p->pAuData, p->pAuData + p->auLen);
+    pAudioData->timestampNs = LatencyTracer::timestamp();
+    pAudioData->onAir = onAir;
+    return pAudioData;
+}
+
 void RadioControl::audioDataCb(dabsdrAudioCBData_t *p, void *ctx)
 {
     RadioControl *radioCtrl = static_cast<RadioControl *>(ctx);
 
+    LatencyTracer::getInstance()->audioFrameReceived();
+
+    // during announcement on other service both primary and secondary audio is passed to decoder
+    // decoder keeps both streams decoded and switches between them without reinitialization
     switch (radioCtrl->m_currentService.announcement.switchState)
     {
         case AnnouncementSwitchState::NoAnnouncement:
         {  // no ennouncement ongoing
             if (DABSDR_ID_AUDIO_PRIMARY == p->id)
             {
-                RadioControlAudioData *pAudioData = new RadioControlAudioData;
-                pAudioData->id = p->id;
-                pAudioData->ASCTy = static_cast<DabAudioDataSCty>(p->ASCTy);
-                pAudioData->header = p->header;
-                pAudioData->data.assign(p->pAuData, p->pAuData + p->auLen);
-
-                radioCtrl->emit_audioData(pAudioData);
+                radioCtrl->emit_audioData(newAudioData(p, true));
             }
             else
             {
@@ -2564,14 +2577,8 @@ void RadioControl::audioDataCb(dabsdrAudioCBData_t *p, void *ctx)
         }
         break;
         case AnnouncementSwitchState::WaitForAnnouncement:
-        {  // announcement expected
-            RadioControlAudioData *pAudioData = new RadioControlAudioData;
-            pAudioData->id = p->id;
-            pAudioData->ASCTy = static_cast<DabAudioDataSCty>(p->ASCTy);
-            pAudioData->header = p->header;
-            pAudioData->data.assign(p->pAuData, p->pAuData + p->auLen);
-
-            radioCtrl->emit_audioData(pAudioData);
+        {  // announcement expected, secondary decoder is warming up
+            radioCtrl->emit_audioData(newAudioData(p, DABSDR_ID_AUDIO_PRIMARY == p->id));
             if (DABSDR_ID_AUDIO_SECONDARY == p->id)
             {  // first announcement data increment value
                 radioCtrl->emit_announcementAudioAvailable();
@@ -2582,21 +2589,8 @@ void RadioControl::audioDataCb(dabsdrAudioCBData_t *p, void *ctx)
         }
         break;
         default:
-        {  //
-            if (DABSDR_ID_AUDIO_SECONDARY == p->id)
-            {
-                RadioControlAudioData *pAudioData = new RadioControlAudioData;
-                pAudioData->id = p->id;
-                pAudioData->ASCTy = static_cast<DabAudioDataSCty>(p->ASCTy);
-                pAudioData->header = p->header;
-                pAudioData->data.assign(p->pAuData, p->pAuData + p->auLen);
-
-                radioCtrl->emit_audioData(pAudioData);
-            }
-            else
-            {
-                // qCDebug(radioControl) << "Ignoring non-announcement audio data";
-            }
+        {  // announcement ongoing, primary decoder is kept in standby
+            radioCtrl->emit_audioData(newAudioData(p, DABSDR_ID_AUDIO_SECONDARY == p->id));
         }
     }
 }
@@ -38,6 +38,7 @@
 
 #include "dabsdr.h"
 #include "dabtables.h"
+#include "datagrouppool.h"
 
 #define RADIO_CONTROL_UEID_INVALID 0xFF000000
 #define RADIO_CONTROL_NOTIFICATION_PERIOD 3  // 2^3 = 8 DAB frames = 8*96ms = 768ms
@@ -266,6 +267,7 @@ struct RadioControlUserAppData
     DabUserApplicationType userAppType;
     QByteArray data;
 };
+Q_DECLARE_METATYPE(RadioControlUserAppData)
 
 struct RadioControlAudioData
 {
@@ -273,6 +275,8 @@ struct RadioControlAudioData
     DabAudioDataSCty ASCTy;
     dabsdrAudioFrameHeader_t header;
     std::vector<uint8_t> data;
+    int64_t timestampNs;  // time of reception from DAB processing, see LatencyTracer
+    bool onAir;           // false for stream that is only decoded to be ready for announcement switching
 };
 
 struct RadioControlTIIData
@@ -440,6 +444,7 @@ private:
     static const uint8_t EEPCoderate[];
 
     dabsdrHandle_t m_dabsdrHandle;
+    DataGroupPool m_dataGroupPool;  // buffers for MSC data groups, used in dataGroupCb only
     dabsdrSyncLevel_t m_syncLevel;
     bool m_enaAutoNotification = false;
     uint32_t m_frequency;
@@ -0,0 +1,68 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SERVICESTREAM_H
+#define SERVICESTREAM_H
+
+#include <stdint.h>
+
+// Service stream file format
+// File contains everything RadioControl passes to audio decoder and user applications for the selected service,
+// so that it can be replayed without input device and DAB SDR library.
+// File header: magic "ADSS", version [u8], 3 bytes reserved
+// Records follow, each starts with 12 bytes header (little endian) followed by payload:
+//   type [u8], id [s8] (dabsdrDecoderId_t), aux [u16], payload length [u32], time since start [u32, ms]
+// Payload by record type:
+//   Ensemble      QDataStream: frequency, ueid, LTO, intTable, alarm, label, labelShort
+//   Service       QDataStream: SId, SCIdS, SubChId, TMId, scType, bitRate, label, labelShort, pty.s, pty.d, lang, user app types
+//   Audio         aux = onAir << 15 | ASCTy, payload = audio frame header [u8] + access unit
+//   DynamicLabel  aux = ServiceStreamChannel, payload = DL data group
+//   DataGroup     aux = ServiceStreamChannel, payload = SCId [u16], user application type [u16] + MSC data group
+
+#define SERVICESTREAM_MAGIC "ADSS"
+#define SERVICESTREAM_VERSION (1)
+#define SERVICESTREAM_FILE_HEADER_SIZE (8)
+#define SERVICESTREAM_RECORD_HEADER_SIZE (12)
+#define SERVICESTREAM_MAX_PAYLOAD (1024 * 1024)  // sanity check of record length when reading
+#define SERVICESTREAM_AUDIO_ONAIR (0x8000)
+
+enum class ServiceStreamRecordType : uint8_t
+{
+    Ensemble = 1,
+    Service = 2,
+    Audio = 3,
+    DynamicLabel = 4,
+    DataGroup = 5,
+};
+
+// user applications and DL are delivered separately for service and announcement
+enum class ServiceStreamChannel : uint16_t
+{
+    Service = 0,
+    Announcement = 1,
+};
+
+#endif  // SERVICESTREAM_H
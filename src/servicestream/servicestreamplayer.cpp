@@ -0,0 +1,270 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "servicestreamplayer.h"
+
+#include <QDataStream>
+#include <QLoggingCategory>
+#include <QtEndian>
+
+#include "latencytracer.h"
+
+Q_LOGGING_CATEGORY(serviceStreamPlayer, "ServiceStreamPlayer", QtInfoMsg)
+
+#define SERVICESTREAM_FAST_BATCH (64)  // records emitted in one timer event when replaying as fast as possible
+
+ServiceStreamPlayer::ServiceStreamPlayer(QObject *parent) : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &ServiceStreamPlayer::onTimeout);
+}
+
+bool ServiceStreamPlayer::open(const QString &fileName)
+{
+    stop();
+    m_file.close();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        qCWarning(serviceStreamPlayer) << "Unable to open file:" << fileName;
+        return false;
+    }
+
+    QByteArray header = m_file.read(SERVICESTREAM_FILE_HEADER_SIZE);
+    if ((header.size() != SERVICESTREAM_FILE_HEADER_SIZE) || !header.startsWith(SERVICESTREAM_MAGIC))
+    {
+        qCWarning(serviceStreamPlayer) << "Not a service stream file:" << fileName;
+        m_file.close();
+        return false;
+    }
+    if (uint8_t(header.at(4)) != SERVICESTREAM_VERSION)
+    {
+        qCWarning(serviceStreamPlayer) << "Unsupported service stream version:" << uint8_t(header.at(4));
+        m_file.close();
+        return false;
+    }
+
+    m_numAudioFrames = 0;
+    m_numDataGroups = 0;
+    m_lastTimeMs = 0;
+    m_isRecordValid = readRecord();
+    return true;
+}
+
+void ServiceStreamPlayer::start()
+{
+    if (!m_file.isOpen())
+    {
+        return;
+    }
+    m_clock.start();
+    m_timer.start(0);
+}
+
+void ServiceStreamPlayer::stop()
+{
+    m_timer.stop();
+}
+
+bool ServiceStreamPlayer::readRecord()
+{
+    char header[SERVICESTREAM_RECORD_HEADER_SIZE];
+    if (m_file.read(header, SERVICESTREAM_RECORD_HEADER_SIZE) != SERVICESTREAM_RECORD_HEADER_SIZE)
+    {  // end of file
+        return false;
+    }
+    m_record.type = ServiceStreamRecordType(header[0]);
+    m_record.id = int8_t(header[1]);
+    m_record.aux = qFromLittleEndian<quint16>(header + 2);
+    uint32_t len = qFromLittleEndian<quint32>(header + 4);
+    m_record.timeMs = qFromLittleEndian<quint32>(header + 8);
+    if (len > SERVICESTREAM_MAX_PAYLOAD)
+    {
+        qCWarning(serviceStreamPlayer) << "Invalid record length:" << len;
+        return false;
+    }
+    m_record.payload = m_file.read(len);
+    if (m_record.payload.size() != qsizetype(len))
+    {  // recording was interrupted
+        qCWarning(serviceStreamPlayer) << "Incomplete record at the end of file";
+        return false;
+    }
+    return true;
+}
+
+void ServiceStreamPlayer::onTimeout()
+{
+    int count = 0;
+    while (m_isRecordValid)
+    {
+        if (m_speed > 0)
+        {
+            qint64 dueMs = qint64(m_record.timeMs / m_speed) - m_clock.elapsed();
+            if (dueMs > 0)
+            {
+                m_timer.start(dueMs);
+                return;
+            }
+        }
+        else if (++count > SERVICESTREAM_FAST_BATCH)
+        {  // let event loop process emitted data
+            m_timer.start(0);
+            return;
+        }
+
+        emitRecord();
+        m_isRecordValid = readRecord();
+    }
+
+    qCInfo(serviceStreamPlayer) << "Replay finished, audio frames:" << m_numAudioFrames << "data groups:" << m_numDataGroups;
+    emit finished();
+}
+
+void ServiceStreamPlayer::emitRecord()
+{
+    m_lastTimeMs = m_record.timeMs;
+    switch (m_record.type)
+    {
+        case ServiceStreamRecordType::Ensemble:
+            emitEnsemble();
+            break;
+        case ServiceStreamRecordType::Service:
+            emitService();
+            break;
+        case ServiceStreamRecordType::Audio:
+        {
+            if (m_record.payload.isEmpty())
+            {
+                break;
+            }
+            RadioControlAudioData *pData = new RadioControlAudioData;
+            pData->id = dabsdrDecoderId_t(m_record.id);
+            pData->ASCTy = DabAudioDataSCty(m_record.aux & ~SERVICESTREAM_AUDIO_ONAIR);
+            pData->onAir = (m_record.aux & SERVICESTREAM_AUDIO_ONAIR) != 0;
+            pData->header.raw = uint8_t(m_record.payload.at(0));
+            pData->data.assign(m_record.payload.constBegin() + 1, m_record.payload.constEnd());
+            pData->timestampNs = LatencyTracer::timestamp();
+            m_numAudioFrames += 1;
+            emit audioData(pData);
+        }
+        break;
+        case ServiceStreamRecordType::DynamicLabel:
+            m_numDataGroups += 1;
+            if (ServiceStreamChannel::Announcement == ServiceStreamChannel(m_record.aux))
+            {
+                emit dlDataGroup_Announcement(m_record.payload);
+            }
+            else
+            {
+                emit dlDataGroup_Service(m_record.payload);
+            }
+            break;
+        case ServiceStreamRecordType::DataGroup:
+        {
+            if (m_record.payload.size() < 4)
+            {
+                break;
+            }
+            RadioControlUserAppData data;
+            data.id = dabsdrDecoderId_t(m_record.id);
+            data.SCId = qFromLittleEndian<quint16>(m_record.payload.constData());
+            data.userAppType = DabUserApplicationType(qFromLittleEndian<quint16>(m_record.payload.constData() + 2));
+            data.data = m_record.payload.mid(4);
+            m_numDataGroups += 1;
+            if (ServiceStreamChannel::Announcement == ServiceStreamChannel(m_record.aux))
+            {
+                emit userAppData_Announcement(data);
+            }
+            else
+            {
+                emit userAppData_Service(data);
+            }
+        }
+        break;
+        default:
+            // unknown records are skipped, this allows adding new record types
+            qCDebug(serviceStreamPlayer) << "Unknown record type:" << int(m_record.type);
+            break;
+    }
+}
+
+void ServiceStreamPlayer::emitEnsemble()
+{
+    QDataStream in(m_record.payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 frequency, ueid;
+    qint8 lto;
+    quint8 intTable, alarm;
+    RadioControlEnsemble ens;
+    in >> frequency >> ueid >> lto >> intTable >> alarm >> ens.label >> ens.labelShort;
+    if (QDataStream::Ok != in.status())
+    {
+        qCWarning(serviceStreamPlayer) << "Invalid ensemble record";
+        return;
+    }
+    ens.frequency = frequency;
+    ens.ueid = ueid;
+    ens.LTO = lto;
+    ens.intTable = intTable;
+    ens.alarm = alarm;
+    emit ensembleInformation(ens);
+}
+
+void ServiceStreamPlayer::emitService()
+{
+    QDataStream in(m_record.payload);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 sid;
+    quint8 SCIdS, SubChId, TMId, scType, ptyS, ptyD;
+    quint16 bitRate;
+    qint8 lang;
+    QList<quint16> uaTypes;
+    RadioControlServiceComponent s{};
+    in >> sid >> SCIdS >> SubChId >> TMId >> scType >> bitRate >> s.label >> s.labelShort >> ptyS >> ptyD >> lang >> uaTypes;
+    if (QDataStream::Ok != in.status())
+    {
+        qCWarning(serviceStreamPlayer) << "Invalid service record";
+        return;
+    }
+    s.SId = DabSId(sid);
+    s.SCIdS = SCIdS;
+    s.SubChId = SubChId;
+    s.TMId = DabTMId(TMId);
+    s.streamAudioData.scType = DabAudioDataSCty(scType);
+    s.streamAudioData.bitRate = bitRate;
+    s.pty.s = ptyS;
+    s.pty.d = ptyD;
+    s.lang = lang;
+    for (quint16 uaType : uaTypes)
+    {
+        RadioControlUserApp ua{};
+        ua.uaType = DabUserApplicationType(uaType);
+        s.userApps.insert(ua.uaType, ua);
+    }
+    s.userAppsValid = true;
+    emit audioServiceSelection(s);
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SERVICESTREAMPLAYER_H
+#define SERVICESTREAMPLAYER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+
+#include "radiocontrol.h"
+#include "servicestream.h"
+
+// Replays service stream file written by ServiceStreamRecorder.
+// Signals have the same signature as corresponding RadioControl signals, so that player can replace RadioControl
+// as source of data for AudioDecoder, DLDecoder and user applications without input device and DAB SDR library.
+// Records are emitted with original timing multiplied by speed, speed 0 replays the file as fast as possible.
+class ServiceStreamPlayer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ServiceStreamPlayer(QObject *parent = nullptr);
+
+    bool open(const QString &fileName);
+    void setSpeed(float speed) { m_speed = speed; }
+    void start();
+    void stop();
+
+    // statistics of emitted records
+    qint64 numAudioFrames() const { return m_numAudioFrames; }
+    qint64 numDataGroups() const { return m_numDataGroups; }
+    qint64 durationMs() const { return m_lastTimeMs; }
+
+signals:
+    void ensembleInformation(const RadioControlEnsemble &ens);
+    void audioServiceSelection(const RadioControlServiceComponent &s);
+    // ownership of data is transferred to receiver
+    void audioData(RadioControlAudioData *pData);
+    void dlDataGroup_Service(const QByteArray &dg);
+    void dlDataGroup_Announcement(const QByteArray &dg);
+    void userAppData_Service(const RadioControlUserAppData &data);
+    void userAppData_Announcement(const RadioControlUserAppData &data);
+    void finished();
+
+private:
+    struct Record
+    {
+        ServiceStreamRecordType type;
+        int8_t id;
+        uint16_t aux;
+        uint32_t timeMs;
+        QByteArray payload;
+    };
+
+    QFile m_file;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    float m_speed = 1.0;
+    Record m_record;
+    bool m_isRecordValid = false;
+    qint64 m_numAudioFrames = 0;
+    qint64 m_numDataGroups = 0;
+    qint64 m_lastTimeMs = 0;
+
+    bool readRecord();
+    void onTimeout();
+    void emitRecord();
+    void emitEnsemble();
+    void emitService();
+};
+
+#endif  // SERVICESTREAMPLAYER_H
@@ -0,0 +1,247 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "servicestreamrecorder.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QLoggingCategory>
+#include <QRegularExpression>
+#include <QtEndian>
+#include <cstring>
+
+#include "androidfilehelper.h"
+#include "audiorecwriter.h"
+#include "settings.h"
+
+Q_LOGGING_CATEGORY(serviceStreamRecorder, "ServiceStreamRecorder", QtInfoMsg)
+
+ServiceStreamRecorder::ServiceStreamRecorder(QObject *parent) : QObject(parent)
+{}
+
+bool ServiceStreamRecorder::isRecording()
+{
+    QMutexLocker locker(&m_mutex);
+    return nullptr != m_writer;
+}
+
+void ServiceStreamRecorder::start(const QString &storagePath)
+{
+    static const QRegularExpression regexp("[" + QRegularExpression::escape("/:*?\"<>|") + "]");
+
+    QMutexLocker locker(&m_mutex);
+    if (nullptr != m_writer)
+    {  // already recording
+        return;
+    }
+
+    const QString recPath = AndroidFileHelper::buildSubdirPath(storagePath, STREAM_DIR_NAME);
+    if (!AndroidFileHelper::mkpath(storagePath, STREAM_DIR_NAME))
+    {
+        qCCritical(serviceStreamRecorder) << "Failed to create service stream directory:" << AndroidFileHelper::lastError();
+        emit recording(false);
+        return;
+    }
+    if (!AndroidFileHelper::hasWritePermission(recPath))
+    {
+        qCCritical(serviceStreamRecorder) << "No permission to write to:" << recPath;
+        emit recording(false);
+        return;
+    }
+
+    QString serviceName = m_isServiceValid ? m_service.label.trimmed() : QString();
+    serviceName.replace(regexp, "_");
+    QString fileName = QString("%1_%2_%3.adss")
+                           .arg(QDateTime::currentDateTime().toString("yyyy-MM-dd-hhmmss"),
+                                QString("%1").arg(m_isServiceValid ? m_service.SId.value() : 0, 6, 16, QChar('0')).toUpper(), serviceName);
+
+    QFile *file = AndroidFileHelper::openFileForWriting(recPath, fileName, "application/octet-stream");
+    if (nullptr == file)
+    {
+        qCCritical(serviceStreamRecorder) << "Unable to open file:" << fileName;
+        emit recording(false);
+        return;
+    }
+    qCInfo(serviceStreamRecorder) << "Service stream recording file:" << fileName;
+
+    m_writer = new AudioRecWriter(file, AudioRecWriter::Format::Raw, 0, this);
+    m_writer->start();
+    m_timer.start();
+
+    char header[SERVICESTREAM_FILE_HEADER_SIZE] = {0};
+    memcpy(header, SERVICESTREAM_MAGIC, 4);
+    header[4] = SERVICESTREAM_VERSION;
+    m_writer->write(header, SERVICESTREAM_FILE_HEADER_SIZE);
+
+    // recording starts in the middle of the service, receiver needs this information first
+    if (m_ensemble.isValid())
+    {
+        writeEnsemble();
+    }
+    if (m_isServiceValid)
+    {
+        writeService();
+    }
+
+    emit recording(true);
+}
+
+void ServiceStreamRecorder::stop()
+{
+    QMutexLocker locker(&m_mutex);
+    stopWriter();
+}
+
+void ServiceStreamRecorder::stopWriter()
+{
+    if (nullptr == m_writer)
+    {
+        return;
+    }
+
+    AudioRecWriter::Statistics stats = m_writer->statistics();
+    qCInfo(serviceStreamRecorder) << "Service stream recording stopped, file size [bytes]:" << stats.fileBytes;
+
+    // remaining data are written by writer thread, writer is deleted when it finishes
+    AudioRecWriter *writer = m_writer;
+    m_writer = nullptr;
+    connect(writer, &AudioRecWriter::finished, writer, &QObject::deleteLater);
+    writer->finish();
+
+    emit recording(false);
+}
+
+void ServiceStreamRecorder::onEnsembleInformation(const RadioControlEnsemble &ens)
+{
+    QMutexLocker locker(&m_mutex);
+    m_ensemble = ens;
+    if (nullptr != m_writer)
+    {
+        writeEnsemble();
+    }
+}
+
+void ServiceStreamRecorder::onAudioServiceSelection(const RadioControlServiceComponent &s)
+{
+    QMutexLocker locker(&m_mutex);
+    m_service = s;
+    m_isServiceValid = true;
+    if (nullptr != m_writer)
+    {
+        writeService();
+    }
+}
+
+void ServiceStreamRecorder::onAudioData(RadioControlAudioData *pData)
+{
+    QMutexLocker locker(&m_mutex);
+    if (nullptr == m_writer)
+    {
+        return;
+    }
+
+    uint16_t aux = uint16_t(pData->ASCTy) | (pData->onAir ? SERVICESTREAM_AUDIO_ONAIR : 0);
+    char header = char(pData->header.raw);
+    writeRecord(ServiceStreamRecordType::Audio, pData->id, aux, &header, 1, reinterpret_cast<const char *>(pData->data.data()),
+                int(pData->data.size()));
+}
+
+void ServiceStreamRecorder::writeDL(ServiceStreamChannel channel, const QByteArray &dg)
+{
+    QMutexLocker locker(&m_mutex);
+    if (nullptr == m_writer)
+    {
+        return;
+    }
+
+    writeRecord(ServiceStreamRecordType::DynamicLabel, 0, uint16_t(channel), dg.constData(), dg.size());
+}
+
+void ServiceStreamRecorder::writeUserAppData(ServiceStreamChannel channel, const RadioControlUserAppData &data)
+{
+    QMutexLocker locker(&m_mutex);
+    if (nullptr == m_writer)
+    {
+        return;
+    }
+
+    char header[4];
+    qToLittleEndian<quint16>(data.SCId, header);
+    qToLittleEndian<quint16>(quint16(data.userAppType), header + 2);
+    writeRecord(ServiceStreamRecordType::DataGroup, data.id, uint16_t(channel), header, sizeof(header), data.data.constData(), data.data.size());
+}
+
+void ServiceStreamRecorder::writeEnsemble()
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint32(m_ensemble.frequency) << quint32(m_ensemble.ueid) << qint8(m_ensemble.LTO) << quint8(m_ensemble.intTable)
+        << quint8(m_ensemble.alarm) << m_ensemble.label << m_ensemble.labelShort;
+    writeRecord(ServiceStreamRecordType::Ensemble, 0, 0, payload.constData(), payload.size());
+}
+
+void ServiceStreamRecorder::writeService()
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << quint32(m_service.SId.value()) << quint8(m_service.SCIdS) << quint8(m_service.SubChId) << quint8(m_service.TMId)
+        << quint8(m_service.streamAudioData.scType) << quint16(m_service.streamAudioData.bitRate) << m_service.label << m_service.labelShort
+        << quint8(m_service.pty.s) << quint8(m_service.pty.d) << qint8(m_service.lang);
+    QList<quint16> uaTypes;
+    for (auto it = m_service.userApps.cbegin(); it != m_service.userApps.cend(); ++it)
+    {
+        uaTypes.append(quint16(it.key()));
+    }
+    out << uaTypes;
+    writeRecord(ServiceStreamRecordType::Service, 0, 0, payload.constData(), payload.size());
+}
+
+void ServiceStreamRecorder::writeRecord(ServiceStreamRecordType type, int8_t id, uint16_t aux, const char *data1, int len1, const char *data2,
+                                        int len2)
+{
+    // record is passed to writer in one call, recording stops when writer drops data
+    // so the file ends with at most one incomplete record
+    m_record.resize(SERVICESTREAM_RECORD_HEADER_SIZE + len1 + len2);
+    char *p = m_record.data();
+    p[0] = char(type);
+    p[1] = char(id);
+    qToLittleEndian<quint16>(aux, p + 2);
+    qToLittleEndian<quint32>(len1 + len2, p + 4);
+    qToLittleEndian<quint32>(quint32(m_timer.elapsed()), p + 8);
+    memcpy(p + SERVICESTREAM_RECORD_HEADER_SIZE, data1, len1);
+    if (len2 > 0)
+    {
+        memcpy(p + SERVICESTREAM_RECORD_HEADER_SIZE + len1, data2, len2);
+    }
+
+    if (!m_writer->write(m_record.constData(), m_record.size()) || m_writer->hasError())
+    {  // file would be inconsistent from now on
+        qCWarning(serviceStreamRecorder) << "Service stream recording failed, storage is too slow or not available";
+        stopWriter();
+    }
+}
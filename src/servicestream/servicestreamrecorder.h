@@ -0,0 +1,85 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SERVICESTREAMRECORDER_H
+#define SERVICESTREAMRECORDER_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+
+#include "radiocontrol.h"
+#include "servicestream.h"
+
+class AudioRecWriter;
+
+// Records audio access units, DL and user application data groups and ensemble/service information
+// of the selected service to compact binary file (see servicestream.h) that can be replayed by ServiceStreamPlayer.
+// Data slots are connected by direct connection to RadioControl signals and are called from RadioControl
+// and DAB SDR threads, file is written by AudioRecWriter thread.
+class ServiceStreamRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ServiceStreamRecorder(QObject *parent = nullptr);
+
+    void start(const QString &storagePath);
+    void stop();
+    bool isRecording();
+
+    void onEnsembleInformation(const RadioControlEnsemble &ens);
+    void onAudioServiceSelection(const RadioControlServiceComponent &s);
+    // audio data is only copied, ownership stays with receiver of queued signal
+    void onAudioData(RadioControlAudioData *pData);
+    void onDLDataGroup_Service(const QByteArray &dg) { writeDL(ServiceStreamChannel::Service, dg); }
+    void onDLDataGroup_Announcement(const QByteArray &dg) { writeDL(ServiceStreamChannel::Announcement, dg); }
+    void onUserAppData_Service(const RadioControlUserAppData &data) { writeUserAppData(ServiceStreamChannel::Service, data); }
+    void onUserAppData_Announcement(const RadioControlUserAppData &data) { writeUserAppData(ServiceStreamChannel::Announcement, data); }
+
+signals:
+    void recording(bool isActive);
+
+private:
+    QMutex m_mutex;
+    AudioRecWriter *m_writer = nullptr;
+    QElapsedTimer m_timer;
+    QByteArray m_record;
+
+    // last information is written at the beginning of recording
+    RadioControlEnsemble m_ensemble;
+    RadioControlServiceComponent m_service;
+    bool m_isServiceValid = false;
+
+    void writeDL(ServiceStreamChannel channel, const QByteArray &dg);
+    void writeUserAppData(ServiceStreamChannel channel, const RadioControlUserAppData &data);
+    void writeEnsemble();
+    void writeService();
+    void writeRecord(ServiceStreamRecordType type, int8_t id, uint16_t aux, const char *data1, int len1, const char *data2 = nullptr, int len2 = 0);
+    void stopWriter();
+};
+
+#endif  // SERVICESTREAMRECORDER_H
@@ -36,6 +36,7 @@
 #include "config.h"
 #include "inputdevice.h"
 #include "rawfileinput.h"
+#include "threadplacement.h"
 
 #define ENSEMBLE_DIR_NAME "ensemble"
 #define SCANNER_DIR_NAME "scanner"
@@ -44,6 +45,7 @@
 #define UA_DIR_NAME "userApps"
 #define AUDIO_DIR_NAME "audio"
 #define RAW_DIR_NAME "raw"
+#define STREAM_DIR_NAME "stream"
 
 #if HAVE_AIRSPY
 #include "airspyinput.h"
@@ -84,6 +86,12 @@ public:
         FAAD = 0,
         FDKAAC = 1
     };
+    enum AudioLatencyProfile
+    {
+        LowLatency = 0,
+        Balanced = 1,
+        Robust = 2
+    };
 
     Settings() {};
 
@@ -165,6 +173,7 @@ public:
     QLocale::Language lang;
     AudioFramework audioFramework;
     AudioDecoder audioDecoder;
+    AudioLatencyProfile audioLatencyProfile;
     bool keepServiceListOnScan;
     bool dlPlusEna;
     int noiseConcealmentLevel;
@@ -172,11 +181,13 @@ public:
     bool spiAppEna;
     bool spiProgressEna;
     bool spiProgressHideComplete;
+    int spiCacheBudget;  // [MB] MOT object cache budget of SPI decoder, 0 = unlimited
     bool useInternet;
     bool radioDnsEna;
     bool trayIconEna;
     bool restoreWindows;
     QColor slsBackground = Qt::red;
+    int slsPrescaleHeight;  // [pixels] slides higher than this are scaled down after decoding, 0 = disabled
     bool updateCheckEna;
     QDateTime updateCheckTime;
     bool uploadEnsembleInfo;
@@ -201,11 +212,39 @@ public:
     struct AudioRec
     {
         bool captureOutput;
+        int flacLevel;  // FLAC compression level of decoded audio recording, -1 = WAV
         bool autoStopEna;
         bool dl;
         bool dlAbsTime;
     } audioRec;
 
+    // time shift buffer settings
+    struct TimeShift
+    {
+        int length;     // [min], 0 = disabled
+        int ramBudget;  // [MB], data over budget is stored in temporary file
+    } timeShift;
+
+    // cache of decoded slides and logos
+    struct ImageCacheConfig
+    {
+        int memoryBudget;  // [MB]
+        int diskBudget;    // [MB], 0 = disk cache disabled
+    } imageCache;
+
+    // logos received from SPI and RadioDNS
+    struct MetadataCacheConfig
+    {
+        int maxAge;      // [days], files not received for longer time are removed, 0 = unlimited
+        int diskBudget;  // [MB], 0 = unlimited
+    } metadataCache;
+
+    // CPU affinity and scheduling of pipeline threads, indexed by ThreadPlacement::Role
+    struct Threads
+    {
+        ThreadPlacement::Config config[ThreadPlacement::NumRoles];
+    } threads;
+
     // this is settings for UA data dumping (storage)
     struct UADumpSettings
     {
@@ -166,7 +166,16 @@ SettingsBackend::SettingsBackend(QQmlApplicationEngine *qmlEngine, QObject *pare
     connect(m_audioNoiseConcealModel, &ItemModel::currentIndexChanged, this, &SettingsBackend::onNoiseLevelChanged);
 
     connect(this, &SettingsBackend::audioRecCaptureOutputChanged, this,
-            [this]() { emit audioRecordingSettings(m_settings->dataStoragePath, m_settings->audioRec.captureOutput); });
+            [this]() { emit audioRecordingSettings(m_settings->dataStoragePath, m_settings->audioRec.captureOutput, m_settings->audioRec.flacLevel); });
+
+    m_audioRecFormatModel = new ItemModel(this);
+    m_audioRecFormatModel->addItem("WAV", QVariant(-1));
+#if HAVE_FLAC
+    m_audioRecFormatModel->addItem(tr("FLAC (fast)"), QVariant(0));
+    m_audioRecFormatModel->addItem("FLAC", QVariant(5));
+    m_audioRecFormatModel->addItem(tr("FLAC (smallest file)"), QVariant(8));
+#endif
+    connect(m_audioRecFormatModel, &ItemModel::currentIndexChanged, this, &SettingsBackend::onAudioRecFormatChanged);
 
     m_audioOutputModel = new ItemModel(this);
 #if (HAVE_PORTAUDIO)
@@ -187,6 +196,28 @@ SettingsBackend::SettingsBackend(QQmlApplicationEngine *qmlEngine, QObject *pare
 #endif
     connect(m_audioDecoderModel, &ItemModel::currentIndexChanged, this, &SettingsBackend::onAudioDecChanged);
 
+    m_audioLatencyModel = new ItemModel(this);
+    m_audioLatencyModel->addItem(tr("Low latency"), Settings::AudioLatencyProfile::LowLatency);
+    m_audioLatencyModel->addItem(tr("Balanced"), Settings::AudioLatencyProfile::Balanced);
+    m_audioLatencyModel->addItem(tr("Robust"), Settings::AudioLatencyProfile::Robust);
+    connect(m_audioLatencyModel, &ItemModel::currentIndexChanged, this, &SettingsBackend::onAudioLatencyChanged);
+
+    m_timeShiftLengthModel = new ItemModel(this);
+    m_timeShiftLengthModel->addItem(tr("Disabled"), QVariant(0));
+    m_timeShiftLengthModel->addItem(tr("15 minutes"), QVariant(15));
+    m_timeShiftLengthModel->addItem(tr("30 minutes"), QVariant(30));
+    m_timeShiftLengthModel->addItem(tr("1 hour"), QVariant(60));
+    m_timeShiftLengthModel->addItem(tr("2 hours"), QVariant(120));
+    connect(m_timeShiftLengthModel, &ItemModel::currentIndexChanged, this, &SettingsBackend::onTimeShiftLengthChanged);
+
+    m_timeShiftMemoryModel = new ItemModel(this);
+    m_timeShiftMemoryModel->addItem("8 MB", QVariant(8));
+    m_timeShiftMemoryModel->addItem("16 MB", QVariant(16));
+    m_timeShiftMemoryModel->addItem("32 MB", QVariant(32));
+    m_timeShiftMemoryModel->addItem("64 MB", QVariant(64));
+    m_timeShiftMemoryModel->addItem("128 MB", QVariant(128));
+    connect(m_timeShiftMemoryModel, &ItemModel::currentIndexChanged, this, &SettingsBackend::onTimeShiftMemoryChanged);
+
     // qmlRegisterType<AnnouncementsProxyModel>("abracaComponents", 1, 0, "AnnouncementsProxyModel");
     m_announcementModel = new ItemModel(this);
 
@@ -213,7 +244,7 @@ SettingsBackend::SettingsBackend(QQmlApplicationEngine *qmlEngine, QObject *pare
                 tiiLogPath(getDisplayPath(m_settings->uaDump.dataStoragePath + '/' + TII_DIR_NAME));
                 audioRecPath(getDisplayPath(m_settings->uaDump.dataStoragePath + '/' + AUDIO_DIR_NAME));
                 emit uaDumpSettings(m_settings->uaDump);
-                emit audioRecordingSettings(m_settings->dataStoragePath, m_settings->audioRec.captureOutput);
+                emit audioRecordingSettings(m_settings->dataStoragePath, m_settings->audioRec.captureOutput, m_settings->audioRec.flacLevel);
             });
     connect(this, &SettingsBackend::isUaDumpOverwiteEnabledChanged, this, [this]() { emit uaDumpSettings(m_settings->uaDump); });
     connect(this, &SettingsBackend::isUaDumpSlsEnabledChanged, this, [this]() { emit uaDumpSettings(m_settings->uaDump); });
@@ -521,6 +552,25 @@ void SettingsBackend::setSettings(Settings *settings)
         m_audioOutputModel->setCurrentIndex(0);
     }
 
+    if (false == m_audioLatencyModel->setCurrentData(QVariant(m_settings->audioLatencyProfile)))
+    {  // balanced as fallback
+        m_audioLatencyModel->setCurrentData(QVariant(Settings::AudioLatencyProfile::Balanced));
+    }
+
+    if (false == m_audioRecFormatModel->setCurrentData(QVariant(m_settings->audioRec.flacLevel)))
+    {  // WAV as fallback (also when FLAC is not available)
+        m_audioRecFormatModel->setCurrentIndex(0);
+    }
+
+    if (false == m_timeShiftLengthModel->setCurrentData(QVariant(m_settings->timeShift.length)))
+    {  // first item as fallback
+        m_timeShiftLengthModel->setCurrentIndex(0);
+    }
+    if (false == m_timeShiftMemoryModel->setCurrentData(QVariant(m_settings->timeShift.ramBudget)))
+    {  // 32 MB as fallback
+        m_timeShiftMemoryModel->setCurrentData(QVariant(32));
+    }
+
     // announcements
     uint16_t announcementEna = m_settings->announcementEna | (1 << static_cast<int>(DabAnnouncement::Alarm));  // enable alarm
     for (int ann = static_cast<int>(DabAnnouncement::Alarm); ann <= static_cast<int>(DabAnnouncement::AlarmTest); ++ann)
@@ -573,19 +623,22 @@ void SettingsBackend::setSettings(Settings *settings)
     // this is to align UI with settings values
     emit newAnnouncementSettings();
     emit noiseConcealmentLevelChanged(m_settings->noiseConcealmentLevel);
+    emit timeShiftSettingsChanged(m_settings->timeShift.length, m_settings->timeShift.ramBudget);
     emit xmlHeaderToggled(m_settings->xmlHeaderEna);
-    emit audioRecordingSettings(m_settings->dataStoragePath, m_settings->audioRec.captureOutput);
+    emit audioRecordingSettings(m_settings->dataStoragePath, m_settings->audioRec.captureOutput, m_settings->audioRec.flacLevel);
     emit uaDumpSettings(m_settings->uaDump);
     emit tiiSettingsChanged();
     emit tiiModeChanged(m_settings->tii.mode);
     emit proxySettingsChanged();
     emit showTrayIconChanged();
     emit slsBackgroundColorChanged();
+    emit slsPrescaleHeightChanged(m_settings->slsPrescaleHeight);
     emit showSystemTimeChanged();
     emit showEnsembleCountryFlagChanged();
     emit spiIconSettingsChanged();
     emit spiApplicationEnabled(m_settings->spiAppEna);
     emit spiApplicationSettingsChanged(m_settings->useInternet && m_settings->spiAppEna, m_settings->radioDnsEna && m_settings->spiAppEna);
+    emit spiCacheBudgetChanged(m_settings->spiCacheBudget);
     emit fullscreenChanged();
     emit compactUiChanged();
     emit cableChannelsEnaChanged();
@@ -1273,6 +1326,46 @@ void SettingsBackend::onAudioDecChanged()
     }
 }
 
+void SettingsBackend::onAudioLatencyChanged()
+{
+    Settings::AudioLatencyProfile profile = static_cast<Settings::AudioLatencyProfile>(m_audioLatencyModel->currentData().toInt());
+    if (profile != m_settings->audioLatencyProfile)
+    {
+        m_settings->audioLatencyProfile = profile;
+        audioLatencyChanged(true);
+    }
+}
+
+void SettingsBackend::onAudioRecFormatChanged()
+{
+    int flacLevel = m_audioRecFormatModel->currentData().toInt();
+    if (flacLevel != m_settings->audioRec.flacLevel)
+    {
+        m_settings->audioRec.flacLevel = flacLevel;
+        emit audioRecordingSettings(m_settings->dataStoragePath, m_settings->audioRec.captureOutput, m_settings->audioRec.flacLevel);
+    }
+}
+
+void SettingsBackend::onTimeShiftLengthChanged()
+{
+    int length = m_timeShiftLengthModel->currentData().toInt();
+    if (length != m_settings->timeShift.length)
+    {
+        m_settings->timeShift.length = length;
+        emit timeShiftSettingsChanged(m_settings->timeShift.length, m_settings->timeShift.ramBudget);
+    }
+}
+
+void SettingsBackend::onTimeShiftMemoryChanged()
+{
+    int ramBudget = m_timeShiftMemoryModel->currentData().toInt();
+    if (ramBudget != m_settings->timeShift.ramBudget)
+    {
+        m_settings->timeShift.ramBudget = ramBudget;
+        emit timeShiftSettingsChanged(m_settings->timeShift.length, m_settings->timeShift.ramBudget);
+    }
+}
+
 QUrl SettingsBackend::dataStoragePathUrl() const
 {
     QString dir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
@@ -1787,6 +1880,15 @@ bool SettingsBackend::haveAirspy() const
 #endif
 }
 
+bool SettingsBackend::haveFlac() const
+{
+#if HAVE_FLAC
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool SettingsBackend::haveSoapySdr() const
 {
 #if HAVE_SOAPYSDR
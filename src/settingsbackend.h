@@ -56,6 +56,10 @@ class SettingsBackend : public UIControlProvider
     Q_PROPERTY(ItemModel *audioNoiseConcealModel READ audioNoiseConcealModel CONSTANT FINAL)
     Q_PROPERTY(ItemModel *audioDecoderModel READ audioDecoderModel CONSTANT FINAL)
     Q_PROPERTY(ItemModel *audioOutputModel READ audioOutputModel CONSTANT FINAL)
+    Q_PROPERTY(ItemModel *audioLatencyModel READ audioLatencyModel CONSTANT FINAL)
+    Q_PROPERTY(ItemModel *audioRecFormatModel READ audioRecFormatModel CONSTANT FINAL)
+    Q_PROPERTY(ItemModel *timeShiftLengthModel READ timeShiftLengthModel CONSTANT FINAL)
+    Q_PROPERTY(ItemModel *timeShiftMemoryModel READ timeShiftMemoryModel CONSTANT FINAL)
     Q_PROPERTY(ItemModel *announcementModel READ announcementModel CONSTANT FINAL)
     Q_PROPERTY(ItemModel *locationSourceModel READ locationSourceModel CONSTANT FINAL)
     Q_PROPERTY(ItemModel *serialPortBaudrateModel READ serialPortBaudrateModel CONSTANT FINAL)
@@ -70,6 +74,7 @@ class SettingsBackend : public UIControlProvider
     Q_PROPERTY(bool haveRtlSdrOldDabDriver READ haveRtlSdrOldDabDriver CONSTANT FINAL)
     Q_PROPERTY(bool haveAirspy READ haveAirspy CONSTANT FINAL)
     Q_PROPERTY(bool haveSoapySdr READ haveSoapySdr CONSTANT FINAL)
+    Q_PROPERTY(bool haveFlac READ haveFlac CONSTANT FINAL)
 
     Q_PROPERTY(int rawFileProgressValue READ rawFileProgressValue WRITE setRawFileProgressValue NOTIFY rawFileProgressValueChanged FINAL)
     Q_PROPERTY(int rtlSdrGainIndex READ rtlSdrGainIndex WRITE setRtlSdrGainIndex NOTIFY rtlSdrGainIndexChanged FINAL)
@@ -172,6 +177,7 @@ class SettingsBackend : public UIControlProvider
     UI_PROPERTY_SETTINGS(bool, audioRecAutoStop, m_settings->audioRec.autoStopEna)
     UI_PROPERTY_DEFAULT(bool, audioDecoderChanged, false)
     UI_PROPERTY_DEFAULT(bool, audioOutputChanged, false)
+    UI_PROPERTY_DEFAULT(bool, audioLatencyChanged, false)
 
     UI_PROPERTY_SETTINGS(bool, annBringToForeground, m_settings->bringWindowToForeground)
     UI_PROPERTY_SETTINGS(bool, isSpiAppEnabled, m_settings->spiAppEna)
@@ -262,6 +268,10 @@ public:
     ItemModel *sdrplayChannelModel() const { return m_sdrplayChannelModel; }
     ItemModel *audioNoiseConcealModel() const { return m_audioNoiseConcealModel; }
     ItemModel *audioDecoderModel() const { return m_audioDecoderModel; }
+    ItemModel *audioLatencyModel() const { return m_audioLatencyModel; }
+    ItemModel *audioRecFormatModel() const { return m_audioRecFormatModel; }
+    ItemModel *timeShiftLengthModel() const { return m_timeShiftLengthModel; }
+    ItemModel *timeShiftMemoryModel() const { return m_timeShiftMemoryModel; }
     ItemModel *audioOutputModel() const { return m_audioOutputModel; }
     ItemModel *announcementModel() const { return m_announcementModel; }
     ItemModel *locationSourceModel() const { return m_locationSourceModel; }
@@ -290,6 +300,7 @@ public:
     bool haveRtlSdrOldDabDriver() const;
     bool haveAirspy() const;
     bool haveSoapySdr() const;
+    bool haveFlac() const;
 
     int rtlSdrGainIndex() const;
     void setRtlSdrGainIndex(int rtlSdrGainIndex);
@@ -338,11 +349,14 @@ signals:
     void newAnnouncementSettings();
     void applicationStyleChanged();
     void noiseConcealmentLevelChanged(int level);
+    void timeShiftSettingsChanged(int lengthMin, int ramBudgetMB);
     void xmlHeaderToggled(bool enabled);
     void spiApplicationEnabled(bool enabled);
     void spiApplicationSettingsChanged(bool useInternet, bool enaRadioDNS);
+    void spiCacheBudgetChanged(int budgetMB);
+    void slsPrescaleHeightChanged(int height);
     void spiIconSettingsChanged();
-    void audioRecordingSettings(const QString &folder, bool doOutputRecording);
+    void audioRecordingSettings(const QString &folder, bool doOutputRecording, int flacLevel);
     void uaDumpSettings(const Settings::UADumpSettings &settings);
     void tiiSettingsChanged();
     void tiiTableSettingsChanged();
@@ -448,6 +462,10 @@ private:
     void onNoiseLevelChanged();
     void onAudioOutChanged();
     void onAudioDecChanged();
+    void onAudioLatencyChanged();
+    void onAudioRecFormatChanged();
+    void onTimeShiftLengthChanged();
+    void onTimeShiftMemoryChanged();
     void onGeolocationSourceChanged();
 
 #if HAVE_AIRSPY
@@ -478,6 +496,10 @@ private:
     SoapySdrGainModel *m_soapySdrGainModel = nullptr;
     ItemModel *m_audioNoiseConcealModel = nullptr;
     ItemModel *m_audioDecoderModel = nullptr;
+    ItemModel *m_audioLatencyModel = nullptr;
+    ItemModel *m_audioRecFormatModel = nullptr;
+    ItemModel *m_timeShiftLengthModel = nullptr;
+    ItemModel *m_timeShiftMemoryModel = nullptr;
     ItemModel *m_audioOutputModel = nullptr;
     ItemModel *m_announcementModel = nullptr;
     ItemModel *m_tabsModel = nullptr;
@@ -158,7 +158,7 @@ void SLSBackend::showSlide(const Slide &slide)
     {
         toolTip += "<br>";
     }
-    toolTip += QString(tr("<b>Resolution:</b> %1x%2 pixels<br>")).arg(slide.getPixmap().width()).arg(slide.getPixmap().height());
+    toolTip += QString(tr("<b>Resolution:</b> %1x%2 pixels<br>")).arg(slide.getSize().width()).arg(slide.getSize().height());
     toolTip += QString(tr("<b>Size:</b> %1 bytes<br>")).arg(slide.getNumBytes());
     toolTip += QString(tr("<b>Format:</b> %1<br>")).arg(slide.getFormat());
     toolTip += QString(tr("<b>Content name:</b> \"%1\"")).arg(slide.getContentName());
@@ -303,8 +303,10 @@ bool SLSBackend::handleRightClick()
 
 void SLSBackend::copySlideToClipboard()
 {
-    QImage image;
-    if (image.loadFromData(m_currentSlide.getRawData(), m_currentSlide.getFormat().toLatin1()))
+    // decoded image can be used unless it was prescaled
+    QImage image = m_currentSlide.getImage();
+    if ((!image.isNull() && (image.size() == m_currentSlide.getSize())) ||
+        image.loadFromData(m_currentSlide.getRawData(), m_currentSlide.getFormat().toLatin1()))
     {
         QGuiApplication::clipboard()->setImage(image, QClipboard::Clipboard);
         qCInfo(application) << "Slide copied to clipboard";
@@ -0,0 +1,450 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "threadplacement.h"
+
+#include <QFile>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+Q_LOGGING_CATEGORY(threadPlacement, "ThreadPlacement", QtInfoMsg)
+
+namespace
+{
+int64_t timestampNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef Q_OS_LINUX
+// reads user + system time [clock ticks] and last CPU of the thread from /proc, returns false if thread does not exist
+bool readThreadStat(int64_t tid, uint64_t &cpuTicks, int &lastCpu)
+{
+    QFile file(QString("/proc/self/task/%1/stat").arg(tid));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QByteArray stat = file.readAll();
+
+    // thread name can contain spaces, fields are counted after closing bracket of the name
+    int pos = stat.lastIndexOf(')');
+    if (pos < 0)
+    {
+        return false;
+    }
+    QList<QByteArray> fields = stat.mid(pos + 2).split(' ');
+    // fields[0] is field 3 of proc_pid_stat(5): utime (14), stime (15), processor (39)
+    if (fields.size() < 37)
+    {
+        return false;
+    }
+    cpuTicks = fields.at(11).toULongLong() + fields.at(12).toULongLong();
+    lastCpu = fields.at(36).toInt();
+    return true;
+}
+#endif
+}  // namespace
+
+int64_t ThreadPlacement::currentThreadId()
+{
+#ifdef Q_OS_LINUX
+    // system call is done only once per thread
+    static thread_local int64_t tid = syscall(SYS_gettid);
+    return tid;
+#else
+    return 1;  // registration is only tracked
+#endif
+}
+
+ThreadPlacement *ThreadPlacement::getInstance()
+{
+    static ThreadPlacement instance;
+    return &instance;
+}
+
+const char *ThreadPlacement::roleName(Role role)
+{
+    switch (role)
+    {
+        case RadioControl:
+            return "radioControl";
+        case DabProcessing:
+            return "dabProcessing";
+        case Input:
+            return "input";
+        case AudioDecoder:
+            return "audioDecoder";
+        case AudioOutput:
+            return "audioOutput";
+        case SpiDecoder:
+            return "spiDecoder";
+        default:
+            return "";
+    }
+}
+
+ThreadPlacement::Role ThreadPlacement::roleFromName(const QString &name)
+{
+    for (int r = 0; r < NumRoles; ++r)
+    {
+        if (0 == name.compare(roleName(Role(r)), Qt::CaseInsensitive))
+        {
+            return Role(r);
+        }
+    }
+    return NumRoles;
+}
+
+QList<int> ThreadPlacement::parseCpuList(const QString &str, bool *ok)
+{
+    QList<int> cpus;
+    bool isValid = true;
+    const QStringList items = str.split(',', Qt::SkipEmptyParts);
+    for (const QString &item : items)
+    {
+        QStringList range = item.trimmed().split('-');
+        bool okFirst = false;
+        bool okLast = false;
+        int first = range.first().toInt(&okFirst);
+        int last = range.last().toInt(&okLast);
+        if ((range.size() > 2) || !okFirst || !okLast || (first < 0) || (last < first))
+        {
+            isValid = false;
+            break;
+        }
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.append(cpu);
+        }
+    }
+    if (!isValid)
+    {
+        cpus.clear();
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+    if (ok)
+    {
+        *ok = isValid;
+    }
+    return cpus;
+}
+
+QString ThreadPlacement::cpuListToString(const QList<int> &cpus)
+{
+    QStringList items;
+    int n = 0;
+    while (n < cpus.size())
+    {
+        int first = cpus.at(n);
+        int last = first;
+        while ((n + 1 < cpus.size()) && (cpus.at(n + 1) == last + 1))
+        {
+            last = cpus.at(++n);
+        }
+        items.append((first == last) ? QString::number(first) : QString("%1-%2").arg(first).arg(last));
+        ++n;
+    }
+    return items.join(',');
+}
+
+bool ThreadPlacement::parseCommandLine(const QString &str)
+{
+    QStringList parts = str.split(':');
+    if ((parts.size() < 2) || (parts.size() > 4))
+    {
+        return false;
+    }
+
+    Role role = roleFromName(parts.at(0));
+    if (NumRoles == role)
+    {
+        return false;
+    }
+
+    Config cfg;
+    bool ok = true;
+    cfg.cpus = parseCpuList(parts.at(1), &ok);
+    if (ok && (parts.size() > 2) && !parts.at(2).isEmpty())
+    {
+        cfg.nice = parts.at(2).toInt(&ok);
+    }
+    if (ok && (parts.size() > 3) && !parts.at(3).isEmpty())
+    {
+        cfg.rtPriority = parts.at(3).toInt(&ok);
+    }
+    if (!ok)
+    {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_roles[role].config = cfg;
+    m_roles[role].isCommandLineConfig = true;
+    apply(role);
+    return true;
+}
+
+void ThreadPlacement::setConfig(Role role, const Config &config)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_roles[role].isCommandLineConfig)
+    {  // command line has priority
+        return;
+    }
+    m_roles[role].config = config;
+    apply(role);
+}
+
+ThreadPlacement::Config ThreadPlacement::config(Role role) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_roles[role].config;
+}
+
+void ThreadPlacement::registerThread(QThread *thread, Role role)
+{
+    // both signals are emitted from the thread itself
+    QObject::connect(thread, &QThread::started, thread, [this, role]() { registerCurrentThread(role); }, Qt::DirectConnection);
+    QObject::connect(thread, &QThread::finished, thread, [this, role]() { unregisterCurrentThread(role); }, Qt::DirectConnection);
+}
+
+void ThreadPlacement::registerCurrentThread(Role role)
+{
+    registerThreadId(currentThreadId(), role);
+}
+
+void ThreadPlacement::registerThreadId(int64_t tid, Role role)
+{
+    QMutexLocker locker(&m_mutex);
+    RoleData &data = m_roles[role];
+    data.tid = tid;
+    data.lastCpuTicks = 0;
+    data.lastTimestampNs = 0;
+    saveOriginal(data);
+    apply(role);
+}
+
+void ThreadPlacement::unregisterCurrentThread(Role role)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_roles[role].tid == currentThreadId())
+    {  // new thread of the same role could be registered already
+        m_roles[role].tid = 0;
+    }
+}
+
+void ThreadPlacement::unregisterThread(Role role)
+{
+    QMutexLocker locker(&m_mutex);
+    m_roles[role].tid = 0;
+}
+
+QList<ThreadPlacement::ThreadStatistics> ThreadPlacement::statistics()
+{
+    QList<ThreadStatistics> stats(NumRoles);
+
+#ifdef Q_OS_LINUX
+    static const long ticksPerSec = sysconf(_SC_CLK_TCK);
+
+    QMutexLocker locker(&m_mutex);
+    int64_t now = timestampNs();
+    for (int r = 0; r < NumRoles; ++r)
+    {
+        RoleData &data = m_roles[r];
+        uint64_t cpuTicks = 0;
+        if ((0 == data.tid) || !readThreadStat(data.tid, cpuTicks, stats[r].lastCpu))
+        {
+            continue;
+        }
+        stats[r].isRunning = true;
+        if ((data.lastTimestampNs > 0) && (now > data.lastTimestampNs) && (ticksPerSec > 0))
+        {
+            double cpuSec = double(cpuTicks - data.lastCpuTicks) / ticksPerSec;
+            stats[r].cpuPercent = 100.0 * cpuSec * 1e9 / (now - data.lastTimestampNs);
+        }
+        data.lastCpuTicks = cpuTicks;
+        data.lastTimestampNs = now;
+    }
+#endif
+
+    return stats;
+}
+
+void ThreadPlacement::saveOriginal(RoleData &data)
+{
+    data.isAffinitySet = false;
+    data.isRtSet = false;
+    data.isNiceSet = false;
+    data.originalCpus.clear();
+    data.originalPolicy = 0;
+    data.originalRtPriority = 0;
+    data.originalNice = 0;
+
+#ifdef Q_OS_LINUX
+    pid_t tid = pid_t(data.tid);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (0 == sched_getaffinity(tid, sizeof(set), &set))
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                data.originalCpus.append(cpu);
+            }
+        }
+    }
+    int policy = sched_getscheduler(tid);
+    data.originalPolicy = (policy >= 0) ? policy : SCHED_OTHER;
+    struct sched_param param;
+    if (0 == sched_getparam(tid, &param))
+    {
+        data.originalRtPriority = param.sched_priority;
+    }
+    errno = 0;  // -1 is valid nice level
+    int nice = getpriority(PRIO_PROCESS, id_t(tid));
+    data.originalNice = (0 == errno) ? nice : 0;
+#endif
+}
+
+void ThreadPlacement::apply(Role role)
+{
+    RoleData &data = m_roles[role];
+    if (0 == data.tid)
+    {  // applied when thread registers
+        return;
+    }
+    const Config &cfg = data.config;
+    bool isDefault = cfg.cpus.isEmpty() && (0 == cfg.nice) && (0 == cfg.rtPriority);
+    if (isDefault && !data.isAffinitySet && !data.isRtSet && !data.isNiceSet)
+    {  // default scheduling is kept
+        return;
+    }
+
+#ifdef Q_OS_LINUX
+    pid_t tid = pid_t(data.tid);
+    bool isApplied = true;
+    if (!cfg.cpus.isEmpty() || (data.isAffinitySet && !data.originalCpus.isEmpty()))
+    {  // configured CPUs or original affinity
+        const QList<int> &cpus = cfg.cpus.isEmpty() ? data.originalCpus : cfg.cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus)
+        {
+            if (cpu < CPU_SETSIZE)
+            {
+                CPU_SET(cpu, &set);
+            }
+        }
+        if (0 != sched_setaffinity(tid, sizeof(set), &set))
+        {
+            qCWarning(threadPlacement, "Failed to set CPU affinity of %s thread to %s: %s", roleName(role), qUtf8Printable(cpuListToString(cpus)),
+                      strerror(errno));
+            isApplied = false;
+        }
+        else
+        {
+            data.isAffinitySet = !cfg.cpus.isEmpty();
+        }
+    }
+    if (cfg.rtPriority > 0)
+    {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = qBound(sched_get_priority_min(SCHED_FIFO), cfg.rtPriority, sched_get_priority_max(SCHED_FIFO));
+        if (0 != sched_setscheduler(tid, SCHED_FIFO, &param))
+        {
+            qCWarning(threadPlacement, "Failed to set SCHED_FIFO priority %d of %s thread: %s", param.sched_priority, roleName(role), strerror(errno));
+            isApplied = false;
+        }
+        else
+        {
+            data.isRtSet = true;
+        }
+    }
+    else
+    {
+        if (data.isRtSet)
+        {  // original policy
+            struct sched_param param;
+            memset(&param, 0, sizeof(param));
+            param.sched_priority = data.originalRtPriority;
+            if (0 != sched_setscheduler(tid, data.originalPolicy, &param))
+            {
+                qCWarning(threadPlacement, "Failed to restore scheduling policy of %s thread: %s", roleName(role), strerror(errno));
+                isApplied = false;
+            }
+            else
+            {
+                data.isRtSet = false;
+            }
+        }
+        if ((0 != cfg.nice) || data.isNiceSet)
+        {  // configured or original nice level
+            int nice = (0 != cfg.nice) ? cfg.nice : data.originalNice;
+            if (0 != setpriority(PRIO_PROCESS, id_t(tid), nice))
+            {
+                qCWarning(threadPlacement, "Failed to set nice level %d of %s thread: %s", nice, roleName(role), strerror(errno));
+                isApplied = false;
+            }
+            else
+            {
+                data.isNiceSet = (0 != cfg.nice);
+            }
+        }
+    }
+    if (isApplied)
+    {
+        if (isDefault)
+        {
+            qCInfo(threadPlacement, "%s thread: original scheduling restored", roleName(role));
+        }
+        else
+        {
+            qCInfo(threadPlacement, "%s thread: CPUs [%s], nice %d, SCHED_FIFO priority %d", roleName(role),
+                   qUtf8Printable(cpuListToString(cfg.cpus)), cfg.nice, cfg.rtPriority);
+        }
+    }
+#else
+    qCWarning(threadPlacement, "Thread placement of %s thread is not supported on this platform", roleName(role));
+#endif
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef THREADPLACEMENT_H
+#define THREADPLACEMENT_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <cstdint>
+
+class QThread;
+
+// CPU affinity and scheduling of receive pipeline threads
+// Each pipeline thread registers itself under its role, configuration of the role is applied to registered thread
+// immediately and to threads registered later (threads are started before settings are loaded, device workers are restarted).
+// Scheduling of the thread at registration is kept and it is restored when configuration of the role is cleared.
+// Configuration is applied where permitted by the system, failures are only logged.
+// Placement and CPU usage statistics are implemented for Linux (including Android), other platforms only keep configuration.
+class ThreadPlacement
+{
+public:
+    enum Role
+    {
+        RadioControl = 0,
+        DabProcessing,  // libdabsdr thread
+        Input,          // input device worker
+        AudioDecoder,
+        AudioOutput,
+        SpiDecoder,  // SPI (EPG) user application
+        NumRoles
+    };
+
+    struct Config
+    {
+        QList<int> cpus;     // allowed CPUs, empty = no restriction
+        int nice = 0;        // nice level of SCHED_OTHER thread, negative values usually require privileges
+        int rtPriority = 0;  // SCHED_FIFO priority 1..99, 0 = normal scheduling
+    };
+
+    struct ThreadStatistics
+    {
+        bool isRunning = false;
+        float cpuPercent = 0.0;  // CPU usage since previous statistics() call, 100% = one core
+        int lastCpu = -1;        // CPU the thread last executed on
+    };
+
+    static ThreadPlacement *getInstance();
+
+    // role name used in settings keys and command line
+    static const char *roleName(Role role);
+    static Role roleFromName(const QString &name);  // returns NumRoles if not valid
+
+    // CPU list in "0,2-3" format
+    static QList<int> parseCpuList(const QString &str, bool *ok = nullptr);
+    static QString cpuListToString(const QList<int> &cpus);
+
+    // command line format is <role>:<cpus>[:<nice>[:<rtPriority>]], for example "audioOutput:3::10"
+    // returns false if string is not valid
+    bool parseCommandLine(const QString &str);
+
+    // configuration from command line overrides configuration from settings
+    void setConfig(Role role, const Config &config);
+    Config config(Role role) const;
+
+    // thread registers itself when it is started and unregisters when it finishes
+    void registerThread(QThread *thread, Role role);
+
+    void registerCurrentThread(Role role);
+    void unregisterCurrentThread(Role role);
+
+    // for threads that must not block (realtime audio callback): thread stores its id and it is registered from other thread
+    static int64_t currentThreadId();
+    void registerThreadId(int64_t tid, Role role);
+
+    // for threads that cannot unregister themselves (libdabsdr), to be called after thread has finished
+    void unregisterThread(Role role);
+
+    QList<ThreadStatistics> statistics();
+
+private:
+    ThreadPlacement() = default;
+
+    struct RoleData
+    {
+        Config config;
+        bool isCommandLineConfig = false;
+        int64_t tid = 0;  // 0 = no thread registered
+        uint64_t lastCpuTicks = 0;
+        int64_t lastTimestampNs = 0;
+
+        // scheduling of the thread when it registered
+        QList<int> originalCpus;
+        int originalPolicy = 0;
+        int originalRtPriority = 0;
+        int originalNice = 0;
+        // original value was changed by configuration
+        bool isAffinitySet = false;
+        bool isRtSet = false;
+        bool isNiceSet = false;
+    };
+
+    mutable QMutex m_mutex;
+    RoleData m_roles[NumRoles];
+
+    void saveOriginal(RoleData &data);
+    void apply(Role role);
+};
+
+// registers current thread under role for the lifetime of the object, to be used in QThread::run()
+class ThreadPlacementScope
+{
+public:
+    explicit ThreadPlacementScope(ThreadPlacement::Role role) : m_role(role) { ThreadPlacement::getInstance()->registerCurrentThread(role); }
+    ~ThreadPlacementScope() { ThreadPlacement::getInstance()->unregisterCurrentThread(m_role); }
+
+private:
+    ThreadPlacement::Role m_role;
+};
+
+#endif  // THREADPLACEMENT_H
@@ -0,0 +1,437 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "timeshiftbuffer.h"
+
+#include <QLoggingCategory>
+#include <chrono>
+#include <cstring>
+
+Q_LOGGING_CATEGORY(timeShift, "TimeShift", QtInfoMsg)
+
+TimeShiftBuffer::TimeShiftBuffer(QObject *parent) : QObject(parent)
+{
+    m_playTimer = new QTimer(this);
+    m_playTimer->setSingleShot(true);
+    m_playTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_playTimer, &QTimer::timeout, this, &TimeShiftBuffer::play);
+}
+
+qint64 TimeShiftBuffer::timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TimeShiftBuffer::setup(int lengthMin, int ramBudgetMB)
+{
+    m_lengthMs = qint64(lengthMin) * 60 * 1000;
+    m_ramBudgetBytes = qMax(qint64(ramBudgetMB) * 1024 * 1024 - metadataBudgetBytes(ramBudgetMB), qint64(2 * TIMESHIFT_SEGMENT_BYTES));
+
+    qCInfo(timeShift, "Time shift buffer length %d min, RAM budget %d MB", lengthMin, ramBudgetMB);
+
+    // apply new limits to data already stored
+    reset();
+}
+
+void TimeShiftBuffer::reset()
+{
+    m_segments.clear();
+    m_firstSeq = 0;
+    m_ramBytes = 0;
+
+    // file is recreated when needed
+    delete m_file;
+    m_file = nullptr;
+    m_freeSlots.clear();
+    m_numSlots = 0;
+    m_cacheSeq = -1;
+    m_cache.clear();
+
+    m_isPaused = false;
+    m_delayMs = 0;
+    m_readSeq = 0;
+    m_readOffset = 0;
+    m_playTimer->stop();
+
+    notifyState();
+}
+
+void TimeShiftBuffer::onAudioData(RadioControlAudioData *inData)
+{
+    if (0 == m_lengthMs)
+    {  // time shift disabled
+        emit audioData(inData);
+        return;
+    }
+
+    qint64 now = timestamp();
+    store(inData, now);
+    dropOld(now);
+
+    if (isLive())
+    {
+        setToLive();
+        emit audioData(inData);
+        return;
+    }
+
+    // data is played from buffer
+    delete inData;
+    if (!m_playTimer->isActive())
+    {  // all stored data was played, new record is scheduled
+        play();
+    }
+}
+
+void TimeShiftBuffer::pause()
+{
+    if ((0 == m_lengthMs) || m_isPaused)
+    {
+        return;
+    }
+    m_isPaused = true;
+    m_pauseStartMs = timestamp();
+    m_playTimer->stop();
+
+    notifyState();
+}
+
+void TimeShiftBuffer::resume()
+{
+    if (!m_isPaused)
+    {
+        return;
+    }
+    m_isPaused = false;
+    m_delayMs = qBound(qint64(0), m_delayMs + timestamp() - m_pauseStartMs, availableMs());
+    seek(timestamp() - m_delayMs);
+    play();
+
+    notifyState();
+}
+
+void TimeShiftBuffer::skip(int seconds)
+{
+    if (0 == m_lengthMs)
+    {
+        return;
+    }
+
+    qint64 now = timestamp();
+    if (m_isPaused)
+    {  // pause duration is added to delay, playback stays paused at new position
+        m_delayMs += now - m_pauseStartMs;
+        m_pauseStartMs = now;
+    }
+    m_delayMs = qBound(qint64(0), m_delayMs - seconds * 1000, availableMs());
+
+    if (isLive())
+    {
+        setToLive();
+    }
+    else
+    {
+        seek(now - m_delayMs);
+        play();
+    }
+
+    notifyState();
+}
+
+void TimeShiftBuffer::jumpToLive()
+{
+    m_isPaused = false;
+    m_delayMs = 0;
+    setToLive();
+
+    notifyState();
+}
+
+qint64 TimeShiftBuffer::availableMs() const
+{
+    if (m_segments.empty())
+    {
+        return 0;
+    }
+    return timestamp() - m_segments.front().startMs;
+}
+
+void TimeShiftBuffer::store(const RadioControlAudioData *inData, qint64 timestampMs)
+{
+    int dataSize = qMin(inData->data.size(), size_t(UINT16_MAX));
+    int recordBytes = RecordHeaderBytes + dataSize;
+
+    if (m_segments.empty() || (m_segments.back().size + recordBytes > TIMESHIFT_SEGMENT_BYTES))
+    {  // new segment
+        Segment segment;
+        segment.startMs = timestampMs;
+        segment.endMs = timestampMs;
+        segment.data.reserve(TIMESHIFT_SEGMENT_BYTES);
+        m_segments.push_back(segment);
+        m_ramBytes += TIMESHIFT_SEGMENT_BYTES;
+
+        // move oldest segments to file if RAM budget is exceeded, segment being written stays in RAM
+        for (auto it = m_segments.begin(); (m_ramBytes > m_ramBudgetBytes) && (it + 1 != m_segments.end()); ++it)
+        {
+            if (!it->data.isEmpty())
+            {
+                moveToFile(*it);
+            }
+        }
+        while ((m_ramBytes > m_ramBudgetBytes) && (m_segments.size() > 1))
+        {  // file is not available -> dropping oldest data
+            popFront();
+        }
+    }
+
+    uint8_t header[RecordHeaderBytes];
+    memcpy(header, &timestampMs, sizeof(timestampMs));
+    header[8] = static_cast<int8_t>(inData->id);
+    header[9] = static_cast<uint8_t>(inData->ASCTy);
+    header[10] = inData->header.raw;
+    header[11] = inData->onAir;
+    header[12] = dataSize & 0xFF;
+    header[13] = dataSize >> 8;
+
+    Segment &segment = m_segments.back();
+    segment.data.append(reinterpret_cast<const char *>(header), RecordHeaderBytes);
+    segment.data.append(reinterpret_cast<const char *>(inData->data.data()), dataSize);
+    segment.size += recordBytes;
+    segment.endMs = timestampMs;
+}
+
+void TimeShiftBuffer::dropOld(qint64 nowMs)
+{
+    while ((m_segments.size() > 1) && (m_segments.front().endMs < nowMs - m_lengthMs))
+    {
+        popFront();
+    }
+}
+
+void TimeShiftBuffer::popFront()
+{
+    Segment &segment = m_segments.front();
+    if (!segment.data.isEmpty())
+    {
+        m_ramBytes -= TIMESHIFT_SEGMENT_BYTES;
+    }
+    if (segment.fileSlot >= 0)
+    {
+        m_freeSlots.push_back(segment.fileSlot);
+    }
+    m_segments.pop_front();
+    m_firstSeq += 1;
+
+    if (m_cacheSeq < m_firstSeq)
+    {
+        m_cacheSeq = -1;
+    }
+    if (m_readSeq < m_firstSeq)
+    {  // data was not played yet, playback continues from oldest data
+        m_readSeq = m_firstSeq;
+        m_readOffset = 0;
+    }
+}
+
+bool TimeShiftBuffer::moveToFile(Segment &segment)
+{
+    if (nullptr == m_file)
+    {
+        m_file = new QTemporaryFile(this);
+        if (!m_file->open())
+        {
+            qCWarning(timeShift) << "Unable to create time shift file:" << m_file->errorString();
+            delete m_file;
+            m_file = nullptr;
+            return false;
+        }
+        qCInfo(timeShift) << "Time shift file:" << m_file->fileName();
+    }
+
+    int slot;
+    if (m_freeSlots.empty())
+    {
+        slot = m_numSlots++;
+    }
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    if (!m_file->seek(qint64(slot) * TIMESHIFT_SEGMENT_BYTES) || (m_file->write(segment.data) != segment.size))
+    {
+        qCWarning(timeShift) << "Error writing time shift file:" << m_file->errorString();
+        m_freeSlots.push_back(slot);
+        return false;
+    }
+
+    segment.fileSlot = slot;
+    segment.data = QByteArray();
+    m_ramBytes -= TIMESHIFT_SEGMENT_BYTES;
+    return true;
+}
+
+const QByteArray &TimeShiftBuffer::segmentData(qint64 seq)
+{
+    const Segment &segment = m_segments[seq - m_firstSeq];
+    if (!segment.data.isEmpty() || (segment.fileSlot < 0))
+    {
+        return segment.data;
+    }
+
+    if (seq != m_cacheSeq)
+    {
+        m_cache.clear();
+        if (m_file->seek(qint64(segment.fileSlot) * TIMESHIFT_SEGMENT_BYTES))
+        {
+            m_cache = m_file->read(segment.size);
+        }
+        if (m_cache.size() != segment.size)
+        {
+            qCWarning(timeShift) << "Error reading time shift file:" << m_file->errorString();
+        }
+        m_cacheSeq = seq;
+    }
+    return m_cache;
+}
+
+void TimeShiftBuffer::seek(qint64 timestampMs)
+{
+    if (m_segments.empty())
+    {
+        return;
+    }
+
+    // find last segment that starts before timestamp
+    m_readSeq = m_firstSeq;
+    for (qint64 seq = endSeq() - 1; seq >= m_firstSeq; --seq)
+    {
+        if (m_segments[seq - m_firstSeq].startMs <= timestampMs)
+        {
+            m_readSeq = seq;
+            break;
+        }
+    }
+
+    // find first record with timestamp >= timestampMs
+    const QByteArray &data = segmentData(m_readSeq);
+    m_readOffset = 0;
+    while (m_readOffset + RecordHeaderBytes <= data.size())
+    {
+        const uint8_t *header = reinterpret_cast<const uint8_t *>(data.constData()) + m_readOffset;
+        qint64 recordMs;
+        memcpy(&recordMs, header, sizeof(recordMs));
+        if (recordMs >= timestampMs)
+        {
+            break;
+        }
+        m_readOffset += RecordHeaderBytes + (header[12] | (header[13] << 8));
+    }
+}
+
+void TimeShiftBuffer::play()
+{
+    m_playTimer->stop();
+    if (m_isPaused || isLive())
+    {
+        return;
+    }
+
+    qint64 now = timestamp();
+    qint64 nextMs = playUntil(now - m_delayMs);
+    if (nextMs >= 0)
+    {
+        m_playTimer->start(qMax(qint64(0), nextMs + m_delayMs - now));
+    }
+    else
+    { /* all data played, next record is scheduled when received */
+    }
+}
+
+qint64 TimeShiftBuffer::playUntil(qint64 timestampMs)
+{
+    while (m_readSeq < endSeq())
+    {
+        const QByteArray &data = segmentData(m_readSeq);
+        if (m_readOffset + RecordHeaderBytes > data.size())
+        {  // end of segment
+            if (m_readSeq + 1 == endSeq())
+            {  // all data played
+                break;
+            }
+            m_readSeq += 1;
+            m_readOffset = 0;
+            continue;
+        }
+
+        const uint8_t *header = reinterpret_cast<const uint8_t *>(data.constData()) + m_readOffset;
+        qint64 recordMs;
+        memcpy(&recordMs, header, sizeof(recordMs));
+        if (recordMs > timestampMs)
+        {
+            return recordMs;
+        }
+        int dataSize = header[12] | (header[13] << 8);
+        if (m_readOffset + RecordHeaderBytes + dataSize > data.size())
+        {  // corrupted record (file read error) -> skip rest of segment
+            m_readOffset = data.size();
+            continue;
+        }
+
+        RadioControlAudioData *outData = new RadioControlAudioData;
+        outData->id = static_cast<dabsdrDecoderId_t>(static_cast<int8_t>(header[8]));
+        outData->ASCTy = static_cast<DabAudioDataSCty>(header[9]);
+        outData->header.raw = header[10];
+        outData->onAir = header[11];
+        outData->data.assign(header + RecordHeaderBytes, header + RecordHeaderBytes + dataSize);
+        outData->timestampNs = LatencyTracer::timestamp();
+
+        m_readOffset += RecordHeaderBytes + dataSize;
+
+        emit audioData(outData);
+    }
+    return -1;
+}
+
+void TimeShiftBuffer::setToLive()
+{
+    m_playTimer->stop();
+    if (m_segments.empty())
+    {
+        m_readSeq = m_firstSeq;
+        m_readOffset = 0;
+        return;
+    }
+    m_readSeq = endSeq() - 1;
+    m_readOffset = m_segments.back().size;
+}
+
+void TimeShiftBuffer::notifyState()
+{
+    qint64 delayMs = m_isPaused ? m_delayMs + timestamp() - m_pauseStartMs : m_delayMs;
+    emit stateChanged(m_isPaused, delayMs, availableMs());
+}
@@ -0,0 +1,132 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TIMESHIFTBUFFER_H
+#define TIMESHIFTBUFFER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QTemporaryFile>
+#include <QTimer>
+#include <deque>
+
+#include "latencytracer.h"
+#include "radiocontrol.h"
+
+#define TIMESHIFT_SEGMENT_BYTES (256 * 1024)  // storage unit, segments over RAM budget are moved to disk
+#define TIMESHIFT_SKIP_SEC (10)               // rewind / forward step used by HMI
+#define TIMESHIFT_METADATA_BUDGET_DIV (8)     // 1/8 of RAM budget is reserved for delayed metadata (slides)
+
+// Time-shift buffer for pause and rewind of live radio
+// Stores received access units (MP2 frames or AAC AUs) with their header in compressed form,
+// so one hour of DAB+ audio requires only tens of MB. Newest segments are kept in RAM,
+// segments over RAM budget are moved to temporary file, segments older than buffer length are dropped.
+// Buffer is placed between RadioControl and AudioDecoder and it lives in audio decoder thread.
+// In live mode data is passed to decoder directly, otherwise stored data is passed to decoder
+// with the same timing as it was received, shifted by current delay. Shifted playback is driven by timer
+// scheduled to the next stored record, so it continues when live reception stops.
+class TimeShiftBuffer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TimeShiftBuffer(QObject *parent = nullptr);
+
+    // monotonic time used to timestamp audio data and metadata [ms]
+    static qint64 timestamp();
+
+    // part of RAM budget used by delayed metadata, the rest is used by audio
+    static qint64 metadataBudgetBytes(int ramBudgetMB) { return qint64(ramBudgetMB) * 1024 * 1024 / TIMESHIFT_METADATA_BUDGET_DIV; }
+
+    // lengthMin == 0 disables time shift, data is always passed to decoder directly
+    void setup(int lengthMin, int ramBudgetMB);
+    void reset();
+    void onAudioData(RadioControlAudioData *inData);
+
+    void pause();
+    void resume();
+    // positive value moves playback towards live, negative rewinds
+    void skip(int seconds);
+    void jumpToLive();
+
+signals:
+    void audioData(RadioControlAudioData *inData);
+
+    // delayMs is playback delay behind live at the time of the signal, it grows while paused
+    void stateChanged(bool isPaused, qint64 delayMs, qint64 availableMs);
+
+private:
+    struct Segment
+    {
+        qint64 startMs;
+        qint64 endMs;
+        QByteArray data;  // empty when segment is stored in file
+        int size = 0;
+        int fileSlot = -1;
+    };
+
+    enum
+    {
+        RecordHeaderBytes = 14  // timestamp [8], id, ASCTy, header, onAir, size [2]
+    };
+
+    qint64 m_lengthMs = 0;
+    qint64 m_ramBudgetBytes = 0;
+    qint64 m_ramBytes = 0;
+    std::deque<Segment> m_segments;
+    qint64 m_firstSeq = 0;  // sequence number of m_segments.front()
+
+    // disk storage
+    QTemporaryFile *m_file = nullptr;
+    std::vector<int> m_freeSlots;
+    int m_numSlots = 0;
+    qint64 m_cacheSeq = -1;  // segment loaded from file for reading
+    QByteArray m_cache;
+
+    // playback
+    bool m_isPaused = false;
+    qint64 m_delayMs = 0;
+    qint64 m_pauseStartMs = 0;
+    qint64 m_readSeq = 0;
+    int m_readOffset = 0;
+    QTimer *m_playTimer = nullptr;
+
+    bool isLive() const { return !m_isPaused && (0 == m_delayMs); }
+    qint64 endSeq() const { return m_firstSeq + m_segments.size(); }
+    qint64 availableMs() const;
+    void store(const RadioControlAudioData *inData, qint64 timestampMs);
+    void dropOld(qint64 nowMs);
+    void popFront();
+    bool moveToFile(Segment &segment);
+    const QByteArray &segmentData(qint64 seq);
+    void seek(qint64 timestampMs);
+    void play();
+    // returns timestamp of next record, -1 if all stored data was played
+    qint64 playUntil(qint64 timestampMs);
+    void setToLive();
+    void notifyState();
+};
+
+#endif  // TIMESHIFTBUFFER_H
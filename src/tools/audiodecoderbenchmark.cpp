@@ -0,0 +1,366 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "audiodecoder.h"
+#include "audiorecorder.h"
+#include "config.h"
+#if HAVE_FDKAAC
+#include "audiodecoderfdkaac.h"
+#endif
+#if HAVE_FAAD
+#include "audiodecoderfaad.h"
+#endif
+
+// Decoder throughput benchmark
+// Input is raw MP2 or LATM framed AAC file as written by AudioRecorder (writeMP2() / writeAAC()).
+// Access units are read back, RadioControlAudioData frames are rebuilt and passed to AudioDecoder
+// as fast as possible. Output FIFO is drained synchronously after each frame, so decoder never waits.
+
+namespace
+{
+struct BenchmarkFrame
+{
+    DabAudioDataSCty ASCTy;
+    dabsdrAudioFrameHeader_t header;
+    std::vector<uint8_t> data;
+    double durationMs;
+};
+
+class BitReader
+{
+public:
+    BitReader(const uint8_t *data, size_t size) : m_data(data), m_sizeBits(size * 8) {}
+    bool isValid() const { return m_pos <= m_sizeBits; }
+    uint32_t read(int numBits)
+    {
+        uint32_t val = 0;
+        for (int n = 0; n < numBits; ++n)
+        {
+            val <<= 1;
+            if (m_pos < m_sizeBits)
+            {
+                val |= (m_data[m_pos >> 3] >> (7 - (m_pos & 0x7))) & 0x1;
+            }
+            m_pos += 1;
+        }
+        return val;
+    }
+
+private:
+    const uint8_t *m_data;
+    size_t m_sizeBits;
+    size_t m_pos = 0;
+};
+
+// inverse of AudioRecorder::writeMP2(), frames are split using MPEG audio layer II header
+bool readMP2(const QByteArray &file, std::vector<BenchmarkFrame> &frames)
+{
+    static const int bitRateMPEG1[] = {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 0};
+    static const int bitRateMPEG2[] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+    static const int sampleRateMPEG1[] = {44100, 48000, 32000, 0};
+
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(file.constData());
+    qsizetype pos = 0;
+    while (pos + 4 <= file.size())
+    {
+        if ((data[pos] != 0xFF) || ((data[pos + 1] & 0xF6) != 0xF4))
+        {  // not synced, layer II only
+            pos += 1;
+            continue;
+        }
+        bool isMPEG1 = (data[pos + 1] & 0x08) != 0;
+        int bitRateIdx = data[pos + 2] >> 4;
+        int sampleRateIdx = (data[pos + 2] >> 2) & 0x3;
+        int padding = (data[pos + 2] >> 1) & 0x1;
+        int bitRate = isMPEG1 ? bitRateMPEG1[bitRateIdx] : bitRateMPEG2[bitRateIdx];
+        int sampleRate = sampleRateMPEG1[sampleRateIdx] / (isMPEG1 ? 1 : 2);
+        if ((0 == bitRate) || (0 == sampleRate))
+        {
+            pos += 1;
+            continue;
+        }
+        qsizetype frameLen = 144 * bitRate * 1000 / sampleRate + padding;
+        if (pos + frameLen > file.size())
+        {
+            break;
+        }
+
+        BenchmarkFrame frame;
+        frame.ASCTy = DabAudioDataSCty::DAB_AUDIO;
+        frame.header.raw = 0;
+        frame.data.assign(data + pos, data + pos + frameLen);
+        frame.durationMs = 1152 * 1000.0 / sampleRate;
+        frames.push_back(std::move(frame));
+        pos += frameLen;
+    }
+    return !frames.empty();
+}
+
+// inverse of AudioRecorder::writeAAC(), header is reconstructed from StreamMuxConfig
+bool readAAC(const QByteArray &file, bool psFlag, std::vector<BenchmarkFrame> &frames)
+{
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(file.constData());
+    qsizetype pos = 0;
+    while (pos + 3 <= file.size())
+    {
+        if ((data[pos] != 0x56) || ((data[pos + 1] & 0xE0) != 0xE0))
+        {  // not synced
+            pos += 1;
+            continue;
+        }
+        qsizetype frameLen = 3 + (((data[pos + 1] & 0x1F) << 8) | data[pos + 2]);
+        if (pos + frameLen > file.size())
+        {
+            break;
+        }
+
+        BitReader reader(data + pos, frameLen);
+        reader.read(11 + 13);  // syncword, audioMuxLengthBytes
+        reader.read(16);       // useSameStreamMux ... numLayer
+        int aot = reader.read(5);
+        int srIdx = reader.read(4);
+        int channelConfig = reader.read(4);
+        bool sbr = (5 == aot);
+        if (sbr)
+        {
+            reader.read(4);  // extension sample rate index
+            aot = reader.read(5);
+        }
+        reader.read(3);      // GASpecificConfig()
+        reader.read(3);      // frameLengthType
+        reader.read(8);      // latmBufferFullness
+        reader.read(1 + 1);  // otherDataPresent, crcCheckPresent
+
+        int auSize = 0;
+        uint32_t tmp;
+        do
+        {
+            tmp = reader.read(8);
+            auSize += tmp;
+        } while (0xFF == tmp);
+
+        dabsdrAudioFrameHeader_t header;
+        header.raw = 0;
+        header.bits.sbr_flag = sbr;
+        header.bits.ps_flag = sbr && psFlag;
+        header.bits.aac_channel_mode = (channelConfig == 2);
+        header.bits.dac_rate = (sbr ? (0x6 == srIdx) : (0x3 == srIdx));
+
+        if ((2 == aot) && reader.isValid())
+        {
+            BenchmarkFrame frame;
+            frame.ASCTy = DabAudioDataSCty::DABPLUS_AUDIO;
+            frame.header = header;
+            frame.data.resize(auSize);
+            for (int n = 0; n < auSize; ++n)
+            {
+                frame.data[n] = reader.read(8);
+            }
+            frame.durationMs = (header.bits.dac_rate ? 20.0 : 30.0) * (sbr ? 2 : 1);
+            if (reader.isValid())
+            {
+                frames.push_back(std::move(frame));
+            }
+        }
+        pos += frameLen;
+    }
+    return !frames.empty();
+}
+
+void drainFifo(audioFifo_t &fifo)
+{
+    int64_t count = fifo.count.load();
+    if (count > 0)
+    {
+        fifo.latencyStamps.pop(count, count);
+        fifo.tail = (fifo.tail + count) % fifo.size;
+        fifo.commitRead(count);
+    }
+}
+
+double percentile(const std::vector<double> &sorted, double p)
+{
+    size_t idx = std::min(sorted.size() - 1, size_t(p / 100.0 * (sorted.size() - 1) + 0.5));
+    return sorted[idx];
+}
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("audiodecoderbenchmark");
+
+    QCommandLineParser parser;
+#if (!HAVE_FAAD)
+    const QString aacDecoderList = "FDK-AAC";
+#elif (!HAVE_FDKAAC)
+    const QString aacDecoderList = "FAAD2";
+#else
+    const QString aacDecoderList = "FAAD2 or FDK-AAC";
+#endif
+    parser.setApplicationDescription(
+        QString("Audio decoder benchmark (MP2: mpg123, AAC: %1). Decodes MP2 or AAC files recorded by AbracaDABra.").arg(aacDecoderList));
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Recorded .mp2 or .aac file.");
+    QCommandLineOption repeatOption(QStringList() << "r" << "repeat", "Number of passes through the file (default 1).", "count", "1");
+    parser.addOption(repeatOption);
+    QCommandLineOption psOption(QStringList() << "p" << "ps", "AAC file is HE-AAC v2 (PS is not signalled in recorded file).");
+    parser.addOption(psOption);
+    QCommandLineOption noiseOption(QStringList() << "n" << "noise-level", "Noise concealment level in dB, 0 means silence (default 0).", "dB",
+                                   "0");
+    parser.addOption(noiseOption);
+#if (HAVE_FAAD && HAVE_FDKAAC)
+    QCommandLineOption decoderOption(QStringList() << "d" << "decoder", "AAC decoder: faad or fdk (default fdk).", "decoder", "fdk");
+    parser.addOption(decoderOption);
+#endif
+    parser.process(app);
+
+    QTextStream out(stdout);
+    if (parser.positionalArguments().size() != 1)
+    {
+        parser.showHelp(1);
+    }
+
+    QFile file(parser.positionalArguments().at(0));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        out << "Unable to open file: " << file.fileName() << Qt::endl;
+        return 1;
+    }
+    QByteArray fileData = file.readAll();
+    file.close();
+
+    std::vector<BenchmarkFrame> frames;
+    if (!readAAC(fileData, parser.isSet(psOption), frames) && !readMP2(fileData, frames))
+    {
+        out << "No MP2 or AAC frames found in file: " << file.fileName() << Qt::endl;
+        return 1;
+    }
+    int numPasses = qMax(1, parser.value(repeatOption).toInt());
+
+    audioFifo[0].allocate(AUDIO_FIFO_CHUNK_MS);
+    audioFifo[1].allocate(AUDIO_FIFO_CHUNK_MS);
+
+    AudioRecorder recorder;
+    std::unique_ptr<AudioDecoder> decoderPtr;
+    QString aacDecoderName;
+#if (!HAVE_FAAD)
+    decoderPtr.reset(new AudioDecoderFDKAAC(&recorder));
+    aacDecoderName = "FDK-AAC";
+#elif (!HAVE_FDKAAC)
+    decoderPtr.reset(new AudioDecoderFAAD(&recorder));
+    aacDecoderName = "FAAD2";
+#else
+    QString decoderName = parser.value(decoderOption).toLower();
+    if ("fdk" == decoderName)
+    {
+        decoderPtr.reset(new AudioDecoderFDKAAC(&recorder));
+        aacDecoderName = "FDK-AAC";
+    }
+    else if ("faad" == decoderName)
+    {
+        decoderPtr.reset(new AudioDecoderFAAD(&recorder));
+        aacDecoderName = "FAAD2";
+    }
+    else
+    {
+        out << "Unknown AAC decoder: " << decoderName << " (expected faad or fdk)" << Qt::endl;
+        return 1;
+    }
+#endif
+    AudioDecoder &decoder = *decoderPtr;
+    decoder.setNoiseConcealment(parser.value(noiseOption).toInt());
+
+    AudioParameters params;
+    params.coding = AudioCoding::None;
+    QObject::connect(&decoder, &AudioDecoder::audioParametersInfo, [&params](const AudioParameters &p) { params = p; });
+
+    RadioControlServiceComponent s;
+    s.TMId = DabTMId::StreamAudio;
+    s.streamAudioData.scType = frames.front().ASCTy;
+    decoder.start(s);
+
+    std::vector<double> frameTimeUs;
+    frameTimeUs.reserve(frames.size() * numPasses);
+    double audioMs = 0.0;
+    double totalUs = 0.0;
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+        for (const BenchmarkFrame &frame : frames)
+        {
+            RadioControlAudioData *inData = new RadioControlAudioData;
+            inData->id = DABSDR_ID_AUDIO_PRIMARY;
+            inData->ASCTy = frame.ASCTy;
+            inData->header = frame.header;
+            inData->data = frame.data;
+            inData->timestampNs = LatencyTracer::timestamp();
+            inData->onAir = true;
+
+            auto start = std::chrono::steady_clock::now();
+            decoder.decodeData(inData);
+            auto stop = std::chrono::steady_clock::now();
+
+            double us = std::chrono::duration<double, std::micro>(stop - start).count();
+            frameTimeUs.push_back(us);
+            totalUs += us;
+            audioMs += frame.durationMs;
+
+            drainFifo(audioFifo[0]);
+            drainFifo(audioFifo[1]);
+        }
+    }
+    decoder.stop();
+
+    std::sort(frameTimeUs.begin(), frameTimeUs.end());
+
+    static const char *codingName[] = {"MP2", "AAC-LC", "HE-AAC", "HE-AAC v2"};
+    out << "File:            " << file.fileName() << Qt::endl;
+    out << "Decoder:         " << ((DabAudioDataSCty::DAB_AUDIO == frames.front().ASCTy) ? QString("mpg123") : aacDecoderName) << Qt::endl;
+    if (AudioCoding::None != params.coding)
+    {
+        out << "Format:          " << codingName[int(params.coding)] << " " << params.sampleRateKHz << " kHz "
+            << (params.stereo ? "stereo" : "mono") << Qt::endl;
+    }
+    out << "Frames:          " << frameTimeUs.size() << " (" << numPasses << " passes)" << Qt::endl;
+    out << "Audio duration:  " << QString::number(audioMs / 1000.0, 'f', 2) << " s" << Qt::endl;
+    out << "Decoding time:   " << QString::number(totalUs / 1000000.0, 'f', 3) << " s" << Qt::endl;
+    out << "Realtime factor: " << QString::number(audioMs * 1000.0 / totalUs, 'f', 1) << "x" << Qt::endl;
+    out << "Frame time [us]: "
+        << "p50 " << QString::number(percentile(frameTimeUs, 50), 'f', 1) << ", p90 " << QString::number(percentile(frameTimeUs, 90), 'f', 1)
+        << ", p99 " << QString::number(percentile(frameTimeUs, 99), 'f', 1) << ", max " << QString::number(frameTimeUs.back(), 'f', 1)
+        << Qt::endl;
+
+    return 0;
+}
@@ -0,0 +1,339 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "audiodsp.h"
+
+// Test of audio sample processing kernels
+// Vectorized kernels are compared with plain scalar reference for lengths that exercise both the vector loop
+// and the scalar tail (not multiple of 8), including rounding ties and saturation.
+// Ramps are compared with reference formulas. At the end, throughput of vectorized and reference gain is printed.
+// Returns 0 if all checks passed.
+
+namespace
+{
+const size_t testLengths[] = {0, 1, 3, 7, 8, 9, 15, 16, 17, 31, 1000, 1027};
+
+int numFailed = 0;
+
+void check(bool ok, const char *name, size_t length)
+{
+    if (!ok)
+    {
+        std::printf("FAILED: %s, length %zu\n", name, length);
+        numFailed += 1;
+    }
+}
+
+// reference rounding to nearest, half to even, with saturation
+int16_t refSaturate(float x)
+{
+    if (x >= 32767.0f)
+    {
+        return 32767;
+    }
+    if (x <= -32768.0f)
+    {
+        return -32768;
+    }
+    float r = std::floor(x);
+    float diff = x - r;
+    if ((diff > 0.5f) || ((diff == 0.5f) && (std::fmod(r, 2.0f) != 0.0f)))
+    {
+        r += 1.0f;
+    }
+    return int16_t(r);
+}
+
+std::vector<int16_t> randomInt16(std::mt19937 &gen, size_t length)
+{
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<int16_t> ret(length);
+    for (size_t n = 0; n < length; ++n)
+    {
+        ret[n] = int16_t(dist(gen));
+    }
+    if (length > 2)
+    {  // extremes
+        ret[0] = -32768;
+        ret[length - 1] = 32767;
+    }
+    return ret;
+}
+
+std::vector<float> randomFloat(std::mt19937 &gen, size_t length)
+{
+    std::uniform_real_distribution<float> dist(-1.25f, 1.25f);  // includes values out of range
+    std::vector<float> ret(length);
+    for (size_t n = 0; n < length; ++n)
+    {
+        if (n % 3 == 0)
+        {  // exact rounding tie after scaling
+            ret[n] = (std::floor(dist(gen) * 32768.0f) + 0.5f) / 32768.0f;
+        }
+        else
+        {
+            ret[n] = dist(gen);
+        }
+    }
+    return ret;
+}
+
+void testGain(std::mt19937 &gen)
+{
+    // 0.5 creates rounding ties for odd input, 2.5 saturates
+    const float gains[] = {0.0f, 0.5f, 0.7071f, 1.0f, 2.5f, -1.0f};
+    for (size_t length : testLengths)
+    {
+        for (float g : gains)
+        {
+            std::vector<int16_t> in = randomInt16(gen, length);
+            std::vector<int16_t> out(length);
+            AudioDsp::gain(out.data(), in.data(), length, g);
+            bool ok = true;
+            for (size_t n = 0; n < length; ++n)
+            {
+                ok = ok && (out[n] == refSaturate(g * in[n]));
+            }
+            check(ok, "int16 gain", length);
+
+            // in place
+            std::vector<int16_t> data = in;
+            AudioDsp::gain(data.data(), length, g);
+            check(data == out, "int16 gain in place", length);
+
+            std::vector<float> inF = randomFloat(gen, length);
+            std::vector<float> outF(length);
+            AudioDsp::gain(outF.data(), inF.data(), length, g);
+            ok = true;
+            for (size_t n = 0; n < length; ++n)
+            {
+                ok = ok && (outF[n] == g * inF[n]);
+            }
+            check(ok, "float gain", length);
+        }
+    }
+}
+
+void testConversion(std::mt19937 &gen)
+{
+    for (size_t length : testLengths)
+    {
+        std::vector<float> in = randomFloat(gen, length);
+        std::vector<int16_t> out(length);
+        AudioDsp::toInt16(out.data(), in.data(), length);
+        bool ok = true;
+        for (size_t n = 0; n < length; ++n)
+        {
+            ok = ok && (out[n] == refSaturate(32768.0f * in[n]));
+        }
+        check(ok, "toInt16", length);
+
+        std::vector<int16_t> inI = randomInt16(gen, length);
+        std::vector<float> outF(length);
+        AudioDsp::toFloat(outF.data(), inI.data(), length);
+        ok = true;
+        for (size_t n = 0; n < length; ++n)
+        {
+            ok = ok && (outF[n] == inI[n] / 32768.0f);
+        }
+        check(ok, "toFloat", length);
+    }
+
+    // saturate itself
+    const float ties[] = {0.5f, 1.5f, 2.5f, -0.5f, -1.5f, -2.5f, 32766.5f, -32767.5f, 40000.0f, -40000.0f};
+    for (float x : ties)
+    {
+        check(AudioDsp::saturate(x) == refSaturate(x), "saturate", 1);
+    }
+}
+
+void testRamps(std::mt19937 &gen)
+{
+    const int channels[] = {1, 2};
+    std::uniform_real_distribution<float> rampDist(0.0f, 1.0f);
+    for (size_t numFrames : testLengths)
+    {
+        for (int numChannels : channels)
+        {
+            size_t length = numFrames * numChannels;
+            std::vector<float> ramp(numFrames);
+            for (auto &r : ramp)
+            {
+                r = rampDist(gen);
+            }
+
+            // exponential ramp
+            std::vector<int16_t> in = randomInt16(gen, length);
+            std::vector<int16_t> data = in;
+            const float coe = 0.99f;
+            float g = AudioDsp::expRamp(data.data(), numFrames, numChannels, 0.9f, coe);
+            float refG = 0.9f;
+            bool ok = true;
+            for (size_t n = 0; n < numFrames; ++n)
+            {
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    ok = ok && (data[n * numChannels + c] == refSaturate(refG * in[n * numChannels + c]));
+                }
+                refG = refG * coe;
+            }
+            check(ok && (g == refG), "int16 expRamp", length);
+
+            std::vector<float> inF = randomFloat(gen, length);
+            std::vector<float> dataF = inF;
+            g = AudioDsp::expRamp(dataF.data(), numFrames, numChannels, 0.9f, coe);
+            refG = 0.9f;
+            ok = true;
+            for (size_t n = 0; n < numFrames; ++n)
+            {
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    ok = ok && (dataF[n * numChannels + c] == refG * inF[n * numChannels + c]);
+                }
+                refG = refG * coe;
+            }
+            check(ok && (g == refG), "float expRamp", length);
+
+            // table ramp, both directions
+            for (bool reverse : {false, true})
+            {
+                data = in;
+                AudioDsp::tableRamp(data.data(), ramp.data(), numFrames, numChannels, reverse);
+                dataF = inF;
+                AudioDsp::tableRamp(dataF.data(), ramp.data(), numFrames, numChannels, reverse);
+                ok = true;
+                bool okF = true;
+                for (size_t n = 0; n < numFrames; ++n)
+                {
+                    float r = reverse ? ramp[numFrames - 1 - n] : ramp[n];
+                    for (int c = 0; c < numChannels; ++c)
+                    {
+                        size_t idx = n * numChannels + c;
+                        ok = ok && (data[idx] == refSaturate(r * in[idx]));
+                        okF = okF && (dataF[idx] == r * inF[idx]);
+                    }
+                }
+                check(ok, reverse ? "int16 tableRamp reverse" : "int16 tableRamp", length);
+                check(okF, reverse ? "float tableRamp reverse" : "float tableRamp", length);
+            }
+
+            // table ramp with noise, noise is used in processing order
+            std::vector<int16_t> noise = randomInt16(gen, length);
+            const float noiseLevel = 0.25f;
+            for (bool reverse : {false, true})
+            {
+                data = in;
+                AudioDsp::tableRampNoiseMix(data.data(), ramp.data(), noise.data(), noiseLevel, numFrames, numChannels, reverse);
+                ok = true;
+                for (size_t n = 0; n < numFrames; ++n)
+                {
+                    size_t frame = reverse ? numFrames - 1 - n : n;
+                    float r = ramp[n];
+                    for (int c = 0; c < numChannels; ++c)
+                    {
+                        size_t idx = frame * numChannels + c;
+                        float expected = r * in[idx] + (1 - r) * noiseLevel * noise[n * numChannels + c];
+                        ok = ok && (data[idx] == refSaturate(expected));
+                    }
+                }
+                check(ok, reverse ? "int16 tableRampNoiseMix reverse" : "int16 tableRampNoiseMix", length);
+            }
+        }
+    }
+}
+
+template <typename F>
+double measureNsPerSample(size_t numSamples, int numPasses, F func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+        func();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (double(numSamples) * numPasses);
+}
+
+void benchmark(std::mt19937 &gen)
+{
+    const size_t numSamples = 1 << 20;
+    const int numPasses = 20;
+    std::vector<int16_t> in = randomInt16(gen, numSamples);
+    std::vector<int16_t> out(numSamples);
+    std::vector<float> inF = randomFloat(gen, numSamples);
+
+    double kernel = measureNsPerSample(numSamples, numPasses, [&]() { AudioDsp::gain(out.data(), in.data(), numSamples, 0.7071f); });
+    double reference = measureNsPerSample(numSamples, numPasses,
+                                          [&]()
+                                          {
+                                              for (size_t n = 0; n < numSamples; ++n)
+                                              {
+                                                  out[n] = refSaturate(0.7071f * in[n]);
+                                              }
+                                          });
+    std::printf("int16 gain: %.3f ns/sample (reference %.3f ns/sample)\n", kernel, reference);
+
+    kernel = measureNsPerSample(numSamples, numPasses, [&]() { AudioDsp::toInt16(out.data(), inF.data(), numSamples); });
+    reference = measureNsPerSample(numSamples, numPasses,
+                                   [&]()
+                                   {
+                                       for (size_t n = 0; n < numSamples; ++n)
+                                       {
+                                           out[n] = refSaturate(32768.0f * inF[n]);
+                                       }
+                                   });
+    std::printf("toInt16:    %.3f ns/sample (reference %.3f ns/sample)\n", kernel, reference);
+}
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    std::mt19937 gen(12345);
+
+    testGain(gen);
+    testConversion(gen);
+    testRamps(gen);
+
+    if ((argc > 1) && (0 == std::strcmp(argv[1], "--benchmark")))
+    {
+        benchmark(gen);
+    }
+
+    if (numFailed > 0)
+    {
+        std::printf("%d checks failed\n", numFailed);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
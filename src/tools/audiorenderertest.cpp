@@ -0,0 +1,275 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <QLoggingCategory>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "audiorenderer.h"
+
+Q_LOGGING_CATEGORY(audioOutput, "AudioOutput", QtInfoMsg)
+
+// Test of AudioRenderer state machine
+// Renderer reads from synthetic FIFO with known content, output and FIFO state are checked after each render() call:
+// unmute when jitter buffer target is reached, mute ramp on underrun, hard mute when less than 1 ms is available,
+// FIFO wrap in underrun copy and FIFO draining while muted on request.
+// Returns 0 if all checks passed.
+
+namespace
+{
+const uint32_t sampleRate_kHz = 48;
+const uint8_t numChannels = 2;
+const uint32_t bytesPerFrame = numChannels * sizeof(audioSample_t);
+const uint32_t chunkMs = 60;
+const uint32_t jitterChunks = 3;  // target is 180 ms
+const uint32_t renderFrames = 1024;
+const float level = 0.5;  // sample value written to FIFO, relative to full scale
+
+int numFailed = 0;
+
+void check(bool ok, const char *test, const char *name)
+{
+    if (!ok)
+    {
+        std::printf("FAILED: %s, %s\n", test, name);
+        numFailed += 1;
+    }
+}
+
+audioSample_t toSample(float x)
+{
+#if USE_FLOAT_AUDIO
+    return x;
+#else
+    return audioSample_t(x * 32767);
+#endif
+}
+
+// FIFO content is set directly: numFrames frames starting at tail, frames before splitFrame have value a, rest has value b
+void fill(audioFifo_t &fifo, int64_t tail, uint32_t numFrames, float a, float b, uint32_t splitFrame)
+{
+    fifo.tail = tail;
+    int64_t pos = tail;
+    for (uint32_t n = 0; n < numFrames; ++n)
+    {
+        audioSample_t value = toSample((n < splitFrame) ? a : b);
+        for (uint8_t c = 0; c < numChannels; ++c)
+        {
+            memcpy(fifo.buffer + pos, &value, sizeof(value));
+            pos = (pos + sizeof(value)) % fifo.size;
+        }
+    }
+    fifo.head = pos;
+    fifo.count = int64_t(numFrames) * bytesPerFrame;
+}
+
+void fill(audioFifo_t &fifo, uint32_t numFrames)
+{
+    fill(fifo, 0, numFrames, level, level, numFrames);
+}
+
+uint32_t fifoFrames(const audioFifo_t &fifo)
+{
+    return fifo.count.load() / bytesPerFrame;
+}
+
+bool isSilence(const audioSample_t *data, uint32_t numFrames)
+{
+    for (uint32_t n = 0; n < numFrames * numChannels; ++n)
+    {
+        if (data[n] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// renderer in playing state, FIFO is filled to target and one buffer was rendered
+void startPlaying(AudioRenderer &renderer, audioFifo_t &fifo, std::vector<audioSample_t> &out)
+{
+    renderer.init(sampleRate_kHz, numChannels, chunkMs, fifo.sizeMs());
+    renderer.start(&fifo);
+    fill(fifo, jitterChunks * chunkMs * sampleRate_kHz + renderFrames);
+    renderer.render(out.data(), renderFrames, false);
+}
+
+void testUnmute(audioFifo_t &fifo)
+{
+    const char *test = "unmute";
+    std::vector<audioSample_t> out(renderFrames * numChannels, 1);
+    AudioRenderer renderer(jitterChunks);
+    renderer.init(sampleRate_kHz, numChannels, chunkMs, fifo.sizeMs());
+    renderer.start(&fifo);
+
+    // below jitter buffer target => silence, nothing consumed
+    uint32_t frames = (jitterChunks * chunkMs - 1) * sampleRate_kHz;
+    fill(fifo, frames);
+    renderer.render(out.data(), renderFrames, false);
+    check(renderer.isMuted(), test, "muted below target");
+    check(isSilence(out.data(), renderFrames), test, "silence below target");
+    check(fifoFrames(fifo) == frames, test, "FIFO not consumed below target");
+
+    // target reached => unmuted with ramp from silence
+    frames = jitterChunks * chunkMs * sampleRate_kHz + renderFrames;
+    fill(fifo, frames);
+    renderer.render(out.data(), renderFrames, false);
+    check(!renderer.isMuted(), test, "playing at target");
+    check(renderer.statistics().unmuteRamps == 1, test, "unmute ramp counted");
+    check(std::abs(float(out[0])) < std::abs(float(toSample(level))) * 0.01, test, "ramp starts at silence");
+    check(out[(renderFrames - 1) * numChannels] > out[0], test, "ramp rises");
+    check(fifoFrames(fifo) < frames, test, "FIFO consumed when playing");
+
+    // next buffer is played without ramp
+    renderer.render(out.data(), renderFrames, false);
+    check(!renderer.isMuted(), test, "playing continues");
+    check(out[0] == toSample(level), test, "full level after ramp");
+    check(renderer.statistics().unmuteRamps == 1, test, "single unmute ramp");
+}
+
+void testUnderrun(audioFifo_t &fifo)
+{
+    const char *test = "underrun";
+    std::vector<audioSample_t> out(renderFrames * numChannels);
+    AudioRenderer renderer(jitterChunks);
+    startPlaying(renderer, fifo, out);
+
+    // 10 ms available => samples are played with mute ramp, rest is silence
+    uint32_t frames = 10 * sampleRate_kHz;
+    fill(fifo, frames);
+    renderer.render(out.data(), renderFrames, false);
+    AudioRenderer::Statistics stats = renderer.statistics();
+    check(renderer.isMuted(), test, "muted");
+    check(stats.underruns == 1, test, "underrun counted");
+    check(stats.muteRamps == 1, test, "mute ramp counted");
+    check(stats.hardMutes == 0, test, "no hard mute");
+    check(fifoFrames(fifo) == 0, test, "all available samples consumed");
+    check(out[0] > 0, test, "ramp starts with signal");
+    check(std::abs(float(out[(frames - 1) * numChannels])) <= std::abs(float(out[0])) * 0.001, test, "ramp ends at silence");
+    check(isSilence(out.data() + frames * numChannels, renderFrames - frames), test, "silence after ramp");
+}
+
+void testHardMute(audioFifo_t &fifo)
+{
+    const char *test = "hard mute";
+    std::vector<audioSample_t> out(renderFrames * numChannels);
+    AudioRenderer renderer(jitterChunks);
+    startPlaying(renderer, fifo, out);
+
+    // less than 1 ms available => no ramp is possible
+    uint32_t frames = sampleRate_kHz - 1;
+    fill(fifo, frames);
+    renderer.render(out.data(), renderFrames, false);
+    AudioRenderer::Statistics stats = renderer.statistics();
+    check(renderer.isMuted(), test, "muted");
+    check(stats.underruns == 1, test, "underrun counted");
+    check(stats.hardMutes == 1, test, "hard mute counted");
+    check(stats.muteRamps == 0, test, "no mute ramp");
+    check(isSilence(out.data(), renderFrames), test, "silence");
+    check(fifoFrames(fifo) == frames, test, "FIFO not consumed");
+}
+
+void testWrap(audioFifo_t &fifo)
+{
+    const char *test = "wrap";
+    std::vector<audioSample_t> out(renderFrames * numChannels);
+    AudioRenderer renderer(jitterChunks);
+    startPlaying(renderer, fifo, out);
+
+    // underrun data wraps around FIFO end: 100 frames positive before end, 200 frames negative after it
+    uint32_t framesToEnd = 100;
+    uint32_t frames = 300;
+    fill(fifo, fifo.size - framesToEnd * bytesPerFrame, frames, level, -level, framesToEnd);
+    renderer.render(out.data(), renderFrames, false);
+    check(renderer.isMuted(), test, "muted");
+    check(fifo.tail == int64_t(frames - framesToEnd) * bytesPerFrame, test, "tail wrapped");
+    check(fifoFrames(fifo) == 0, test, "all available samples consumed");
+    bool ok = true;
+    for (uint32_t n = 0; n < framesToEnd; ++n)
+    {
+        ok = ok && (out[n * numChannels] > 0) && (out[n * numChannels + 1] > 0);
+    }
+    check(ok, test, "data before FIFO end");
+    ok = true;
+    for (uint32_t n = framesToEnd; n < 2 * framesToEnd; ++n)
+    {
+        ok = ok && (out[n * numChannels] < 0) && (out[n * numChannels + 1] < 0);
+    }
+    check(ok, test, "data after FIFO end");
+    check(isSilence(out.data() + frames * numChannels, renderFrames - frames), test, "silence after ramp");
+}
+
+void testMutedDrain(audioFifo_t &fifo)
+{
+    const char *test = "muted drain";
+    std::vector<audioSample_t> out(renderFrames * numChannels, 1);
+    AudioRenderer renderer(jitterChunks);
+    renderer.init(sampleRate_kHz, numChannels, chunkMs, fifo.sizeMs());
+    renderer.start(&fifo);
+
+    // target reached but mute is requested => silence, FIFO is consumed so that decoder is not blocked
+    uint32_t frames = jitterChunks * chunkMs * sampleRate_kHz + 3 * renderFrames;
+    fill(fifo, frames);
+    for (int n = 0; n < 2; ++n)
+    {
+        renderer.render(out.data(), renderFrames, true);
+        check(renderer.isMuted(), test, "stays muted");
+        check(isSilence(out.data(), renderFrames), test, "silence");
+    }
+    check(fifoFrames(fifo) == frames - 2 * renderFrames, test, "FIFO drained by rendered frames");
+    check(fifo.tail == int64_t(2 * renderFrames) * bytesPerFrame, test, "tail moved");
+    check(renderer.statistics().unmuteRamps == 0, test, "no unmute ramp");
+
+    // mute request released => unmuted
+    renderer.render(out.data(), renderFrames, false);
+    check(!renderer.isMuted(), test, "unmuted after request");
+}
+}  // namespace
+
+int main()
+{
+    audioFifo_t fifo;
+    fifo.allocate(chunkMs);
+    fifo.sampleRate = sampleRate_kHz * 1000;
+    fifo.numChannels = numChannels;
+
+    testUnmute(fifo);
+    testUnderrun(fifo);
+    testHardMute(fifo);
+    testWrap(fifo);
+    testMutedDrain(fifo);
+
+    if (numFailed > 0)
+    {
+        std::printf("%d checks failed\n", numFailed);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
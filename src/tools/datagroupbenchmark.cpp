@@ -0,0 +1,262 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <chrono>
+
+#include "crc16.h"
+#include "dldecoder.h"
+#include "motdecoder.h"
+#include "mscdatagroup.h"
+#include "servicestreamplayer.h"
+
+// Data group parsing benchmark
+// Input is service stream file recorded by ServiceStreamRecorder. All MSC and DL data groups are read to memory first,
+// then CRC check, MSC data group parsing and complete MOT / DL decoding are timed over several passes.
+// Bitwise CRC implementation used before slicing-by-8 is included as a reference, results of both are compared.
+
+namespace
+{
+bool crc16checkBitwise(const QByteArray &data)
+{
+    uint16_t crc = 0xFFFF;
+    uint16_t mask = 0x1020;
+
+    for (int n = 0; n < data.size() - 2; ++n)
+    {
+        for (int bit = 7; bit >= 0; --bit)
+        {
+            uint16_t in = (data[n] >> bit) & 0x1;
+            uint16_t tmp = in ^ ((crc >> 15) & 0x1);
+            crc <<= 1;
+
+            crc ^= (tmp * mask);
+            crc += tmp;
+        }
+    }
+
+    uint16_t invTxCRC = ~((uint16_t(data[data.size() - 2]) << 8) | uint8_t(data[data.size() - 1]));
+
+    return (crc == invTxCRC);
+}
+
+template <typename F>
+double measureUs(int numPasses, F func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+        func();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(stop - start).count();
+}
+
+QString throughput(double us, int numPasses, qint64 numGroups, qint64 numBytes)
+{
+    return QString("%1 s, %2 data groups/s, %3 MB/s")
+        .arg(us / 1000000.0, 0, 'f', 3)
+        .arg(numGroups * numPasses * 1000000.0 / us, 0, 'f', 0)
+        .arg(numBytes * numPasses / us, 0, 'f', 1);
+}
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("datagroupbenchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Data group parsing benchmark. Parses MSC and DL data groups from service stream file recorded by AbracaDABra.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Recorded .adss file.");
+    QCommandLineOption repeatOption(QStringList() << "r" << "repeat", "Number of passes through the data groups (default 10).", "count", "10");
+    parser.addOption(repeatOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    if (parser.positionalArguments().size() != 1)
+    {
+        parser.showHelp(1);
+    }
+
+    ServiceStreamPlayer player;
+    if (!player.open(parser.positionalArguments().at(0)))
+    {
+        out << "Unable to open service stream file: " << parser.positionalArguments().at(0) << Qt::endl;
+        return 1;
+    }
+    player.setSpeed(0);
+    int numPasses = qMax(1, parser.value(repeatOption).toInt());
+
+    QList<RadioControlUserAppData> mscDataGroups;
+    QList<QByteArray> dlDataGroups;
+    qint64 mscBytes = 0;
+    qint64 dlBytes = 0;
+    QObject::connect(&player, &ServiceStreamPlayer::audioData, &app, [](RadioControlAudioData *pData) { delete pData; });
+    QObject::connect(&player, &ServiceStreamPlayer::userAppData_Service, &app,
+                     [&](const RadioControlUserAppData &data)
+                     {
+                         mscDataGroups.append(data);
+                         mscBytes += data.data.size();
+                     });
+    QObject::connect(&player, &ServiceStreamPlayer::userAppData_Announcement, &app,
+                     [&](const RadioControlUserAppData &data)
+                     {
+                         mscDataGroups.append(data);
+                         mscBytes += data.data.size();
+                     });
+    QObject::connect(&player, &ServiceStreamPlayer::dlDataGroup_Service, &app,
+                     [&](const QByteArray &dg)
+                     {
+                         dlDataGroups.append(dg);
+                         dlBytes += dg.size();
+                     });
+    QObject::connect(&player, &ServiceStreamPlayer::finished, &app, &QCoreApplication::quit);
+    player.start();
+    app.exec();
+
+    if (mscDataGroups.isEmpty() && dlDataGroups.isEmpty())
+    {
+        out << "No data groups found in file: " << parser.positionalArguments().at(0) << Qt::endl;
+        return 1;
+    }
+
+    // CRC of MSC data groups
+    QList<QByteArray> crcDataGroups;
+    qint64 crcBytes = 0;
+    for (const auto &data : std::as_const(mscDataGroups))
+    {
+        if (!data.data.isEmpty() && (data.data.at(0) & 0x40))
+        {  // CRC flag
+            crcDataGroups.append(data.data);
+            crcBytes += data.data.size();
+        }
+    }
+    int crcMismatch = 0;
+    for (const auto &dg : std::as_const(crcDataGroups))
+    {
+        if (crc16checkBitwise(dg) != Crc16::check(reinterpret_cast<const uint8_t *>(dg.constData()), dg.size()))
+        {
+            crcMismatch += 1;
+        }
+    }
+    int crcOk = 0;
+    double crcBitwiseUs = measureUs(numPasses,
+                                    [&]()
+                                    {
+                                        for (const auto &dg : std::as_const(crcDataGroups))
+                                        {
+                                            crcOk += crc16checkBitwise(dg);
+                                        }
+                                    });
+    double crcTableUs = measureUs(numPasses,
+                                  [&]()
+                                  {
+                                      for (const auto &dg : std::as_const(crcDataGroups))
+                                      {
+                                          crcOk += Crc16::check(reinterpret_cast<const uint8_t *>(dg.constData()), dg.size());
+                                      }
+                                  });
+
+    // MSC data group header parsing
+    int numValid = 0;
+    double parseUs = measureUs(numPasses,
+                               [&]()
+                               {
+                                   for (const auto &data : std::as_const(mscDataGroups))
+                                   {
+                                       MSCDataGroup mscDataGroup(data.data);
+                                       numValid += mscDataGroup.isValid();
+                                   }
+                               });
+    numValid /= numPasses;
+
+    // MOT decoding, decoder per service component as in user applications
+    int numMotObjects = 0;
+    double motUs = measureUs(numPasses,
+                             [&]()
+                             {
+                                 QHash<uint32_t, MOTDecoder *> decoders;
+                                 for (const auto &data : std::as_const(mscDataGroups))
+                                 {
+                                     uint32_t key = (uint32_t(data.userAppType) << 16) | data.SCId;
+                                     MOTDecoder *decoder = decoders.value(key, nullptr);
+                                     if (nullptr == decoder)
+                                     {
+                                         decoder = new MOTDecoder();
+                                         QObject::connect(decoder, &MOTDecoder::newMOTObject, [&numMotObjects]() { numMotObjects += 1; });
+                                         QObject::connect(decoder, &MOTDecoder::newMOTObjectInDirectory, [&numMotObjects]() { numMotObjects += 1; });
+                                         decoders.insert(key, decoder);
+                                     }
+                                     decoder->newDataGroup(data.data);
+                                 }
+                                 qDeleteAll(decoders);
+                             });
+    numMotObjects /= numPasses;
+
+    // DL decoding
+    int numLabels = 0;
+    DLDecoder dlDecoder;
+    QObject::connect(&dlDecoder, &DLDecoder::dlComplete, [&numLabels]() { numLabels += 1; });
+    double dlUs = measureUs(numPasses,
+                            [&]()
+                            {
+                                dlDecoder.reset();
+                                for (const auto &dg : std::as_const(dlDataGroups))
+                                {
+                                    dlDecoder.newDataGroup(dg);
+                                }
+                            });
+    numLabels /= numPasses;
+
+    out << "File:               " << parser.positionalArguments().at(0) << Qt::endl;
+    out << "MSC data groups:    " << mscDataGroups.size() << " (" << mscBytes << " bytes, " << numValid << " valid, " << crcDataGroups.size()
+        << " with CRC)" << Qt::endl;
+    out << "DL data groups:     " << dlDataGroups.size() << " (" << dlBytes << " bytes)" << Qt::endl;
+    out << "Passes:             " << numPasses << Qt::endl;
+    if (!crcDataGroups.isEmpty())
+    {
+        out << "CRC bitwise:        " << throughput(crcBitwiseUs, numPasses, crcDataGroups.size(), crcBytes) << Qt::endl;
+        out << "CRC slicing-by-8:   " << throughput(crcTableUs, numPasses, crcDataGroups.size(), crcBytes) << " ("
+            << QString::number(crcBitwiseUs / crcTableUs, 'f', 1) << "x)" << Qt::endl;
+        out << "CRC mismatches:     " << crcMismatch << Qt::endl;
+    }
+    if (!mscDataGroups.isEmpty())
+    {
+        out << "MSC header parsing: " << throughput(parseUs, numPasses, mscDataGroups.size(), mscBytes) << Qt::endl;
+        out << "MOT decoding:       " << throughput(motUs, numPasses, mscDataGroups.size(), mscBytes) << ", " << numMotObjects << " objects"
+            << Qt::endl;
+    }
+    if (!dlDataGroups.isEmpty())
+    {
+        out << "DL decoding:        " << throughput(dlUs, numPasses, dlDataGroups.size(), dlBytes) << ", " << numLabels << " labels" << Qt::endl;
+    }
+
+    return (crcMismatch == 0) ? 0 : 1;
+}
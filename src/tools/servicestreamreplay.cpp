@@ -0,0 +1,201 @@
+/*
+ * This file is part of the AbracaDABra project
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019-2026 Petr Kopecký <xkejpi (at) gmail (dot) com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QGuiApplication>
+#include <QTextStream>
+
+#include "audiodecoder.h"
+#include "audiorecorder.h"
+#include "config.h"
+#include "dldecoder.h"
+#include "servicestreamplayer.h"
+#include "slideshowapp.h"
+#include "spiapp.h"
+#if HAVE_FDKAAC
+#include "audiodecoderfdkaac.h"
+typedef AudioDecoderFDKAAC AudioDecoderAAC;
+#else
+#include "audiodecoderfaad.h"
+typedef AudioDecoderFAAD AudioDecoderAAC;
+#endif
+
+// Service stream replay
+// Input is service stream file recorded by ServiceStreamRecorder (Ensemble information -> context menu of latency statistics).
+// Recorded data are passed to AudioDecoder, DLDecoder, SlideShowApp and SPIApp the same way as from RadioControl,
+// decoded DL, slides and SPI documents are printed. This allows reproducing decoder issues without input device and DAB SDR library.
+
+namespace
+{
+void drainFifo(audioFifo_t &fifo)
+{
+    int64_t count = fifo.count.load();
+    if (count > 0)
+    {
+        fifo.latencyStamps.pop(count, count);
+        fifo.tail = (fifo.tail + count) % fifo.size;
+        fifo.commitRead(count);
+    }
+}
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    // slides are decoded to QPixmap, no display is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QGuiApplication::setApplicationName("servicestreamreplay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Service stream replay. Decodes audio, DL, slideshow and SPI from service stream file recorded by AbracaDABra.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Recorded .adss file.");
+    QCommandLineOption speedOption(QStringList() << "s" << "speed", "Replay speed, 1 is real time, 0 is as fast as possible (default 0).", "speed",
+                                   "0");
+    parser.addOption(speedOption);
+    QCommandLineOption slidesOption(QStringList() << "d" << "dump-slides", "Save received slides to directory.", "directory");
+    parser.addOption(slidesOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    if (parser.positionalArguments().size() != 1)
+    {
+        parser.showHelp(1);
+    }
+
+    ServiceStreamPlayer player;
+    if (!player.open(parser.positionalArguments().at(0)))
+    {
+        out << "Unable to open service stream file: " << parser.positionalArguments().at(0) << Qt::endl;
+        return 1;
+    }
+    player.setSpeed(parser.value(speedOption).toFloat());
+
+    const QString slidesDir = parser.value(slidesOption);
+    if (!slidesDir.isEmpty())
+    {
+        QDir().mkpath(slidesDir);
+    }
+
+    audioFifo[0].allocate(AUDIO_FIFO_CHUNK_MS);
+    audioFifo[1].allocate(AUDIO_FIFO_CHUNK_MS);
+
+    // audio
+    AudioRecorder recorder;
+    AudioDecoderAAC decoder(&recorder);
+    QObject::connect(&player, &ServiceStreamPlayer::audioServiceSelection, &decoder, &AudioDecoder::start);
+    QObject::connect(&player, &ServiceStreamPlayer::audioData, &decoder,
+                     [&decoder](RadioControlAudioData *pData)
+                     {
+                         decoder.decodeData(pData);
+                         drainFifo(audioFifo[0]);
+                         drainFifo(audioFifo[1]);
+                     });
+    static const char *codingName[] = {"MP2", "AAC-LC", "HE-AAC", "HE-AAC v2"};
+    QObject::connect(&decoder, &AudioDecoder::audioParametersInfo, &app,
+                     [&out](const AudioParameters &p)
+                     {
+                         if (AudioCoding::None != p.coding)
+                         {
+                             out << "Audio: " << codingName[int(p.coding)] << " " << p.sampleRateKHz << " kHz " << (p.stereo ? "stereo" : "mono")
+                                 << Qt::endl;
+                         }
+                     });
+
+    // ensemble and service
+    QObject::connect(&player, &ServiceStreamPlayer::ensembleInformation, &app,
+                     [&out](const RadioControlEnsemble &ens)
+                     {
+                         out << "Ensemble: " << ens.label << " [" << QString("%1").arg(ens.ueid, 6, 16, QChar('0')).toUpper() << "] "
+                             << ens.frequency << " kHz" << Qt::endl;
+                     });
+    QObject::connect(&player, &ServiceStreamPlayer::audioServiceSelection, &app,
+                     [&out](const RadioControlServiceComponent &s)
+                     {
+                         out << "Service: " << s.label << " [" << QString("%1").arg(s.SId.value(), 6, 16, QChar('0')).toUpper() << "]"
+                             << Qt::endl;
+                     });
+
+    // dynamic label
+    DLDecoder dlDecoder;
+    QObject::connect(&player, &ServiceStreamPlayer::dlDataGroup_Service, &dlDecoder, &DLDecoder::newDataGroup);
+    QObject::connect(&player, &ServiceStreamPlayer::audioServiceSelection, &dlDecoder, &DLDecoder::reset);
+    QObject::connect(&dlDecoder, &DLDecoder::dlComplete, &app, [&out](const QString &dl) { out << "DL: " << dl << Qt::endl; });
+
+    // slideshow
+    SlideShowApp slideShowApp;
+    QObject::connect(&player, &ServiceStreamPlayer::audioServiceSelection, &slideShowApp, &SlideShowApp::start);
+    QObject::connect(&player, &ServiceStreamPlayer::userAppData_Service, &slideShowApp, &SlideShowApp::onUserAppData);
+    QObject::connect(&player, &ServiceStreamPlayer::ensembleInformation, &slideShowApp, &UserApplication::setEnsId);
+    QObject::connect(&player, &ServiceStreamPlayer::audioServiceSelection, &slideShowApp, &UserApplication::setAudioServiceId);
+    int slideCount = 0;
+    QObject::connect(&slideShowApp, &SlideShowApp::currentSlide, &app,
+                     [&out, &slideCount, &slidesDir](const Slide &slide)
+                     {
+                         slideCount += 1;
+                         out << "Slide: " << slide.getContentName() << " " << slide.getSize().width() << "x" << slide.getSize().height()
+                             << Qt::endl;
+                         if (!slidesDir.isEmpty())
+                         {
+                             slide.getImage().save(QString("%1/slide_%2.png").arg(slidesDir).arg(slideCount, 4, 10, QChar('0')));
+                         }
+                     });
+
+    // SPI
+    SPIApp spiApp;
+    QObject::connect(&player, &ServiceStreamPlayer::audioServiceSelection, &spiApp, &SPIApp::start);
+    QObject::connect(&player, &ServiceStreamPlayer::userAppData_Service, &spiApp, &SPIApp::onUserAppData);
+    QObject::connect(&player, &ServiceStreamPlayer::ensembleInformation, &spiApp, &UserApplication::setEnsId);
+    QObject::connect(&player, &ServiceStreamPlayer::audioServiceSelection, &spiApp, &UserApplication::setAudioServiceId);
+    QObject::connect(&spiApp, &SPIApp::metadata, &app,
+                     [&out](const SPIMetadata &metadata, const QString &scopeId, uint16_t decoderId)
+                     {
+                         int numProgrammes = 0;
+                         for (const auto &schedule : metadata.schedules)
+                         {
+                             numProgrammes += schedule.programmes.size();
+                         }
+                         out << "SPI: " << scopeId << " decoder " << decoderId << ", " << metadata.root << ": " << metadata.services.size()
+                             << " services, " << numProgrammes << " programmes" << Qt::endl;
+                     });
+
+    QObject::connect(&player, &ServiceStreamPlayer::finished, &app,
+                     [&]()
+                     {
+                         decoder.stop();
+                         slideShowApp.waitForDecoding();
+                         out << "Replayed " << QString::number(player.durationMs() / 1000.0, 'f', 1) << " s, " << player.numAudioFrames()
+                             << " audio frames, " << player.numDataGroups() << " data groups, " << slideCount << " slides" << Qt::endl;
+                         app.quit();
+                     });
+
+    player.start();
+    return app.exec();
+}